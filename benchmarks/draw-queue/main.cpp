@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <orb/renderer.hpp>
+
+using namespace orb;
+
+static constexpr ui32 iterations = 32;
+
+static constexpr std::array<ui32, 4> draw_counts = {
+    1'000,
+    10'000,
+    100'000,
+    1'000'000,
+};
+
+/* @brief Distinct states a synthetic scene draws with */
+struct scene_t
+{
+    const char* name;
+    ui32        pipelines;
+    ui32        desc_sets;
+    ui32        meshes;
+};
+
+static constexpr std::array<scene_t, 3> scenes = { {
+    { "few materials", 8, 32, 64 },
+    { "many materials", 256, 2048, 1024 },
+    { "unique meshes", 16, 128, 4096 },
+} };
+
+struct timing_t
+{
+    double avg_ms = 0.0;
+    double min_ms = std::numeric_limits<double>::max();
+
+    void add(double ms)
+    {
+        avg_ms += ms / iterations;
+        min_ms  = std::min(min_ms, ms);
+    }
+};
+
+template <typename T>
+static auto fake_handle(ui32 id) -> T
+{
+    return reinterpret_cast<T>(static_cast<uintptr_t>(id + 1)); // NOLINT
+}
+
+static auto total_binds(const vk::draw_stats_t& s) -> ui32
+{
+    return s.pipeline_binds + s.set_binds + s.vertex_binds + s.index_binds;
+}
+
+/* @brief Pushes `count` draws of `scene` in random order */
+static void fill(vk::draw_queue_t& queue, const scene_t& scene, ui32 count, std::mt19937& rng)
+{
+    std::uniform_real_distribution<f32> depth(0.0f, 1.0f);
+
+    queue.clear();
+
+    for (ui32 i = 0; i < count; ++i)
+    {
+        const ui32 pipeline = rng() % scene.pipelines;
+        const ui32 set      = rng() % scene.desc_sets;
+        const ui32 mesh     = rng() % scene.meshes;
+
+        const vk::draw_key_t key {
+            .layer    = 0,
+            .pipeline = pipeline,
+            .desc_set = set,
+            .mesh     = mesh,
+            .depth    = depth(rng),
+        };
+
+        const vk::draw_item_t item {
+            .pipeline      = fake_handle<VkPipeline>(pipeline),
+            .layout        = fake_handle<VkPipelineLayout>(0),
+            .desc_set      = fake_handle<VkDescriptorSet>(set),
+            .vertex_buffer = fake_handle<VkBuffer>(mesh),
+            .index_buffer  = fake_handle<VkBuffer>(mesh),
+            .index_count   = 36,
+        };
+
+        queue.push(key, item);
+    }
+}
+
+auto main() -> int
+{
+    std::mt19937 rng(42);
+
+    fmt::println("{:>16} {:>9} | {:>10} {:>10} {:>10} | {:>10} {:>10} | {:>10} {:>10}",
+                 "scene",
+                 "draws",
+                 "radix avg",
+                 "radix min",
+                 "Mkeys/s",
+                 "std avg",
+                 "Mkeys/s",
+                 "binds",
+                 "sorted");
+
+    vk::draw_queue_t queue;
+
+    for (const auto& scene : scenes)
+    {
+        for (auto count : draw_counts)
+        {
+            queue.reserve(count);
+
+            timing_t radix;
+            timing_t reference;
+
+            vk::draw_stats_t unsorted;
+            vk::draw_stats_t sorted;
+
+            for (ui32 i = 0; i < iterations; ++i)
+            {
+                fill(queue, scene, count, rng);
+                unsorted = queue.stats();
+
+                // Same keys through a comparison sort, as a baseline
+                std::vector<std::pair<ui64, ui32>> keys(count);
+                for (ui32 k = 0; k < count; ++k)
+                {
+                    keys[k] = { queue.key(k), k };
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                queue.sort();
+                auto end = std::chrono::steady_clock::now();
+
+                radix.add(std::chrono::duration<double, std::milli>(end - start).count());
+
+                start = std::chrono::steady_clock::now();
+                std::ranges::stable_sort(keys, {}, &std::pair<ui64, ui32>::first);
+                end = std::chrono::steady_clock::now();
+
+                reference.add(std::chrono::duration<double, std::milli>(end - start).count());
+
+                sorted = queue.stats();
+            }
+
+            const auto mkeys = [count](double ms) {
+                return static_cast<double>(count) / (ms * 1000.0);
+            };
+
+            fmt::println("{:>16} {:>9} | {:>8.3f}ms {:>8.3f}ms {:>10.1f} | {:>8.3f}ms {:>10.1f} | {:>10} {:>10}",
+                         scene.name,
+                         count,
+                         radix.avg_ms,
+                         radix.min_ms,
+                         mkeys(radix.avg_ms),
+                         reference.avg_ms,
+                         mkeys(reference.avg_ms),
+                         total_binds(unsorted),
+                         total_binds(sorted));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <vector>
+
+#include <orb/renderer.hpp>
+
+using namespace orb;
+
+static constexpr ui32 iterations = 5;
+
+static constexpr ui32 max_async_in_flight = 256;
+
+static constexpr std::array<ui32, 3> task_counts = {
+    1'000,
+    10'000,
+    100'000,
+};
+
+/* @brief Work done by each task */
+struct workload_t
+{
+    const char* name;
+    ui32        spins;
+};
+
+static constexpr std::array<workload_t, 3> workloads = { {
+    { "empty", 0 },
+    { "~1us", 250 },
+    { "~10us", 2'500 },
+} };
+
+struct timing_t
+{
+    double avg_ms = 0.0;
+    double min_ms = std::numeric_limits<double>::max();
+
+    void add(double ms)
+    {
+        avg_ms += ms / iterations;
+        min_ms  = std::min(min_ms, ms);
+    }
+};
+
+static std::atomic<ui64> sink = 0;
+
+static void task(ui32 spins)
+{
+    f32 x = 1.0f;
+    for (ui32 i = 0; i < spins; ++i)
+    {
+        x = std::sqrt(x + static_cast<f32>(i));
+    }
+
+    sink.fetch_add(static_cast<ui64>(x), std::memory_order_relaxed);
+}
+
+template <typename TFn>
+static auto time_ms(TFn&& fn) -> double
+{
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+auto main() -> int
+{
+    auto jobs = job_system_builder_t::prepare().unwrap().build().unwrap();
+
+    fmt::println("{} workers, plus the main thread", jobs->threads());
+    fmt::println("");
+    fmt::println("{:>8} {:>8} | {:>10} {:>10} | {:>10} {:>10} | {:>10} {:>10} | {:>8}",
+                 "task",
+                 "count",
+                 "jobs avg",
+                 "Mtasks/s",
+                 "nested avg",
+                 "Mtasks/s",
+                 "async avg",
+                 "Mtasks/s",
+                 "speedup");
+
+    for (const auto& workload : workloads)
+    {
+        for (auto count : task_counts)
+        {
+            timing_t scheduled;
+            timing_t nested;
+            timing_t async;
+
+            for (ui32 i = 0; i < iterations; ++i)
+            {
+                // Scheduled from the main thread, through the shared queue
+                scheduled.add(time_ms([&] {
+                    job_counter_t done;
+                    for (ui32 t = 0; t < count; ++t)
+                    {
+                        jobs->run([spins = workload.spins] { task(spins); }, &done);
+                    }
+                    jobs->wait(done);
+                }));
+
+                // Scheduled from a worker, into its own deque and stolen by the others
+                nested.add(time_ms([&] {
+                    job_counter_t done;
+                    jobs->run(
+                        [&] {
+                            for (ui32 t = 0; t < count; ++t)
+                            {
+                                jobs->run([spins = workload.spins] { task(spins); }, &done);
+                            }
+                        },
+                        &done);
+                    jobs->wait(done);
+                }));
+
+                // One thread per task, bounded so that large counts stay under the thread limit
+                async.add(time_ms([&] {
+                    std::vector<std::future<void>> futures(std::min(count, max_async_in_flight));
+                    for (ui32 t = 0; t < count; ++t)
+                    {
+                        auto& f = futures[t % futures.size()];
+                        if (f.valid()) f.wait();
+
+                        f = std::async(std::launch::async, task, workload.spins);
+                    }
+                    for (auto& f : futures)
+                    {
+                        if (f.valid()) f.wait();
+                    }
+                }));
+            }
+
+            const auto mtasks = [count](double ms) {
+                return static_cast<double>(count) / (ms * 1000.0);
+            };
+
+            fmt::println("{:>8} {:>8} | {:>8.3f}ms {:>10.2f} | {:>8.3f}ms {:>10.2f} | {:>8.3f}ms {:>10.2f} | {:>7.1f}x",
+                         workload.name,
+                         count,
+                         scheduled.avg_ms,
+                         mtasks(scheduled.avg_ms),
+                         nested.avg_ms,
+                         mtasks(nested.avg_ms),
+                         async.avg_ms,
+                         mtasks(async.avg_ms),
+                         async.avg_ms / std::min(scheduled.avg_ms, nested.avg_ms));
+        }
+    }
+
+    // Data parallel loop, against a serial one
+    constexpr ui32 elements = 10'000'000;
+
+    std::vector<f32> values(elements, 2.0f);
+
+    timing_t serial;
+    timing_t parallel;
+
+    for (ui32 i = 0; i < iterations; ++i)
+    {
+        serial.add(time_ms([&] {
+            for (auto& v : values)
+            {
+                v = std::sqrt(v + 1.0f);
+            }
+        }));
+
+        parallel.add(time_ms([&] {
+            jobs->parallel_for(elements, 16'384, [&](ui32 begin, ui32 end) {
+                for (ui32 e = begin; e < end; ++e)
+                {
+                    values[e] = std::sqrt(values[e] + 1.0f);
+                }
+            });
+        }));
+    }
+
+    fmt::println("");
+    fmt::println("parallel_for over {} floats: serial {:.3f}ms, parallel {:.3f}ms ({:.1f}x)",
+                 elements,
+                 serial.avg_ms,
+                 parallel.avg_ms,
+                 serial.avg_ms / parallel.avg_ms);
+
+    return 0;
+}
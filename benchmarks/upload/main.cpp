@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <orb/renderer.hpp>
+
+using namespace orb;
+
+static constexpr ui32 iterations = 64;
+
+static constexpr std::array<ui64, 4> upload_sizes = {
+    64 * 1024,
+    1024 * 1024,
+    16 * 1024 * 1024,
+    64 * 1024 * 1024,
+};
+
+struct timing_t
+{
+    double             avg_ms = 0.0;
+    double             min_ms = 0.0;
+    vk::upload_stats_t stats  = {};
+};
+
+/* @brief Creates a vertex buffer sized for `data` and uploads `data` into it `iterations` times */
+static auto bench_upload(weak<vk::device_t>   device,
+                         weak<vk::cmd_pool_t> pool,
+                         VkQueue              queue,
+                         std::span<const ui8> data,
+                         bool                 direct) -> timing_t
+{
+    auto buffer = vk::vertex_buffer_builder_t::prepare(device)
+                      .unwrap()
+                      .vertices(data)
+                      .prefer_direct_upload(direct)
+                      .build()
+                      .unwrap();
+
+    timing_t timing;
+    timing.min_ms = std::numeric_limits<double>::max();
+
+    for (ui32 i = 0; i < iterations; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        timing.stats = vk::buffer_upload_helper_t::prepare(device)
+                           .copy(data, buffer)
+                           .staging(pool, queue)
+                           .upload()
+                           .unwrap();
+
+        const auto end = std::chrono::steady_clock::now();
+        const auto ms  = std::chrono::duration<double, std::milli>(end - start).count();
+
+        timing.avg_ms += ms;
+        timing.min_ms  = std::min(timing.min_ms, ms);
+    }
+
+    timing.avg_ms /= iterations;
+
+    return timing;
+}
+
+auto main() -> int
+{
+    try
+    {
+        box<vk::instance_t> instance = vk::instance_builder_t::prepare()
+                                           .unwrap()
+                                           .molten_vk(orb::on_macos ? true : false)
+                                           .add_extension(vk::khr_extensions::device_properties_2)
+                                           .build()
+                                           .unwrap();
+
+        box<vk::gpu_t> gpu = vk::gpu_selector_t::prepare(instance->handle)
+                                 .unwrap()
+                                 .prefer_type(vk::gpu_type::discrete)
+                                 .prefer_type(vk::gpu_type::integrated)
+                                 .select()
+                                 .unwrap();
+
+        gpu->describe();
+
+        auto transfer_qf = gpu->queue_family_map->transfer().unwrap().front();
+
+        auto device = vk::device_builder_t::prepare(instance->handle)
+                          .unwrap()
+                          .add_queue(transfer_qf, 1.0f)
+                          .build(*gpu)
+                          .unwrap();
+
+        auto pool = vk::cmd_pool_builder_t::prepare(device.getmut(), transfer_qf->index)
+                        .unwrap()
+                        .build()
+                        .unwrap();
+
+        VkQueue queue = transfer_qf->queues.front();
+
+        fmt::println("- Host visible VRAM available: {}",
+                     vk::has_host_visible_vram(device->allocator, upload_sizes.front()));
+
+        fmt::println("{:>12} | {:>12} {:>12} | {:>12} {:>12} | {}",
+                     "size (KiB)",
+                     "staged avg",
+                     "staged min",
+                     "direct avg",
+                     "direct min",
+                     "direct path");
+
+        for (auto size : upload_sizes)
+        {
+            std::vector<ui8> data(size);
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                data[i] = static_cast<ui8>(i);
+            }
+
+            const auto staged = bench_upload(device.getmut(), pool.getmut(), queue, data, false);
+            const auto direct = bench_upload(device.getmut(), pool.getmut(), queue, data, true);
+
+            fmt::println("{:>12} | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms | {}",
+                         size / 1024,
+                         staged.avg_ms,
+                         staged.min_ms,
+                         direct.avg_ms,
+                         direct.min_ms,
+                         direct.stats.direct_copies > 0 ? "yes" : "no (fell back to staging)");
+        }
+
+        device->wait().unwrap();
+    }
+    catch (const orb::exception& e)
+    {
+        fmt::println("Fatal error: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace orb
+{
+    class job_system_t;
+
+    /* @brief A job, must not throw */
+    using job_fn_t = std::function<void()>;
+
+    struct job_t;
+
+    /* @brief Unfinished jobs attached to it, waited on with `job_system_t::wait`
+     *
+     * A counter must outlive its jobs and the jobs scheduled after it with `run_after`.
+     */
+    class job_counter_t
+    {
+    public:
+        job_counter_t() = default;
+
+        job_counter_t(const job_counter_t&)                    = delete;
+        auto operator=(const job_counter_t&) -> job_counter_t& = delete;
+
+        job_counter_t(job_counter_t&&)                    = delete;
+        auto operator=(job_counter_t&&) -> job_counter_t& = delete;
+
+        [[nodiscard]] auto done() const -> bool { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class job_system_t;
+
+        std::atomic<ui32>   m_pending = 0;
+        std::mutex          m_mutex; // guards the continuations
+        std::vector<job_t*> m_continuations;
+    };
+
+    /* @brief Chase-Lev work stealing deque: the owner pushes and pops at the bottom, thieves
+     * steal from the top. Grows when full, retired rings are kept since thieves may read them.
+     */
+    class work_deque_t
+    {
+    public:
+        work_deque_t();
+
+        work_deque_t(const work_deque_t&)                    = delete;
+        auto operator=(const work_deque_t&) -> work_deque_t& = delete;
+
+        work_deque_t(work_deque_t&&)                    = delete;
+        auto operator=(work_deque_t&&) -> work_deque_t& = delete;
+
+        /* @brief Owner only */
+        void push(job_t* job);
+
+        /* @brief Owner only, newest job first */
+        [[nodiscard]] auto pop() -> job_t*;
+
+        /* @brief Any thread, oldest job first. Returns null when empty or when losing a race */
+        [[nodiscard]] auto steal() -> job_t*;
+
+    private:
+        struct ring_t
+        {
+            std::int64_t                           capacity = 0;
+            std::unique_ptr<std::atomic<job_t*>[]> slots;
+
+            explicit ring_t(std::int64_t size);
+
+            [[nodiscard]] auto load(std::int64_t i) const -> job_t* { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+
+            void store(std::int64_t i, job_t* job) { slots[i & (capacity - 1)].store(job, std::memory_order_relaxed); }
+        };
+
+        auto grow(ring_t* ring, std::int64_t top, std::int64_t bottom) -> ring_t*;
+
+        std::atomic<std::int64_t>            m_top    = 0;
+        std::atomic<std::int64_t>            m_bottom = 0;
+        std::atomic<ring_t*>                 m_ring   = nullptr;
+        std::vector<std::unique_ptr<ring_t>> m_rings; // owner only, current one last
+    };
+
+    /* @brief Threads running jobs, shared by every subsystem instead of each spawning its own
+     *
+     * Each worker owns a work stealing deque: jobs scheduled from a worker go to its own deque,
+     * where it takes the newest first, and idle workers steal the oldest jobs of the others.
+     * Jobs scheduled from other threads go through a shared queue.
+     *
+     *   job_counter_t loaded;
+     *   for (auto& file : files) jobs->run([&] { decode(file); }, &loaded);
+     *   job_counter_t uploaded;
+     *   jobs->run_after(loaded, [&] { upload_all(); }, &uploaded);
+     *   jobs->wait(uploaded);
+     *
+     *   jobs->parallel_for(object_count, 1024, [&](ui32 begin, ui32 end) { cull(begin, end); });
+     *
+     * `wait` runs jobs while the counter is not done, so waiting from a job does not block its
+     * worker. A job given an affinity only runs on that worker and is never stolen, for work
+     * touching objects owned by a thread, like command pools. `thread_slot` gives a dense index
+     * to key such per thread objects with.
+     */
+    class job_system_t
+    {
+    public:
+        static constexpr i32 any_thread = -1;
+
+        job_system_t() = default;
+
+        job_system_t(const job_system_t&)                    = delete;
+        auto operator=(const job_system_t&) -> job_system_t& = delete;
+
+        job_system_t(job_system_t&&)                    = delete;
+        auto operator=(job_system_t&&) -> job_system_t& = delete;
+
+        /* @brief Stops the workers, every counter must be done */
+        ~job_system_t();
+
+        /* @brief Schedules `fn`, `counter` is done once it ran
+         *
+         * `affinity` is a worker index, taken modulo `threads()`.
+         */
+        void run(job_fn_t fn, job_counter_t* counter = nullptr, i32 affinity = any_thread);
+
+        /* @brief Schedules `fn` once `dependency` is done */
+        void run_after(job_counter_t& dependency, job_fn_t fn, job_counter_t* counter = nullptr, i32 affinity = any_thread);
+
+        /* @brief Runs jobs until `counter` is done */
+        void wait(job_counter_t& counter);
+
+        /* @brief Calls `fn(begin, end)` over [0, count) in chunks of at least `min_batch` items
+         *
+         * Blocks until every chunk ran, the calling thread running chunks as well.
+         */
+        template <typename TFn>
+        void parallel_for(ui32 count, ui32 min_batch, TFn&& fn)
+        {
+            if (count == 0) return;
+
+            // A few chunks per thread, so that threads finishing early steal the rest
+            const ui32 batches = (count + std::max(min_batch, 1u) - 1) / std::max(min_batch, 1u);
+            const ui32 chunks  = std::min(batches, (threads() + 1) * 4);
+
+            job_counter_t counter;
+
+            for (ui32 i = 1; i < chunks; ++i)
+            {
+                const ui32 begin = static_cast<ui64>(count) * i / chunks;
+                const ui32 end   = static_cast<ui64>(count) * (i + 1) / chunks;
+
+                run([&fn, begin, end] { fn(begin, end); }, &counter);
+            }
+
+            fn(0, static_cast<ui32>(static_cast<ui64>(count) / chunks));
+            wait(counter);
+        }
+
+        /* @brief Worker threads, not counting the threads scheduling and waiting */
+        [[nodiscard]] auto threads() const -> ui32 { return static_cast<ui32>(m_workers.size()); }
+
+        /* @brief Index of the calling worker, `threads()` for any other thread */
+        [[nodiscard]] auto thread_slot() const -> ui32;
+
+    private:
+        friend class job_system_builder_t;
+
+        struct worker_t
+        {
+            work_deque_t deque;
+            std::thread  thread;
+
+            // Jobs with an affinity to this worker
+            std::mutex          mailbox_mutex;
+            std::vector<job_t*> mailbox;
+            std::atomic<ui32>   mailbox_size = 0;
+        };
+
+        void worker_loop(ui32 index);
+        void schedule(job_t* job);
+        void execute(job_t* job);
+        void finish(job_counter_t& counter);
+
+        /* @brief A job the calling thread may run, null if none was found */
+        [[nodiscard]] auto find_job(i32 self) -> job_t*;
+
+        [[nodiscard]] auto worker_index() const -> i32;
+
+        std::vector<std::unique_ptr<worker_t>> m_workers;
+
+        std::mutex         m_shared_mutex;
+        std::deque<job_t*> m_shared; // scheduled by non worker threads
+        std::atomic<ui32>  m_shared_size = 0;
+
+        std::atomic<ui32> m_signal = 0; // bumped by each schedule, idle workers sleep on it
+        std::atomic<bool> m_stop   = false;
+    };
+
+    class job_system_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare() -> result<job_system_builder_t>
+        {
+            return job_system_builder_t {};
+        }
+
+        /* @brief Worker threads. Defaults to the core count minus one, for the main thread */
+        auto threads(ui32 count) -> job_system_builder_t&
+        {
+            m_threads = count;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<job_system_t>>;
+
+    private:
+        ui32 m_threads = 0;
+    };
+} // namespace orb
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <orb/result.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace orb
+{
+    /* @brief Read-only memory mapping of a whole file
+     *
+     * The pages are loaded by the OS on first access, so readers can copy straight from the
+     * mapping to their destination (typically a staging buffer) without reading the file into an
+     * intermediate buffer first.
+     */
+    class mapped_file_t
+    {
+    public:
+        [[nodiscard]] static auto open(const std::filesystem::path& file_path) -> result<mapped_file_t>;
+
+        mapped_file_t() = default;
+
+        mapped_file_t(const mapped_file_t&)                    = delete;
+        auto operator=(const mapped_file_t&) -> mapped_file_t& = delete;
+
+        mapped_file_t(mapped_file_t&& other) noexcept;
+        auto operator=(mapped_file_t&& other) noexcept -> mapped_file_t&;
+
+        ~mapped_file_t();
+
+        void close();
+
+        [[nodiscard]] auto data() const -> const std::byte* { return m_data; }
+        [[nodiscard]] auto size() const -> size_t { return m_size; }
+        [[nodiscard]] auto bytes() const -> std::span<const std::byte> { return { m_data, m_size }; }
+
+        /* @brief Returns `size` bytes starting at `offset`, or an empty span if out of bounds */
+        [[nodiscard]] auto bytes(size_t offset, size_t size) const -> std::span<const std::byte>
+        {
+            if (offset > m_size || size > m_size - offset) return {};
+            return { m_data + offset, size };
+        }
+
+    private:
+        const std::byte* m_data = nullptr;
+        size_t           m_size = 0;
+
+#ifdef _WIN32
+        void* m_file    = nullptr;
+        void* m_mapping = nullptr;
+#else
+        int m_fd = -1;
+#endif
+    };
+} // namespace orb
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "orb/mapped_file.hpp"
+
+#include <orb/result.hpp>
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* .orbpak layout (little endian)
+ *
+ *   pak_header_t
+ *   blob data, each blob starting at a multiple of `header.alignment`
+ *   pak_entry_t[header.entry_count], sorted by name
+ *   name table (names are not null terminated)
+ */
+namespace orb
+{
+    enum class pak_blob_kind : ui32
+    {
+        raw,
+        vertices,
+        indices_u16,
+        indices_u32,
+        spirv,
+        ktx2,
+    };
+
+    inline constexpr std::array<char, 8> pak_magic   = { 'O', 'R', 'B', 'P', 'A', 'K', '\0', '\0' };
+    inline constexpr ui32                pak_version = 1;
+
+    /* @brief Default blob alignment: enough for any vertex attribute, index or SPIR-V word, and
+     * for the optimal buffer copy offset alignment of common GPUs */
+    inline constexpr ui32 pak_default_alignment = 256;
+
+    struct pak_header_t
+    {
+        std::array<char, 8> magic;
+        ui32                version;
+        ui32                entry_count;
+        ui64                index_offset;
+        ui64                names_offset;
+        ui64                names_size;
+        ui32                alignment;
+        ui32                reserved;
+    };
+
+    struct pak_entry_t
+    {
+        ui64 offset;
+        ui64 size;
+        ui64 checksum;
+        ui32 name_offset;
+        ui32 name_size;
+        ui32 kind;
+        ui32 reserved;
+    };
+
+    static_assert(sizeof(pak_header_t) == 48);
+    static_assert(sizeof(pak_entry_t) == 40);
+
+    /* @brief 64 bit FNV-1a hash of a blob */
+    [[nodiscard]] auto pak_checksum(std::span<const std::byte> bytes) -> ui64;
+
+    struct pak_blob_t
+    {
+        std::string_view           name;
+        pak_blob_kind              kind = pak_blob_kind::raw;
+        std::span<const std::byte> data;
+        ui64                       checksum = 0;
+
+        /* @brief Views the blob as an array of T. Blobs are aligned, so this is a plain cast */
+        template <typename T>
+        [[nodiscard]] auto as() const -> std::span<const T>
+        {
+            return { reinterpret_cast<const T*>(data.data()), data.size() / sizeof(T) }; // NOLINT
+        }
+    };
+
+    /* @brief Memory mapped .orbpak archive
+     *
+     * Blob data is never copied: `find` returns spans into the mapping that can be handed to
+     * the upload helpers directly. They stay valid as long as the reader is alive.
+     */
+    class pak_reader_t
+    {
+    public:
+        [[nodiscard]] static auto open(const std::filesystem::path& file_path) -> result<pak_reader_t>;
+
+        [[nodiscard]] auto find(std::string_view name) const -> result<pak_blob_t>;
+        [[nodiscard]] auto blob(size_t index) const -> pak_blob_t;
+        [[nodiscard]] auto size() const -> size_t { return m_entries.size(); }
+
+        /* @brief Recomputes the checksum of a blob, touching all of its pages */
+        [[nodiscard]] auto verify(const pak_blob_t& blob) const -> bool;
+        [[nodiscard]] auto verify_all() const -> result<void>;
+
+    private:
+        mapped_file_t                m_file;
+        std::span<const pak_entry_t> m_entries;
+        std::string_view             m_names;
+    };
+
+    /* @brief Builds .orbpak archives (used by the orbpak tool) */
+    class pak_writer_t
+    {
+    public:
+        [[nodiscard]] static auto prepare() -> pak_writer_t { return {}; }
+
+        auto alignment(ui32 alignment) -> pak_writer_t&
+        {
+            m_alignment = alignment;
+            return *this;
+        }
+
+        auto add(std::string name, pak_blob_kind kind, std::vector<std::byte> data) -> pak_writer_t&
+        {
+            m_blobs.push_back({ std::move(name), kind, std::move(data) });
+            return *this;
+        }
+
+        [[nodiscard]] auto add_file(std::string name, pak_blob_kind kind, const std::filesystem::path& file_path)
+            -> result<void>;
+
+        [[nodiscard]] auto write(const std::filesystem::path& file_path) -> result<void>;
+
+    private:
+        struct pending_blob_t
+        {
+            std::string            name;
+            pak_blob_kind          kind;
+            std::vector<std::byte> data;
+        };
+
+        std::vector<pending_blob_t> m_blobs;
+        ui32                        m_alignment = pak_default_alignment;
+    };
+} // namespace orb
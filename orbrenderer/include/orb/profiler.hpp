@@ -0,0 +1,150 @@
+#pragma once
+
+#include <orb/result.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+/* CPU instrumentation, compiled in with the ORBRENDERER_PROFILING CMake option
+ *
+ *   ORB_PROFILE_THREAD("Render thread");
+ *   {
+ *       ORB_PROFILE_ZONE("Record scene");
+ *       ...
+ *   }
+ *   orb::profiler::write_trace("frame.json").unwrap(); // chrome://tracing or ui.perfetto.dev
+ *
+ * Zone names must outlive the export: string literals or other static storage.
+ */
+#ifdef ORBRENDERER_PROFILING
+    #define ORB_PROFILE_CONCAT_IMPL(a, b) a##b
+    #define ORB_PROFILE_CONCAT(a, b)      ORB_PROFILE_CONCAT_IMPL(a, b)
+    #define ORB_PROFILE_ZONE(name)        const ::orb::profiler::scoped_zone_t ORB_PROFILE_CONCAT(orb_zone_, __LINE__)(name)
+    #define ORB_PROFILE_FUNCTION()        ORB_PROFILE_ZONE(__func__)
+    #define ORB_PROFILE_THREAD(name)      ::orb::profiler::set_thread_name(name)
+#else
+    #define ORB_PROFILE_ZONE(name)   static_cast<void>(0)
+    #define ORB_PROFILE_FUNCTION()   static_cast<void>(0)
+    #define ORB_PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+namespace orb::profiler
+{
+    using trace_clock_t = std::chrono::steady_clock;
+
+    struct event_t
+    {
+        const char*             name = nullptr;
+        trace_clock_t::duration begin {};
+        trace_clock_t::duration end {};
+    };
+
+    /* @brief Fixed size block of events, appended to by its thread only */
+    struct event_chunk_t
+    {
+        static constexpr ui32 capacity = 4096;
+
+        std::array<event_t, capacity> events {};
+        std::atomic<ui32>             count = 0;
+        std::atomic<event_chunk_t*>   next  = nullptr;
+    };
+
+    /* @brief Events of one thread
+     *
+     * The owning thread is the only writer and publishes each event with a release store, so
+     * `write_trace` can read the buffers of running threads without locking them. Buffers are
+     * owned by a global registry and outlive their thread.
+     *
+     * A buffer holds at most `max_chunks` chunks, about 6 MiB. Once full, later events are
+     * counted as dropped instead of recorded, so long sessions keep their first events.
+     */
+    class thread_buffer_t
+    {
+    public:
+        thread_buffer_t() = default;
+
+        thread_buffer_t(const thread_buffer_t&)                    = delete;
+        auto operator=(const thread_buffer_t&) -> thread_buffer_t& = delete;
+
+        thread_buffer_t(thread_buffer_t&&)                    = delete;
+        auto operator=(thread_buffer_t&&) -> thread_buffer_t& = delete;
+
+        static constexpr ui32 max_chunks = 64;
+
+        ~thread_buffer_t();
+
+        void push(const event_t& event)
+        {
+            ui32 n = m_tail->count.load(std::memory_order_relaxed);
+
+            if (n == event_chunk_t::capacity) [[unlikely]]
+            {
+                if (m_chunks == max_chunks)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                grow();
+                n = 0;
+            }
+
+            m_tail->events[n] = event;
+            m_tail->count.store(n + 1, std::memory_order_release);
+        }
+
+        [[nodiscard]] auto head() const -> const event_chunk_t* { return &m_head; }
+
+        /* @brief Events not recorded since the buffer was full */
+        [[nodiscard]] auto dropped() const -> ui64 { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        void grow();
+
+        event_chunk_t     m_head;
+        event_chunk_t*    m_tail    = &m_head;
+        ui32              m_chunks  = 1;
+        std::atomic<ui64> m_dropped = 0;
+    };
+
+    /* @brief Buffer of the calling thread, registered on first use */
+    [[nodiscard]] auto thread_buffer() -> thread_buffer_t&;
+
+    /* @brief Name shown for the calling thread in exported traces */
+    void set_thread_name(std::string name);
+
+    /* @brief Records the time spent between construction and destruction */
+    class scoped_zone_t
+    {
+    public:
+        explicit scoped_zone_t(const char* name)
+            : m_name(name)
+            , m_begin(trace_clock_t::now().time_since_epoch())
+        {
+        }
+
+        scoped_zone_t(const scoped_zone_t&)                    = delete;
+        auto operator=(const scoped_zone_t&) -> scoped_zone_t& = delete;
+
+        scoped_zone_t(scoped_zone_t&&)                    = delete;
+        auto operator=(scoped_zone_t&&) -> scoped_zone_t& = delete;
+
+        ~scoped_zone_t()
+        {
+            thread_buffer().push({ m_name, m_begin, trace_clock_t::now().time_since_epoch() });
+        }
+
+    private:
+        const char*             m_name;
+        trace_clock_t::duration m_begin;
+    };
+
+    /* @brief Writes every event recorded so far as Chrome trace event JSON
+     *
+     * The format is read by chrome://tracing and by the Perfetto UI.
+     */
+    [[nodiscard]] auto write_trace(const std::filesystem::path& file_path) -> result<void>;
+} // namespace orb::profiler
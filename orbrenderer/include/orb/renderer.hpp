@@ -1,4 +1,7 @@
 #pragma once
 
 #include "orb/glfw.hpp"
+#include "orb/jobs.hpp"
+#include "orb/pak.hpp"
+#include "orb/profiler.hpp"
 #include "orb/vk/all.hpp"
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <orb/result.hpp>
+
+#include <array>
+
+namespace orb
+{
+    /* @brief Timings over the last `window` samples, in milliseconds */
+    struct rolling_stats_t
+    {
+        static constexpr ui32 window = 128;
+
+        std::array<f32, window> samples {};
+        ui32                    count = 0;
+        ui32                    head  = 0;
+        f32                     last  = 0.0f;
+
+        void add(f32 ms);
+
+        /* @brief Moving average over the window */
+        [[nodiscard]] auto average() const -> f32;
+
+        /* @brief Sample below which a fraction `p` of the window falls, e.g. 0.99f */
+        [[nodiscard]] auto percentile(f32 p) const -> f32;
+    };
+} // namespace orb
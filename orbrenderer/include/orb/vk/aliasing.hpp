@@ -0,0 +1,125 @@
+#pragma once
+
+#include "orb/vk/device.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Images placed in one shared allocation
+     *
+     * Images whose lifetimes do not overlap may occupy the same memory: their content is
+     * undefined at the start of their lifetime and they must be transitioned from
+     * `image_layout::undefined` on first use.
+     */
+    struct aliased_images_t
+    {
+        VkDevice      device     = nullptr;
+        VmaAllocator  allocator  = nullptr;
+        VmaAllocation allocation = nullptr;
+
+        std::vector<VkImage>      handles;
+        std::vector<VkDeviceSize> offsets;
+        std::vector<VkDeviceSize> sizes;
+
+        VkDeviceSize size           = 0; // size of the shared allocation
+        VkDeviceSize unaliased_size = 0; // what separate allocations would have used
+
+        aliased_images_t() = default;
+
+        aliased_images_t(const aliased_images_t&)                    = delete;
+        auto operator=(const aliased_images_t&) -> aliased_images_t& = delete;
+
+        aliased_images_t(aliased_images_t&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        auto operator=(aliased_images_t&& other) noexcept -> aliased_images_t&
+        {
+            destroy();
+
+            device         = other.device;
+            allocator      = other.allocator;
+            allocation     = other.allocation;
+            handles        = std::move(other.handles);
+            offsets        = std::move(other.offsets);
+            sizes          = std::move(other.sizes);
+            size           = other.size;
+            unaliased_size = other.unaliased_size;
+
+            other.allocation = nullptr;
+            other.handles.clear();
+
+            return *this;
+        }
+
+        ~aliased_images_t()
+        {
+            destroy();
+        }
+
+        void destroy()
+        {
+            for (auto& img : handles)
+            {
+                vkDestroyImage(device, img, host_callbacks(host_scope::resources));
+            }
+
+            handles.clear();
+
+            if (allocation)
+            {
+                vmaFreeMemory(allocator, allocation);
+                allocation = nullptr;
+            }
+        }
+
+        /* @brief Whether images `a` and `b` share memory, regardless of their lifetimes */
+        [[nodiscard]] auto overlap(size_t a, size_t b) const -> bool
+        {
+            return offsets[a] < offsets[b] + sizes[b] && offsets[b] < offsets[a] + sizes[a];
+        }
+    };
+
+    /* @brief Packs images with disjoint lifetimes into a single VMA allocation
+     *
+     * Lifetimes are inclusive ranges of user defined steps (typically render pass indices).
+     * Images are placed largest first, each at the lowest offset that does not overlap the
+     * memory of an already placed image whose lifetime intersects its own.
+     */
+    class aliased_images_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<aliased_images_builder_t>
+        {
+            aliased_images_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        /* @brief Adds an image alive from step `first_use` to step `last_use`, both included */
+        auto image(const VkImageCreateInfo& info, ui32 first_use, ui32 last_use) -> aliased_images_builder_t&
+        {
+            m_images.push_back({ info, first_use, last_use });
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<aliased_images_t>;
+
+    private:
+        struct request_t
+        {
+            VkImageCreateInfo info;
+            ui32              first_use;
+            ui32              last_use;
+        };
+
+        weak<device_t>         m_device = nullptr;
+        std::vector<request_t> m_images;
+    };
+} // namespace orb::vk
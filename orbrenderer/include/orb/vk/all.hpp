@@ -1,23 +1,47 @@
 #pragma once
 
+#include "orb/vk/aliasing.hpp"
+#include "orb/vk/async_compute.hpp"
 #include "orb/vk/attachments.hpp"
+#include "orb/vk/buffer_upload.hpp"
+#include "orb/vk/cmd_cache.hpp"
+#include "orb/vk/cmd_list.hpp"
 #include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/compute_pipeline.hpp"
+#include "orb/vk/deletion_queue.hpp"
 #include "orb/vk/desc_pool.hpp"
 #include "orb/vk/desc_sets.hpp"
 #include "orb/vk/device.hpp"
+#include "orb/vk/draw_queue.hpp"
+#include "orb/vk/frame_context.hpp"
+#include "orb/vk/frame_graph.hpp"
+#include "orb/vk/frame_pacer.hpp"
+#include "orb/vk/frame_sync.hpp"
 #include "orb/vk/framebuffers.hpp"
 #include "orb/vk/gpu.hpp"
+#include "orb/vk/gpu_culling.hpp"
+#include "orb/vk/gpu_profiler.hpp"
+#include "orb/vk/host_allocator.hpp"
 #include "orb/vk/graphics_pipeline.hpp"
 #include "orb/vk/images.hpp"
 #include "orb/vk/imgui.hpp"
 #include "orb/vk/instance.hpp"
+#include "orb/vk/ktx2.hpp"
+#include "orb/vk/parallel_recorder.hpp"
+#include "orb/vk/pipeline_stats.hpp"
 #include "orb/vk/render_pass.hpp"
+#include "orb/vk/resource_tracker.hpp"
 #include "orb/vk/shaders.hpp"
 #include "orb/vk/staging_buffer.hpp"
 #include "orb/vk/uniform_buffer.hpp"
+#include "orb/vk/submit_batch.hpp"
+#include "orb/vk/submit_service.hpp"
 #include "orb/vk/subpasses.hpp"
 #include "orb/vk/surface.hpp"
 #include "orb/vk/swapchain.hpp"
+#include "orb/vk/texture.hpp"
+#include "orb/vk/timeline.hpp"
+#include "orb/vk/transcode.hpp"
 #include "orb/vk/fences.hpp"
 #include "orb/vk/semaphores.hpp"
 #include "orb/vk/vertex_buffer.hpp"
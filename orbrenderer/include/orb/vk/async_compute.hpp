@@ -0,0 +1,209 @@
+#pragma once
+
+#include "orb/vk/device.hpp"
+#include "orb/vk/frame_context.hpp"
+#include "orb/vk/frame_sync.hpp"
+#include "orb/vk/gpu.hpp"
+#include "orb/vk/resource_tracker.hpp"
+#include "orb/vk/submit_batch.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Resource changing queue between two usages, see `compute_job_t::acquire` */
+    struct queue_handoff_t
+    {
+        VkImage                 image     = nullptr;
+        VkBuffer                buffer    = nullptr;
+        VkImageSubresourceRange range     = { vkflag(image_aspect_flag::color), 0, 1, 0, 1 };
+        resource_usage          src_usage = resource_usage::general;
+        resource_usage          dst_usage = resource_usage::general;
+    };
+
+    class async_compute_t;
+
+    /* @brief Work recorded for the compute queue, submitted through `async_compute_t::submit` */
+    class compute_job_t
+    {
+    public:
+        cmd_buffer_t cmd;
+
+        /* @brief The job starts once `point` is reached, e.g. the graphics value producing its input */
+        auto after(sync_point_t point, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT)
+            -> compute_job_t&
+        {
+            m_waits.emplace_back(point, stages);
+            return *this;
+        }
+
+        /* @brief Takes a buffer last used by graphics work as `graphics_usage`
+         *
+         * Records the acquire barrier now, call it before recording the commands using the buffer.
+         * The matching release is recorded by `async_compute_t::release_inputs`.
+         */
+        auto acquire(VkBuffer buffer, resource_usage graphics_usage, resource_usage compute_usage) -> compute_job_t&;
+
+        auto acquire(VkImage                        image,
+                     resource_usage                 graphics_usage,
+                     resource_usage                 compute_usage,
+                     const VkImageSubresourceRange& range = { vkflag(image_aspect_flag::color), 0, 1, 0, 1 })
+            -> compute_job_t&;
+
+        /* @brief Hands a resource back to graphics work once the job is done
+         *
+         * The release barrier is recorded by `async_compute_t::submit`, the acquire by
+         * `async_compute_t::acquire_outputs` in the graphics command buffer consuming it.
+         */
+        auto release(VkBuffer buffer, resource_usage compute_usage, resource_usage graphics_usage) -> compute_job_t&;
+
+        auto release(VkImage                        image,
+                     resource_usage                 compute_usage,
+                     resource_usage                 graphics_usage,
+                     const VkImageSubresourceRange& range = { vkflag(image_aspect_flag::color), 0, 1, 0, 1 })
+            -> compute_job_t&;
+
+    private:
+        friend class async_compute_t;
+
+        const async_compute_t* m_owner = nullptr;
+
+        std::vector<std::pair<sync_point_t, VkPipelineStageFlags2>> m_waits;
+        std::vector<queue_handoff_t>                                m_inputs;
+        std::vector<queue_handoff_t>                                m_outputs;
+        sync_point_t                                                m_done;
+    };
+
+    /* @brief Schedules compute work on its own queue, next to the graphics queue
+     *
+     * With a dedicated compute queue, jobs run concurrently with rasterization and only meet
+     * graphics work where they declare it: a job waits for the graphics timeline values given to
+     * `after`, graphics submissions wait for the value `submit` returns. Resources with exclusive
+     * sharing also change queue family: each handoff is a release barrier on the queue giving the
+     * resource up and an acquire barrier on the queue taking it, both recorded by this class.
+     *
+     * Without a dedicated queue, jobs are submitted to the graphics queue. The API does not
+     * change, handoffs turn into plain barriers.
+     *
+     *   // Post processing on the output of the scene pass
+     *   auto job = async->begin(*frames).unwrap();
+     *   job.acquire(scene_img, resource_usage::color_attachment_write, resource_usage::compute_shader_read)
+     *      .release(post_img, resource_usage::compute_storage_write, resource_usage::fragment_shader_read)
+     *      .after(scene_done);
+     *   async->release_inputs(job, scene_cmd.handle);   // before ending the scene commands
+     *   ...dispatches in job.cmd...
+     *   auto post_done = async->submit(job, *sync, submits).unwrap();
+     *   async->acquire_outputs(job, composite_cmd.handle); // graphics commands waiting on post_done
+     *
+     * Resources handed over must not be tracked by a `resource_tracker_t` meanwhile, or be
+     * re-tracked in their new layout.
+     */
+    class async_compute_t
+    {
+    public:
+        /* @brief Whether jobs run on their own queue */
+        [[nodiscard]] auto dedicated() const -> bool { return m_compute != m_graphics; }
+
+        /* @brief Whether handoffs transfer queue family ownership */
+        [[nodiscard]] auto transfers_ownership() const -> bool { return m_compute_qf != m_graphics_qf; }
+
+        [[nodiscard]] auto queue() const -> VkQueue { return m_compute; }
+        [[nodiscard]] auto qf_index() const -> ui32 { return m_compute_qf; }
+
+        /* @brief Starts a job with a command buffer of the current frame of `frames` */
+        [[nodiscard]] auto begin(frame_context_t& frames) -> result<compute_job_t>;
+
+        /* @brief Records the graphics side releases of the job's inputs in `graphics_cmd` */
+        void release_inputs(const compute_job_t& job, VkCommandBuffer graphics_cmd) const;
+
+        /* @brief Ends the job and queues it in `submits`, returns the value it signals */
+        [[nodiscard]] auto submit(compute_job_t& job, frame_sync_t& sync, submit_batch_t& submits) -> result<sync_point_t>;
+
+        /* @brief Records the graphics side acquires of the job's outputs in `graphics_cmd` */
+        void acquire_outputs(const compute_job_t& job, VkCommandBuffer graphics_cmd) const;
+
+    private:
+        friend class async_compute_builder_t;
+        friend class compute_job_t;
+
+        enum class side
+        {
+            release,
+            acquire,
+        };
+
+        /* @brief Records the barriers of `handoffs` from `src_qf` to `dst_qf`, seen from `s` */
+        void record(VkCommandBuffer                  cmd,
+                    std::span<const queue_handoff_t> handoffs,
+                    ui32                             src_qf,
+                    ui32                             dst_qf,
+                    side                             s) const;
+
+        bool    m_use_sync2   = false;
+        VkQueue m_graphics    = nullptr;
+        VkQueue m_compute     = nullptr;
+        ui32    m_graphics_qf = 0;
+        ui32    m_compute_qf  = 0;
+    };
+
+    class async_compute_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<async_compute_builder_t>
+        {
+            async_compute_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        auto graphics(weak<queue_family_t> qf) -> async_compute_builder_t&
+        {
+            m_graphics = qf;
+            return *this;
+        }
+
+        /* @brief Family to run the jobs on, typically `queue_family_map_t::async_compute`. The
+         * device must have been created with a queue from it (see `device_builder_t::add_queue`),
+         * the graphics queue is used otherwise
+         */
+        auto compute(weak<queue_family_t> qf) -> async_compute_builder_t&
+        {
+            m_compute = qf;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<async_compute_t>>
+        {
+            if (!m_graphics.raw() || m_graphics->queues.empty())
+            {
+                return error_t { "Could not create async compute: no graphics queue" };
+            }
+
+            auto async           = make_box<async_compute_t>();
+            async->m_use_sync2   = m_device->features_13.synchronization2 == VK_TRUE;
+            async->m_graphics    = m_graphics->queues.front();
+            async->m_graphics_qf = m_graphics->index;
+            async->m_compute     = async->m_graphics;
+            async->m_compute_qf  = async->m_graphics_qf;
+
+            if (m_compute.raw() && !m_compute->queues.empty())
+            {
+                // Prefer a queue other than the graphics one when the family is shared
+                async->m_compute    = m_compute->queues.back();
+                async->m_compute_qf = m_compute->index;
+            }
+
+            return async;
+        }
+
+    private:
+        weak<device_t>       m_device   = nullptr;
+        weak<queue_family_t> m_graphics = nullptr;
+        weak<queue_family_t> m_compute  = nullptr;
+    };
+} // namespace orb::vk
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/fences.hpp"
+#include "orb/vk/staging_buffer.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Checks whether the GPU exposes device local memory that the host can write to
+     *
+     * This is the case on integrated GPUs, and on discrete GPUs with resizable BAR enabled.
+     *
+     * @param allocator The VMA allocator of the device
+     * @param size The size of the allocation that should fit in the remaining heap budget
+     * @return true if a DEVICE_LOCAL | HOST_VISIBLE memory type has enough budget left
+     */
+    [[nodiscard]] inline auto has_host_visible_vram(VmaAllocator allocator, VkDeviceSize size) -> bool
+    {
+        const VkPhysicalDeviceMemoryProperties* props {};
+        vmaGetMemoryProperties(allocator, &props);
+
+        std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets {};
+        vmaGetHeapBudgets(allocator, budgets.data());
+
+        const auto required = vkflag(memory_property_flag::device_local | memory_property_flag::host_visible);
+
+        for (ui32 i = 0; i < props->memoryTypeCount; ++i)
+        {
+            const auto& type = props->memoryTypes[i];
+
+            if ((type.propertyFlags & required) != required) continue;
+
+            const auto& budget = budgets[type.heapIndex];
+
+            if (budget.budget > budget.usage && budget.budget - budget.usage >= size)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /* @brief Allocation flags letting VMA place a buffer in host visible VRAM when there is room for it
+     *
+     * With `host_access_allow_transfer_instead`, VMA may still pick a memory type the host cannot
+     * access. The buffer builders check the resulting memory properties and only expose a mapped
+     * pointer when the direct write path is actually usable.
+     */
+    [[nodiscard]] inline auto direct_upload_memory_flags() -> VmaAllocationCreateFlags
+    {
+        return vkflag(memory_flag::host_access_sequential_write
+                      | memory_flag::host_access_allow_transfer_instead
+                      | memory_flag::mapped);
+    }
+
+    /* @brief Returns the mapped pointer of an allocation if it ended up in host visible VRAM
+     *
+     * Plain host memory is left to the staging path, the GPU would read it over the bus.
+     */
+    [[nodiscard]] inline auto mapped_if_host_visible(VmaAllocator             allocator,
+                                                     VmaAllocation            allocation,
+                                                     const VmaAllocationInfo& info) -> void*
+    {
+        VkMemoryPropertyFlags props {};
+        vmaGetAllocationMemoryProperties(allocator, allocation, &props);
+
+        const auto required = vkflag(memory_property_flag::device_local | memory_property_flag::host_visible);
+
+        if ((props & required) != required) return nullptr;
+
+        return info.pMappedData;
+    }
+
+    struct upload_stats_t
+    {
+        ui64 direct_bytes   = 0;
+        ui64 staged_bytes   = 0;
+        ui32 direct_copies  = 0;
+        ui32 staged_copies  = 0;
+        bool submitted_copy = false;
+    };
+
+    /* @brief Uploads data to GPU buffers, writing straight to mapped VRAM when possible
+     *
+     * Destinations that live in host visible memory (see `prefer_direct_upload` on the buffer
+     * builders) are written with a memcpy. Every other destination is gathered in a single
+     * staging buffer and copied with one command buffer and one queue submission.
+     */
+    class buffer_upload_helper_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> buffer_upload_helper_t
+        {
+            buffer_upload_helper_t d;
+            d.m_device = device;
+            return d;
+        }
+
+        auto copy(const void* src, ui64 size, VkBuffer dst, VmaAllocation allocation, void* mapped)
+            -> buffer_upload_helper_t&
+        {
+            m_copies.push_back({
+                .src        = src,
+                .size       = size,
+                .dst        = dst,
+                .allocation = allocation,
+                .mapped     = mapped,
+            });
+            return *this;
+        }
+
+        template <typename TData, typename TBuffer>
+        auto copy(std::span<const TData> src, TBuffer& dst) -> buffer_upload_helper_t&
+        {
+            return copy(src.data(), src.size_bytes(), dst.buffer, dst.allocation, dst.mapped);
+        }
+
+        template <typename TData, typename TBuffer>
+        auto copy(const std::vector<TData>& src, TBuffer& dst) -> buffer_upload_helper_t&
+        {
+            return copy(std::span<const TData> { src }, dst);
+        }
+
+        /* @brief Sets the queue and command pool used when a destination needs the staging path */
+        auto staging(weak<cmd_pool_t> pool, VkQueue queue) -> buffer_upload_helper_t&
+        {
+            m_pool  = pool;
+            m_queue = queue;
+            return *this;
+        }
+
+        [[nodiscard]] auto upload() -> result<upload_stats_t>
+        {
+            upload_stats_t stats;
+            ui64           staged_size = 0;
+
+            for (const auto& c : m_copies)
+            {
+                if (c.mapped)
+                {
+                    std::memcpy(c.mapped, c.src, c.size);
+                    vmaFlushAllocation(m_device->allocator, c.allocation, 0, c.size);
+
+                    stats.direct_bytes += c.size;
+                    stats.direct_copies++;
+                }
+                else
+                {
+                    staged_size += c.size;
+                }
+            }
+
+            if (staged_size == 0)
+            {
+                return stats;
+            }
+
+            if (!m_pool || !m_queue)
+            {
+                return error_t { "Could not upload buffers: a staging copy is required but no queue was given" };
+            }
+
+            auto cmds_res = m_pool->alloc_cmds(1);
+            if (!cmds_res) return cmds_res.error();
+            auto cmd = cmds_res.value().get(0).unwrap();
+
+            // Freed on every path, the copy is no longer pending once it returns
+            auto copy_res = copy_staged(cmd, staged_size, stats);
+            m_pool->free_cmds({ &cmd.handle, 1 });
+
+            if (!copy_res) return copy_res.error();
+
+            stats.submitted_copy = true;
+
+            return stats;
+        }
+
+    private:
+        [[nodiscard]] auto copy_staged(cmd_buffer_t& cmd, ui64 staged_size, upload_stats_t& stats) -> result<void>
+        {
+            auto staging_res = staging_buffer_builder_t::prepare(m_device, staged_size).unwrap().build();
+            if (!staging_res) return staging_res.error();
+            auto& staging = staging_res.value();
+
+            if (auto r = cmd.begin(command_buffer_usage_flag::one_time_submit); !r) return r.error();
+
+            void* staging_data {};
+            if (auto r = vmaMapMemory(m_device->allocator, staging.allocation, &staging_data); r != vkres::ok)
+            {
+                return error_t { "Could not map staging buffer: {}", vkres::get_repr(r) };
+            }
+
+            ui64 offset = 0;
+            for (const auto& c : m_copies)
+            {
+                if (c.mapped) continue;
+
+                std::memcpy(static_cast<std::byte*>(staging_data) + offset, c.src, c.size);
+
+                VkBufferCopy region {
+                    .srcOffset = offset,
+                    .dstOffset = 0,
+                    .size      = c.size,
+                };
+
+                vkCmdCopyBuffer(cmd.handle, staging.buffer, c.dst, 1, &region);
+
+                offset += c.size;
+                stats.staged_bytes += c.size;
+                stats.staged_copies++;
+            }
+
+            vmaFlushAllocation(m_device->allocator, staging.allocation, 0, staged_size);
+            vmaUnmapMemory(m_device->allocator, staging.allocation);
+
+            if (auto r = cmd.end(); !r) return r.error();
+
+            auto fences_res = fences_builder_t::create(m_device, 1);
+            if (!fences_res) return fences_res.error();
+            auto fence = fences_res.value()[0];
+
+            if (auto r = fence.reset(); !r) return r.error();
+
+            if (auto r = submit_helper_t::prepare().cmd_buffer(&cmd.handle).submit(m_queue, fence.handle); !r)
+            {
+                return r.error();
+            }
+
+            if (auto r = fence.wait(); !r) return r.error();
+
+            return {};
+        }
+
+        struct copy_t
+        {
+            const void*   src {};
+            ui64          size {};
+            VkBuffer      dst {};
+            VmaAllocation allocation {};
+            void*         mapped {};
+        };
+
+        weak<device_t>      m_device = nullptr;
+        weak<cmd_pool_t>    m_pool   = nullptr;
+        VkQueue             m_queue  = nullptr;
+        std::vector<copy_t> m_copies;
+    };
+} // namespace orb::vk
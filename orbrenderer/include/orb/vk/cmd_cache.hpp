@@ -0,0 +1,118 @@
+#pragma once
+
+#include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/device.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief What a cached segment was recorded against, any change re-records it */
+    struct cmd_segment_key_t
+    {
+        ui64         content_hash = 0; // hash of what the recording reads: draw list, materials...
+        ui64         generation   = 0; // bumped when the target is recreated, e.g. swapchain_t::generation
+        VkRenderPass render_pass  = nullptr;
+        ui32         subpass      = 0;
+
+        auto operator==(const cmd_segment_key_t&) const -> bool = default;
+    };
+
+    /* @brief Records the commands of a segment into a secondary buffer */
+    using segment_fn_t = std::function<void(cmd_buffer_t& cmd)>;
+
+    /* @brief Secondary command buffers recorded once and executed every frame until invalidated
+     *
+     * Static content is split into segments, identified by small dense ids. `segment` returns
+     * the buffer recorded for the id when its key and version still match, and only re-records
+     * it otherwise, so a frame where nothing changed records no draw at all. Buffers are
+     * recorded without `one_time_submit` and without a framebuffer in their inheritance, so they
+     * can be executed in any framebuffer of the render pass.
+     *
+     *   cache->begin_frame(slot);
+     *   const cmd_segment_key_t key { .content_hash = hud.hash(), .generation = swapchain->generation,
+     *                                 .render_pass = pass->handle };
+     *   VkCommandBuffer hud = cache->segment(hud_segment, key, record_hud).unwrap();
+     *   pass->begin(cmd.handle, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+     *   cmd.execute({ &hud, 1 });
+     *
+     * Each frame in flight owns its copy of a segment: a buffer is only re-recorded once the
+     * slot's previous frame completed, never while pending. Recording dynamic state such as the
+     * viewport inside the segment requires its size to be part of the key, the generation
+     * usually covers it.
+     */
+    class cmd_cache_t
+    {
+    public:
+        /* @brief Selects the buffers of `slot`, the caller guarantees its previous work completed */
+        void begin_frame(ui32 slot);
+
+        /* @brief Returns the buffer of segment `id`, recording it with `fn` first if stale */
+        [[nodiscard]] auto segment(ui32 id, const cmd_segment_key_t& key, const segment_fn_t& fn)
+            -> result<VkCommandBuffer>;
+
+        /* @brief Forces segment `id` to be re-recorded by every frame in flight */
+        void invalidate(ui32 id);
+
+        /* @brief Forces every segment to be re-recorded */
+        void invalidate_all();
+
+        /* @brief Segments recorded since `begin_frame` */
+        [[nodiscard]] auto recorded() const -> ui32 { return m_recorded; }
+
+        /* @brief Segments reused as they were since `begin_frame` */
+        [[nodiscard]] auto reused() const -> ui32 { return m_reused; }
+
+    private:
+        friend class cmd_cache_builder_t;
+
+        struct entry_t
+        {
+            VkCommandBuffer   handle = nullptr;
+            cmd_segment_key_t key;
+            ui64              version  = 0;
+            bool              recorded = false;
+        };
+
+        struct slot_t
+        {
+            box<cmd_pool_t>      pool;
+            std::vector<entry_t> entries;
+        };
+
+        std::vector<slot_t> m_slots;
+        std::vector<ui64>   m_versions; // per segment, bumped by invalidate
+        ui32                m_slot     = 0;
+        ui32                m_recorded = 0;
+        ui32                m_reused   = 0;
+    };
+
+    class cmd_cache_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device, ui32 qf_index) -> result<cmd_cache_builder_t>
+        {
+            cmd_cache_builder_t b;
+            b.m_device   = device;
+            b.m_qf_index = qf_index;
+            return b;
+        }
+
+        auto frames_in_flight(ui32 count) -> cmd_cache_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<cmd_cache_t>>;
+
+    private:
+        weak<device_t> m_device           = nullptr;
+        ui32           m_qf_index         = 0;
+        ui32           m_frames_in_flight = 2;
+    };
+} // namespace orb::vk
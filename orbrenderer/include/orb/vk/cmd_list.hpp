@@ -0,0 +1,116 @@
+#pragma once
+
+#include "orb/vk/device.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace orb::vk
+{
+    enum class cmd_type : ui32
+    {
+        bind_pipeline,
+        bind_desc_sets,
+        bind_vertex_buffers,
+        bind_index_buffer,
+        set_viewport,
+        set_scissor,
+        push_constants,
+        draw,
+        draw_indexed,
+        dispatch,
+    };
+
+    /* @brief What `cmd_list_t::optimize` removed */
+    struct cmd_list_stats_t
+    {
+        ui32 commands_in    = 0;
+        ui32 commands_out   = 0;
+        ui32 dropped_binds  = 0; // pipelines, descriptor sets, vertex and index buffers
+        ui32 dropped_states = 0; // viewports and scissors
+        ui32 merged_draws   = 0; // draws folded into the instances of the previous one
+    };
+
+    /* @brief Commands recorded on the CPU into a linear arena, replayed into a command buffer later
+     *
+     * Recording only appends to the list's own memory, so lists can be filled on any thread
+     * without touching Vulkan and replayed on the thread recording the command buffer. Before
+     * replay, `optimize` rewrites the list:
+     *
+     *   - pipeline, descriptor set, vertex and index buffer binds of what is already bound are dropped
+     *   - viewports and scissors equal to the current ones are dropped
+     *   - a draw that continues the instances of the previous draw, with the same geometry and
+     *     nothing recorded in between, is merged into it as more instances
+     *
+     *   vk::cmd_list_t list;
+     *   for (ui32 i = 0; i < count; ++i)
+     *   {
+     *       list.bind_pipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->handle);
+     *       list.draw_indexed(6, 1, 0, 0, i);
+     *   }
+     *   list.optimize(); // one bind, one draw of `count` instances
+     *   list.replay(cmd.handle);
+     *
+     * Merged draws keep gl_InstanceIndex, but gl_BaseInstance is the one of the first draw.
+     * Binding a graphics pipeline resets the tracked viewport and scissor, since pipelines with
+     * static state invalidate them.
+     */
+    class cmd_list_t
+    {
+    public:
+        /* @brief Empties the list, keeping its memory */
+        void reset();
+
+        void bind_pipeline(VkPipelineBindPoint bind_point, VkPipeline pipeline);
+
+        void bind_desc_sets(VkPipelineBindPoint              bind_point,
+                            VkPipelineLayout                 layout,
+                            ui32                             first_set,
+                            std::span<const VkDescriptorSet> sets,
+                            std::span<const ui32>            dynamic_offsets = {});
+
+        void bind_vertex_buffers(ui32                          first_binding,
+                                 std::span<const VkBuffer>     buffers,
+                                 std::span<const VkDeviceSize> offsets);
+
+        void bind_index_buffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type);
+
+        void set_viewport(const VkViewport& viewport);
+
+        void set_scissor(const VkRect2D& scissor);
+
+        void push_constants(VkPipelineLayout           layout,
+                            VkShaderStageFlags         stages,
+                            ui32                       offset,
+                            std::span<const std::byte> data);
+
+        template <typename TPushConstants>
+        void push_constants(VkPipelineLayout layout, VkShaderStageFlags stages, const TPushConstants& constants)
+        {
+            push_constants(layout, stages, 0, std::as_bytes(std::span { &constants, 1 }));
+        }
+
+        void draw(ui32 vertex_count, ui32 instance_count, ui32 first_vertex, ui32 first_instance);
+
+        void draw_indexed(ui32 index_count, ui32 instance_count, ui32 first_index, i32 vertex_offset, ui32 first_instance);
+
+        void dispatch(ui32 x, ui32 y, ui32 z);
+
+        /* @brief Drops redundant state and merges draws, see the class description */
+        auto optimize() -> cmd_list_stats_t;
+
+        /* @brief Records every command into `cmd`, the list is left as is */
+        void replay(VkCommandBuffer cmd) const;
+
+        [[nodiscard]] auto command_count() const -> ui32 { return m_count; }
+
+        /* @brief Bytes used by the arena */
+        [[nodiscard]] auto size() const -> size_t { return m_data.size(); }
+
+    private:
+        std::vector<std::byte> m_data;
+        std::vector<std::byte> m_scratch;
+        ui32                   m_count = 0;
+    };
+} // namespace orb::vk
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "orb/profiler.hpp"
 #include "orb/vk/device.hpp"
+#include "orb/vk/timeline.hpp"
 
 #include <orb/box.hpp>
 #include <orb/result.hpp>
@@ -48,6 +50,53 @@ namespace orb::vk
             return {};
         }
 
+        /* @brief Starts recording without resetting the buffer first
+         *
+         * Use it for freshly allocated buffers, or for buffers whose pool was reset as a whole.
+         */
+        auto begin(command_buffer_usage_flag flags) -> result<void>
+        {
+            auto info  = structs::cmd_buffer_begin();
+            info.flags = vkflag(flags);
+
+            if (auto res = vkBeginCommandBuffer(handle, &info); res != vkres::ok)
+            {
+                return error_t { "Could not start recording cmd buffer: {}", vkres::get_repr(res) };
+            }
+
+            return {};
+        }
+
+        /* @brief Starts recording a secondary buffer that continues a render pass
+         *
+         * `inheritance` names the render pass and subpass the buffer will be executed in, and
+         * optionally the framebuffer. Dynamic state is not inherited from the primary buffer.
+         */
+        auto begin_secondary(const VkCommandBufferInheritanceInfo& inheritance,
+                             command_buffer_usage_flag flags = command_buffer_usage_flag::one_time_submit)
+            -> result<void>
+        {
+            auto info             = structs::cmd_buffer_begin();
+            info.flags            = vkflag(flags | command_buffer_usage_flag::render_pass_continue);
+            info.pInheritanceInfo = &inheritance;
+
+            if (auto res = vkBeginCommandBuffer(handle, &info); res != vkres::ok)
+            {
+                return error_t { "Could not start recording secondary cmd buffer: {}", vkres::get_repr(res) };
+            }
+
+            return {};
+        }
+
+        /* @brief Executes secondary buffers, the render pass must have been begun with
+         * VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+         */
+        void execute(std::span<const VkCommandBuffer> cmds)
+        {
+            if (cmds.empty()) return;
+            vkCmdExecuteCommands(handle, cmds.size(), cmds.data());
+        }
+
         auto copy_buffer(VkBuffer src, VkBuffer dst, VkDeviceSize size) -> result<void>
         {
             VkBufferCopy copy_region {
@@ -132,7 +181,7 @@ namespace orb::vk
                 return;
             }
 
-            vkDestroyCommandPool(device, handle, nullptr);
+            vkDestroyCommandPool(device, handle, host_callbacks(host_scope::commands));
             handle = nullptr;
         }
 
@@ -156,6 +205,22 @@ namespace orb::vk
 
             return cmd_buffers_t { .handles = std::move(cmds) };
         }
+
+        void free_cmds(std::span<const VkCommandBuffer> cmds)
+        {
+            vkFreeCommandBuffers(device, handle, cmds.size(), cmds.data());
+        }
+
+        /* @brief Resets every command buffer of the pool at once, none may be pending */
+        [[nodiscard]] auto reset() -> result<void>
+        {
+            if (auto res = vkResetCommandPool(device, handle, 0); res != vkres::ok)
+            {
+                return error_t { "Could not reset command pool: {}", vkres::get_repr(res) };
+            }
+
+            return {};
+        }
     };
 
     class cmd_pool_builder_t
@@ -180,7 +245,7 @@ namespace orb::vk
             cmd_pool_info.queueFamilyIndex = m_qf_index;
             cmd_pool_info.flags            = m_flags;
 
-            if (auto res = vkCreateCommandPool(m_device->handle, &cmd_pool_info, nullptr, &pool->handle);
+            if (auto res = vkCreateCommandPool(m_device->handle, &cmd_pool_info, host_callbacks(host_scope::commands), &pool->handle);
                 res != vkres::ok)
             {
                 return error_t { "Could not create command pool: {}", vkres::get_repr(res) };
@@ -202,6 +267,11 @@ namespace orb::vk
         ui32 m_flags {};
     };
 
+    /* @brief Fills and submits a VkSubmitInfo
+     *
+     * Binary and timeline semaphores can be mixed: timeline waits and signals carry a value,
+     * and a VkTimelineSemaphoreSubmitInfo is chained when at least one of them is used.
+     */
     class submit_helper_t
     {
     public:
@@ -209,24 +279,47 @@ namespace orb::vk
 
         auto wait_semaphores(const vk::semaphores_t& semaphores) -> submit_helper_t&
         {
-            m_info.waitSemaphoreCount = semaphores.handles.size();
-            m_info.pWaitSemaphores    = semaphores.handles.data();
-            m_info.pWaitDstStageMask  = semaphores.wait_stages.data();
+            for (size_t i = 0; i < semaphores.handles.size(); ++i)
+            {
+                add_wait(semaphores.handles[i], 0, semaphores.wait_stages[i]);
+            }
+
             return *this;
         }
 
         auto wait_semaphores(const vk::semaphores_view_t& semaphores) -> submit_helper_t&
         {
-            m_info.waitSemaphoreCount = semaphores.handles.size();
-            m_info.pWaitSemaphores    = semaphores.handles.data();
-            m_info.pWaitDstStageMask  = semaphores.wait_stages.data();
+            for (size_t i = 0; i < semaphores.handles.size(); ++i)
+            {
+                add_wait(semaphores.handles[i], 0, semaphores.wait_stages[i]);
+            }
+
             return *this;
         }
 
         auto signal_semaphores(std::span<VkSemaphore> semaphores) -> submit_helper_t&
         {
-            m_info.signalSemaphoreCount = semaphores.size();
-            m_info.pSignalSemaphores    = semaphores.data();
+            for (auto semaphore : semaphores)
+            {
+                add_signal(semaphore, 0);
+            }
+
+            return *this;
+        }
+
+        /* @brief Waits for a timeline value before `stage` */
+        auto wait_timeline(sync_point_t point, pipeline_stage_flag stage) -> submit_helper_t&
+        {
+            add_wait(point.semaphore, point.value, vkflag(stage));
+            m_uses_timeline = true;
+            return *this;
+        }
+
+        /* @brief Signals a timeline value once the submitted commands complete */
+        auto signal_timeline(sync_point_t point) -> submit_helper_t&
+        {
+            add_signal(point.semaphore, point.value);
+            m_uses_timeline = true;
             return *this;
         }
 
@@ -244,9 +337,24 @@ namespace orb::vk
             return *this;
         }
 
-
         [[nodiscard]] auto submit(VkQueue queue, VkFence fence = nullptr) -> result<void>
         {
+            ORB_PROFILE_ZONE("submit_helper_t::submit");
+
+            m_info.waitSemaphoreCount   = m_wait_semaphores.size();
+            m_info.pWaitSemaphores      = m_wait_semaphores.data();
+            m_info.pWaitDstStageMask    = m_wait_stages.data();
+            m_info.signalSemaphoreCount = m_signal_semaphores.size();
+            m_info.pSignalSemaphores    = m_signal_semaphores.data();
+
+            auto timeline_info                      = structs::timeline_semaphore_submit();
+            timeline_info.waitSemaphoreValueCount   = m_wait_values.size();
+            timeline_info.pWaitSemaphoreValues      = m_wait_values.data();
+            timeline_info.signalSemaphoreValueCount = m_signal_values.size();
+            timeline_info.pSignalSemaphoreValues    = m_signal_values.data();
+
+            m_info.pNext = m_uses_timeline ? &timeline_info : nullptr;
+
             if (auto res = vkQueueSubmit(queue, 1, &m_info, fence); res != vkres::ok)
             {
                 return error_t { "Failed to submit command buffer: {}", vkres::get_repr(res) };
@@ -256,6 +364,27 @@ namespace orb::vk
         }
 
     private:
+        void add_wait(VkSemaphore semaphore, ui64 value, VkPipelineStageFlags stage)
+        {
+            m_wait_semaphores.push_back(semaphore);
+            m_wait_values.push_back(value);
+            m_wait_stages.push_back(stage);
+        }
+
+        void add_signal(VkSemaphore semaphore, ui64 value)
+        {
+            m_signal_semaphores.push_back(semaphore);
+            m_signal_values.push_back(value);
+        }
+
         VkSubmitInfo m_info = structs::submit();
+
+        // Values of binary semaphores are ignored
+        std::vector<VkSemaphore>          m_wait_semaphores;
+        std::vector<ui64>                 m_wait_values;
+        std::vector<VkPipelineStageFlags> m_wait_stages;
+        std::vector<VkSemaphore>          m_signal_semaphores;
+        std::vector<ui64>                 m_signal_values;
+        bool                              m_uses_timeline = false;
     };
 } // namespace orb::vk
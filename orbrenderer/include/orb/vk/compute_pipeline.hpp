@@ -0,0 +1,204 @@
+#pragma once
+
+#include "orb/profiler.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/shaders.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <vector>
+
+namespace orb::vk
+{
+    struct compute_pipeline_t
+    {
+        VkDevice              device          = nullptr;
+        VkPipeline            handle          = nullptr;
+        VkDescriptorSetLayout desc_set_layout = nullptr;
+        VkPipelineLayout      layout          = nullptr;
+
+        compute_pipeline_t() = default;
+
+        compute_pipeline_t(const compute_pipeline_t&)                    = delete;
+        auto operator=(const compute_pipeline_t&) -> compute_pipeline_t& = delete;
+
+        compute_pipeline_t(compute_pipeline_t&& other) noexcept
+        {
+            device          = other.device;
+            handle          = other.handle;
+            desc_set_layout = other.desc_set_layout;
+            layout          = other.layout;
+
+            other.handle          = nullptr;
+            other.desc_set_layout = nullptr;
+            other.layout          = nullptr;
+        }
+
+        auto operator=(compute_pipeline_t&& other) noexcept -> compute_pipeline_t&
+        {
+            destroy();
+
+            device          = other.device;
+            handle          = other.handle;
+            desc_set_layout = other.desc_set_layout;
+            layout          = other.layout;
+
+            other.handle          = nullptr;
+            other.desc_set_layout = nullptr;
+            other.layout          = nullptr;
+
+            return *this;
+        }
+
+        ~compute_pipeline_t()
+        {
+            destroy();
+        }
+
+        void destroy()
+        {
+            if (handle)
+            {
+                vkDestroyPipeline(device, handle, host_callbacks(host_scope::pipelines));
+                handle = nullptr;
+            }
+
+            if (layout)
+            {
+                vkDestroyPipelineLayout(device, layout, host_callbacks(host_scope::pipelines));
+                layout = nullptr;
+            }
+
+            if (desc_set_layout)
+            {
+                vkDestroyDescriptorSetLayout(device, desc_set_layout, host_callbacks(host_scope::descriptors));
+                desc_set_layout = nullptr;
+            }
+        }
+
+        void bind(VkCommandBuffer cmd) const
+        {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, handle);
+        }
+
+        void bind_desc_set(VkCommandBuffer cmd, VkDescriptorSet set) const
+        {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+        }
+
+        template <typename TPushConstants>
+        void push_constants(VkCommandBuffer cmd, const TPushConstants& constants) const
+        {
+            vkCmdPushConstants(cmd,
+                               layout,
+                               VK_SHADER_STAGE_COMPUTE_BIT,
+                               0,
+                               sizeof(TPushConstants),
+                               &constants);
+        }
+    };
+
+    class compute_pipeline_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<compute_pipeline_builder_t>
+        {
+            compute_pipeline_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        auto shader(VkShaderModule module, const char* entry_point = "main") -> compute_pipeline_builder_t&
+        {
+            m_module      = module;
+            m_entry_point = entry_point;
+            return *this;
+        }
+
+        auto binding(ui32 binding, descriptor_type type, ui32 count = 1) -> compute_pipeline_builder_t&
+        {
+            auto& binding_desc = m_bindings.emplace_back();
+
+            binding_desc.binding         = binding;
+            binding_desc.descriptorType  = vkenum(type);
+            binding_desc.descriptorCount = count;
+            binding_desc.stageFlags      = vkflag(shader_stage_flag::compute);
+
+            return *this;
+        }
+
+        auto push_constants_size(ui32 size) -> compute_pipeline_builder_t&
+        {
+            m_push_constants_size = size;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<compute_pipeline_t>>
+        {
+            ORB_PROFILE_ZONE("compute_pipeline_builder_t::build");
+
+            if (!m_module)
+            {
+                return error_t { "Could not create compute pipeline: no shader module given" };
+            }
+
+            auto pipeline    = make_box<compute_pipeline_t>();
+            pipeline->device = m_device->handle;
+
+            auto set_layout_info         = structs::create::desc_set_layout();
+            set_layout_info.bindingCount = m_bindings.size();
+            set_layout_info.pBindings    = m_bindings.data();
+
+            if (auto res = vkCreateDescriptorSetLayout(m_device->handle, &set_layout_info, host_callbacks(host_scope::descriptors), &pipeline->desc_set_layout);
+                res != vkres::ok)
+            {
+                return error_t { "Could not create descriptor set layout: {}", vkres::get_repr(res) };
+            }
+
+            VkPushConstantRange push_constants {
+                .stageFlags = vkflag(shader_stage_flag::compute),
+                .offset     = 0,
+                .size       = m_push_constants_size,
+            };
+
+            auto layout_info           = structs::create::pipeline_layout();
+            layout_info.setLayoutCount = 1;
+            layout_info.pSetLayouts    = &pipeline->desc_set_layout;
+
+            if (m_push_constants_size > 0)
+            {
+                layout_info.pushConstantRangeCount = 1;
+                layout_info.pPushConstantRanges    = &push_constants;
+            }
+
+            if (auto res = vkCreatePipelineLayout(m_device->handle, &layout_info, host_callbacks(host_scope::pipelines), &pipeline->layout);
+                res != vkres::ok)
+            {
+                return error_t { "Could not create pipeline layout: {}", vkres::get_repr(res) };
+            }
+
+            auto info         = structs::create::compute_pipeline();
+            info.stage.module = m_module;
+            info.stage.pName  = m_entry_point;
+            info.layout       = pipeline->layout;
+
+            if (auto res = vkCreateComputePipelines(m_device->handle, nullptr, 1, &info, host_callbacks(host_scope::pipelines), &pipeline->handle);
+                res != vkres::ok)
+            {
+                return error_t { "Could not create compute pipeline: {}", vkres::get_repr(res) };
+            }
+
+            return pipeline;
+        }
+
+    private:
+        weak<device_t> m_device      = nullptr;
+        VkShaderModule m_module      = nullptr;
+        const char*    m_entry_point = "main";
+
+        std::vector<VkDescriptorSetLayoutBinding> m_bindings;
+
+        ui32 m_push_constants_size = 0;
+    };
+} // namespace orb::vk
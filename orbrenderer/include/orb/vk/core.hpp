@@ -19,6 +19,8 @@ namespace orb::vk
         inline constexpr const char* win32_surface           = "VK_KHR_win32_surface";
         inline constexpr const char* swapchain               = "VK_KHR_swapchain";
         inline constexpr const char* buffer_device_address   = "VK_KHR_buffer_device_address";
+        inline constexpr const char* present_id              = "VK_KHR_present_id";
+        inline constexpr const char* present_wait            = "VK_KHR_present_wait";
     } // namespace khr_extensions
 
     namespace extensions
@@ -187,6 +189,26 @@ namespace orb::vk
             return fn;
         }
 
+        // Labels are optional: null when VK_EXT_debug_utils is not enabled
+        using cmd_begin_label_fn_t = PFN_vkCmdBeginDebugUtilsLabelEXT;
+        inline auto cmd_begin_label(VkInstance instance)
+        {
+            return (cmd_begin_label_fn_t)vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT"); // NOLINT
+        }
+
+        using cmd_end_label_fn_t = PFN_vkCmdEndDebugUtilsLabelEXT;
+        inline auto cmd_end_label(VkInstance instance)
+        {
+            return (cmd_end_label_fn_t)vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT"); // NOLINT
+        }
+
+        // Optional: null when VK_KHR_present_wait is not enabled
+        using wait_for_present_fn_t = PFN_vkWaitForPresentKHR;
+        inline auto wait_for_present(VkDevice device)
+        {
+            return (wait_for_present_fn_t)vkGetDeviceProcAddr(device, "vkWaitForPresentKHR"); // NOLINT
+        }
+
         inline auto destroy_deb_report_callback(VkInstance instance)
         {
             using destroy_debug_report_callback = PFN_vkDestroyDebugReportCallbackEXT;
@@ -637,6 +659,14 @@ namespace orb::vk
                 };
             }
 
+            [[nodiscard]] inline auto semaphore_type() -> VkSemaphoreTypeCreateInfo
+            {
+                return {
+                    .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+                    .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+                };
+            }
+
             [[nodiscard]] inline auto fence() -> VkFenceCreateInfo
             {
                 return {
@@ -675,6 +705,25 @@ namespace orb::vk
                     .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
                 };
             }
+
+            [[nodiscard]] inline auto pipeline_layout() -> VkPipelineLayoutCreateInfo
+            {
+                return {
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                };
+            }
+
+            [[nodiscard]] inline auto compute_pipeline() -> VkComputePipelineCreateInfo
+            {
+                return {
+                    .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                    .stage = {
+                        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pName = "main",
+                    },
+                };
+            }
         } // namespace create
 
         [[nodiscard]] inline auto cmd_buffer_begin() -> VkCommandBufferBeginInfo
@@ -684,6 +733,13 @@ namespace orb::vk
             };
         }
 
+        [[nodiscard]] inline auto cmd_buffer_inheritance() -> VkCommandBufferInheritanceInfo
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            };
+        }
+
         [[nodiscard]] inline auto one_time_cmd_buffer_begin() -> VkCommandBufferBeginInfo
         {
             return {
@@ -712,6 +768,90 @@ namespace orb::vk
                 .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
             };
         }
+
+        [[nodiscard]] inline auto submit_2() -> VkSubmitInfo2
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            };
+        }
+
+        [[nodiscard]] inline auto semaphore_submit() -> VkSemaphoreSubmitInfo
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            };
+        }
+
+        [[nodiscard]] inline auto cmd_buffer_submit() -> VkCommandBufferSubmitInfo
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            };
+        }
+
+        [[nodiscard]] inline auto timeline_semaphore_submit() -> VkTimelineSemaphoreSubmitInfo
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            };
+        }
+
+        [[nodiscard]] inline auto semaphore_wait() -> VkSemaphoreWaitInfo
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            };
+        }
+
+        [[nodiscard]] inline auto semaphore_signal() -> VkSemaphoreSignalInfo
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+            };
+        }
+
+        [[nodiscard]] inline auto present_id() -> VkPresentIdKHR
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+            };
+        }
+
+        [[nodiscard]] inline auto physical_device_features() -> VkPhysicalDeviceFeatures2
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            };
+        }
+
+        [[nodiscard]] inline auto vulkan_12_features() -> VkPhysicalDeviceVulkan12Features
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            };
+        }
+
+        [[nodiscard]] inline auto vulkan_13_features() -> VkPhysicalDeviceVulkan13Features
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+            };
+        }
+
+        [[nodiscard]] inline auto present_id_features() -> VkPhysicalDevicePresentIdFeaturesKHR
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+            };
+        }
+
+        [[nodiscard]] inline auto present_wait_features() -> VkPhysicalDevicePresentWaitFeaturesKHR
+        {
+            return {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+            };
+        }
     } // namespace structs
 
 } // namespace orb::vk
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "orb/vk/core.hpp"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace orb::vk
+{
+    /* @brief Defers the destruction of GPU resources until the GPU is done with them
+     *
+     * Entries are tagged with a retire value: a frame number or a timeline semaphore value that
+     * the GPU work using the resource signals. `collect(completed)` destroys every entry whose
+     * value is lower or equal to `completed`. Resources are moved in and destroyed through their
+     * destructor, so any RAII type of the library can be deferred:
+     *
+     *   deletions.defer(std::move(old_vertex_buffer));
+     *
+     * With a fixed number of frames in flight, call `begin_frame` once the frame's fence has been
+     * waited on: everything retired at least `frames_in_flight` frames ago is released.
+     */
+    class deletion_queue_t
+    {
+    public:
+        deletion_queue_t() = default;
+
+        deletion_queue_t(const deletion_queue_t&)                    = delete;
+        auto operator=(const deletion_queue_t&) -> deletion_queue_t& = delete;
+
+        deletion_queue_t(deletion_queue_t&&)                    = delete;
+        auto operator=(deletion_queue_t&&) -> deletion_queue_t& = delete;
+
+        ~deletion_queue_t()
+        {
+            flush();
+        }
+
+        /* @brief Sets the value that resources deferred from now on are tagged with */
+        void set_current(ui64 value)
+        {
+            std::scoped_lock lock(m_mutex);
+            m_current = value;
+        }
+
+        [[nodiscard]] auto current() const -> ui64
+        {
+            std::scoped_lock lock(m_mutex);
+            return m_current;
+        }
+
+        template <typename T>
+        void defer(T&& resource)
+        {
+            using value_t = std::remove_cvref_t<T>;
+
+            auto* moved = new value_t(std::forward<T>(resource)); // NOLINT
+            push({ moved, [](void* r) { delete static_cast<value_t*>(r); } });
+        }
+
+        /* @brief Defers an arbitrary callback, e.g. for raw handles not owned by a resource type */
+        void defer_fn(std::function<void()> fn)
+        {
+            auto* moved = new std::function<void()>(std::move(fn)); // NOLINT
+            push({ moved, [](void* r) {
+                      auto* f = static_cast<std::function<void()>*>(r);
+                      (*f)();
+                      delete f;
+                  } });
+        }
+
+        /* @brief Destroys every entry retired at or before `completed` */
+        void collect(ui64 completed)
+        {
+            std::deque<entry_t> ready;
+
+            {
+                std::scoped_lock lock(m_mutex);
+
+                // Values only grow, so the queue is sorted
+                while (!m_entries.empty() && m_entries.front().value <= completed)
+                {
+                    ready.push_back(std::move(m_entries.front()));
+                    m_entries.pop_front();
+                }
+            }
+
+            // Destructors run outside the lock, they may defer other resources
+            ready.clear();
+        }
+
+        /* @brief Frame based helper: collects frame `frame - frames_in_flight` and tags with `frame` */
+        void begin_frame(ui64 frame, ui32 frames_in_flight)
+        {
+            if (frame >= frames_in_flight) collect(frame - frames_in_flight);
+            set_current(frame);
+        }
+
+        /* @brief Destroys everything. Only valid once the device is idle */
+        void flush()
+        {
+            std::deque<entry_t> all;
+
+            {
+                std::scoped_lock lock(m_mutex);
+                all.swap(m_entries);
+            }
+
+            all.clear();
+        }
+
+        [[nodiscard]] auto size() const -> size_t
+        {
+            std::scoped_lock lock(m_mutex);
+            return m_entries.size();
+        }
+
+    private:
+        using resource_t = std::unique_ptr<void, void (*)(void*)>;
+
+        struct entry_t
+        {
+            ui64       value;
+            resource_t resource;
+        };
+
+        void push(resource_t resource)
+        {
+            std::scoped_lock lock(m_mutex);
+            m_entries.push_back({ m_current, std::move(resource) });
+        }
+
+        mutable std::mutex  m_mutex;
+        std::deque<entry_t> m_entries;
+        ui64                m_current = 0;
+    };
+} // namespace orb::vk
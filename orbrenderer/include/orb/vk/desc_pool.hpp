@@ -51,7 +51,7 @@ namespace orb::vk
         {
             if (!handle) return;
 
-            vkDestroyDescriptorPool(device, handle, nullptr);
+            vkDestroyDescriptorPool(device, handle, host_callbacks(host_scope::descriptors));
             handle = nullptr;
         }
     };
@@ -82,7 +82,7 @@ namespace orb::vk
             pool_info.poolSizeCount = m_pool_sizes.size();
             pool_info.pPoolSizes    = m_pool_sizes.data();
 
-            if (auto r = vkCreateDescriptorPool(m_device->handle, &pool_info, nullptr, &pool.handle);
+            if (auto r = vkCreateDescriptorPool(m_device->handle, &pool_info, host_callbacks(host_scope::descriptors), &pool.handle);
                 r != vkres::ok)
             {
                 return error_t { "Could not create descriptor pool: {}", vkres::get_repr(r) };
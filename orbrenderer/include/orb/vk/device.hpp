@@ -1,6 +1,7 @@
 #pragma once
 
 #include "orb/vk/core.hpp"
+#include "orb/vk/host_allocator.hpp"
 
 #include <orb/box.hpp>
 #include <orb/result.hpp>
@@ -26,10 +27,21 @@ namespace orb::vk
 
     struct device_t
     {
-        VkDevice                            handle {};
-        std::vector<VkQueue>                queues {};
-        VmaAllocator                        allocator {};
-        proc_addresses::set_debug_name_fn_t set_debug_name_fb {};
+        VkDevice                             handle {};
+        VkPhysicalDevice                     physical_device {};
+        std::vector<VkQueue>                 queues {};
+        VmaAllocator                         allocator {};
+        proc_addresses::set_debug_name_fn_t  set_debug_name_fb {};
+        proc_addresses::cmd_begin_label_fn_t cmd_begin_label_fb {};
+        proc_addresses::cmd_end_label_fn_t   cmd_end_label_fb {};
+
+        // Null unless `device_builder_t::present_wait` could enable it
+        proc_addresses::wait_for_present_fn_t wait_for_present_fb {};
+
+        // Features enabled at creation, pNext members are cleared
+        VkPhysicalDeviceFeatures         features {};
+        VkPhysicalDeviceVulkan12Features features_12 {};
+        VkPhysicalDeviceVulkan13Features features_13 {};
 
         device_t() = default;
 
@@ -40,28 +52,48 @@ namespace orb::vk
         {
             destroy();
 
-            handle            = other.handle;
-            queues            = std::move(other.queues);
-            allocator         = other.allocator;
-            set_debug_name_fb = other.set_debug_name_fb;
+            handle              = other.handle;
+            physical_device     = other.physical_device;
+            queues              = std::move(other.queues);
+            allocator           = other.allocator;
+            set_debug_name_fb   = other.set_debug_name_fb;
+            cmd_begin_label_fb  = other.cmd_begin_label_fb;
+            cmd_end_label_fb    = other.cmd_end_label_fb;
+            wait_for_present_fb = other.wait_for_present_fb;
+            features            = other.features;
+            features_12         = other.features_12;
+            features_13         = other.features_13;
 
-            other.handle            = nullptr;
-            other.allocator         = nullptr;
-            other.set_debug_name_fb = nullptr;
+            other.handle              = nullptr;
+            other.allocator           = nullptr;
+            other.set_debug_name_fb   = nullptr;
+            other.cmd_begin_label_fb  = nullptr;
+            other.cmd_end_label_fb    = nullptr;
+            other.wait_for_present_fb = nullptr;
         }
 
         auto operator=(device_t&& other) noexcept -> device_t&
         {
             destroy();
 
-            handle            = other.handle;
-            queues            = std::move(other.queues);
-            allocator         = other.allocator;
-            set_debug_name_fb = other.set_debug_name_fb;
+            handle              = other.handle;
+            physical_device     = other.physical_device;
+            queues              = std::move(other.queues);
+            allocator           = other.allocator;
+            set_debug_name_fb   = other.set_debug_name_fb;
+            cmd_begin_label_fb  = other.cmd_begin_label_fb;
+            cmd_end_label_fb    = other.cmd_end_label_fb;
+            wait_for_present_fb = other.wait_for_present_fb;
+            features            = other.features;
+            features_12         = other.features_12;
+            features_13         = other.features_13;
 
-            other.handle            = nullptr;
-            other.allocator         = nullptr;
-            other.set_debug_name_fb = nullptr;
+            other.handle              = nullptr;
+            other.allocator           = nullptr;
+            other.set_debug_name_fb   = nullptr;
+            other.cmd_begin_label_fb  = nullptr;
+            other.cmd_end_label_fb    = nullptr;
+            other.wait_for_present_fb = nullptr;
 
             return *this;
         }
@@ -81,7 +113,7 @@ namespace orb::vk
 
             if (handle)
             {
-                vkDestroyDevice(handle, nullptr);
+                vkDestroyDevice(handle, host_callbacks(host_scope::device));
                 handle = nullptr;
             }
         }
@@ -125,9 +157,103 @@ namespace orb::vk
 
         auto add_queue(weak<queue_family_t>, priority_t) -> device_builder_t&;
 
+        /* @brief Core features to enable */
+        auto features() -> VkPhysicalDeviceFeatures&
+        {
+            return m_features.features;
+        }
+
+        /* @brief Vulkan 1.2 features to enable, only chained when accessed */
+        auto features_12() -> VkPhysicalDeviceVulkan12Features&
+        {
+            m_use_features_12 = true;
+            return m_features_12;
+        }
+
+        /* @brief Vulkan 1.3 features to enable, only chained when accessed */
+        auto features_13() -> VkPhysicalDeviceVulkan13Features&
+        {
+            m_use_features_13 = true;
+            return m_features_13;
+        }
+
+        /* @brief Chains an extension feature struct, it must stay alive until `build()` */
+        auto add_features(void* features) -> device_builder_t&
+        {
+            m_extension_features.push_back(static_cast<VkBaseOutStructure*>(features));
+            return *this;
+        }
+
+        auto timeline_semaphores(bool enable = true) -> device_builder_t&
+        {
+            features_12().timelineSemaphore = enable ? VK_TRUE : VK_FALSE;
+            return *this;
+        }
+
+        /* @brief Allows pipeline statistics queries, see `pipeline_stats_t` */
+        auto pipeline_statistics(bool enable = true) -> device_builder_t&
+        {
+            m_features.features.pipelineStatisticsQuery = enable ? VK_TRUE : VK_FALSE;
+            return *this;
+        }
+
+        /* @brief Allows resetting query pools from the host with vkResetQueryPool */
+        auto host_query_reset(bool enable = true) -> device_builder_t&
+        {
+            features_12().hostQueryReset = enable ? VK_TRUE : VK_FALSE;
+            return *this;
+        }
+
+        /* @brief Allows GPU-driven draws with vkCmdDrawIndexedIndirectCount, see `gpu_culling_t`
+         *
+         * Also enables multiDrawIndirect and drawIndirectFirstInstance, which the indirect draws
+         * written on the GPU rely on.
+         */
+        auto draw_indirect_count(bool enable = true) -> device_builder_t&
+        {
+            m_features.features.multiDrawIndirect         = enable ? VK_TRUE : VK_FALSE;
+            m_features.features.drawIndirectFirstInstance = enable ? VK_TRUE : VK_FALSE;
+            features_12().drawIndirectCount               = enable ? VK_TRUE : VK_FALSE;
+            return *this;
+        }
+
+        /* @brief Enables vkQueueSubmit2 and the other Vulkan 1.3 synchronization commands
+         *
+         * Passing false leaves the Vulkan 1.3 features alone, so this can be gated on the GPU
+         * api version without chaining VkPhysicalDeviceVulkan13Features on older devices.
+         */
+        auto synchronization2(bool enable = true) -> device_builder_t&
+        {
+            if (enable || m_use_features_13) features_13().synchronization2 = enable ? VK_TRUE : VK_FALSE;
+            return *this;
+        }
+
+        /* @brief Enables VK_KHR_present_id and VK_KHR_present_wait if the GPU supports them
+         *
+         * Unlike the other features this one is optional, `device_t::wait_for_present_fb` stays
+         * null when unsupported. See `frame_pacer_t`.
+         */
+        auto present_wait(bool enable = true) -> device_builder_t&
+        {
+            m_present_wait = enable;
+            return *this;
+        }
+
     private:
         device_builder_t() = default;
 
+        VkPhysicalDeviceFeatures2        m_features        = structs::physical_device_features();
+        VkPhysicalDeviceVulkan12Features m_features_12     = structs::vulkan_12_features();
+        VkPhysicalDeviceVulkan13Features m_features_13     = structs::vulkan_13_features();
+        bool                             m_use_features_12 = false;
+        bool                             m_use_features_13 = false;
+
+        VkPhysicalDevicePresentIdFeaturesKHR   m_present_id_features   = structs::present_id_features();
+        VkPhysicalDevicePresentWaitFeaturesKHR m_present_wait_features = structs::present_wait_features();
+        bool                                   m_present_wait          = false;
+
+        std::vector<VkBaseOutStructure*> m_extension_features;
+
         VkInstance               m_instance {};
         std::vector<const char*> m_extensions;
         weak<gpu_t>              m_gpu;
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "orb/vk/device.hpp"
+
+#include <orb/result.hpp>
+
+#include <span>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Fields of a draw sort key, from the most to the least significant
+     *
+     * Ids are truncated to their bit width: small indices or hashes both work, a collision
+     * only costs an extra bind since binds compare the actual handles.
+     */
+    struct draw_key_t
+    {
+        ui32 layer    = 0;    // 4 bits: passes, opaque before transparent
+        ui32 pipeline = 0;    // 12 bits
+        ui32 desc_set = 0;    // 12 bits
+        ui32 mesh     = 0;    // 12 bits
+        f32  depth    = 0.0f; // 24 bits, view depth in [0, 1], pass 1 - depth to draw back to front
+
+        [[nodiscard]] auto pack() const -> ui64;
+    };
+
+    /* @brief State and parameters of an indexed draw */
+    struct draw_item_t
+    {
+        VkPipeline       pipeline       = nullptr;
+        VkPipelineLayout layout         = nullptr;
+        VkDescriptorSet  desc_set       = nullptr; // bound at set 0 when not null
+        VkBuffer         vertex_buffer  = nullptr; // bound at binding 0
+        VkBuffer         index_buffer   = nullptr;
+        VkIndexType      index_type     = VK_INDEX_TYPE_UINT16;
+        ui32             index_count    = 0;
+        ui32             instance_count = 1;
+        ui32             first_index    = 0;
+        i32              vertex_offset  = 0;
+        ui32             first_instance = 0;
+    };
+
+    /* @brief Commands recorded by `draw_queue_t::record`, to compare against one bind per draw */
+    struct draw_stats_t
+    {
+        ui32 draws          = 0;
+        ui32 pipeline_binds = 0;
+        ui32 set_binds      = 0;
+        ui32 vertex_binds   = 0;
+        ui32 index_binds    = 0;
+    };
+
+    /* @brief Draws collected in any order, sorted by key and recorded with minimal state changes
+     *
+     * Keys are sorted with a least significant digit radix sort over bytes: one pass over the
+     * keys builds the eight histograms, and passes whose byte is the same for every key are
+     * skipped, so keys using few distinct values sort in fewer passes. Small queues fall back
+     * to a comparison sort. Both are stable: draws with equal keys keep their push order.
+     *
+     *   queue.clear();
+     *   for (auto& obj : scene) queue.push({ .layer = 0, .pipeline = obj.material, ... }, obj.draw);
+     *   queue.sort();
+     *   queue.record(cmd.handle);
+     *
+     * The queue keeps its storage between frames, steady state pushes allocate nothing.
+     */
+    class draw_queue_t
+    {
+    public:
+        void clear();
+
+        void reserve(ui32 count);
+
+        void push(ui64 key, const draw_item_t& item);
+
+        void push(const draw_key_t& key, const draw_item_t& item)
+        {
+            push(key.pack(), item);
+        }
+
+        void sort();
+
+        /* @brief Records the draws in queue order, skipping binds of the state already bound */
+        auto record(VkCommandBuffer cmd) const -> draw_stats_t;
+
+        /* @brief What `record` would emit, without recording */
+        [[nodiscard]] auto stats() const -> draw_stats_t;
+
+        [[nodiscard]] auto size() const -> ui32 { return static_cast<ui32>(m_entries.size()); }
+
+        /* @brief Sorted keys, for inspection */
+        [[nodiscard]] auto key(ui32 i) const -> ui64 { return m_entries[i].key; }
+
+        [[nodiscard]] auto item(ui32 i) const -> const draw_item_t& { return m_items[m_entries[i].index]; }
+
+    private:
+        struct entry_t
+        {
+            ui64 key;
+            ui32 index;
+        };
+
+        [[nodiscard]] auto walk(VkCommandBuffer cmd) const -> draw_stats_t;
+
+        std::vector<entry_t>     m_entries;
+        std::vector<entry_t>     m_scratch;
+        std::vector<draw_item_t> m_items;
+    };
+} // namespace orb::vk
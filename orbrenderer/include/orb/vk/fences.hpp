@@ -1,5 +1,6 @@
 #pragma once
 
+#include "orb/profiler.hpp"
 #include "orb/vk/device.hpp"
 
 #include <orb/box.hpp>
@@ -19,6 +20,8 @@ namespace orb::vk
 
         [[nodiscard]] auto wait() -> result<void>
         {
+            ORB_PROFILE_ZONE("fence_t::wait");
+
             const auto res = vkWaitForFences(device, 1, &handle, VK_TRUE, UINT64_MAX);
 
             if (res != vkres::ok)
@@ -81,7 +84,7 @@ namespace orb::vk
                     continue;
                 }
 
-                vkDestroyFence(device, fence, nullptr);
+                vkDestroyFence(device, fence, host_callbacks(host_scope::sync));
                 fence = nullptr;
             }
         }
@@ -93,6 +96,8 @@ namespace orb::vk
 
         [[nodiscard]] auto wait() -> result<void>
         {
+            ORB_PROFILE_ZONE("fences_t::wait");
+
             const auto res = vkWaitForFences(device,
                                              handles.size(),
                                              handles.data(),
@@ -135,7 +140,7 @@ namespace orb::vk
 
             for (auto& fence : objs.handles)
             {
-                if (auto res = vkCreateFence(device->handle, &fence_info, nullptr, &fence); res != vkres::ok)
+                if (auto res = vkCreateFence(device->handle, &fence_info, host_callbacks(host_scope::sync), &fence); res != vkres::ok)
                 {
                     return error_t { "Could not create fence: {}", vkres::get_repr(res) };
                 }
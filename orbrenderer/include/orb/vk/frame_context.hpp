@@ -0,0 +1,193 @@
+#pragma once
+
+#include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/frame_sync.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Transient command pool whose buffers are recycled after each pool reset
+     *
+     * Buffers are never freed nor reset one by one: `reset` rewinds the pool with a single
+     * vkResetCommandPool and hands the same buffers out again, so steady state recording
+     * allocates nothing.
+     */
+    class recycling_cmd_pool_t
+    {
+    public:
+        box<cmd_pool_t> pool;
+
+        [[nodiscard]] auto acquire(cmd_buffer_level level = cmd_buffer_level::primary) -> result<cmd_buffer_t>
+        {
+            auto& list = level == cmd_buffer_level::primary ? m_primaries : m_secondaries;
+
+            if (list.used == list.handles.size())
+            {
+                // Grow geometrically to keep allocation calls rare during warm up
+                const size_t count = std::max<size_t>(list.handles.size(), 4);
+
+                auto cmds = pool->alloc_cmds(count, level);
+                if (!cmds) return cmds.error();
+
+                list.handles.insert(list.handles.end(), cmds.value().handles.begin(), cmds.value().handles.end());
+            }
+
+            return cmd_buffer_t { .handle = list.handles[list.used++] };
+        }
+
+        [[nodiscard]] auto reset() -> result<void>
+        {
+            if (m_primaries.used == 0 && m_secondaries.used == 0) return {};
+
+            if (auto r = pool->reset(); !r) return r.error();
+
+            m_primaries.used   = 0;
+            m_secondaries.used = 0;
+
+            return {};
+        }
+
+    private:
+        struct free_list_t
+        {
+            std::vector<VkCommandBuffer> handles;
+            size_t                       used = 0;
+        };
+
+        free_list_t m_primaries;
+        free_list_t m_secondaries;
+    };
+
+    /* @brief Ring of per frame command pools, one per queue family and frame in flight
+     *
+     * Command buffers obtained with `cmd` are only valid for the current frame. Their pool is
+     * reset as a whole the next time the slot comes around, once `frame_sync_t` reports that the
+     * GPU is done with it. Pools are created with `command_pool_create_flag::transient` and
+     * without `reset_command_buffer`, so buffers are started with `cmd_buffer_t::begin`.
+     *
+     *   const ui32 slot = frames->begin_frame(*sync).unwrap();
+     *   auto       cmd  = frames->cmd(graphics_qf->index).unwrap();
+     *   cmd.begin(command_buffer_usage_flag::one_time_submit).unwrap();
+     */
+    class frame_context_t
+    {
+    public:
+        /* @brief Waits for the slot through `sync`, then resets its pools */
+        [[nodiscard]] auto begin_frame(frame_sync_t& sync) -> result<ui32>
+        {
+            auto slot = sync.begin_frame();
+            if (!slot) return slot.error();
+
+            if (auto r = begin_frame(slot.value()); !r) return r.error();
+
+            return slot.value();
+        }
+
+        /* @brief Resets the pools of `slot`, the caller guarantees its previous work completed */
+        [[nodiscard]] auto begin_frame(ui32 slot) -> result<void>
+        {
+            m_slot = slot % m_slots.size();
+
+            for (auto& pool : m_slots[m_slot])
+            {
+                if (auto r = pool.reset(); !r) return r.error();
+            }
+
+            return {};
+        }
+
+        [[nodiscard]] auto cmd(ui32 qf_index, cmd_buffer_level level = cmd_buffer_level::primary)
+            -> result<cmd_buffer_t>
+        {
+            for (auto& pool : m_slots[m_slot])
+            {
+                if (pool.pool->qf_index == qf_index) return pool.acquire(level);
+            }
+
+            return error_t { "Queue family {} not registered in frame context", qf_index };
+        }
+
+        /* @brief Pool of the current slot for `qf_index`, e.g. to hand to a worker */
+        [[nodiscard]] auto pool(ui32 qf_index) -> weak<recycling_cmd_pool_t>
+        {
+            for (auto& pool : m_slots[m_slot])
+            {
+                if (pool.pool->qf_index == qf_index) return &pool;
+            }
+
+            return nullptr;
+        }
+
+        [[nodiscard]] auto slot() const -> ui32 { return m_slot; }
+
+    private:
+        friend class frame_context_builder_t;
+
+        std::vector<std::vector<recycling_cmd_pool_t>> m_slots;
+        ui32                                           m_slot = 0;
+    };
+
+    class frame_context_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<frame_context_builder_t>
+        {
+            frame_context_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        auto frames_in_flight(ui32 count) -> frame_context_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        auto queue_family(ui32 qf_index) -> frame_context_builder_t&
+        {
+            m_qf_indices.push_back(qf_index);
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<frame_context_t>>
+        {
+            if (m_frames_in_flight == 0)
+            {
+                return error_t { "Could not create frame context: at least one frame in flight is required" };
+            }
+
+            auto ctx = make_box<frame_context_t>();
+            ctx->m_slots.resize(m_frames_in_flight);
+
+            for (auto& slot : ctx->m_slots)
+            {
+                slot.resize(m_qf_indices.size());
+
+                for (size_t i = 0; i < m_qf_indices.size(); ++i)
+                {
+                    auto pool = cmd_pool_builder_t::prepare(m_device, m_qf_indices[i])
+                                    .unwrap()
+                                    .flag(command_pool_create_flag::transient)
+                                    .build();
+
+                    if (!pool) return pool.error();
+
+                    slot[i].pool = std::move(pool.value());
+                }
+            }
+
+            return ctx;
+        }
+
+    private:
+        weak<device_t>    m_device           = nullptr;
+        ui32              m_frames_in_flight = 2;
+        std::vector<ui32> m_qf_indices;
+    };
+} // namespace orb::vk
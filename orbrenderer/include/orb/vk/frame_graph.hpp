@@ -0,0 +1,414 @@
+#pragma once
+
+#include "orb/vk/aliasing.hpp"
+#include "orb/vk/deletion_queue.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/frame_context.hpp"
+#include "orb/vk/frame_sync.hpp"
+#include "orb/vk/gpu_profiler.hpp"
+#include "orb/vk/resource_tracker.hpp"
+#include "orb/vk/submit_batch.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <array>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace orb::vk
+{
+    enum class graph_queue : ui32
+    {
+        graphics,
+        compute,
+        transfer,
+    };
+
+    inline constexpr ui32 graph_queue_count = 3;
+
+    /* @brief Index of a resource in the graph, valid until the next `frame_graph_t::reset` */
+    using graph_resource_t = ui32;
+
+    /* @brief Image owned by the graph, created at compile time and aliased when possible */
+    struct graph_image_desc_t
+    {
+        vk::format        format = vk::format::r8g8b8a8_unorm;
+        VkExtent2D        extent {}; // 0 x 0: the graph extent times `scale`
+        f32               scale  = 1.0f;
+        image_aspect_flag aspect = image_aspect_flag::color;
+        ui32              levels = 1;
+    };
+
+    /* @brief Image owned by the caller, e.g. the acquired swapchain image */
+    struct graph_import_t
+    {
+        VkImage           image  = nullptr;
+        VkImageView       view   = nullptr;
+        VkExtent2D        extent {};
+        image_aspect_flag aspect = image_aspect_flag::color;
+        ui32              levels = 1;
+        VkImageLayout     layout = VK_IMAGE_LAYOUT_UNDEFINED; // layout the first time the graph sees the image
+    };
+
+    class frame_graph_t;
+
+    /* @brief What a pass sees while it records */
+    class graph_context_t
+    {
+    public:
+        cmd_buffer_t cmd;
+        ui32         slot = 0; // frame slot being recorded
+
+        [[nodiscard]] auto image(graph_resource_t id) const -> VkImage;
+        [[nodiscard]] auto view(graph_resource_t id) const -> VkImageView;
+        [[nodiscard]] auto buffer(graph_resource_t id) const -> VkBuffer;
+        [[nodiscard]] auto extent(graph_resource_t id) const -> VkExtent2D;
+
+    private:
+        friend class frame_graph_t;
+
+        const frame_graph_t* m_graph = nullptr;
+    };
+
+    using graph_execute_fn_t = std::function<void(graph_context_t& ctx)>;
+
+    class graph_pass_builder_t
+    {
+    public:
+        /* @brief Declares a usage, whether the pass reads or writes follows from `usage` */
+        auto use(graph_resource_t id, resource_usage usage) -> graph_pass_builder_t&;
+
+        /* @brief The pass has effects outside of the graph and is never culled */
+        auto side_effect() -> graph_pass_builder_t&;
+
+        auto execute(graph_execute_fn_t fn) -> graph_pass_builder_t&;
+
+    private:
+        friend class frame_graph_t;
+
+        graph_pass_builder_t(frame_graph_t* graph, ui32 pass)
+            : m_graph(graph),
+              m_pass(pass)
+        {
+        }
+
+        frame_graph_t* m_graph = nullptr;
+        ui32           m_pass  = 0;
+    };
+
+    /* @brief Transient images of one frame slot, with their views */
+    struct graph_transients_t
+    {
+        VkDevice                 device = nullptr;
+        aliased_images_t         images;
+        std::vector<VkImageView> views;
+
+        graph_transients_t() = default;
+
+        graph_transients_t(const graph_transients_t&)                    = delete;
+        auto operator=(const graph_transients_t&) -> graph_transients_t& = delete;
+
+        graph_transients_t(graph_transients_t&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        auto operator=(graph_transients_t&& other) noexcept -> graph_transients_t&
+        {
+            destroy();
+
+            device = other.device;
+            images = std::move(other.images);
+            views  = std::move(other.views);
+
+            other.views.clear();
+
+            return *this;
+        }
+
+        ~graph_transients_t()
+        {
+            destroy();
+        }
+
+        void destroy()
+        {
+            for (auto view : views)
+            {
+                vkDestroyImageView(device, view, host_callbacks(host_scope::resources));
+            }
+
+            views.clear();
+            images.destroy();
+        }
+    };
+
+    /* @brief Declarative frame graph
+     *
+     * Every frame, passes declare the resources they use, `compile` turns the declarations into
+     * a schedule and `execute` records and submits it:
+     *
+     *   - passes contributing neither to an output nor to a side effect are culled
+     *   - the remaining passes are ordered to respect every read/write hazard, passes of the
+     *     same queue being kept together
+     *   - consecutive passes on one queue form a batch: one command buffer, one submission.
+     *     Batches consuming the work of another queue wait on its timeline value. With every
+     *     pass culled, a single empty batch on graphics still waits and signals the imported
+     *     semaphores
+     *   - barriers and layout transitions come from a `resource_tracker_t`
+     *   - transient images live in one allocation per frame in flight, images with disjoint
+     *     lifetimes sharing memory
+     *
+     * `compile` only does work when the declarations (imported handles aside) or the extent
+     * changed since the last compilation, so redeclaring the graph every frame is cheap.
+     *
+     *   graph->reset();
+     *   graph->set_extent(swapchain->extent);
+     *   auto ui = graph->create_image("ui", { .format = vk::format::b8g8r8a8_unorm });
+     *   auto sc = graph->import_image("swapchain", { img, view, swapchain->extent });
+     *   graph->add_pass("ui").use(ui, resource_usage::color_attachment_write).execute(...);
+     *   graph->add_pass("blit", graph_queue::transfer)
+     *        .use(ui, resource_usage::transfer_src)
+     *        .use(sc, resource_usage::transfer_dst)
+     *        .execute(...);
+     *   graph->output(sc, resource_usage::present);
+     *   graph->compile().unwrap();
+     *   graph->execute(*frames, *sync, submits).unwrap();
+     *
+     * With a `gpu_profiler_t`, every pass with an execute function is timed in a zone of its name.
+     *
+     * Transient images use concurrent sharing when the graph spans several queue families,
+     * imported resources used from several families must be concurrent as well.
+     */
+    class frame_graph_t
+    {
+    public:
+        frame_graph_t() = default;
+
+        frame_graph_t(const frame_graph_t&)                    = delete;
+        auto operator=(const frame_graph_t&) -> frame_graph_t& = delete;
+
+        frame_graph_t(frame_graph_t&&)                    = delete;
+        auto operator=(frame_graph_t&&) -> frame_graph_t& = delete;
+
+        ~frame_graph_t() = default;
+
+        /* @brief Clears the declarations, the compiled schedule is kept for the next `compile` */
+        void reset();
+
+        void set_extent(VkExtent2D extent) { m_extent = extent; }
+
+        [[nodiscard]] auto create_image(std::string name, const graph_image_desc_t& desc) -> graph_resource_t;
+        [[nodiscard]] auto import_image(std::string name, const graph_import_t& image) -> graph_resource_t;
+        [[nodiscard]] auto import_buffer(std::string name, VkBuffer buffer) -> graph_resource_t;
+
+        [[nodiscard]] auto add_pass(std::string name, graph_queue queue = graph_queue::graphics)
+            -> graph_pass_builder_t;
+
+        /* @brief Keeps the passes producing `id` and leaves it in `final_usage` */
+        void output(graph_resource_t id, resource_usage final_usage = resource_usage::general);
+
+        /* @brief The first batch using `id` waits on `semaphore`, e.g. the acquire semaphore */
+        void wait(graph_resource_t id, VkSemaphore semaphore, VkPipelineStageFlags2 stages);
+
+        /* @brief The last batch using `id` signals `semaphore`, e.g. the present semaphore */
+        void signal(graph_resource_t id, VkSemaphore semaphore);
+
+        /* @brief Drops the state of an imported image, to call before destroying it */
+        void forget(VkImage image) { m_tracker.forget(image); }
+
+        /* @brief Schedules the declared graph, does nothing if it did not change */
+        [[nodiscard]] auto compile() -> result<void>;
+
+        /* @brief Records the passes in the current slot of `frames` and queues them in `submits` */
+        [[nodiscard]] auto execute(frame_context_t& frames, frame_sync_t& sync, submit_batch_t& submits)
+            -> result<void>;
+
+        /* @brief Number of actual compilations, e.g. to invalidate framebuffers on graph images */
+        [[nodiscard]] auto generation() const -> ui64 { return m_generation; }
+
+        [[nodiscard]] auto scheduled_passes() const -> size_t { return m_order.size(); }
+        [[nodiscard]] auto culled_passes() const -> size_t { return m_passes.size() - m_order.size(); }
+        [[nodiscard]] auto batches() const -> size_t { return m_batches.size(); }
+
+        /* @brief Memory held by the transients of one frame slot, and what it would be without aliasing */
+        [[nodiscard]] auto transient_size() const -> VkDeviceSize;
+        [[nodiscard]] auto unaliased_transient_size() const -> VkDeviceSize;
+
+        /* @brief Prints the compiled schedule */
+        void describe() const;
+
+    private:
+        friend class frame_graph_builder_t;
+        friend class graph_pass_builder_t;
+        friend class graph_context_t;
+
+        static constexpr ui32 none = ~0u;
+
+        struct resource_t
+        {
+            std::string        name;
+            bool               imported  = false;
+            bool               is_buffer = false;
+            graph_image_desc_t desc;
+            graph_import_t     import;
+            VkBuffer           buffer = nullptr;
+
+            bool           output      = false;
+            resource_usage final_usage = resource_usage::general;
+
+            VkSemaphore           wait_semaphore   = nullptr;
+            VkPipelineStageFlags2 wait_stages      = VK_PIPELINE_STAGE_2_NONE;
+            VkSemaphore           signal_semaphore = nullptr;
+        };
+
+        struct use_t
+        {
+            graph_resource_t resource;
+            resource_usage   usage;
+        };
+
+        struct pass_t
+        {
+            std::string        name;
+            graph_queue        queue       = graph_queue::graphics;
+            bool               side_effect = false;
+            std::vector<use_t> uses;
+            graph_execute_fn_t fn;
+        };
+
+        struct queue_t
+        {
+            VkQueue handle   = nullptr;
+            ui32    qf_index = 0;
+        };
+
+        /* @brief Compiled state of a resource, valid until the next compilation */
+        struct compiled_resource_t
+        {
+            ui32 transient   = none; // index in the transients of a slot
+            ui32 first_batch = none;
+            ui32 last_batch  = none;
+            bool aliased     = false; // shares memory with a transient used earlier in the frame
+        };
+
+        struct batch_t
+        {
+            queue_t           queue;
+            std::vector<ui32> passes;
+
+            // Earlier batches of other queues this one waits for, with the stages that wait
+            std::vector<std::pair<ui32, VkPipelineStageFlags2>> waits;
+        };
+
+        [[nodiscard]] auto hash() const -> ui64;
+        [[nodiscard]] auto queue(graph_queue kind) const -> const queue_t&;
+        [[nodiscard]] auto image_extent(const resource_t& r) const -> VkExtent2D;
+        [[nodiscard]] auto image_handle(graph_resource_t id) const -> VkImage;
+
+        void schedule(const std::vector<std::vector<ui32>>& successors, const std::vector<bool>& alive);
+        void build_batches();
+        [[nodiscard]] auto build_transients() -> result<void>;
+
+        void add_wait(ui32 batch, ui32 producer, VkPipelineStageFlags2 stages);
+        void enter(graph_resource_t id, ui32 batch);
+        void track(graph_resource_t id, resource_usage usage);
+
+        weak<device_t>                         m_device    = nullptr;
+        weak<deletion_queue_t>                 m_deletions = nullptr;
+        weak<gpu_profiler_t>                   m_profiler  = nullptr;
+        std::array<queue_t, graph_queue_count> m_queues {};
+        ui32                                   m_frames_in_flight = 2;
+
+        // Declarations, cleared by `reset`
+        std::vector<resource_t> m_resources;
+        std::vector<pass_t>     m_passes;
+        VkExtent2D              m_extent {};
+
+        // Compiled schedule
+        ui64                             m_hash       = 0;
+        ui64                             m_generation = 0;
+        std::vector<ui32>                m_order;
+        std::vector<batch_t>             m_batches;
+        std::vector<compiled_resource_t> m_compiled;
+        std::vector<graph_resource_t>    m_transient_resources; // resource of each transient index
+        std::vector<graph_transients_t>  m_transients;          // per frame slot
+
+        // Execution
+        resource_tracker_t        m_tracker;
+        ui32                      m_slot = 0;
+        std::vector<sync_point_t> m_batch_points;
+        std::vector<ui32>         m_entered; // per resource, last batch that declared a usage
+    };
+
+    class frame_graph_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<frame_graph_builder_t>
+        {
+            frame_graph_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        /* @brief Queue running the passes of `kind`, kinds without a queue run on graphics */
+        auto queue(graph_queue kind, VkQueue queue, ui32 qf_index) -> frame_graph_builder_t&
+        {
+            m_queues[std::to_underlying(kind)] = { queue, qf_index };
+            return *this;
+        }
+
+        /* @brief Must match the frame context the graph is executed with */
+        auto frames_in_flight(ui32 count) -> frame_graph_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        /* @brief Old transients are deferred there on recompilation instead of waiting for the device */
+        auto deletion_queue(weak<deletion_queue_t> deletions) -> frame_graph_builder_t&
+        {
+            m_deletions = deletions;
+            return *this;
+        }
+
+        /* @brief Times the passes, `gpu_profiler_t::begin_frame` being called by the user */
+        auto profiler(weak<gpu_profiler_t> profiler) -> frame_graph_builder_t&
+        {
+            m_profiler = profiler;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<frame_graph_t>>
+        {
+            if (!m_queues[std::to_underlying(graph_queue::graphics)].handle)
+            {
+                return error_t { "Could not create frame graph: no graphics queue given" };
+            }
+
+            auto tracker = resource_tracker_t::prepare(m_device);
+            if (!tracker) return tracker.error();
+
+            auto graph                = make_box<frame_graph_t>();
+            graph->m_device           = m_device;
+            graph->m_deletions        = m_deletions;
+            graph->m_profiler         = m_profiler;
+            graph->m_queues           = m_queues;
+            graph->m_frames_in_flight = m_frames_in_flight;
+            graph->m_tracker          = std::move(tracker.value());
+
+            return graph;
+        }
+
+    private:
+        weak<device_t>         m_device           = nullptr;
+        weak<deletion_queue_t> m_deletions        = nullptr;
+        weak<gpu_profiler_t>   m_profiler         = nullptr;
+        ui32                   m_frames_in_flight = 2;
+
+        std::array<frame_graph_t::queue_t, graph_queue_count> m_queues {};
+    };
+} // namespace orb::vk
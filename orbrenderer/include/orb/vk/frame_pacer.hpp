@@ -0,0 +1,165 @@
+#pragma once
+
+#include "orb/rolling_stats.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/swapchain.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <chrono>
+#include <vector>
+
+namespace orb::vk
+{
+    using pacing_clock_t = std::chrono::steady_clock;
+
+    /* @brief Limits the latency between the start of a frame and its display
+     *
+     * Each present is tagged with an id (VK_KHR_present_id). Before a frame starts, `begin_frame`
+     * waits with vkWaitForPresentKHR until the frame `frames_in_flight()` presents earlier is on
+     * screen, then sleeps for an extra delay: the later a frame starts, the fresher its input and
+     * the shorter its wait in the presentation queue. With mailbox, no frame is rendered only to
+     * be replaced; with FIFO, frames do not pile up in the queue.
+     *
+     *   pacer->begin_frame().unwrap();
+     *   const ui32 slot = frame_sync->begin_frame().unwrap();
+     *   ...
+     *   auto res = present_helper_t::prepare()...present_id(pacer->present_id()).present(queue);
+     *   pacer->presented(res);
+     *
+     * The present to display latency is measured on every frame, from the return of
+     * vkQueuePresentKHR to the return of vkWaitForPresentKHR. The delay is adjusted to bring it to
+     * the target, and the number of frames in flight is tuned every `tuning_window` frames:
+     * - it grows when the frames waited on were often already displayed, the GPU or the CPU
+     *   being the bottleneck, not the display;
+     * - it shrinks when the latency stays above the target although the delay cannot grow, and
+     *   grows back if frames are then displayed less often.
+     *
+     * `frame_sync_t` and the per frame resources keep their maximum frame count, the pacer only
+     * starts frames later. Without `device_builder_t::present_wait`, `begin_frame` returns right
+     * away and `frames_in_flight` stays at the maximum.
+     */
+    class frame_pacer_t
+    {
+    public:
+        static constexpr ui32 tuning_window = 64;
+
+        frame_pacer_t() = default;
+
+        frame_pacer_t(const frame_pacer_t&)                    = delete;
+        auto operator=(const frame_pacer_t&) -> frame_pacer_t& = delete;
+
+        frame_pacer_t(frame_pacer_t&&)                    = delete;
+        auto operator=(frame_pacer_t&&) -> frame_pacer_t& = delete;
+
+        /* @brief Waits until the next frame may start, before acquiring an image */
+        [[nodiscard]] auto begin_frame() -> result<void>;
+
+        /* @brief Id to present the current frame with, 0 without present wait */
+        [[nodiscard]] auto present_id() const -> ui64 { return enabled() ? m_next_id : 0; }
+
+        /* @brief Records the present of the current frame, right after vkQueuePresentKHR
+         *
+         * A failed present queued nothing: its id is presented again by the next frame.
+         */
+        void presented(const img_res_t& res);
+
+        /* @brief Whether present wait is available, the pacer does nothing otherwise */
+        [[nodiscard]] auto enabled() const -> bool { return m_device->wait_for_present_fb != nullptr; }
+
+        [[nodiscard]] auto frames_in_flight() const -> ui32 { return m_frames_in_flight; }
+
+        /* @brief Present to display latency, in milliseconds */
+        [[nodiscard]] auto latency() const -> const rolling_stats_t& { return m_latency; }
+
+        /* @brief Time between two displayed frames, in milliseconds */
+        [[nodiscard]] auto refresh_interval() const -> f32 { return m_refresh_ms; }
+
+        /* @brief Sleep added before each frame, in milliseconds */
+        [[nodiscard]] auto delay() const -> f32 { return m_delay_ms; }
+
+        /* @brief Latency aimed for, the refresh interval unless set by the builder */
+        [[nodiscard]] auto target_latency() const -> f32 { return m_target_ms > 0.0f ? m_target_ms : m_refresh_ms; }
+
+    private:
+        friend class frame_pacer_builder_t;
+
+        void reset();
+        void sample(f32 latency_ms, f32 blocked_ms, bool missed);
+        void tune();
+
+        weak<device_t>    m_device     = nullptr;
+        weak<swapchain_t> m_swapchain  = nullptr;
+        ui64              m_generation = 0;
+
+        ui32 m_min_frames       = 1;
+        ui32 m_max_frames       = 2;
+        ui32 m_frames_in_flight = 2;
+        f32  m_target_ms        = 0.0f;
+
+        // Present times of the ids not waited on yet, indexed by id modulo the size
+        std::vector<pacing_clock_t::time_point> m_present_times;
+        ui64                                    m_next_id   = 1;
+        ui64                                    m_waited_id = 0;
+
+        // Last wait that blocked, its return being the display time of its id
+        pacing_clock_t::time_point m_last_display {};
+        ui64                       m_last_display_id = 0;
+
+        rolling_stats_t m_latency;
+        f32             m_last_latency_ms = 0.0f;
+        f32             m_refresh_ms      = 1000.0f / 60.0f;
+        f32             m_delay_ms        = 0.0f;
+
+        // Current tuning window
+        ui32 m_frames   = 0;
+        f32  m_sum_ms   = 0.0f;
+        ui32 m_starved  = 0; // frames whose wait found the present already displayed, without delay
+        ui32 m_cooldown = 0; // windows left before shrinking again after growing
+
+        f32 m_shrunk_interval_ms = 0.0f; // display interval before the last shrink, until checked
+    };
+
+    class frame_pacer_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device, weak<swapchain_t> swapchain) -> result<frame_pacer_builder_t>
+        {
+            frame_pacer_builder_t b;
+            b.m_device    = device;
+            b.m_swapchain = swapchain;
+            return b;
+        }
+
+        /* @brief Most frames in flight, the count the per frame resources were created for */
+        auto max_frames_in_flight(ui32 count) -> frame_pacer_builder_t&
+        {
+            m_max_frames = count;
+            return *this;
+        }
+
+        /* @brief Fewest frames in flight the tuning may go down to */
+        auto min_frames_in_flight(ui32 count) -> frame_pacer_builder_t&
+        {
+            m_min_frames = count;
+            return *this;
+        }
+
+        /* @brief Present to display latency to aim for, defaults to one refresh interval */
+        auto target_latency(f32 ms) -> frame_pacer_builder_t&
+        {
+            m_target_ms = ms;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<frame_pacer_t>>;
+
+    private:
+        weak<device_t>    m_device     = nullptr;
+        weak<swapchain_t> m_swapchain  = nullptr;
+        ui32              m_min_frames = 1;
+        ui32              m_max_frames = 2;
+        f32               m_target_ms  = 0.0f;
+    };
+} // namespace orb::vk
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "orb/profiler.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/timeline.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Monotonic counter of the submissions made to one queue
+     *
+     * Every submission signals the next value of the queue's timeline semaphore. Waiting for any
+     * piece of work (a frame, an upload, a compute job) is waiting for the value it signaled.
+     */
+    class queue_timeline_t
+    {
+    public:
+        VkQueue              queue = nullptr;
+        timeline_semaphore_t semaphore;
+
+        /* @brief Reserves the value the next submission to this queue must signal */
+        [[nodiscard]] auto next() -> sync_point_t
+        {
+            return semaphore.point(++m_submitted);
+        }
+
+        /* @brief Value signaled by the last submission */
+        [[nodiscard]] auto last() const -> sync_point_t
+        {
+            return semaphore.point(m_submitted);
+        }
+
+        [[nodiscard]] auto completed() const -> result<ui64>
+        {
+            return semaphore.value();
+        }
+
+        [[nodiscard]] auto wait_idle() const -> result<void>
+        {
+            return semaphore.wait(m_submitted);
+        }
+
+    private:
+        ui64 m_submitted = 0;
+    };
+
+    /* @brief Frame pacing with one timeline semaphore per queue
+     *
+     * Replaces the per frame fences: `end_frame` records the last value of every queue, and
+     * `begin_frame` waits for the values recorded `frames_in_flight` frames earlier, in a single
+     * vkWaitSemaphores call. Requires `device_builder_t::timeline_semaphores`.
+     *
+     *   const ui32 slot = sync->begin_frame().unwrap();
+     *   auto&      gfx  = sync->timeline(queue);
+     *   submit_helper_t::prepare()...signal_timeline(gfx.next()).submit(queue);
+     *   sync->end_frame();
+     */
+    class frame_sync_t
+    {
+    public:
+        [[nodiscard]] auto timeline(VkQueue queue) -> queue_timeline_t&
+        {
+            for (auto& t : m_timelines)
+            {
+                if (t.queue == queue) return t;
+            }
+
+            orbassert(false, "Queue not registered in frame_sync_t");
+            return m_timelines.front();
+        }
+
+        /* @brief Waits until the frame slot is free, returns the slot index */
+        [[nodiscard]] auto begin_frame() -> result<ui32>
+        {
+            ORB_PROFILE_ZONE("frame_sync_t::begin_frame");
+
+            const ui32 slot = m_frame % m_frames_in_flight;
+
+            if (auto r = wait_sync_points(m_device, m_slots[slot]); !r) return r.error();
+
+            return slot;
+        }
+
+        void end_frame()
+        {
+            auto& points = m_slots[m_frame % m_frames_in_flight];
+
+            for (size_t i = 0; i < m_timelines.size(); ++i)
+            {
+                points[i] = m_timelines[i].last();
+            }
+
+            m_frame++;
+        }
+
+        /* @brief Number of frames ended so far */
+        [[nodiscard]] auto frame() const -> ui64 { return m_frame; }
+
+        [[nodiscard]] auto frames_in_flight() const -> ui32 { return m_frames_in_flight; }
+
+        /* @brief Waits for everything submitted on every queue */
+        [[nodiscard]] auto wait_idle() const -> result<void>
+        {
+            std::vector<sync_point_t> points;
+            points.reserve(m_timelines.size());
+
+            for (const auto& t : m_timelines)
+            {
+                points.push_back(t.last());
+            }
+
+            return wait_sync_points(m_device, points);
+        }
+
+    private:
+        friend class frame_sync_builder_t;
+
+        VkDevice                               m_device           = nullptr;
+        ui32                                   m_frames_in_flight = 2;
+        ui64                                   m_frame            = 0;
+        std::vector<queue_timeline_t>          m_timelines;
+        std::vector<std::vector<sync_point_t>> m_slots;
+    };
+
+    class frame_sync_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<frame_sync_builder_t>
+        {
+            frame_sync_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        auto frames_in_flight(ui32 count) -> frame_sync_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        auto queue(VkQueue queue) -> frame_sync_builder_t&
+        {
+            m_queues.push_back(queue);
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<frame_sync_t>>
+        {
+            if (m_queues.empty())
+            {
+                return error_t { "Could not create frame sync: no queue given" };
+            }
+
+            if (m_frames_in_flight == 0)
+            {
+                return error_t { "Could not create frame sync: at least one frame in flight is required" };
+            }
+
+            auto sync                = make_box<frame_sync_t>();
+            sync->m_device           = m_device->handle;
+            sync->m_frames_in_flight = m_frames_in_flight;
+            sync->m_timelines.resize(m_queues.size());
+            sync->m_slots.resize(m_frames_in_flight, std::vector<sync_point_t>(m_queues.size()));
+
+            for (size_t i = 0; i < m_queues.size(); ++i)
+            {
+                auto sem = timeline_semaphore_builder_t::prepare(m_device).unwrap().build();
+                if (!sem) return sem.error();
+
+                sync->m_timelines[i].queue     = m_queues[i];
+                sync->m_timelines[i].semaphore = std::move(sem.value());
+            }
+
+            return sync;
+        }
+
+    private:
+        weak<device_t>       m_device           = nullptr;
+        ui32                 m_frames_in_flight = 2;
+        std::vector<VkQueue> m_queues;
+    };
+} // namespace orb::vk
@@ -53,7 +53,7 @@ namespace orb::vk
             {
                 if (!fb) continue;
 
-                vkDestroyFramebuffer(device, fb, nullptr);
+                vkDestroyFramebuffer(device, fb, host_callbacks(host_scope::resources));
                 fb = nullptr;
             }
         }
@@ -102,7 +102,7 @@ namespace orb::vk
                 info.height          = m_height;
                 info.layers          = 1;
 
-                if (auto res = vkCreateFramebuffer(m_device->handle, &info, nullptr, &fb); res != vkres::ok)
+                if (auto res = vkCreateFramebuffer(m_device->handle, &info, host_callbacks(host_scope::resources), &fb); res != vkres::ok)
                 {
                     return error_t { "Could not create framebuffer {} : {}", i, (ui32)res };
                 }
@@ -44,6 +44,26 @@ namespace orb::vk
         [[nodiscard]] auto compute() const { return get_queues(queue_family::compute); }
         [[nodiscard]] auto sparse() const { return get_queues(queue_family::sparse); }
 
+        /* @brief Family for async compute: a compute family without graphics when there is one,
+         * the first graphics family otherwise
+         */
+        [[nodiscard]] auto async_compute() const -> result<queue_family_ref_t>
+        {
+            for (const auto& qf : m_families[get_index(queue_family::compute)])
+            {
+                if (!(qf->properties.queueFlags & vkenum(queue_family::graphics))) return qf;
+            }
+
+            const auto& graphics = m_families[get_index(queue_family::graphics)];
+
+            if (graphics.empty())
+            {
+                return error_t { "No queue family supports compute" };
+            }
+
+            return graphics.front();
+        }
+
     private:
         std::array<std::vector<queue_family_ref_t>, 4> m_families {};
 
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "orb/maths.hpp"
+#include "orb/vk/compute_pipeline.hpp"
+#include "orb/vk/desc_pool.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/shaders.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <array>
+#include <span>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Bounds and draw parameters of one object, laid out as the culling shader reads them (std430) */
+    struct gpu_object_t
+    {
+        glm::vec4 sphere { 0.0f }; // world space center in xyz, radius in w
+        ui32      index_count   = 0;
+        ui32      first_index   = 0;
+        i32       vertex_offset = 0;
+        ui32      instance      = 0; // firstInstance of the draw, lets the vertex shader find the object
+    };
+
+    static_assert(sizeof(gpu_object_t) == 32);
+
+    /* @brief Planes of a view frustum, normals point inwards */
+    struct frustum_t
+    {
+        std::array<glm::vec4, 6> planes {};
+
+        /* @brief Extracts the planes of a projection * view matrix
+         *
+         * The near plane is taken for a [-1, 1] depth range, which also holds for [0, 1]
+         * projections where it is slightly conservative.
+         */
+        [[nodiscard]] static auto from_view_proj(const glm::mat4& view_proj) -> frustum_t;
+    };
+
+    /* @brief GPU-driven draws: frustum culling in a compute pass, drawn with one indirect count call
+     *
+     * Objects are set with `objects` and copied to the storage buffer of a slot by the next
+     * `begin_frame` on that slot, once its previous frame completed. Each frame, `record_cull`
+     * resets a counter and dispatches one invocation per object: the ones whose bounding sphere
+     * touches the frustum append a VkDrawIndexedIndirectCommand with an atomic on the counter.
+     * `record_draw` then issues vkCmdDrawIndexedIndirectCount from those buffers, so the CPU cost
+     * of a frame does not depend on the object count.
+     *
+     *   culling->begin_frame(frame).unwrap();
+     *   culling->record_cull(cmd.handle, vk::frustum_t::from_view_proj(proj * view));
+     *   render_pass->begin(cmd.handle);
+     *   // bind the pipeline, vertex and index buffers
+     *   culling->record_draw(cmd.handle);
+     *
+     * Object, draw and count buffers are duplicated per frame in flight. All objects share the vertex
+     * and index buffers bound by the caller. `record_cull` only needs a compute queue, so it may
+     * run as an `async_compute_t` job. Requires `device_builder_t::draw_indirect_count`.
+     */
+    class gpu_culling_t
+    {
+    public:
+        gpu_culling_t() = default;
+
+        gpu_culling_t(const gpu_culling_t&)                    = delete;
+        auto operator=(const gpu_culling_t&) -> gpu_culling_t& = delete;
+
+        gpu_culling_t(gpu_culling_t&&)                    = delete;
+        auto operator=(gpu_culling_t&&) -> gpu_culling_t& = delete;
+
+        ~gpu_culling_t()
+        {
+            destroy();
+        }
+
+        void destroy();
+
+        /* @brief Sets the objects to cull and draw, replacing the previous ones
+         *
+         * Frames in flight keep culling their own copy, each slot picks the new objects up in
+         * its next `begin_frame`.
+         */
+        [[nodiscard]] auto objects(std::span<const gpu_object_t> objects) -> result<void>;
+
+        /* @brief Selects the buffers of `slot`, reads how many draws it kept last time and
+         * uploads the objects set since
+         *
+         * Call it after the slot's fence was waited on.
+         */
+        [[nodiscard]] auto begin_frame(ui32 slot) -> result<void>;
+
+        /* @brief Records the culling dispatch, outside a render pass */
+        void record_cull(VkCommandBuffer cmd, const frustum_t& frustum);
+
+        /* @brief Draws the objects kept by `record_cull`, in a render pass with the buffers bound */
+        void record_draw(VkCommandBuffer cmd) const;
+
+        [[nodiscard]] auto object_count() const -> ui32 { return m_object_count; }
+
+        /* @brief Draws kept by the last collected frame of the current slot */
+        [[nodiscard]] auto visible_count() const -> ui32 { return m_visible_count; }
+
+        /* @brief Buffers of the current slot written by `record_cull` and read by `record_draw`,
+         * to hand over when culling runs on another queue (see `async_compute_t`)
+         */
+        [[nodiscard]] auto draw_buffer() const -> VkBuffer { return m_current->draws.buffer; }
+        [[nodiscard]] auto count_buffer() const -> VkBuffer { return m_current->count.buffer; }
+
+    private:
+        friend class gpu_culling_builder_t;
+
+        struct buffer_t
+        {
+            VkBuffer      buffer     = nullptr;
+            VmaAllocation allocation = nullptr;
+            void*         ptr        = nullptr; // persistently mapped, host visible buffers only
+        };
+
+        struct frame_t
+        {
+            buffer_t        objects;
+            buffer_t        draws;
+            buffer_t        count;
+            buffer_t        readback;
+            VkDescriptorSet set             = nullptr;
+            bool            recorded        = false;
+            ui32            object_count    = 0;
+            ui64            objects_version = 0; // of the objects copied to `objects`
+        };
+
+        [[nodiscard]] auto create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocationCreateFlags flags)
+            -> result<buffer_t>;
+
+        void destroy_buffer(buffer_t& buffer);
+
+        weak<device_t>          m_device = nullptr;
+        box<compute_pipeline_t> m_pipeline;
+        desc_pool_t             m_desc_pool;
+
+        std::vector<gpu_object_t> m_objects;
+        std::vector<frame_t>      m_frames;
+
+        frame_t* m_current         = nullptr;
+        ui32     m_max_objects     = 0;
+        ui32     m_object_count    = 0;
+        ui32     m_visible_count   = 0;
+        ui64     m_objects_version = 0;
+    };
+
+    class gpu_culling_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device, weak<spirv_compiler_t> compiler)
+            -> result<gpu_culling_builder_t>
+        {
+            gpu_culling_builder_t b;
+            b.m_device   = device;
+            b.m_compiler = compiler;
+            return b;
+        }
+
+        auto frames_in_flight(ui32 count) -> gpu_culling_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        /* @brief Capacity of the object buffer, and of the draw buffers */
+        auto max_objects(ui32 count) -> gpu_culling_builder_t&
+        {
+            m_max_objects = count;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<gpu_culling_t>>;
+
+    private:
+        weak<device_t>         m_device           = nullptr;
+        weak<spirv_compiler_t> m_compiler         = nullptr;
+        ui32                   m_frames_in_flight = 2;
+        ui32                   m_max_objects      = 0;
+    };
+} // namespace orb::vk
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "orb/rolling_stats.hpp"
+#include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/gpu.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <array>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Timings of a zone over its last `window` samples, in milliseconds */
+    struct gpu_zone_stats_t : rolling_stats_t
+    {
+        std::string name;
+    };
+
+    class gpu_profiler_t;
+
+    /* @brief Timed region of a command buffer, closed when the zone is destroyed */
+    class gpu_zone_t
+    {
+    public:
+        gpu_zone_t() = default;
+
+        gpu_zone_t(const gpu_zone_t&)                    = delete;
+        auto operator=(const gpu_zone_t&) -> gpu_zone_t& = delete;
+
+        gpu_zone_t(gpu_zone_t&& other) noexcept
+            : m_profiler(std::exchange(other.m_profiler, nullptr))
+            , m_cmd(other.m_cmd)
+            , m_pool(other.m_pool)
+            , m_query(other.m_query)
+        {
+        }
+
+        auto operator=(gpu_zone_t&& other) noexcept -> gpu_zone_t&
+        {
+            end();
+
+            m_profiler = std::exchange(other.m_profiler, nullptr);
+            m_cmd      = other.m_cmd;
+            m_pool     = other.m_pool;
+            m_query    = other.m_query;
+
+            return *this;
+        }
+
+        ~gpu_zone_t()
+        {
+            end();
+        }
+
+        /* @brief Closes the zone before the end of the scope */
+        void end();
+
+    private:
+        friend class gpu_profiler_t;
+
+        gpu_profiler_t* m_profiler = nullptr;
+        VkCommandBuffer m_cmd      = nullptr;
+        VkQueryPool     m_pool     = nullptr;
+        ui32            m_query    = std::numeric_limits<ui32>::max();
+    };
+
+    /* @brief Measures GPU time spent in named zones of command buffers
+     *
+     * Each zone writes a timestamp query when opened and when closed, and wraps its commands in a
+     * debug utils label so capture tools show the same structure. There is one query pool per
+     * frame in flight: `begin_frame` reads the timestamps the slot recorded `frames_in_flight`
+     * frames ago, without waiting on the GPU, then resets the pool for the new frame.
+     *
+     *   const ui32 frame = frame_ctx->begin_frame(*frame_sync).unwrap();
+     *   profiler->begin_frame(frame).unwrap();
+     *   {
+     *       auto zone = profiler->zone(cmd, "shadows");
+     *       ...
+     *   }
+     *   fmt::println("shadows: {:.3f} ms", profiler->stats("shadows")->average());
+     *
+     * Without `device_builder_t::host_query_reset`, the pool is reset from the command buffer of
+     * the first zone of the frame: it must be opened outside a render pass, in the first command
+     * buffer submitted.
+     */
+    class gpu_profiler_t
+    {
+    public:
+        gpu_profiler_t() = default;
+
+        gpu_profiler_t(const gpu_profiler_t&)                    = delete;
+        auto operator=(const gpu_profiler_t&) -> gpu_profiler_t& = delete;
+
+        gpu_profiler_t(gpu_profiler_t&&)                    = delete;
+        auto operator=(gpu_profiler_t&&) -> gpu_profiler_t& = delete;
+
+        ~gpu_profiler_t()
+        {
+            destroy();
+        }
+
+        void destroy();
+
+        /* @brief Collects the timings of the frame that last used `slot` and resets its queries
+         *
+         * Call it after the slot's fence was waited on, e.g. right after
+         * `frame_context_t::begin_frame`. Zones the GPU did not finish yet are dropped.
+         */
+        [[nodiscard]] auto begin_frame(ui32 slot) -> result<void>;
+
+        /* @brief Opens a zone in `cmd`, recorded on a queue of family `qf_index`
+         *
+         * Queues without timestamp support, or zones past `max_zones` in a frame, only get the
+         * debug label.
+         */
+        [[nodiscard]] auto zone(VkCommandBuffer cmd, std::string_view name, ui32 qf_index) -> gpu_zone_t;
+
+        [[nodiscard]] auto zone(const cmd_buffer_t& cmd, std::string_view name) -> gpu_zone_t
+        {
+            return zone(cmd.handle, name, m_default_qf);
+        }
+
+        /* @brief Every zone opened so far, in order of appearance */
+        [[nodiscard]] auto zones() const -> std::span<const gpu_zone_stats_t> { return m_zones; }
+
+        /* @brief Stats of the zone named `name`, nullptr if it was never opened */
+        [[nodiscard]] auto stats(std::string_view name) const -> const gpu_zone_stats_t*;
+
+        void describe() const;
+
+    private:
+        friend class gpu_profiler_builder_t;
+        friend class gpu_zone_t;
+
+        struct name_hash_t
+        {
+            using is_transparent = void;
+
+            auto operator()(std::string_view s) const -> size_t
+            {
+                return std::hash<std::string_view> {}(s);
+            }
+        };
+
+        struct recorded_t
+        {
+            ui32 zone;
+            ui32 query;
+            ui64 mask;
+        };
+
+        struct frame_t
+        {
+            VkQueryPool             pool        = nullptr;
+            ui32                    used        = 0;
+            bool                    needs_reset = true;
+            std::vector<recorded_t> recorded;
+        };
+
+        void close(const gpu_zone_t& zone);
+
+        weak<device_t>       m_device = nullptr;
+        std::vector<frame_t> m_frames;
+        std::vector<ui64>    m_results;
+
+        // Valid timestamp bits, per queue family index
+        std::vector<ui64> m_masks;
+
+        std::vector<gpu_zone_stats_t>                                        m_zones;
+        std::unordered_map<std::string, ui32, name_hash_t, std::equal_to<>> m_zone_ids;
+
+        frame_t* m_current     = nullptr;
+        f32      m_ms_per_tick = 0.0f;
+        ui32     m_max_queries = 0;
+        ui32     m_default_qf  = 0;
+        bool     m_host_reset  = false;
+    };
+
+    class gpu_profiler_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device, weak<gpu_t> gpu) -> result<gpu_profiler_builder_t>
+        {
+            gpu_profiler_builder_t b;
+            b.m_device = device;
+            b.m_gpu    = gpu;
+            return b;
+        }
+
+        auto frames_in_flight(ui32 count) -> gpu_profiler_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        /* @brief Zones recorded per frame, later ones only get their debug label */
+        auto max_zones(ui32 count) -> gpu_profiler_builder_t&
+        {
+            m_max_zones = count;
+            return *this;
+        }
+
+        /* @brief Family of the queue `gpu_profiler_t::zone(cmd_buffer_t, name)` records for */
+        auto queue_family(ui32 qf_index) -> gpu_profiler_builder_t&
+        {
+            m_default_qf = qf_index;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<gpu_profiler_t>>;
+
+    private:
+        weak<device_t> m_device           = nullptr;
+        weak<gpu_t>    m_gpu              = nullptr;
+        ui32           m_frames_in_flight = 2;
+        ui32           m_max_zones        = 64;
+        ui32           m_default_qf       = 0;
+    };
+} // namespace orb::vk
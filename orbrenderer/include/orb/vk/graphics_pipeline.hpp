@@ -1,5 +1,6 @@
 #pragma once
 
+#include "orb/profiler.hpp"
 #include "orb/vk/device.hpp"
 #include "orb/vk/render_pass.hpp"
 #include "orb/vk/shaders.hpp"
@@ -527,19 +528,19 @@ namespace orb::vk
         {
             if (desc_set_layout)
             {
-                vkDestroyDescriptorSetLayout(device, desc_set_layout, nullptr);
+                vkDestroyDescriptorSetLayout(device, desc_set_layout, host_callbacks(host_scope::descriptors));
                 desc_set_layout = nullptr;
             }
 
             if (layout)
             {
-                vkDestroyPipelineLayout(device, layout, nullptr);
+                vkDestroyPipelineLayout(device, layout, host_callbacks(host_scope::pipelines));
                 layout = nullptr;
             }
 
             if (handle)
             {
-                vkDestroyPipeline(device, handle, nullptr);
+                vkDestroyPipeline(device, handle, host_callbacks(host_scope::pipelines));
                 handle = nullptr;
             }
         }
@@ -680,6 +681,8 @@ namespace orb::vk
 
         [[nodiscard]] auto build() -> result<box<graphics_pipeline_t>>
         {
+            ORB_PROFILE_ZONE("graphics_pipeline_builder_t::build");
+
             auto pipeline    = make_box<graphics_pipeline_t>();
             pipeline->device = m_device->handle;
 
@@ -688,7 +691,7 @@ namespace orb::vk
 
             auto desc_set_layout_create_res = vkCreateDescriptorSetLayout(m_device->handle,
                                                                           &m_desc_set_layout.m_create_info,
-                                                                          nullptr,
+                                                                          host_callbacks(host_scope::descriptors),
                                                                           &pipeline->desc_set_layout);
 
             if (desc_set_layout_create_res != vkres::ok)
@@ -702,7 +705,7 @@ namespace orb::vk
 
             auto pipeline_layout_create_res = vkCreatePipelineLayout(m_device->handle,
                                                                      &m_pipeline_layout.m_create_info,
-                                                                     nullptr,
+                                                                     host_callbacks(host_scope::pipelines),
                                                                      &pipeline->layout);
             if (pipeline_layout_create_res != vkres::ok)
             {
@@ -746,7 +749,7 @@ namespace orb::vk
                                                                  nullptr,
                                                                  1,
                                                                  &m_create_info,
-                                                                 nullptr,
+                                                                 host_callbacks(host_scope::pipelines),
                                                                  &pipeline->handle);
 
             if (pipeline_create_res != vkres::ok)
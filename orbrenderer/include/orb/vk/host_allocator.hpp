@@ -0,0 +1,76 @@
+#pragma once
+
+#include "orb/vk/core.hpp"
+
+#include <array>
+
+namespace orb::vk
+{
+    /* @brief Library side categories of Vulkan host allocations
+     *
+     * Each scope gets its own VkAllocationCallbacks, so the counters tell which kind of object
+     * the driver allocated memory for, independently of the VkSystemAllocationScope it reports.
+     */
+    enum class host_scope : ui8
+    {
+        instance,
+        device,
+        allocator,
+        pipelines,
+        descriptors,
+        commands,
+        sync,
+        resources,
+        count,
+    };
+
+    [[nodiscard]] auto host_scope_name(host_scope scope) -> const char*;
+
+    struct host_scope_stats_t
+    {
+        ui64 allocations    = 0;
+        ui64 reallocations  = 0;
+        ui64 frees          = 0;
+        ui64 pooled         = 0; // allocations served by a size class pool
+        ui64 live_bytes     = 0;
+        ui64 peak_bytes     = 0;
+        ui64 total_bytes    = 0;
+        ui64 internal_bytes = 0; // reported through pfnInternalAllocation
+    };
+
+    struct host_allocation_report_t
+    {
+        std::array<host_scope_stats_t, static_cast<size_t>(host_scope::count)> scopes {};
+
+        ui64 pool_chunks      = 0;
+        ui64 pool_chunk_bytes = 0;
+
+        [[nodiscard]] auto operator[](host_scope scope) const -> const host_scope_stats_t&
+        {
+            return scopes[static_cast<size_t>(scope)];
+        }
+
+        void print() const;
+    };
+
+    /* @brief Tracking VkAllocationCallbacks shared by the whole library
+     *
+     * Disabled by default, in which case `host_callbacks` returns nullptr and the driver uses its
+     * own allocator. Once enabled, small allocations (up to 512 bytes with an alignment of at most
+     * 16) are served from size class free lists carved out of 64 KiB chunks, larger ones go to
+     * the system allocator. Chunks are never returned to the system.
+     *
+     * Create and destroy calls must use the same callbacks, so tracking has to be enabled before
+     * the instance is created (see `instance_builder_t::track_host_allocations`) and stays on for
+     * the lifetime of the process.
+     */
+    namespace host_allocator
+    {
+        void               enable();
+        [[nodiscard]] auto enabled() -> bool;
+        [[nodiscard]] auto report() -> host_allocation_report_t;
+    } // namespace host_allocator
+
+    /* @brief Callbacks to pass as `pAllocator` for objects of the given scope, nullptr if disabled */
+    [[nodiscard]] auto host_callbacks(host_scope scope) -> const VkAllocationCallbacks*;
+} // namespace orb::vk
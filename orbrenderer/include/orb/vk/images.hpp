@@ -17,6 +17,9 @@ namespace orb::vk
 
         VmaAllocator allocator = nullptr;
 
+        // Set when transient images actually got lazily allocated memory
+        bool lazily_allocated = false;
+
         images_t() = default;
 
         images_t(const images_t&)                    = delete;
@@ -26,9 +29,10 @@ namespace orb::vk
         {
             destroy();
 
-            handles     = std::move(other.handles);
-            allocations = std::move(other.allocations);
-            allocator   = other.allocator;
+            handles          = std::move(other.handles);
+            allocations      = std::move(other.allocations);
+            allocator        = other.allocator;
+            lazily_allocated = other.lazily_allocated;
 
             other.allocator = nullptr;
         }
@@ -37,9 +41,10 @@ namespace orb::vk
         {
             destroy();
 
-            handles     = std::move(other.handles);
-            allocations = std::move(other.allocations);
-            allocator   = other.allocator;
+            handles          = std::move(other.handles);
+            allocations      = std::move(other.allocations);
+            allocator        = other.allocator;
+            lazily_allocated = other.lazily_allocated;
 
             other.allocator = nullptr;
 
@@ -141,9 +146,30 @@ namespace orb::vk
             return *this;
         }
 
+        /* @brief Attachment whose content never leaves the render pass (depth, MSAA color...)
+         *
+         * Adds the transient attachment usage and asks for lazily allocated memory, which tiled
+         * GPUs may never back at all. Falls back to regular device memory when no lazily
+         * allocated memory type exists. The image must only be used as an attachment.
+         */
+        auto transient(bool enable = true) -> images_builder_t&
+        {
+            m_transient = enable;
+            return *this;
+        }
+
+        /* @brief Create info of a single image, e.g. for `aliased_images_builder_t` */
+        [[nodiscard]] auto info() const -> VkImageCreateInfo
+        {
+            auto info = m_info;
+            if (m_transient) info.usage |= vkflag(image_usage_flag::transient_attachment);
+            return info;
+        }
+
     private:
         VmaAllocator m_allocator = nullptr;
         size_t       m_count     = 1;
+        bool         m_transient = false;
 
         VkImageCreateInfo       m_info       = vk::structs::create::image();
         VmaAllocationCreateInfo m_alloc_info = vk::structs::create::allocation();
@@ -154,6 +180,23 @@ namespace orb::vk
                            image_layout prev,
                            image_layout next);
 
+    /* @brief Transitions a subresource range (mip levels and array layers) of an image
+     *
+     * The pipeline stages and access masks are derived from the layouts: a transfer_dst_optimal
+     * layout waits on transfer writes, shader_read_only_optimal on shader reads, and so on.
+     * Stages the recording queue family lacks (`queue_flags`) are left out, e.g. the fragment
+     * stages of a final shader_read_only_optimal transition recorded on a transfer queue.
+     */
+    void transition_layout(VkCommandBuffer                cmd,
+                           VkImage                        img,
+                           image_layout                   prev,
+                           image_layout                   next,
+                           const VkImageSubresourceRange& range,
+                           VkQueueFlags                   queue_flags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+
+    /* @brief Capabilities of a queue family, 0 for an invalid index */
+    [[nodiscard]] auto queue_family_flags(VkPhysicalDevice gpu, ui32 qf_index) -> VkQueueFlags;
+
     void copy_img(VkCommandBuffer cmd,
                   VkImage         src,
                   VkImage         dst,
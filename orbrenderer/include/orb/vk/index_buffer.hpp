@@ -1,5 +1,6 @@
 #pragma once
 
+#include "orb/vk/buffer_upload.hpp"
 #include "orb/vk/device.hpp"
 
 #include <orb/result.hpp>
@@ -17,10 +18,12 @@ namespace orb::vk
             : allocator(other.allocator),
               allocation(other.allocation),
               buffer(other.buffer),
-              size(other.size)
+              size(other.size),
+              mapped(other.mapped)
         {
             other.buffer     = nullptr;
             other.allocation = nullptr;
+            other.mapped     = nullptr;
         }
 
         auto operator=(index_buffer_t&& other) noexcept -> index_buffer_t&
@@ -29,9 +32,11 @@ namespace orb::vk
             allocation = other.allocation;
             buffer     = other.buffer;
             size       = other.size;
+            mapped     = other.mapped;
 
             other.allocation = nullptr;
             other.buffer     = nullptr;
+            other.mapped     = nullptr;
 
             return *this;
         }
@@ -40,6 +45,7 @@ namespace orb::vk
         VmaAllocation allocation {};
         VkBuffer      buffer {};
         ui64          size {};
+        void*         mapped {}; // Set when the buffer lives in host visible VRAM
         size_t        count {};
         VkIndexType   index_type {};
 
@@ -56,8 +62,14 @@ namespace orb::vk
 
                 allocation = nullptr;
                 buffer     = nullptr;
+                mapped     = nullptr;
             }
         }
+
+        [[nodiscard]] auto host_visible() const -> bool
+        {
+            return mapped != nullptr;
+        }
     };
 
     class index_buffer_builder_t
@@ -126,18 +138,41 @@ namespace orb::vk
             return *this;
         }
 
+        /* @brief Places the buffer in host visible VRAM (ReBAR / UMA) when the GPU has budget for it
+         *
+         * The resulting buffer exposes a `mapped` pointer that `buffer_upload_helper_t` writes to
+         * directly. When no such memory is available, the buffer is allocated as usual and is
+         * filled through a staging copy.
+         */
+        auto prefer_direct_upload(bool enable = true) -> index_buffer_builder_t&
+        {
+            m_prefer_direct_upload = enable;
+            return *this;
+        }
+
         [[nodiscard]] auto build() -> result<index_buffer_t>
         {
             index_buffer_t buffer {};
             buffer.count     = m_count;
             buffer.allocator = m_device->allocator;
 
+            // Either path may end up writing through a transfer
+            m_create_info.usage |= vkflag(buffer_usage_flag::transfer_destination);
+
+            auto alloc_info = m_alloc_info;
+            if (m_prefer_direct_upload && has_host_visible_vram(m_device->allocator, m_create_info.size))
+            {
+                alloc_info.flags |= direct_upload_memory_flags();
+            }
+
+            VmaAllocationInfo info {};
+
             auto res = vmaCreateBuffer(m_device->allocator,
                                        &m_create_info,
-                                       &m_alloc_info,
+                                       &alloc_info,
                                        &buffer.buffer,
                                        &buffer.allocation,
-                                       nullptr);
+                                       &info);
 
             buffer.size = m_create_info.size;
 
@@ -146,6 +181,8 @@ namespace orb::vk
                 return error_t { "Failed to create index buffer: {}", vkres::get_repr(res) };
             }
 
+            buffer.mapped = mapped_if_host_visible(m_device->allocator, buffer.allocation, info);
+
             return buffer;
         }
 
@@ -153,6 +190,7 @@ namespace orb::vk
         weak<device_t>          m_device;
         VkBufferCreateInfo      m_create_info {};
         VmaAllocationCreateInfo m_alloc_info {};
+        bool                    m_prefer_direct_upload = false;
         VkIndexType             m_index_type {};
         size_t                  m_count {};
     };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "orb/vk/core.hpp"
+#include "orb/vk/host_allocator.hpp"
 
 #include <orb/box.hpp>
 #include <orb/result.hpp>
@@ -55,13 +56,13 @@ namespace orb::vk
             if (debug_utils)
             {
                 auto destroy_deb_callback_fn = proc_addresses::destroy_deb_utils(handle);
-                destroy_deb_callback_fn(handle, debug_utils, nullptr);
+                destroy_deb_callback_fn(handle, debug_utils, host_callbacks(host_scope::instance));
                 debug_utils = nullptr;
             }
 
             if (handle)
             {
-                vkDestroyInstance(handle, nullptr);
+                vkDestroyInstance(handle, host_callbacks(host_scope::instance));
                 handle = nullptr;
             }
         }
@@ -93,6 +94,16 @@ namespace orb::vk
             return *this;
         }
 
+        /* @brief Routes every Vulkan host allocation of the library through `host_callbacks`
+         *
+         * Must be called before the first instance is built, see `host_allocator::report()`.
+         */
+        auto track_host_allocations(bool enable) -> instance_builder_t&
+        {
+            if (enable) host_allocator::enable();
+            return *this;
+        }
+
         auto debug_layer(const char* layer) -> instance_builder_t&
         {
             val_layers.push_back(layer);
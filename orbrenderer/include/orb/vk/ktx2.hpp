@@ -0,0 +1,123 @@
+#pragma once
+
+#include "orb/mapped_file.hpp"
+#include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/texture.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace orb::vk
+{
+    struct ktx2_level_t
+    {
+        ui64 offset            = 0;
+        ui64 length            = 0;
+        ui64 uncompressed_size = 0;
+    };
+
+    /* @brief KTX2 container backed by a memory mapping
+     *
+     * Only the header and the level index are parsed. Level data stays in the mapping and is
+     * accessed through `level_data`, without copies. `parse` reads a container that lives in
+     * memory owned by someone else, such as a blob of a mapped `.orbpak` archive.
+     */
+    struct ktx2_file_t
+    {
+        mapped_file_t              file;
+        std::span<const std::byte> bytes;
+
+        VkFormat format           = VK_FORMAT_UNDEFINED;
+        ui32     width            = 0;
+        ui32     height           = 0;
+        ui32     depth            = 0;
+        ui32     layers           = 0;
+        ui32     faces            = 1;
+        ui32     supercompression = 0;
+
+        // Texel block of the format, from the data format descriptor
+        ui32 block_width  = 1;
+        ui32 block_height = 1;
+        ui32 block_bytes  = 0;
+
+        std::vector<ktx2_level_t> levels;
+
+        [[nodiscard]] static auto open(const std::filesystem::path& file_path) -> result<ktx2_file_t>;
+        [[nodiscard]] static auto parse(std::span<const std::byte> bytes) -> result<ktx2_file_t>;
+
+        /* @brief Bytes of a mip level, all layers and faces included */
+        [[nodiscard]] auto level_data(ui32 level) const -> std::span<const std::byte>
+        {
+            const auto& l = levels.at(level);
+            if (l.offset > bytes.size() || l.length > bytes.size() - l.offset) return {};
+            return bytes.subspan(l.offset, l.length);
+        }
+
+        [[nodiscard]] auto level_width(ui32 level) const -> ui32 { return std::max(width >> level, 1u); }
+        [[nodiscard]] auto level_height(ui32 level) const -> ui32 { return std::max(height >> level, 1u); }
+
+        /* @brief Number of array layers of the Vulkan image: layers times faces */
+        [[nodiscard]] auto image_layers() const -> ui32 { return std::max(layers, 1u) * faces; }
+
+        /* @brief Bytes a level must hold, all layers and faces included */
+        [[nodiscard]] auto level_size(ui32 level) const -> ui64
+        {
+            const ui64 blocks_x = (level_width(level) + block_width - 1) / block_width;
+            const ui64 blocks_y = (level_height(level) + block_height - 1) / block_height;
+            return blocks_x * blocks_y * block_bytes * image_layers();
+        }
+    };
+
+    /* @brief Creates a texture from a KTX2 file
+     *
+     * When the GPU can sample the file's format, the mip levels are copied from the mapping
+     * straight into a staging buffer and uploaded as is. Otherwise, BC1-BC5, BC7 and ASTC LDR data
+     * is decoded to RGBA8 directly into the staging buffer (see `transcode_to_rgba8`).
+     */
+    class ktx2_texture_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device, const ktx2_file_t& file)
+            -> result<ktx2_texture_builder_t>;
+
+        [[nodiscard]] auto build() -> result<texture_t>;
+
+        auto staging(weak<cmd_pool_t> pool, VkQueue queue) -> ktx2_texture_builder_t&
+        {
+            m_pool  = pool;
+            m_queue = queue;
+            return *this;
+        }
+
+        auto final_layout(image_layout layout) -> ktx2_texture_builder_t&
+        {
+            m_final_layout = layout;
+            return *this;
+        }
+
+        /* @brief Always decode to RGBA8, even if the format is supported (for testing the fallback) */
+        auto force_transcode(bool enable) -> ktx2_texture_builder_t&
+        {
+            m_force_transcode = enable;
+            return *this;
+        }
+
+    private:
+        [[nodiscard]] auto format_supported() const -> bool;
+        [[nodiscard]] auto upload(cmd_buffer_t& cmd) -> result<texture_t>;
+
+        weak<device_t>     m_device = nullptr;
+        weak<cmd_pool_t>   m_pool   = nullptr;
+        VkQueue            m_queue  = nullptr;
+        const ktx2_file_t* m_file   = nullptr;
+
+        image_layout m_final_layout    = image_layout::shader_read_only_optimal;
+        bool         m_force_transcode = false;
+    };
+} // namespace orb::vk
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "orb/jobs.hpp"
+#include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/frame_context.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Render pass and subpass the recorded secondary buffers will be executed in */
+    struct secondary_target_t
+    {
+        VkRenderPass  render_pass = nullptr;
+        ui32          subpass     = 0;
+        VkFramebuffer framebuffer = nullptr; // optional, may let the driver optimize the buffers
+    };
+
+    /* @brief Records the items [begin, end) of the work into `cmd` */
+    using record_fn_t = std::function<void(cmd_buffer_t& cmd, ui32 begin, ui32 end)>;
+
+    /* @brief Splits the recording of a render pass across the threads of a `job_system_t`
+     *
+     * Every worker owns one transient command pool per frame in flight, picked with
+     * `job_system_t::thread_slot`, so workers never synchronize on a pool. Threads outside the job
+     * system, which run chunks from `job_system_t::wait`, share one more pool set behind a mutex.
+     * `record` cuts the work in contiguous chunks, one secondary buffer per chunk, and returns the
+     * buffers in chunk order: executing them in that order gives the same result as recording
+     * everything inline. The calling thread records the first chunk, then runs jobs until the
+     * others are recorded. One thread calls `record` at a time.
+     *
+     *   recorder->begin_frame(slot).unwrap();
+     *   pass->begin(cmd.handle, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+     *   cmd.execute(recorder->record({ pass->handle, 0, fb }, draw_count, draw_fn).unwrap());
+     *   pass->end(cmd.handle);
+     */
+    class parallel_recorder_t
+    {
+    public:
+        parallel_recorder_t() = default;
+
+        parallel_recorder_t(const parallel_recorder_t&)                    = delete;
+        auto operator=(const parallel_recorder_t&) -> parallel_recorder_t& = delete;
+
+        parallel_recorder_t(parallel_recorder_t&&)                    = delete;
+        auto operator=(parallel_recorder_t&&) -> parallel_recorder_t& = delete;
+
+        /* @brief Resets the pools of `slot`, the caller guarantees its previous work completed */
+        [[nodiscard]] auto begin_frame(ui32 slot) -> result<void>;
+
+        /* @brief Records `count` items into secondary buffers, blocks until all are recorded
+         *
+         * `fn` is called concurrently from several threads. The returned span is valid until
+         * the next call to `record`.
+         */
+        [[nodiscard]] auto record(const secondary_target_t& target, ui32 count, const record_fn_t& fn)
+            -> result<std::span<const VkCommandBuffer>>;
+
+        /* @brief Number of recording threads, the calling thread included */
+        [[nodiscard]] auto threads() const -> ui32 { return m_pools.size(); }
+
+    private:
+        friend class parallel_recorder_builder_t;
+
+        void record_chunk(ui32 index);
+
+        weak<job_system_t> m_jobs = nullptr;
+
+        // m_pools[thread slot][frame slot]
+        std::vector<std::vector<recycling_cmd_pool_t>> m_pools;
+        ui32                                           m_slot      = 0;
+        ui32                                           m_min_batch = 1;
+
+        // Current job, written before the chunks are scheduled
+        const record_fn_t*             m_fn = nullptr;
+        VkCommandBufferInheritanceInfo m_inheritance {};
+        ui32                           m_count       = 0;
+        ui32                           m_chunk_count = 0;
+        std::vector<VkCommandBuffer>   m_cmds;
+
+        std::mutex             m_mutex; // guards the error
+        std::optional<error_t> m_error;
+
+        std::mutex m_external_mutex; // held while a thread outside the job system records
+    };
+
+    class parallel_recorder_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device, ui32 qf_index, weak<job_system_t> jobs)
+            -> result<parallel_recorder_builder_t>
+        {
+            parallel_recorder_builder_t b;
+            b.m_device   = device;
+            b.m_qf_index = qf_index;
+            b.m_jobs     = jobs;
+            return b;
+        }
+
+        auto frames_in_flight(ui32 count) -> parallel_recorder_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        /* @brief Smallest number of items worth a secondary buffer of their own */
+        auto min_batch(ui32 count) -> parallel_recorder_builder_t&
+        {
+            m_min_batch = count;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<parallel_recorder_t>>;
+
+    private:
+        weak<device_t>     m_device           = nullptr;
+        ui32               m_qf_index         = 0;
+        weak<job_system_t> m_jobs             = nullptr;
+        ui32               m_frames_in_flight = 2;
+        ui32               m_min_batch        = 256;
+    };
+} // namespace orb::vk
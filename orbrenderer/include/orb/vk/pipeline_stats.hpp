@@ -0,0 +1,245 @@
+#pragma once
+
+#include "orb/vk/device.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Counters of a pipeline statistics query, in the order Vulkan writes them */
+    enum class pipeline_counter : ui32
+    {
+        vertex_invocations,
+        clipping_invocations,
+        clipping_primitives,
+        fragment_invocations,
+        compute_invocations,
+    };
+
+    inline constexpr ui32 pipeline_counter_count = 5;
+
+    [[nodiscard]] auto pipeline_counter_name(pipeline_counter counter) -> const char*;
+
+    struct pipeline_counters_t
+    {
+        std::array<ui64, pipeline_counter_count> values {};
+
+        [[nodiscard]] auto operator[](pipeline_counter c) const -> ui64
+        {
+            return values[std::to_underlying(c)];
+        }
+
+        auto operator+=(const pipeline_counters_t& other) -> pipeline_counters_t&
+        {
+            for (ui32 i = 0; i < pipeline_counter_count; ++i)
+            {
+                values[i] += other.values[i];
+            }
+
+            return *this;
+        }
+    };
+
+    /* @brief Work of every query sharing a key, e.g. all draws of a pipeline */
+    struct pipeline_stats_entry_t
+    {
+        ui64                key = 0;
+        std::string         name;
+        ui64                frames = 0;
+        pipeline_counters_t last;  // summed over the last frame collected
+        pipeline_counters_t total; // summed over every frame collected
+
+        [[nodiscard]] auto average(pipeline_counter c) const -> ui64
+        {
+            return frames == 0 ? 0 : total[c] / frames;
+        }
+    };
+
+    class pipeline_stats_t;
+
+    /* @brief Pipeline statistics query, ended when destroyed */
+    class pipeline_query_t
+    {
+    public:
+        pipeline_query_t() = default;
+
+        pipeline_query_t(const pipeline_query_t&)                    = delete;
+        auto operator=(const pipeline_query_t&) -> pipeline_query_t& = delete;
+
+        pipeline_query_t(pipeline_query_t&& other) noexcept
+            : m_cmd(std::exchange(other.m_cmd, nullptr))
+            , m_pool(other.m_pool)
+            , m_query(other.m_query)
+        {
+        }
+
+        auto operator=(pipeline_query_t&& other) noexcept -> pipeline_query_t&
+        {
+            end();
+
+            m_cmd   = std::exchange(other.m_cmd, nullptr);
+            m_pool  = other.m_pool;
+            m_query = other.m_query;
+
+            return *this;
+        }
+
+        ~pipeline_query_t()
+        {
+            end();
+        }
+
+        void end()
+        {
+            if (!m_cmd) return;
+
+            vkCmdEndQuery(m_cmd, m_pool, m_query);
+            m_cmd = nullptr;
+        }
+
+    private:
+        friend class pipeline_stats_t;
+
+        VkCommandBuffer m_cmd   = nullptr;
+        VkQueryPool     m_pool  = nullptr;
+        ui32            m_query = 0;
+    };
+
+    /* @brief Counts the shading work of scoped draws and dispatches, per pipeline
+     *
+     * Works like `gpu_profiler_t`: one query pool per frame in flight, `begin_frame` collects
+     * what the slot recorded `frames_in_flight` frames ago without waiting on the GPU. Queries
+     * carry a key, typically the hash of the pipeline or of the material, and are summed per key
+     * into the stats table.
+     *
+     *   stats->begin_frame(frame).unwrap();
+     *   {
+     *       auto q = stats->query(cmd.handle, material.hash, "terrain");
+     *       vkCmdDrawIndexed(...);
+     *   }
+     *   for (const auto* e : stats->ranked(pipeline_counter::fragment_invocations)) ...
+     *
+     * Queries must not nest, and must start and end in the same subpass or both outside a render
+     * pass. Command buffers recording them must come from a pool of a graphics family, also for
+     * dispatches. Requires `features().pipelineStatisticsQuery`, lavapipe exposes it as well.
+     */
+    class pipeline_stats_t
+    {
+    public:
+        pipeline_stats_t() = default;
+
+        pipeline_stats_t(const pipeline_stats_t&)                    = delete;
+        auto operator=(const pipeline_stats_t&) -> pipeline_stats_t& = delete;
+
+        pipeline_stats_t(pipeline_stats_t&&)                    = delete;
+        auto operator=(pipeline_stats_t&&) -> pipeline_stats_t& = delete;
+
+        ~pipeline_stats_t()
+        {
+            destroy();
+        }
+
+        void destroy();
+
+        /* @brief Collects the queries of the frame that last used `slot` and resets them
+         *
+         * Call it after the slot's fence was waited on. Queries not available yet are dropped.
+         */
+        [[nodiscard]] auto begin_frame(ui32 slot) -> result<void>;
+
+        /* @brief Resets the queries of the frame from `cmd`, outside a render pass
+         *
+         * Only needed without `device_builder_t::host_query_reset`, before the first query of the
+         * frame in submission order. Does nothing when the queries were reset on the host.
+         */
+        void record_reset(VkCommandBuffer cmd);
+
+        /* @brief Starts counting the commands recorded in `cmd`, under `key`
+         *
+         * `name` is kept from the first query of a key. Past `max_queries` in a frame, returns
+         * an inactive query.
+         */
+        [[nodiscard]] auto query(VkCommandBuffer cmd, ui64 key, std::string_view name) -> pipeline_query_t;
+
+        /* @brief Keyed on the pipeline handle */
+        [[nodiscard]] auto query(VkCommandBuffer cmd, VkPipeline pipeline, std::string_view name) -> pipeline_query_t
+        {
+            return query(cmd, reinterpret_cast<ui64>(pipeline), name); // NOLINT
+        }
+
+        [[nodiscard]] auto entries() const -> std::span<const pipeline_stats_entry_t> { return m_entries; }
+
+        /* @brief Entries sorted by decreasing average of `counter` */
+        [[nodiscard]] auto ranked(pipeline_counter counter) const -> std::vector<const pipeline_stats_entry_t*>;
+
+        /* @brief Prints the `count` most expensive entries by `counter` */
+        void describe(pipeline_counter counter = pipeline_counter::fragment_invocations, ui32 count = 10) const;
+
+    private:
+        friend class pipeline_stats_builder_t;
+
+        struct recorded_t
+        {
+            ui32 entry;
+            ui32 query;
+        };
+
+        struct frame_t
+        {
+            VkQueryPool             pool        = nullptr;
+            ui32                    used        = 0;
+            bool                    needs_reset = true;
+            std::vector<recorded_t> recorded;
+        };
+
+        weak<device_t>       m_device = nullptr;
+        std::vector<frame_t> m_frames;
+        std::vector<ui64>    m_results;
+
+        std::vector<pipeline_stats_entry_t> m_entries;
+        std::unordered_map<ui64, ui32>      m_entry_ids;
+
+        frame_t* m_current     = nullptr;
+        ui32     m_max_queries = 0;
+        bool     m_host_reset  = false;
+    };
+
+    class pipeline_stats_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<pipeline_stats_builder_t>
+        {
+            pipeline_stats_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        auto frames_in_flight(ui32 count) -> pipeline_stats_builder_t&
+        {
+            m_frames_in_flight = count;
+            return *this;
+        }
+
+        auto max_queries(ui32 count) -> pipeline_stats_builder_t&
+        {
+            m_max_queries = count;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<pipeline_stats_t>>;
+
+    private:
+        weak<device_t> m_device           = nullptr;
+        ui32           m_frames_in_flight = 2;
+        ui32           m_max_queries      = 256;
+    };
+} // namespace orb::vk
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "orb/vk/attachments.hpp"
+#include "orb/vk/host_allocator.hpp"
 #include "orb/vk/subpasses.hpp"
 
 #include <orb/box.hpp>
@@ -51,7 +52,7 @@ namespace orb::vk
         void destroy()
         {
             if (!handle) return;
-            vkDestroyRenderPass(device, handle, nullptr);
+            vkDestroyRenderPass(device, handle, host_callbacks(host_scope::pipelines));
             handle = nullptr;
         }
 
@@ -60,9 +61,15 @@ namespace orb::vk
             begin_info.pClearValues = &clear_color;
         }
 
-        void begin(VkCommandBuffer& cmd)
+        /* @brief Use VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS to execute secondary buffers */
+        void begin(VkCommandBuffer& cmd, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE)
         {
-            vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+            vkCmdBeginRenderPass(cmd, &begin_info, contents);
+        }
+
+        void next_subpass(VkCommandBuffer& cmd, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE)
+        {
+            vkCmdNextSubpass(cmd, contents);
         }
 
         void end(VkCommandBuffer& cmd)
@@ -96,7 +103,7 @@ namespace orb::vk
             info.dependencyCount        = subpasses.dependencies.size();
             info.pDependencies          = subpasses.dependencies.data();
 
-            if (auto res = vkCreateRenderPass(m_device, &info, nullptr, &pass->handle); res != vkres::ok)
+            if (auto res = vkCreateRenderPass(m_device, &info, host_callbacks(host_scope::pipelines), &pass->handle); res != vkres::ok)
             {
                 return error_t { "Failed to create render pass: {}", vkres::get_repr(res) };
             }
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "orb/vk/device.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief How a pass is about to use a resource
+     *
+     * Each usage maps to the pipeline stages, access masks and, for images, the layout it
+     * implies (see `usage_info`). Buffers ignore the layout.
+     */
+    enum class resource_usage : ui32
+    {
+        undefined,                // previous content may be discarded
+        indirect_buffer,          // vkCmdDraw*Indirect / vkCmdDispatchIndirect arguments
+        index_buffer,
+        vertex_buffer,
+        uniform_buffer,           // read from any graphics or compute shader
+        vertex_shader_read,       // sampled image or storage buffer read in vertex shaders
+        fragment_shader_read,     // sampled image or storage buffer read in fragment shaders
+        compute_shader_read,      // sampled image or storage buffer read in compute shaders
+        compute_storage_read,     // storage image read in compute shaders
+        compute_storage_write,    // storage image or buffer written in compute shaders
+        compute_storage_read_write,
+        color_attachment_write,
+        color_attachment_read_write,
+        depth_attachment_write,
+        depth_attachment_read,
+        transfer_src,
+        transfer_dst,
+        host_read,
+        host_write,
+        present,
+        general, // any access from any stage, last resort
+    };
+
+    struct usage_info_t
+    {
+        VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2        access = VK_ACCESS_2_NONE;
+        VkImageLayout         layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        bool                  writes = false;
+    };
+
+    [[nodiscard]] auto usage_info(resource_usage usage) -> usage_info_t;
+
+    /* @brief Tracks the state of images and buffers and emits the barriers between usages
+     *
+     * Every image subresource (mip level and array layer) and every buffer remembers its
+     * layout, the stages that last wrote it, and the stages that read it since. Declaring the
+     * next usage with `use` queues only what that transition needs:
+     *
+     *   - nothing for a read after a read in the same layout, or for the first use of a resource
+     *   - an execution dependency for a write after reads
+     *   - a memory dependency for anything after a write, or to make a write visible to new stages
+     *   - an image barrier when the layout changes
+     *
+     * Memory dependencies without layout change are merged into a single global memory barrier,
+     * image barriers over adjacent subresources into one range. `flush` records everything
+     * queued in one vkCmdPipelineBarrier2, or vkCmdPipelineBarrier without synchronization2.
+     *
+     * Usages must be declared in the order the commands are recorded. Flush after declaring
+     * the usages of a pass and before recording it, and declare each subresource at most once
+     * between two flushes. Queue family ownership transfers are not handled.
+     *
+     *   tracker.use(img, resource_usage::transfer_dst);
+     *   tracker.use(staging, resource_usage::transfer_src);
+     *   tracker.flush(cmd);
+     *   vkCmdCopyBufferToImage(...);
+     *   tracker.use(img, resource_usage::fragment_shader_read);
+     *   tracker.flush(cmd);
+     */
+    class resource_tracker_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<resource_tracker_t>
+        {
+            resource_tracker_t t;
+            t.m_use_sync2 = device->features_13.synchronization2 == VK_TRUE;
+            return t;
+        }
+
+        /* @brief Starts tracking an image, all its subresources in `layout` */
+        void track_image(VkImage           image,
+                         image_aspect_flag aspect = image_aspect_flag::color,
+                         ui32              levels = 1,
+                         ui32              layers = 1,
+                         VkImageLayout     layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+        void track_buffer(VkBuffer buffer);
+
+        void forget(VkImage image) { m_images.erase(image); }
+        void forget(VkBuffer buffer) { m_buffers.erase(buffer); }
+
+        /* @brief Declares the next usage of every subresource of `image` */
+        void use(VkImage image, resource_usage usage);
+
+        /* @brief Declares the next usage of a subresource range of `image` */
+        void use(VkImage image, resource_usage usage, const VkImageSubresourceRange& range);
+
+        void use(VkBuffer buffer, resource_usage usage);
+
+        /* @brief The image was last accessed outside of the tracked commands
+         *
+         * Typically a swapchain image whose acquire semaphore is waited for at `stages`: the next
+         * barrier on the image chains on `stages` instead of racing ahead of the wait.
+         */
+        void wait_external(VkImage image, VkPipelineStageFlags2 stages);
+        void wait_external(VkBuffer buffer, VkPipelineStageFlags2 stages);
+
+        [[nodiscard]] auto tracked(VkImage image) const -> bool { return m_images.contains(image); }
+        [[nodiscard]] auto tracked(VkBuffer buffer) const -> bool { return m_buffers.contains(buffer); }
+
+        /* @brief Layout the subresource will be in once the queued barriers are recorded */
+        [[nodiscard]] auto layout(VkImage image, ui32 level = 0, ui32 layer = 0) const -> VkImageLayout;
+
+        /* @brief Records the queued barriers, if any */
+        void flush(VkCommandBuffer cmd);
+
+        [[nodiscard]] auto pending() const -> bool
+        {
+            return m_global_pending || !m_image_barriers.empty();
+        }
+
+        /* @brief Number of barrier commands recorded so far, and of image barriers they held */
+        [[nodiscard]] auto barrier_calls() const -> ui64 { return m_barrier_calls; }
+        [[nodiscard]] auto image_barriers() const -> ui64 { return m_image_barrier_count; }
+
+    private:
+        struct state_t
+        {
+            VkImageLayout         layout         = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags2 write_stages   = VK_PIPELINE_STAGE_2_NONE; // last write or layout transition
+            VkAccessFlags2        write_access   = VK_ACCESS_2_NONE;
+            VkPipelineStageFlags2 read_stages    = VK_PIPELINE_STAGE_2_NONE; // reads since the last write
+            VkPipelineStageFlags2 visible_stages = VK_PIPELINE_STAGE_2_NONE; // where the last write is visible
+            VkAccessFlags2        visible_access = VK_ACCESS_2_NONE;
+        };
+
+        struct image_state_t
+        {
+            image_aspect_flag    aspect = image_aspect_flag::color;
+            ui32                 levels = 1;
+            ui32                 layers = 1;
+            std::vector<state_t> subresources; // layer major
+        };
+
+        struct transition_t
+        {
+            VkPipelineStageFlags2 src_stages = VK_PIPELINE_STAGE_2_NONE;
+            VkAccessFlags2        src_access = VK_ACCESS_2_NONE;
+            VkPipelineStageFlags2 dst_stages = VK_PIPELINE_STAGE_2_NONE;
+            VkAccessFlags2        dst_access = VK_ACCESS_2_NONE;
+            VkImageLayout         old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkImageLayout         new_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            bool                  needed     = false;
+
+            auto operator==(const transition_t&) const -> bool = default;
+        };
+
+        /* @brief Updates `state` for `next`, returns the dependency it needs */
+        [[nodiscard]] static auto transition(state_t& state, const usage_info_t& next, bool is_image) -> transition_t;
+
+        void queue_global(const transition_t& t);
+        void queue_image(VkImage image, image_aspect_flag aspect, const transition_t& t, ui32 level, ui32 level_count, ui32 layer);
+
+        [[nodiscard]] static auto empty_global() -> VkMemoryBarrier2
+        {
+            return { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        }
+
+        void flush_sync2(VkCommandBuffer cmd);
+        void flush_legacy(VkCommandBuffer cmd);
+
+        bool m_use_sync2 = false;
+
+        std::unordered_map<VkImage, image_state_t> m_images;
+        std::unordered_map<VkBuffer, state_t>      m_buffers;
+
+        VkMemoryBarrier2                   m_global         = empty_global();
+        bool                               m_global_pending = false;
+        std::vector<VkImageMemoryBarrier2> m_image_barriers;
+
+        // Legacy scratch storage
+        std::vector<VkImageMemoryBarrier> m_legacy_barriers;
+
+        ui64 m_barrier_calls       = 0;
+        ui64 m_image_barrier_count = 0;
+    };
+} // namespace orb::vk
@@ -90,7 +90,7 @@ namespace orb::vk
                     continue;
                 }
 
-                vkDestroySemaphore(device, semaphore, nullptr);
+                vkDestroySemaphore(device, semaphore, host_callbacks(host_scope::sync));
                 semaphore = nullptr;
             }
         }
@@ -161,7 +161,7 @@ namespace orb::vk
 
             for (auto& sem : objs.handles)
             {
-                if (auto res = vkCreateSemaphore(m_device->handle, &sem_info, nullptr, &sem); res != vkres::ok)
+                if (auto res = vkCreateSemaphore(m_device->handle, &sem_info, host_callbacks(host_scope::sync), &sem); res != vkres::ok)
                 {
                     return error_t { "Could not create semaphore: {}", vkres::get_repr(res) };
                 }
@@ -1,11 +1,13 @@
 #pragma once
 
+#include "orb/profiler.hpp"
 #include "orb/vk/device.hpp"
 
 #include <orb/box.hpp>
 #include <orb/files.hpp>
 #include <orb/result.hpp>
 
+#include <span>
 #include <string_view>
 
 namespace orb::vk
@@ -199,7 +201,7 @@ namespace orb::vk
         {
             if (!handle) return;
 
-            vkDestroyShaderModule(device, handle, nullptr);
+            vkDestroyShaderModule(device, handle, host_callbacks(host_scope::pipelines));
             handle = nullptr;
         }
     };
@@ -234,8 +236,30 @@ namespace orb::vk
             return *this;
         }
 
+        /* @brief Uses precompiled SPIR-V (e.g. a blob of a .orbpak archive) instead of GLSL
+         *
+         * The code is not copied and must outlive `build()`. No compiler is needed in this case.
+         */
+        auto spirv(std::span<const ui32> code) -> shader_module_builder_t&
+        {
+            m_spirv = code;
+            return *this;
+        }
+
         [[nodiscard]] auto build() -> result<shader_module_t>
         {
+            ORB_PROFILE_ZONE("shader_module_builder_t::build");
+
+            if (!m_spirv.empty())
+            {
+                return create_module(m_spirv);
+            }
+
+            if (!m_compiler)
+            {
+                return error_t { "Could not compile shader: no compiler given" };
+            }
+
             auto preprocess_res = m_compiler->preprocess_glsl(m_content,
                                                               vkenum(m_kind),
                                                               m_entry_point);
@@ -254,14 +278,21 @@ namespace orb::vk
                 return error_t { "Could not compile shader: {}", compile_res.GetErrorMessage() };
             }
 
+            return create_module({ reinterpret_cast<const ui32*>(compile_res.cbegin()),
+                                   static_cast<size_t>(compile_res.cend() - compile_res.cbegin()) });
+        }
+
+    private:
+        [[nodiscard]] auto create_module(std::span<const ui32> code) -> result<shader_module_t>
+        {
             shader_module_t module;
             module.device = m_device->handle;
 
             auto create_info     = structs::create::shader_module();
-            create_info.codeSize = (compile_res.cend() - compile_res.cbegin()) * sizeof(unsigned int);
-            create_info.pCode    = reinterpret_cast<const uint32_t*>(compile_res.cbegin());
+            create_info.codeSize = code.size_bytes();
+            create_info.pCode    = code.data();
 
-            if (auto res = vkCreateShaderModule(module.device, &create_info, nullptr, &module.handle); res != vkres::ok)
+            if (auto res = vkCreateShaderModule(module.device, &create_info, host_callbacks(host_scope::pipelines), &module.handle); res != vkres::ok)
             {
                 return error_t { "Could not create shader module: {}", vkres::get_repr(res) };
             }
@@ -269,12 +300,13 @@ namespace orb::vk
             return module;
         }
 
-    private:
         weak<device_t>         m_device   = nullptr;
         weak<spirv_compiler_t> m_compiler = nullptr;
 
         shader_kind m_kind { shader_kind::glsl_infer };
         std::string          m_content;
         const char*          m_entry_point = "main";
+
+        std::span<const ui32> m_spirv;
     };
 } // namespace orb::vk
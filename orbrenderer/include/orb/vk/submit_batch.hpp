@@ -0,0 +1,357 @@
+#pragma once
+
+#include "orb/profiler.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/semaphores.hpp"
+#include "orb/vk/timeline.hpp"
+
+#include <orb/result.hpp>
+
+#include <span>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Collects the submissions of a frame and flushes them with as few calls as possible
+     *
+     * Each `submit` starts a new submission, the following calls describe it. Waits and signals
+     * carry their own stage mask (VkSemaphoreSubmitInfo) and an optional timeline value.
+     * `flush` keeps the recorded order and merges runs of consecutive submissions to the same
+     * queue into one vkQueueSubmit2. A submission with a fence ends its run, as each call takes
+     * a single fence. Without `device_builder_t::synchronization2` it falls back to
+     * vkQueueSubmit, 64 bit stages being widened to all_commands.
+     *
+     * The batch keeps its storage between flushes, keep one around for the whole run.
+     *
+     *   batch.submit(graphics).wait_semaphores(img_avail).signal_timeline(gfx.next()).cmd_buffer(cmd)
+     *        .submit(transfer).wait_timeline(gfx.last(), pipeline_stage_flag::transfer).cmd_buffer(copy);
+     *   batch.flush().unwrap();
+     */
+    class submit_batch_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> submit_batch_t
+        {
+            submit_batch_t b;
+            b.m_use_sync2 = device->features_13.synchronization2 == VK_TRUE;
+            return b;
+        }
+
+        /* @brief Starts a new submission to `queue` */
+        auto submit(VkQueue queue) -> submit_batch_t&
+        {
+            m_submits.push_back({
+                .queue        = queue,
+                .first_wait   = static_cast<ui32>(m_waits.size()),
+                .first_signal = static_cast<ui32>(m_signals.size()),
+                .first_cmd    = static_cast<ui32>(m_cmds.size()),
+            });
+
+            return *this;
+        }
+
+        /* @brief Fence signaled once the current submission and those before it on its queue completed */
+        auto fence(VkFence fence) -> submit_batch_t&
+        {
+            current().fence = fence;
+            return *this;
+        }
+
+        auto wait(VkSemaphore semaphore, VkPipelineStageFlags2 stages, ui64 value = 0) -> submit_batch_t&
+        {
+            auto info      = structs::semaphore_submit();
+            info.semaphore = semaphore;
+            info.value     = value;
+            info.stageMask = stages;
+
+            m_waits.push_back(info);
+            current().wait_count++;
+
+            return *this;
+        }
+
+        auto wait_semaphores(const semaphores_view_t& semaphores) -> submit_batch_t&
+        {
+            for (size_t i = 0; i < semaphores.handles.size(); ++i)
+            {
+                wait(semaphores.handles[i], semaphores.wait_stages[i]);
+            }
+
+            return *this;
+        }
+
+        auto wait_semaphores(const semaphores_t& semaphores) -> submit_batch_t&
+        {
+            for (size_t i = 0; i < semaphores.handles.size(); ++i)
+            {
+                wait(semaphores.handles[i], semaphores.wait_stages[i]);
+            }
+
+            return *this;
+        }
+
+        auto wait_timeline(sync_point_t point, pipeline_stage_flag stage) -> submit_batch_t&
+        {
+            return wait(point.semaphore, vkflag(stage), point.value);
+        }
+
+        auto signal(VkSemaphore           semaphore,
+                    VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                    ui64                  value  = 0) -> submit_batch_t&
+        {
+            auto info      = structs::semaphore_submit();
+            info.semaphore = semaphore;
+            info.value     = value;
+            info.stageMask = stages;
+
+            m_signals.push_back(info);
+            current().signal_count++;
+
+            return *this;
+        }
+
+        auto signal_semaphores(std::span<const VkSemaphore> semaphores) -> submit_batch_t&
+        {
+            for (auto semaphore : semaphores)
+            {
+                signal(semaphore);
+            }
+
+            return *this;
+        }
+
+        /* @brief Signals a timeline value once the commands complete up to `stages` */
+        auto signal_timeline(sync_point_t point, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT)
+            -> submit_batch_t&
+        {
+            return signal(point.semaphore, stages, point.value);
+        }
+
+        auto cmd_buffer(VkCommandBuffer cmd) -> submit_batch_t&
+        {
+            auto info          = structs::cmd_buffer_submit();
+            info.commandBuffer = cmd;
+
+            m_cmds.push_back(info);
+            current().cmd_count++;
+
+            return *this;
+        }
+
+        auto cmd_buffers(std::span<const VkCommandBuffer> cmds) -> submit_batch_t&
+        {
+            for (auto cmd : cmds)
+            {
+                cmd_buffer(cmd);
+            }
+
+            return *this;
+        }
+
+        /* @brief Submits everything collected since the last flush, then clears the batch */
+        [[nodiscard]] auto flush() -> result<void>
+        {
+            ORB_PROFILE_ZONE("submit_batch_t::flush");
+
+            auto res = m_use_sync2 ? flush_sync2() : flush_legacy();
+            clear();
+            return res;
+        }
+
+        void clear()
+        {
+            m_submits.clear();
+            m_waits.clear();
+            m_signals.clear();
+            m_cmds.clear();
+        }
+
+        [[nodiscard]] auto uses_sync2() const -> bool { return m_use_sync2; }
+
+        [[nodiscard]] auto empty() const -> bool { return m_submits.empty(); }
+
+    private:
+        struct submission_t
+        {
+            VkQueue queue        = nullptr;
+            VkFence fence        = nullptr;
+            ui32    first_wait   = 0;
+            ui32    wait_count   = 0;
+            ui32    first_signal = 0;
+            ui32    signal_count = 0;
+            ui32    first_cmd    = 0;
+            ui32    cmd_count    = 0;
+        };
+
+        auto current() -> submission_t&
+        {
+            orbassert(!m_submits.empty(), "submit_batch_t: call submit(queue) first");
+            return m_submits.back();
+        }
+
+        /* @brief Calls `fn(queue, fence)` for each run of consecutive submissions to one queue, in
+         * recorded order, with `m_queue_submits` holding the run
+         *
+         * Merging only consecutive submissions keeps binary semaphore chains such as
+         * graphics -> transfer -> graphics valid. A fence ends the run it belongs to.
+         */
+        template <typename Fn>
+        auto for_each_queue(Fn&& fn) -> result<void>
+        {
+            size_t i = 0;
+
+            while (i < m_submits.size())
+            {
+                const VkQueue queue = m_submits[i].queue;
+                VkFence       fence = nullptr;
+
+                m_queue_submits.clear();
+
+                while (i < m_submits.size() && m_submits[i].queue == queue && !fence)
+                {
+                    fence = m_submits[i].fence;
+                    m_queue_submits.push_back(&m_submits[i++]);
+                }
+
+                if (auto r = fn(queue, fence); !r) return r.error();
+            }
+
+            return {};
+        }
+
+        [[nodiscard]] auto flush_sync2() -> result<void>
+        {
+            return for_each_queue([&](VkQueue queue, VkFence fence) -> result<void> {
+                m_infos_2.clear();
+
+                for (const auto* s : m_queue_submits)
+                {
+                    auto info                     = structs::submit_2();
+                    info.waitSemaphoreInfoCount   = s->wait_count;
+                    info.pWaitSemaphoreInfos      = m_waits.data() + s->first_wait;
+                    info.signalSemaphoreInfoCount = s->signal_count;
+                    info.pSignalSemaphoreInfos    = m_signals.data() + s->first_signal;
+                    info.commandBufferInfoCount   = s->cmd_count;
+                    info.pCommandBufferInfos      = m_cmds.data() + s->first_cmd;
+
+                    m_infos_2.push_back(info);
+                }
+
+                if (auto res = vkQueueSubmit2(queue, m_infos_2.size(), m_infos_2.data(), fence); res != vkres::ok)
+                {
+                    return error_t { "Failed to submit batch: {}", vkres::get_repr(res) };
+                }
+
+                return {};
+            });
+        }
+
+        [[nodiscard]] auto flush_legacy() -> result<void>
+        {
+            // Flat copies of the batch in the layout VkSubmitInfo expects, reserved up front so
+            // the pointers taken below stay valid
+            m_legacy_semaphores.clear();
+            m_legacy_values.clear();
+            m_legacy_stages.clear();
+            m_legacy_cmds.clear();
+            m_legacy_semaphores.reserve(m_waits.size() + m_signals.size());
+            m_legacy_values.reserve(m_waits.size() + m_signals.size());
+            m_legacy_stages.reserve(m_waits.size());
+            m_legacy_cmds.reserve(m_cmds.size());
+
+            return for_each_queue([&](VkQueue queue, VkFence fence) -> result<void> {
+                m_infos.clear();
+                m_timeline_infos.clear();
+                m_infos.reserve(m_queue_submits.size());
+                m_timeline_infos.reserve(m_queue_submits.size());
+
+                for (const auto* s : m_queue_submits)
+                {
+                    auto info          = structs::submit();
+                    auto timeline      = structs::timeline_semaphore_submit();
+                    bool uses_timeline = false;
+
+                    info.waitSemaphoreCount          = s->wait_count;
+                    info.pWaitSemaphores             = m_legacy_semaphores.data() + m_legacy_semaphores.size();
+                    info.pWaitDstStageMask           = m_legacy_stages.data() + m_legacy_stages.size();
+                    timeline.waitSemaphoreValueCount = s->wait_count;
+                    timeline.pWaitSemaphoreValues    = m_legacy_values.data() + m_legacy_values.size();
+
+                    for (ui32 i = 0; i < s->wait_count; ++i)
+                    {
+                        const auto& wait = m_waits[s->first_wait + i];
+
+                        m_legacy_semaphores.push_back(wait.semaphore);
+                        m_legacy_values.push_back(wait.value);
+                        m_legacy_stages.push_back(legacy_stages(wait.stageMask));
+
+                        uses_timeline |= wait.value != 0;
+                    }
+
+                    info.signalSemaphoreCount          = s->signal_count;
+                    info.pSignalSemaphores             = m_legacy_semaphores.data() + m_legacy_semaphores.size();
+                    timeline.signalSemaphoreValueCount = s->signal_count;
+                    timeline.pSignalSemaphoreValues    = m_legacy_values.data() + m_legacy_values.size();
+
+                    for (ui32 i = 0; i < s->signal_count; ++i)
+                    {
+                        const auto& signal = m_signals[s->first_signal + i];
+
+                        m_legacy_semaphores.push_back(signal.semaphore);
+                        m_legacy_values.push_back(signal.value);
+
+                        uses_timeline |= signal.value != 0;
+                    }
+
+                    info.commandBufferCount = s->cmd_count;
+                    info.pCommandBuffers    = m_legacy_cmds.data() + m_legacy_cmds.size();
+
+                    for (ui32 i = 0; i < s->cmd_count; ++i)
+                    {
+                        m_legacy_cmds.push_back(m_cmds[s->first_cmd + i].commandBuffer);
+                    }
+
+                    m_timeline_infos.push_back(timeline);
+                    info.pNext = uses_timeline ? &m_timeline_infos.back() : nullptr;
+
+                    m_infos.push_back(info);
+                }
+
+                if (auto res = vkQueueSubmit(queue, m_infos.size(), m_infos.data(), fence); res != vkres::ok)
+                {
+                    return error_t { "Failed to submit batch: {}", vkres::get_repr(res) };
+                }
+
+                return {};
+            });
+        }
+
+        /* @brief Legacy stage masks are the low 32 bits of the sync2 ones */
+        [[nodiscard]] static auto legacy_stages(VkPipelineStageFlags2 stages) -> VkPipelineStageFlags
+        {
+            if (stages == VK_PIPELINE_STAGE_2_NONE || (stages >> 32) != 0)
+            {
+                return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            }
+
+            return static_cast<VkPipelineStageFlags>(stages);
+        }
+
+        bool m_use_sync2 = false;
+
+        std::vector<submission_t>              m_submits;
+        std::vector<VkSemaphoreSubmitInfo>     m_waits;
+        std::vector<VkSemaphoreSubmitInfo>     m_signals;
+        std::vector<VkCommandBufferSubmitInfo> m_cmds;
+
+        // Scratch storage reused by every flush
+        std::vector<const submission_t*>           m_queue_submits;
+        std::vector<VkSubmitInfo2>                 m_infos_2;
+        std::vector<VkSubmitInfo>                  m_infos;
+        std::vector<VkTimelineSemaphoreSubmitInfo> m_timeline_infos;
+        std::vector<VkSemaphore>                   m_legacy_semaphores;
+        std::vector<ui64>                          m_legacy_values;
+        std::vector<VkPipelineStageFlags>          m_legacy_stages;
+        std::vector<VkCommandBuffer>               m_legacy_cmds;
+    };
+} // namespace orb::vk
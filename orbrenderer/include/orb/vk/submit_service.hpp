@@ -0,0 +1,225 @@
+#pragma once
+
+#include "orb/vk/device.hpp"
+#include "orb/vk/submit_batch.hpp"
+#include "orb/vk/timeline.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Command buffers and semaphores of one submission, see `submit_service_t::push` */
+    class submit_packet_t
+    {
+    public:
+        auto wait(VkSemaphore semaphore, VkPipelineStageFlags2 stages, ui64 value = 0) -> submit_packet_t&
+        {
+            m_waits.push_back({ .semaphore = semaphore, .value = value, .stages = stages });
+            return *this;
+        }
+
+        auto wait_timeline(sync_point_t point, VkPipelineStageFlags2 stages) -> submit_packet_t&
+        {
+            return wait(point.semaphore, stages, point.value);
+        }
+
+        auto signal(VkSemaphore           semaphore,
+                    VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                    ui64                  value  = 0) -> submit_packet_t&
+        {
+            m_signals.push_back({ .semaphore = semaphore, .value = value, .stages = stages });
+            return *this;
+        }
+
+        auto cmd_buffer(VkCommandBuffer cmd) -> submit_packet_t&
+        {
+            m_cmds.push_back(cmd);
+            return *this;
+        }
+
+        auto cmd_buffers(std::span<const VkCommandBuffer> cmds) -> submit_packet_t&
+        {
+            m_cmds.insert(m_cmds.end(), cmds.begin(), cmds.end());
+            return *this;
+        }
+
+        /* @brief Fence signaled once the packet completed, ends the batch it is part of */
+        auto fence(VkFence fence) -> submit_packet_t&
+        {
+            m_fence = fence;
+            return *this;
+        }
+
+    private:
+        friend class submit_service_t;
+
+        struct semaphore_t
+        {
+            VkSemaphore           semaphore = nullptr;
+            ui64                  value     = 0;
+            VkPipelineStageFlags2 stages    = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        };
+
+        std::vector<semaphore_t>     m_waits;
+        std::vector<semaphore_t>     m_signals;
+        std::vector<VkCommandBuffer> m_cmds;
+        VkFence                      m_fence = nullptr;
+    };
+
+    /* @brief Submits to queues from a thread per queue, packets being pushed from any thread
+     *
+     * VkQueue must be externally synchronized. Instead of a lock around every submission, each
+     * queue given to the builder gets a submit thread, the only one calling vkQueueSubmit on it.
+     * `push` appends the packet to the queue's lock-free multi-producer list and wakes the
+     * thread, which takes every packet available and submits them with a single call through
+     * a `submit_batch_t`.
+     *
+     * Each packet gets a ticket, returned as a point on the queue's timeline semaphore: the
+     * point is reached once the packet completed. Packets are submitted in ticket order, so the
+     * timeline is only signaled by the last packet of a batch, submission order covering the
+     * ones before it.
+     *
+     *   vk::submit_packet_t packet;
+     *   packet.wait_timeline(gfx_done, VK_PIPELINE_STAGE_2_COPY_BIT).cmd_buffer(copy.handle);
+     *   auto done = submits->push(transfer_queue, std::move(packet)).unwrap();
+     *   ...
+     *   submits->wait(done).unwrap();
+     *
+     * A queue driven by the service must not be used directly, presentation included. Command
+     * buffers must be fully recorded before being pushed. The device must be idle before the
+     * service is destroyed, like for any object it owns.
+     */
+    class submit_service_t
+    {
+    public:
+        submit_service_t() = default;
+
+        submit_service_t(const submit_service_t&)                    = delete;
+        auto operator=(const submit_service_t&) -> submit_service_t& = delete;
+
+        submit_service_t(submit_service_t&&)                    = delete;
+        auto operator=(submit_service_t&&) -> submit_service_t& = delete;
+
+        /* @brief Submits the packets already pushed, then stops the threads */
+        ~submit_service_t();
+
+        /* @brief Queues `packet` for submission to `queue`, returns its completion point */
+        [[nodiscard]] auto push(VkQueue queue, submit_packet_t&& packet) -> result<sync_point_t>;
+
+        /* @brief Waits until the packet of `token` completed
+         *
+         * Returns the service's error as soon as a submission failed, packets dropped after it never
+         * complete.
+         */
+        [[nodiscard]] auto wait(sync_point_t token, ui64 timeout = UINT64_MAX) const -> result<void>;
+
+        /* @brief Whether the packet of `token` completed, without blocking */
+        [[nodiscard]] auto completed(sync_point_t token) const -> result<bool>;
+
+        /* @brief The first submission error, the service drops every packet after it */
+        [[nodiscard]] auto status() const -> result<void>;
+
+        /* @brief vkQueueSubmit calls made so far, against `packets` submitted */
+        [[nodiscard]] auto submit_calls() const -> ui64;
+
+        [[nodiscard]] auto packets() const -> ui64;
+
+    private:
+        friend class submit_service_builder_t;
+
+        struct node_t
+        {
+            std::atomic<node_t*> next   = nullptr;
+            ui64                 ticket = 0;
+            submit_packet_t      packet;
+        };
+
+        struct pending_t
+        {
+            ui64            ticket = 0;
+            submit_packet_t packet;
+        };
+
+        struct worker_t
+        {
+            VkQueue              queue = nullptr;
+            timeline_semaphore_t timeline;
+            submit_batch_t       batch;
+            std::thread          thread;
+
+            // Producers exchange the head, the submit thread alone follows the links from the tail
+            std::atomic<node_t*> head = nullptr;
+            node_t*              tail = nullptr;
+
+            std::atomic<ui64> next_ticket = 1;
+            std::atomic<ui64> pushed      = 0; // bumped after each push, the submit thread sleeps on it
+            std::atomic<bool> stop        = false;
+
+            // Submit thread only: packets popped ahead of a ticket still being pushed
+            std::vector<pending_t> pending;
+            ui64                   next_submit = 1;
+
+            std::atomic<ui64> submit_calls = 0;
+            std::atomic<ui64> packets      = 0;
+        };
+
+        void worker_loop(worker_t& worker);
+        void drain(worker_t& worker);
+        void fail(error_t error);
+
+        [[nodiscard]] auto find(VkQueue queue) -> worker_t*;
+
+        VkDevice                   m_device    = nullptr;
+        ui32                       m_max_batch = 64;
+        std::vector<box<worker_t>> m_workers;
+
+        mutable std::mutex     m_error_mutex;
+        std::optional<error_t> m_error;
+        std::atomic<bool>      m_failed = false;
+    };
+
+    class submit_service_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<submit_service_builder_t>
+        {
+            if (device->features_12.timelineSemaphore != VK_TRUE)
+            {
+                return error_t { "submit_service_t requires timeline semaphores, see device_builder_t::timeline_semaphores" };
+            }
+
+            submit_service_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        /* @brief Adds a queue, driven by its own submit thread */
+        auto queue(VkQueue queue) -> submit_service_builder_t&
+        {
+            m_queues.push_back(queue);
+            return *this;
+        }
+
+        /* @brief Most packets submitted by a single vkQueueSubmit call */
+        auto max_batch(ui32 count) -> submit_service_builder_t&
+        {
+            m_max_batch = count;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<box<submit_service_t>>;
+
+    private:
+        weak<device_t>       m_device    = nullptr;
+        std::vector<VkQueue> m_queues;
+        ui32                 m_max_batch = 64;
+    };
+} // namespace orb::vk
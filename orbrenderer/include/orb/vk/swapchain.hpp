@@ -1,5 +1,6 @@
 #pragma once
 
+#include "orb/profiler.hpp"
 #include "orb/vk/core.hpp"
 
 #include <orb/box.hpp>
@@ -20,6 +21,7 @@ namespace orb::vk
     struct gpu_t;
     struct device_t;
     struct surface_t;
+    class deletion_queue_t;
 
     struct swapchain_t
     {
@@ -36,10 +38,12 @@ namespace orb::vk
         VkPresentModeKHR         present_mode {};
         VkExtent2D               extent {};
         std::vector<VkImage>     images;
+        std::vector<ui32>        queue_families; // sharing the images concurrently when more than one
 
         ui32 width {};
         ui32 height {};
         ui32 img_count {};
+        ui64 generation {}; // bumped by every rebuild, for caches of size dependent state
 
         swapchain_t() = default;
 
@@ -50,19 +54,21 @@ namespace orb::vk
         {
             if (handle or surface) destroy();
 
-            info         = other.info;
-            cap          = other.cap;
-            device       = other.device;
-            gpu          = other.gpu;
-            window       = other.window;
-            handle       = other.handle;
-            surface      = other.surface;
-            instance     = other.instance;
-            format       = other.format;
-            cmd          = other.cmd;
-            present_mode = other.present_mode;
-            extent       = other.extent;
-            images       = std::move(other.images);
+            info           = other.info;
+            cap            = other.cap;
+            device         = other.device;
+            gpu            = other.gpu;
+            window         = other.window;
+            handle         = other.handle;
+            surface        = other.surface;
+            instance       = other.instance;
+            format         = other.format;
+            cmd            = other.cmd;
+            present_mode   = other.present_mode;
+            extent         = other.extent;
+            images         = std::move(other.images);
+            queue_families = std::move(other.queue_families);
+            generation     = other.generation;
 
             other.handle  = nullptr;
             other.surface = nullptr;
@@ -72,19 +78,21 @@ namespace orb::vk
         {
             destroy();
 
-            info         = other.info;
-            cap          = other.cap;
-            device       = other.device;
-            gpu          = other.gpu;
-            window       = other.window;
-            handle       = other.handle;
-            surface      = other.surface;
-            instance     = other.instance;
-            format       = other.format;
-            cmd          = other.cmd;
-            present_mode = other.present_mode;
-            extent       = other.extent;
-            images       = std::move(other.images);
+            info           = other.info;
+            cap            = other.cap;
+            device         = other.device;
+            gpu            = other.gpu;
+            window         = other.window;
+            handle         = other.handle;
+            surface        = other.surface;
+            instance       = other.instance;
+            format         = other.format;
+            cmd            = other.cmd;
+            present_mode   = other.present_mode;
+            extent         = other.extent;
+            images         = std::move(other.images);
+            queue_families = std::move(other.queue_families);
+            generation     = other.generation;
 
             other.handle  = nullptr;
             other.surface = nullptr;
@@ -99,7 +107,28 @@ namespace orb::vk
 
         void destroy();
 
+        /* @brief Recreates the swapchain, destroying the old one right away
+         *
+         * The old swapchain may still be in use by frames in flight: the device must be idle.
+         */
         auto rebuild() -> result<void>;
+
+        /* @brief Recreates the swapchain without waiting for the device
+         *
+         * The new swapchain is created with the old one as `oldSwapchain`, and the old one is
+         * handed to `retired` instead of being destroyed, so that frames in flight still present
+         * to it. Views and framebuffers on the old images go to the same queue:
+         *
+         *   swapchain->rebuild(deletions).unwrap();
+         *   deletions.defer(std::move(views));
+         *   views = create_views();
+         *
+         * `retired` must be emptied before the swapchain is destroyed, the surface going with it.
+         */
+        auto rebuild(deletion_queue_t& retired) -> result<void>;
+
+    private:
+        auto recreate() -> result<void>;
     };
 
     class swapchain_builder_t
@@ -130,6 +159,9 @@ namespace orb::vk
         auto fb_dimensions_from_window() -> swapchain_builder_t&;
         auto present_queue_family_index(ui32 index) -> swapchain_builder_t&;
 
+        /* @brief Queue family using the images besides the present one, without ownership transfers */
+        auto queue_family(ui32 index) -> swapchain_builder_t&;
+
         auto format(format v) -> swapchain_builder_t&
         {
             formats.push_back(v);
@@ -228,10 +260,30 @@ namespace orb::vk
             return *this;
         }
 
+        /* @brief Tags the present for vkWaitForPresentKHR, 0 leaves it untagged. See `frame_pacer_t` */
+        auto present_id(ui64 id) -> present_helper_t&
+        {
+            m_id = id;
+            return *this;
+        }
+
         auto present(VkQueue queue) -> img_res_t
         {
+            ORB_PROFILE_ZONE("present_helper_t::present");
+
+            // Chained here, the helper may have been moved since `present_id`
+            auto id = structs::present_id();
+
+            if (m_id != 0)
+            {
+                id.swapchainCount = 1;
+                id.pPresentIds    = &m_id;
+                m_info.pNext      = &id;
+            }
+
             img_res_t  res;
             const auto r = vkQueuePresentKHR(queue, &m_info);
+            m_info.pNext = nullptr;
 
             if (r == vkres::ok)
             {
@@ -245,5 +297,6 @@ namespace orb::vk
 
     private:
         VkPresentInfoKHR m_info = structs::present();
+        ui64             m_id   = 0;
     };
 } // namespace orb::vk
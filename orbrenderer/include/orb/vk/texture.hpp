@@ -0,0 +1,245 @@
+#pragma once
+
+#include "orb/vk/cmd_pool.hpp"
+#include "orb/vk/compute_pipeline.hpp"
+#include "orb/vk/desc_pool.hpp"
+#include "orb/vk/device.hpp"
+#include "orb/vk/shaders.hpp"
+#include "orb/vk/staging_buffer.hpp"
+#include "orb/vk/views.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief Number of levels in a full mip chain, down to 1x1 */
+    [[nodiscard]] inline auto mip_chain_length(ui32 width, ui32 height) -> ui32
+    {
+        return std::bit_width(std::max(width, height));
+    }
+
+    struct texture_t
+    {
+        VkDevice      device     = nullptr;
+        VmaAllocator  allocator  = nullptr;
+        VmaAllocation allocation = nullptr;
+        VkImage       image      = nullptr;
+        VkImageView   view       = nullptr;
+
+        VkFormat     format     = VK_FORMAT_UNDEFINED;
+        VkExtent2D   extent     = {};
+        ui32         mip_levels = 1;
+        image_layout layout     = image_layout::undefined;
+
+        texture_t() = default;
+
+        texture_t(const texture_t&)                    = delete;
+        auto operator=(const texture_t&) -> texture_t& = delete;
+
+        texture_t(texture_t&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        auto operator=(texture_t&& other) noexcept -> texture_t&
+        {
+            destroy();
+
+            device     = other.device;
+            allocator  = other.allocator;
+            allocation = other.allocation;
+            image      = other.image;
+            view       = other.view;
+            format     = other.format;
+            extent     = other.extent;
+            mip_levels = other.mip_levels;
+            layout     = other.layout;
+
+            other.allocation = nullptr;
+            other.image      = nullptr;
+            other.view       = nullptr;
+
+            return *this;
+        }
+
+        ~texture_t()
+        {
+            destroy();
+        }
+
+        void destroy()
+        {
+            if (view)
+            {
+                vkDestroyImageView(device, view, host_callbacks(host_scope::resources));
+                view = nullptr;
+            }
+
+            if (image && allocation)
+            {
+                vmaDestroyImage(allocator, image, allocation);
+                image      = nullptr;
+                allocation = nullptr;
+            }
+        }
+    };
+
+    /* @brief Resources used by a compute mip generation, to be kept alive until the work completes */
+    struct mip_generation_t
+    {
+        desc_pool_t pool;
+        views_t     views;
+    };
+
+    /* @brief A texture whose upload was recorded, see `texture_builder_t::record`
+     *
+     * `staging` and `mips` must stay alive until the command buffer completed, e.g. by deferring
+     * them to a `deletion_queue_t`. The texture is ready for commands submitted after it.
+     */
+    struct texture_upload_t
+    {
+        texture_t        texture;
+        staging_buffer_t staging;
+        mip_generation_t mips;
+    };
+
+    /* @brief Downsamples mip chains with a compute shader
+     *
+     * This is the fallback for formats that do not support linear blits. One pipeline is compiled
+     * per storage format on first use, so a single generator should be shared across textures.
+     */
+    class mip_generator_t
+    {
+    public:
+        [[nodiscard]] static auto create(weak<device_t> device, weak<spirv_compiler_t> compiler)
+            -> result<box<mip_generator_t>>;
+
+        /* @brief Whether the format can be written from a compute shader by this generator */
+        [[nodiscard]] auto supports(format fmt) const -> bool;
+
+        /* @brief Records the downsampling of mips 1..levels-1 from mip 0
+         *
+         * All the levels of the image must be in the general layout. They are left in it.
+         */
+        [[nodiscard]] auto record(VkCommandBuffer cmd,
+                                  VkImage         image,
+                                  format          fmt,
+                                  VkExtent2D      extent,
+                                  ui32            levels) -> result<mip_generation_t>;
+
+    private:
+        [[nodiscard]] auto pipeline(format fmt) -> result<weak<compute_pipeline_t>>;
+
+        weak<device_t>         m_device   = nullptr;
+        weak<spirv_compiler_t> m_compiler = nullptr;
+
+        std::vector<std::pair<format, box<compute_pipeline_t>>> m_pipelines;
+    };
+
+    /* @brief Creates sampled textures from pixel data
+     *
+     * The pixels go through one staging buffer. The mip chain is generated on the GPU with
+     * vkCmdBlitImage when the format supports linear blits and the queue family supports graphics,
+     * or with the compute downsampler of `mip_generator()` otherwise.
+     *
+     * `build` submits the upload on its own and waits for it. To stream many textures, `record`
+     * them into one command buffer and wait once:
+     *
+     *   for (auto& t : textures) uploads.push_back(builder.pixels(t).record(cmd, qf_index).unwrap());
+     *   submit cmd, then defer each upload's staging and mips until it completed
+     */
+    class texture_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<texture_builder_t>;
+        [[nodiscard]] auto        build() -> result<texture_t>;
+
+        /* @brief Records the upload into `cmd`, to be submitted by the caller
+         *
+         * @param qf_index The queue family `cmd` will be submitted to, which decides how mips are generated
+         */
+        [[nodiscard]] auto record(VkCommandBuffer cmd, ui32 qf_index) -> result<texture_upload_t>;
+
+        auto pixels(const void* data, ui64 size) -> texture_builder_t&
+        {
+            m_data = data;
+            m_size = size;
+            return *this;
+        }
+
+        template <typename TPixel>
+        auto pixels(std::span<const TPixel> data) -> texture_builder_t&
+        {
+            return pixels(data.data(), data.size_bytes());
+        }
+
+        auto size(ui32 w, ui32 h) -> texture_builder_t&
+        {
+            m_info.extent.width  = w;
+            m_info.extent.height = h;
+            return *this;
+        }
+
+        auto format(format format) -> texture_builder_t&
+        {
+            m_info.format = vkenum(format);
+            return *this;
+        }
+
+        auto usage(image_usage_flag flag) -> texture_builder_t&
+        {
+            m_info.usage |= vkflag(flag);
+            return *this;
+        }
+
+        auto generate_mips(bool enable) -> texture_builder_t&
+        {
+            m_generate_mips = enable;
+            return *this;
+        }
+
+        auto final_layout(image_layout layout) -> texture_builder_t&
+        {
+            m_final_layout = layout;
+            return *this;
+        }
+
+        auto staging(weak<cmd_pool_t> pool, VkQueue queue) -> texture_builder_t&
+        {
+            m_pool  = pool;
+            m_queue = queue;
+            return *this;
+        }
+
+        auto mip_generator(weak<mip_generator_t> generator) -> texture_builder_t&
+        {
+            m_generator = generator;
+            return *this;
+        }
+
+    private:
+        [[nodiscard]] auto supports_linear_blit() const -> bool;
+        [[nodiscard]] auto submit_and_wait(cmd_buffer_t& cmd) -> result<texture_t>;
+
+        weak<device_t>        m_device    = nullptr;
+        weak<cmd_pool_t>      m_pool      = nullptr;
+        weak<mip_generator_t> m_generator = nullptr;
+        VkQueue               m_queue     = nullptr;
+
+        const void* m_data = nullptr;
+        ui64        m_size = 0;
+
+        VkImageCreateInfo       m_info       = vk::structs::create::image();
+        VmaAllocationCreateInfo m_alloc_info = vk::structs::create::allocation();
+
+        bool         m_generate_mips = true;
+        image_layout m_final_layout  = image_layout::shader_read_only_optimal;
+    };
+} // namespace orb::vk
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "orb/profiler.hpp"
+#include "orb/vk/device.hpp"
+
+#include <orb/box.hpp>
+#include <orb/result.hpp>
+
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace orb::vk
+{
+    /* @brief A point on a timeline: reached once `semaphore` holds at least `value` */
+    struct sync_point_t
+    {
+        VkSemaphore semaphore = nullptr;
+        ui64        value     = 0;
+    };
+
+    /* @brief Waits until all sync points are reached, with a single vkWaitSemaphores call */
+    [[nodiscard]] inline auto wait_sync_points(VkDevice                      device,
+                                               std::span<const sync_point_t> points,
+                                               ui64                          timeout = UINT64_MAX) -> result<void>
+    {
+        std::vector<VkSemaphore> semaphores;
+        std::vector<ui64>        values;
+        semaphores.reserve(points.size());
+        values.reserve(points.size());
+
+        for (const auto& point : points)
+        {
+            if (!point.semaphore || point.value == 0) continue;
+
+            semaphores.push_back(point.semaphore);
+            values.push_back(point.value);
+        }
+
+        if (semaphores.empty()) return {};
+
+        auto info           = structs::semaphore_wait();
+        info.semaphoreCount = semaphores.size();
+        info.pSemaphores    = semaphores.data();
+        info.pValues        = values.data();
+
+        if (auto res = vkWaitSemaphores(device, &info, timeout); res != vkres::ok)
+        {
+            return error_t { "Failed to wait for timeline semaphores: {}", vkres::get_repr(res) };
+        }
+
+        return {};
+    }
+
+    /* @brief Timeline semaphore (Vulkan 1.2, see `device_builder_t::timeline_semaphores`) */
+    struct timeline_semaphore_t
+    {
+        VkDevice    device = nullptr;
+        VkSemaphore handle = nullptr;
+
+        timeline_semaphore_t() = default;
+
+        timeline_semaphore_t(const timeline_semaphore_t&)                    = delete;
+        auto operator=(const timeline_semaphore_t&) -> timeline_semaphore_t& = delete;
+
+        timeline_semaphore_t(timeline_semaphore_t&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        auto operator=(timeline_semaphore_t&& other) noexcept -> timeline_semaphore_t&
+        {
+            destroy();
+
+            device = other.device;
+            handle = other.handle;
+
+            other.handle = nullptr;
+
+            return *this;
+        }
+
+        ~timeline_semaphore_t()
+        {
+            destroy();
+        }
+
+        void destroy()
+        {
+            if (handle)
+            {
+                vkDestroySemaphore(device, handle, host_callbacks(host_scope::sync));
+                handle = nullptr;
+            }
+        }
+
+        [[nodiscard]] auto point(ui64 value) const -> sync_point_t
+        {
+            return { handle, value };
+        }
+
+        /* @brief Current counter value, i.e. the last value signaled by the GPU or the host */
+        [[nodiscard]] auto value() const -> result<ui64>
+        {
+            ui64 value = 0;
+
+            if (auto res = vkGetSemaphoreCounterValue(device, handle, &value); res != vkres::ok)
+            {
+                return error_t { "Failed to read timeline semaphore: {}", vkres::get_repr(res) };
+            }
+
+            return value;
+        }
+
+        [[nodiscard]] auto wait(ui64 value, ui64 timeout = UINT64_MAX) const -> result<void>
+        {
+            ORB_PROFILE_ZONE("timeline_semaphore_t::wait");
+
+            const sync_point_t p = point(value);
+            return wait_sync_points(device, { &p, 1 }, timeout);
+        }
+
+        /* @brief Signals `value` from the host */
+        [[nodiscard]] auto signal(ui64 value) const -> result<void>
+        {
+            auto info      = structs::semaphore_signal();
+            info.semaphore = handle;
+            info.value     = value;
+
+            if (auto res = vkSignalSemaphore(device, &info); res != vkres::ok)
+            {
+                return error_t { "Failed to signal timeline semaphore: {}", vkres::get_repr(res) };
+            }
+
+            return {};
+        }
+    };
+
+    class timeline_semaphore_builder_t
+    {
+    public:
+        [[nodiscard]] static auto prepare(weak<device_t> device) -> result<timeline_semaphore_builder_t>
+        {
+            timeline_semaphore_builder_t b;
+            b.m_device = device;
+            return b;
+        }
+
+        auto initial_value(ui64 value) -> timeline_semaphore_builder_t&
+        {
+            m_initial_value = value;
+            return *this;
+        }
+
+        [[nodiscard]] auto build() -> result<timeline_semaphore_t>
+        {
+            auto type_info         = structs::create::semaphore_type();
+            type_info.initialValue = m_initial_value;
+
+            auto sem_info  = structs::create::semaphore();
+            sem_info.pNext = &type_info;
+
+            timeline_semaphore_t sem;
+            sem.device = m_device->handle;
+
+            if (auto res = vkCreateSemaphore(m_device->handle, &sem_info, host_callbacks(host_scope::sync), &sem.handle);
+                res != vkres::ok)
+            {
+                return error_t { "Could not create timeline semaphore: {}", vkres::get_repr(res) };
+            }
+
+            return sem;
+        }
+
+    private:
+        weak<device_t> m_device        = nullptr;
+        ui64           m_initial_value = 0;
+    };
+} // namespace orb::vk
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "orb/vk/core.hpp"
+
+#include <orb/result.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace orb::vk
+{
+    /* @brief Whether `transcode_to_rgba8` can decode the given block compressed format
+     *
+     * Supported: BC1, BC2, BC3, BC4 (unsigned), BC5 (unsigned), BC7 and every 2D ASTC LDR footprint,
+     * in both UNORM and SRGB. ASTC blocks using HDR endpoints decode to the error color (magenta).
+     * BC7 and ASTC interpolate their texels with SSE2 when available.
+     */
+    [[nodiscard]] auto can_transcode_to_rgba8(VkFormat format) -> bool;
+
+    /* @brief RGBA8 format matching the color space of a block compressed format */
+    [[nodiscard]] auto transcoded_format(VkFormat format) -> VkFormat;
+
+    /* @brief Decodes one block compressed image to tightly packed RGBA8 texels
+     *
+     * @param format The block compressed format of `src`
+     * @param src The blocks, row after row, as stored in KTX2 and DDS files
+     * @param width Width of the image in texels
+     * @param height Height of the image in texels
+     * @param dst Destination of at least width * height * 4 bytes
+     */
+    [[nodiscard]] auto transcode_to_rgba8(VkFormat                   format,
+                                          std::span<const std::byte> src,
+                                          ui32                       width,
+                                          ui32                       height,
+                                          std::span<std::byte>       dst) -> result<void>;
+} // namespace orb::vk
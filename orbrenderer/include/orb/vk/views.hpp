@@ -1,6 +1,7 @@
 #pragma once
 
 #include "orb/vk/core.hpp"
+#include "orb/vk/host_allocator.hpp"
 
 #include <orb/box.hpp>
 #include <orb/result.hpp>
@@ -54,7 +55,7 @@ namespace orb::vk
         {
             for (auto& [img, view] : handles)
             {
-                vkDestroyImageView(device, view, nullptr);
+                vkDestroyImageView(device, view, host_callbacks(host_scope::resources));
                 view = nullptr;
             }
         }
@@ -96,7 +97,7 @@ namespace orb::vk
             for (auto& [img, view] : views.handles)
             {
                 m_info.image = img;
-                vkCreateImageView(m_device, &m_info, nullptr, &view);
+                vkCreateImageView(m_device, &m_info, host_callbacks(host_scope::resources), &view);
             }
 
             return views;
@@ -2,6 +2,7 @@
 
 #include "glfw/core.hpp"
 #include "orb/vk/core.hpp"
+#include "orb/vk/host_allocator.hpp"
 
 namespace orb::glfw
 {
@@ -32,7 +33,7 @@ namespace orb::glfw
     {
         VkSurfaceKHR surface {};
 
-        const auto res = glfwCreateWindowSurface(instance, get_handle<GLFWwindow>(), nullptr, &surface);
+        const auto res = glfwCreateWindowSurface(instance, get_handle<GLFWwindow>(), vk::host_callbacks(vk::host_scope::instance), &surface);
 
         if (res != vk::vkres::ok)
         {
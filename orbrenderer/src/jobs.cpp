@@ -0,0 +1,381 @@
+#include "orb/jobs.hpp"
+
+#include "orb/profiler.hpp"
+
+#include <string>
+
+namespace orb
+{
+    struct job_t
+    {
+        job_fn_t       fn;
+        job_counter_t* counter  = nullptr;
+        i32            affinity = job_system_t::any_thread;
+    };
+
+    namespace
+    {
+        constexpr std::int64_t initial_capacity = 256;
+
+        // Failed searches before an idle worker sleeps
+        constexpr ui32 spin_count = 64;
+
+        struct thread_identity_t
+        {
+            const job_system_t* owner = nullptr;
+            i32                 index = -1;
+        };
+
+        thread_local thread_identity_t this_thread;
+    } // namespace
+
+    work_deque_t::ring_t::ring_t(std::int64_t size)
+        : capacity(size)
+        , slots(std::make_unique<std::atomic<job_t*>[]>(size))
+    {
+    }
+
+    work_deque_t::work_deque_t()
+    {
+        m_rings.push_back(std::make_unique<ring_t>(initial_capacity));
+        m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    void work_deque_t::push(job_t* job)
+    {
+        const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t top    = m_top.load(std::memory_order_acquire);
+        ring_t*            ring   = m_ring.load(std::memory_order_relaxed);
+
+        if (bottom - top >= ring->capacity) ring = grow(ring, top, bottom);
+
+        ring->store(bottom, job);
+
+        // Publishes the job to thieves
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    auto work_deque_t::pop() -> job_t*
+    {
+        const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        ring_t*            ring   = m_ring.load(std::memory_order_relaxed);
+
+        // Reserves the bottom job before reading the top, thieves see one or the other
+        m_bottom.store(bottom, std::memory_order_seq_cst);
+        std::int64_t top = m_top.load(std::memory_order_seq_cst);
+
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        job_t* job = ring->load(bottom);
+
+        if (top == bottom)
+        {
+            // Last job, thieves may be after it too
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                job = nullptr;
+            }
+
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return job;
+    }
+
+    auto work_deque_t::steal() -> job_t*
+    {
+        std::int64_t       top    = m_top.load(std::memory_order_seq_cst);
+        const std::int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+
+        if (top >= bottom) return nullptr;
+
+        job_t* job = m_ring.load(std::memory_order_acquire)->load(top);
+
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+
+        return job;
+    }
+
+    auto work_deque_t::grow(ring_t* ring, std::int64_t top, std::int64_t bottom) -> ring_t*
+    {
+        auto bigger = std::make_unique<ring_t>(ring->capacity * 2);
+
+        for (std::int64_t i = top; i < bottom; ++i)
+        {
+            bigger->store(i, ring->load(i));
+        }
+
+        ring_t* raw = bigger.get();
+        m_rings.push_back(std::move(bigger));
+        m_ring.store(raw, std::memory_order_release);
+
+        return raw;
+    }
+
+    job_system_t::~job_system_t()
+    {
+        m_stop.store(true, std::memory_order_release);
+        m_signal.fetch_add(1, std::memory_order_release);
+        m_signal.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            if (worker->thread.joinable()) worker->thread.join();
+        }
+
+        // Workers only stop once they find no job, only mailboxes of workers gone first remain
+        for (auto& worker : m_workers)
+        {
+            for (auto* job : worker->mailbox)
+            {
+                delete job;
+            }
+        }
+
+        for (auto* job : m_shared)
+        {
+            delete job;
+        }
+    }
+
+    void job_system_t::run(job_fn_t fn, job_counter_t* counter, i32 affinity)
+    {
+        if (counter) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        schedule(new job_t { .fn = std::move(fn), .counter = counter, .affinity = affinity });
+    }
+
+    void job_system_t::run_after(job_counter_t& dependency, job_fn_t fn, job_counter_t* counter, i32 affinity)
+    {
+        if (counter) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        auto* job = new job_t { .fn = std::move(fn), .counter = counter, .affinity = affinity };
+
+        {
+            // The last job of the dependency takes the continuations under the same lock
+            std::lock_guard lock(dependency.m_mutex);
+
+            if (!dependency.done())
+            {
+                dependency.m_continuations.push_back(job);
+                return;
+            }
+        }
+
+        schedule(job);
+    }
+
+    void job_system_t::wait(job_counter_t& counter)
+    {
+        ORB_PROFILE_ZONE("job_system_t::wait");
+
+        const i32 self = worker_index();
+
+        while (!counter.done())
+        {
+            if (auto* job = find_job(self))
+            {
+                execute(job);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // The last job reaches zero holding the lock, let it release it before the counter goes away
+        std::lock_guard lock(counter.m_mutex);
+    }
+
+    auto job_system_t::thread_slot() const -> ui32
+    {
+        const i32 index = worker_index();
+        return index >= 0 ? static_cast<ui32>(index) : threads();
+    }
+
+    auto job_system_t::worker_index() const -> i32
+    {
+        return this_thread.owner == this ? this_thread.index : -1;
+    }
+
+    void job_system_t::schedule(job_t* job)
+    {
+        if (job->affinity != any_thread)
+        {
+            auto& worker = *m_workers[static_cast<ui32>(job->affinity) % threads()];
+
+            {
+                std::lock_guard lock(worker.mailbox_mutex);
+                worker.mailbox.push_back(job);
+                worker.mailbox_size.fetch_add(1, std::memory_order_release);
+            }
+
+            // Only one worker may take it, wake them all to be sure it is awake
+            m_signal.fetch_add(1, std::memory_order_release);
+            m_signal.notify_all();
+            return;
+        }
+
+        if (const i32 self = worker_index(); self >= 0)
+        {
+            m_workers[self]->deque.push(job);
+        }
+        else
+        {
+            std::lock_guard lock(m_shared_mutex);
+            m_shared.push_back(job);
+            m_shared_size.fetch_add(1, std::memory_order_release);
+        }
+
+        m_signal.fetch_add(1, std::memory_order_release);
+        m_signal.notify_one();
+    }
+
+    void job_system_t::execute(job_t* job)
+    {
+        job->fn();
+
+        if (job->counter) finish(*job->counter);
+
+        delete job;
+    }
+
+    void job_system_t::finish(job_counter_t& counter)
+    {
+        // Jobs other than the last leave the counter without locking it
+        ui32 pending = counter.m_pending.load(std::memory_order_relaxed);
+        while (pending > 1)
+        {
+            if (counter.m_pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+            {
+                return;
+            }
+        }
+
+        std::vector<job_t*> ready;
+
+        {
+            std::lock_guard lock(counter.m_mutex);
+
+            if (counter.m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                ready.swap(counter.m_continuations);
+            }
+        }
+
+        for (auto* job : ready)
+        {
+            schedule(job);
+        }
+    }
+
+    auto job_system_t::find_job(i32 self) -> job_t*
+    {
+        if (self >= 0)
+        {
+            auto& worker = *m_workers[self];
+
+            if (worker.mailbox_size.load(std::memory_order_acquire) > 0)
+            {
+                std::lock_guard lock(worker.mailbox_mutex);
+
+                if (!worker.mailbox.empty())
+                {
+                    job_t* job = worker.mailbox.back();
+                    worker.mailbox.pop_back();
+                    worker.mailbox_size.fetch_sub(1, std::memory_order_relaxed);
+                    return job;
+                }
+            }
+
+            if (auto* job = worker.deque.pop()) return job;
+        }
+
+        if (m_shared_size.load(std::memory_order_acquire) > 0)
+        {
+            std::lock_guard lock(m_shared_mutex);
+
+            if (!m_shared.empty())
+            {
+                job_t* job = m_shared.front();
+                m_shared.pop_front();
+                m_shared_size.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        // Victims in turn, starting after the calling worker so thieves spread out
+        const ui32 count = threads();
+        const ui32 first = self >= 0 ? static_cast<ui32>(self) + 1 : 0;
+
+        for (ui32 i = 0; i < count; ++i)
+        {
+            const ui32 victim = (first + i) % count;
+            if (static_cast<i32>(victim) == self) continue;
+
+            if (auto* job = m_workers[victim]->deque.steal()) return job;
+        }
+
+        return nullptr;
+    }
+
+    void job_system_t::worker_loop(ui32 index)
+    {
+        this_thread = { .owner = this, .index = static_cast<i32>(index) };
+        ORB_PROFILE_THREAD("Job worker " + std::to_string(index));
+
+        ui32 idle = 0;
+
+        while (true)
+        {
+            const ui32 signal = m_signal.load(std::memory_order_acquire);
+
+            if (auto* job = find_job(static_cast<i32>(index)))
+            {
+                execute(job);
+                idle = 0;
+                continue;
+            }
+
+            if (m_stop.load(std::memory_order_acquire)) return;
+
+            if (++idle < spin_count)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Anything scheduled since the load above changed the signal, so nothing is missed
+            m_signal.wait(signal, std::memory_order_acquire);
+            idle = 0;
+        }
+    }
+
+    auto job_system_builder_t::build() -> result<box<job_system_t>>
+    {
+        const ui32 cores   = std::max(std::thread::hardware_concurrency(), 2u);
+        const ui32 threads = m_threads ? m_threads : cores - 1;
+
+        auto jobs = make_box<job_system_t>();
+
+        for (ui32 i = 0; i < threads; ++i)
+        {
+            jobs->m_workers.push_back(std::make_unique<job_system_t::worker_t>());
+        }
+
+        // Workers steal from each other, they start once all of them exist
+        for (ui32 i = 0; i < threads; ++i)
+        {
+            jobs->m_workers[i]->thread = std::thread(&job_system_t::worker_loop, jobs.getmut().raw(), i);
+        }
+
+        return jobs;
+    }
+} // namespace orb
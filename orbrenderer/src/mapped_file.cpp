@@ -0,0 +1,140 @@
+#include "orb/mapped_file.hpp"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace orb
+{
+    auto mapped_file_t::open(const std::filesystem::path& file_path) -> result<mapped_file_t>
+    {
+        mapped_file_t file;
+
+#ifdef _WIN32
+        HANDLE handle = CreateFileW(file_path.c_str(),
+                                    GENERIC_READ,
+                                    FILE_SHARE_READ,
+                                    nullptr,
+                                    OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                    nullptr);
+
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            return error_t { "Could not open {}", file_path.string() };
+        }
+
+        file.m_file = handle;
+
+        LARGE_INTEGER size {};
+        if (!GetFileSizeEx(handle, &size))
+        {
+            return error_t { "Could not get the size of {}", file_path.string() };
+        }
+
+        file.m_size = static_cast<size_t>(size.QuadPart);
+
+        // Empty files cannot be mapped, they are exposed as an empty span instead
+        if (file.m_size == 0) return file;
+
+        file.m_mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!file.m_mapping)
+        {
+            return error_t { "Could not create a file mapping for {}", file_path.string() };
+        }
+
+        file.m_data = static_cast<const std::byte*>(MapViewOfFile(file.m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!file.m_data)
+        {
+            return error_t { "Could not map {}", file_path.string() };
+        }
+#else
+        file.m_fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file.m_fd < 0)
+        {
+            return error_t { "Could not open {}", file_path.string() };
+        }
+
+        struct stat st {};
+        if (fstat(file.m_fd, &st) != 0)
+        {
+            return error_t { "Could not get the size of {}", file_path.string() };
+        }
+
+        file.m_size = static_cast<size_t>(st.st_size);
+
+        // Empty files cannot be mapped, they are exposed as an empty span instead
+        if (file.m_size == 0) return file;
+
+        void* data = mmap(nullptr, file.m_size, PROT_READ, MAP_PRIVATE, file.m_fd, 0);
+        if (data == MAP_FAILED)
+        {
+            return error_t { "Could not map {}", file_path.string() };
+        }
+
+        // Files are read front to back, level after level
+        madvise(data, file.m_size, MADV_SEQUENTIAL);
+
+        file.m_data = static_cast<const std::byte*>(data);
+#endif
+
+        return file;
+    }
+
+    mapped_file_t::mapped_file_t(mapped_file_t&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    auto mapped_file_t::operator=(mapped_file_t&& other) noexcept -> mapped_file_t&
+    {
+        close();
+
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+
+#ifdef _WIN32
+        m_file    = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#else
+        m_fd = std::exchange(other.m_fd, -1);
+#endif
+
+        return *this;
+    }
+
+    mapped_file_t::~mapped_file_t()
+    {
+        close();
+    }
+
+    void mapped_file_t::close()
+    {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file) CloseHandle(m_file);
+
+        m_file    = nullptr;
+        m_mapping = nullptr;
+#else
+        if (m_data) munmap(const_cast<std::byte*>(m_data), m_size);
+        if (m_fd >= 0) ::close(m_fd);
+
+        m_fd = -1;
+#endif
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+} // namespace orb
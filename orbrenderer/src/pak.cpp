@@ -0,0 +1,259 @@
+#include "orb/pak.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace orb
+{
+    namespace
+    {
+        auto align_up(ui64 value, ui64 alignment) -> ui64
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        void write_padding(std::ofstream& out, ui64 from, ui64 to)
+        {
+            static constexpr std::array<char, 256> zeros {};
+
+            while (from < to)
+            {
+                const auto count = std::min<ui64>(to - from, zeros.size());
+                out.write(zeros.data(), static_cast<std::streamsize>(count));
+                from += count;
+            }
+        }
+    } // namespace
+
+    auto pak_checksum(std::span<const std::byte> bytes) -> ui64
+    {
+        ui64 hash = 0xcbf29ce484222325ull;
+
+        for (auto b : bytes)
+        {
+            hash ^= static_cast<ui64>(b);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    auto pak_reader_t::open(const std::filesystem::path& file_path) -> result<pak_reader_t>
+    {
+        auto mapping = mapped_file_t::open(file_path);
+        if (!mapping) return mapping.error();
+
+        pak_reader_t reader;
+        reader.m_file = std::move(mapping.value());
+
+        const auto bytes = reader.m_file.bytes();
+
+        if (bytes.size() < sizeof(pak_header_t))
+        {
+            return error_t { "Could not open {}: file too small", file_path.string() };
+        }
+
+        pak_header_t header {};
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        if (header.magic != pak_magic)
+        {
+            return error_t { "Could not open {}: not an orbpak archive", file_path.string() };
+        }
+
+        if (header.version != pak_version)
+        {
+            return error_t { "Could not open {}: unsupported version {}", file_path.string(), header.version };
+        }
+
+        const auto index = reader.m_file.bytes(header.index_offset, size_t { header.entry_count } * sizeof(pak_entry_t));
+        const auto names = reader.m_file.bytes(header.names_offset, header.names_size);
+
+        if (index.size() != size_t { header.entry_count } * sizeof(pak_entry_t) || names.size() != header.names_size)
+        {
+            return error_t { "Could not open {}: index out of bounds", file_path.string() };
+        }
+
+        if (header.index_offset % alignof(pak_entry_t) != 0)
+        {
+            return error_t { "Could not open {}: misaligned index", file_path.string() };
+        }
+
+        if (header.alignment == 0 || (header.alignment & (header.alignment - 1)) != 0)
+        {
+            return error_t { "Could not open {}: alignment {} is not a power of two", file_path.string(), header.alignment };
+        }
+
+        // The index is used in place, the mapping is page aligned
+        reader.m_entries = { reinterpret_cast<const pak_entry_t*>(index.data()), header.entry_count }; // NOLINT
+        reader.m_names   = { reinterpret_cast<const char*>(names.data()), names.size() };              // NOLINT
+
+        for (const auto& entry : reader.m_entries)
+        {
+            if (reader.m_file.bytes(entry.offset, entry.size).size() != entry.size
+                || ui64 { entry.name_offset } + entry.name_size > reader.m_names.size())
+            {
+                return error_t { "Could not open {}: corrupted entry", file_path.string() };
+            }
+
+            // Blobs are handed out as typed spans and copied to buffers at their offset
+            if (entry.offset % header.alignment != 0)
+            {
+                return error_t { "Could not open {}: misaligned blob", file_path.string() };
+            }
+        }
+
+        return reader;
+    }
+
+    auto pak_reader_t::blob(size_t index) const -> pak_blob_t
+    {
+        const auto& entry = m_entries[index];
+
+        return {
+            .name     = m_names.substr(entry.name_offset, entry.name_size),
+            .kind     = static_cast<pak_blob_kind>(entry.kind),
+            .data     = m_file.bytes(entry.offset, entry.size),
+            .checksum = entry.checksum,
+        };
+    }
+
+    auto pak_reader_t::find(std::string_view name) const -> result<pak_blob_t>
+    {
+        const auto name_of = [&](const pak_entry_t& entry) {
+            return m_names.substr(entry.name_offset, entry.name_size);
+        };
+
+        const auto it = std::lower_bound(m_entries.begin(), m_entries.end(), name, [&](const pak_entry_t& entry, std::string_view n) {
+            return name_of(entry) < n;
+        });
+
+        if (it == m_entries.end() || name_of(*it) != name)
+        {
+            return error_t { "Blob {} not found in archive", name };
+        }
+
+        return blob(static_cast<size_t>(it - m_entries.begin()));
+    }
+
+    auto pak_reader_t::verify(const pak_blob_t& blob) const -> bool
+    {
+        return pak_checksum(blob.data) == blob.checksum;
+    }
+
+    auto pak_reader_t::verify_all() const -> result<void>
+    {
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            const auto b = blob(i);
+
+            if (!verify(b))
+            {
+                return error_t { "Checksum mismatch for blob {}", b.name };
+            }
+        }
+
+        return {};
+    }
+
+    auto pak_writer_t::add_file(std::string name, pak_blob_kind kind, const std::filesystem::path& file_path)
+        -> result<void>
+    {
+        auto mapping = mapped_file_t::open(file_path);
+        if (!mapping) return mapping.error();
+
+        const auto bytes = mapping.value().bytes();
+        add(std::move(name), kind, { bytes.begin(), bytes.end() });
+
+        return {};
+    }
+
+    auto pak_writer_t::write(const std::filesystem::path& file_path) -> result<void>
+    {
+        if (m_alignment == 0 || (m_alignment & (m_alignment - 1)) != 0)
+        {
+            return error_t { "Could not write archive: alignment {} is not a power of two", m_alignment };
+        }
+
+        std::sort(m_blobs.begin(), m_blobs.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+
+        for (size_t i = 1; i < m_blobs.size(); ++i)
+        {
+            if (m_blobs[i - 1].name == m_blobs[i].name)
+            {
+                return error_t { "Could not write archive: duplicate blob name {}", m_blobs[i].name };
+            }
+        }
+
+        std::vector<pak_entry_t> entries(m_blobs.size());
+        std::string              names;
+
+        ui64 offset = align_up(sizeof(pak_header_t), m_alignment);
+
+        for (size_t i = 0; i < m_blobs.size(); ++i)
+        {
+            const auto& blob = m_blobs[i];
+
+            entries[i] = {
+                .offset      = offset,
+                .size        = blob.data.size(),
+                .checksum    = pak_checksum(blob.data),
+                .name_offset = static_cast<ui32>(names.size()),
+                .name_size   = static_cast<ui32>(blob.name.size()),
+                .kind        = static_cast<ui32>(blob.kind),
+                .reserved    = 0,
+            };
+
+            names += blob.name;
+            offset = align_up(offset + blob.data.size(), m_alignment);
+        }
+
+        // The reader uses the index in place
+        offset = align_up(offset, alignof(pak_entry_t));
+
+        const pak_header_t header {
+            .magic        = pak_magic,
+            .version      = pak_version,
+            .entry_count  = static_cast<ui32>(entries.size()),
+            .index_offset = offset,
+            .names_offset = offset + entries.size() * sizeof(pak_entry_t),
+            .names_size   = names.size(),
+            .alignment    = m_alignment,
+            .reserved     = 0,
+        };
+
+        std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            return error_t { "Could not open {} for writing", file_path.string() };
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header)); // NOLINT
+
+        ui64 written = sizeof(header);
+
+        for (size_t i = 0; i < m_blobs.size(); ++i)
+        {
+            write_padding(out, written, entries[i].offset);
+
+            out.write(reinterpret_cast<const char*>(m_blobs[i].data.data()), // NOLINT
+                      static_cast<std::streamsize>(m_blobs[i].data.size()));
+
+            written = entries[i].offset + entries[i].size;
+        }
+
+        write_padding(out, written, header.index_offset);
+
+        out.write(reinterpret_cast<const char*>(entries.data()), // NOLINT
+                  static_cast<std::streamsize>(entries.size() * sizeof(pak_entry_t)));
+        out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+        if (!out)
+        {
+            return error_t { "Could not write {}", file_path.string() };
+        }
+
+        return {};
+    }
+} // namespace orb
@@ -0,0 +1,158 @@
+#include "orb/profiler.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace orb::profiler
+{
+    namespace
+    {
+        struct thread_entry_t
+        {
+            thread_buffer_t buffer;
+            std::string     name;
+            ui32            id = 0;
+        };
+
+        /* @brief Every thread that recorded an event, locked on registration and export only */
+        struct registry_t
+        {
+            std::mutex                                   mutex;
+            std::vector<std::unique_ptr<thread_entry_t>> threads;
+            trace_clock_t::duration                      origin = trace_clock_t::now().time_since_epoch();
+        };
+
+        auto registry() -> registry_t&
+        {
+            static registry_t r;
+            return r;
+        }
+
+        auto this_entry() -> thread_entry_t&
+        {
+            thread_local thread_entry_t* entry = nullptr;
+
+            if (!entry) [[unlikely]]
+            {
+                auto&            r = registry();
+                std::scoped_lock lock(r.mutex);
+
+                auto& e = r.threads.emplace_back(std::make_unique<thread_entry_t>());
+                e->id   = static_cast<ui32>(r.threads.size());
+                e->name = "Thread " + std::to_string(e->id);
+                entry   = e.get();
+            }
+
+            return *entry;
+        }
+
+        void write_escaped(std::ofstream& out, std::string_view str)
+        {
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\') out << '\\';
+                if (static_cast<unsigned char>(c) >= 0x20) out << c;
+            }
+        }
+
+        auto microseconds(trace_clock_t::duration d) -> double
+        {
+            return std::chrono::duration<double, std::micro>(d).count();
+        }
+    } // namespace
+
+    thread_buffer_t::~thread_buffer_t()
+    {
+        const event_chunk_t* chunk = m_head.next.load(std::memory_order_relaxed);
+
+        while (chunk)
+        {
+            const event_chunk_t* next = chunk->next.load(std::memory_order_relaxed);
+            delete chunk; // NOLINT
+            chunk = next;
+        }
+    }
+
+    void thread_buffer_t::grow()
+    {
+        auto* chunk = new event_chunk_t(); // NOLINT
+        m_tail->next.store(chunk, std::memory_order_release);
+        m_tail = chunk;
+        m_chunks++;
+    }
+
+    auto thread_buffer() -> thread_buffer_t&
+    {
+        return this_entry().buffer;
+    }
+
+    void set_thread_name(std::string name)
+    {
+        auto& entry = this_entry();
+
+        std::scoped_lock lock(registry().mutex);
+        entry.name = std::move(name);
+    }
+
+    auto write_trace(const std::filesystem::path& file_path) -> result<void>
+    {
+        std::ofstream out(file_path, std::ios::trunc);
+        if (!out)
+        {
+            return error_t { "Could not open {} for writing", file_path.string() };
+        }
+
+        auto&            r = registry();
+        std::scoped_lock lock(r.mutex);
+
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+
+        for (const auto& t : r.threads)
+        {
+            out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t->id
+                << ",\"args\":{\"name\":\"";
+            write_escaped(out, t->name);
+
+            if (const ui64 dropped = t->buffer.dropped(); dropped > 0)
+            {
+                out << " (" << dropped << " events dropped)";
+            }
+
+            out << "\"}}";
+
+            first = false;
+
+            // Events published after the count was loaded are left for the next export
+            for (const event_chunk_t* chunk = t->buffer.head(); chunk;
+                 chunk                      = chunk->next.load(std::memory_order_acquire))
+            {
+                const ui32 count = chunk->count.load(std::memory_order_acquire);
+
+                for (ui32 i = 0; i < count; ++i)
+                {
+                    const auto& e = chunk->events[i];
+
+                    out << ",\n{\"name\":\"";
+                    write_escaped(out, e.name);
+                    out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t->id << ",\"ts\":" << microseconds(e.begin - r.origin)
+                        << ",\"dur\":" << microseconds(e.end - e.begin) << "}";
+                }
+            }
+        }
+
+        out << "\n]}\n";
+
+        if (!out)
+        {
+            return error_t { "Could not write {}", file_path.string() };
+        }
+
+        return {};
+    }
+} // namespace orb::profiler
@@ -0,0 +1,34 @@
+#include "orb/rolling_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace orb
+{
+    void rolling_stats_t::add(f32 ms)
+    {
+        samples[head] = ms;
+        head          = (head + 1) % window;
+        count         = std::min(count + 1, window);
+        last          = ms;
+    }
+
+    auto rolling_stats_t::average() const -> f32
+    {
+        if (count == 0) return 0.0f;
+        return std::accumulate(samples.begin(), samples.begin() + count, 0.0f) / static_cast<f32>(count);
+    }
+
+    auto rolling_stats_t::percentile(f32 p) const -> f32
+    {
+        if (count == 0) return 0.0f;
+
+        std::array<f32, window> sorted = samples;
+
+        const auto rank = static_cast<ui32>(std::lround(std::clamp(p, 0.0f, 1.0f) * static_cast<f32>(count - 1)));
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + count);
+
+        return sorted[rank];
+    }
+} // namespace orb
@@ -0,0 +1,134 @@
+#include "orb/vk/aliasing.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace orb::vk
+{
+    namespace
+    {
+        auto align_up(VkDeviceSize value, VkDeviceSize alignment) -> VkDeviceSize
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        struct placement_t
+        {
+            VkDeviceSize offset;
+            VkDeviceSize size;
+            ui32         first_use;
+            ui32         last_use;
+        };
+    } // namespace
+
+    auto aliased_images_builder_t::build() -> result<aliased_images_t>
+    {
+        aliased_images_t images;
+        images.device    = m_device->handle;
+        images.allocator = m_device->allocator;
+        images.handles.resize(m_images.size());
+        images.offsets.resize(m_images.size());
+        images.sizes.resize(m_images.size());
+
+        // Nothing to place, and no zero sized allocation to make
+        if (m_images.empty()) return images;
+
+        std::vector<VkMemoryRequirements> requirements(m_images.size());
+
+        ui32         memory_type_bits = ~0u;
+        VkDeviceSize alignment        = 1;
+
+        for (size_t i = 0; i < m_images.size(); ++i)
+        {
+            if (auto res = vkCreateImage(m_device->handle,
+                                         &m_images[i].info,
+                                         host_callbacks(host_scope::resources),
+                                         &images.handles[i]);
+                res != vkres::ok)
+            {
+                return error_t { "Could not create aliased image: {}", vkres::get_repr(res) };
+            }
+
+            vkGetImageMemoryRequirements(m_device->handle, images.handles[i], &requirements[i]);
+
+            memory_type_bits &= requirements[i].memoryTypeBits;
+            alignment = std::max(alignment, requirements[i].alignment);
+
+            images.sizes[i] = requirements[i].size;
+            images.unaliased_size += requirements[i].size;
+        }
+
+        if (memory_type_bits == 0)
+        {
+            return error_t { "Could not alias images: no memory type is compatible with all of them" };
+        }
+
+        // Largest first gives the big attachments the low offsets and lets small ones fill gaps
+        std::vector<size_t> order(m_images.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return requirements[a].size > requirements[b].size;
+        });
+
+        std::vector<placement_t> placed;
+        placed.reserve(m_images.size());
+
+        for (size_t i : order)
+        {
+            const auto&  req    = requirements[i];
+            const auto&  img    = m_images[i];
+            VkDeviceSize offset = 0;
+
+            // Bump the offset past every conflicting placement until it fits, placements only
+            // move it forward so this terminates
+            for (bool moved = true; moved;)
+            {
+                moved = false;
+
+                for (const auto& p : placed)
+                {
+                    const bool alive_together = img.first_use <= p.last_use && p.first_use <= img.last_use;
+                    const bool overlapping    = offset < p.offset + p.size && p.offset < offset + req.size;
+
+                    if (alive_together && overlapping)
+                    {
+                        offset = align_up(p.offset + p.size, req.alignment);
+                        moved  = true;
+                    }
+                }
+            }
+
+            placed.push_back({ offset, req.size, img.first_use, img.last_use });
+
+            images.offsets[i] = offset;
+            images.size       = std::max(images.size, offset + req.size);
+        }
+
+        const VkMemoryRequirements shared {
+            .size           = align_up(images.size, alignment),
+            .alignment      = alignment,
+            .memoryTypeBits = memory_type_bits,
+        };
+
+        auto alloc_info           = structs::create::allocation();
+        alloc_info.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        alloc_info.flags          = vkflag(memory_flag::dedicated_memory);
+
+        if (auto res = vmaAllocateMemory(m_device->allocator, &shared, &alloc_info, &images.allocation, nullptr);
+            res != vkres::ok)
+        {
+            return error_t { "Could not allocate aliased image memory: {}", vkres::get_repr(res) };
+        }
+
+        for (size_t i = 0; i < m_images.size(); ++i)
+        {
+            if (auto res = vmaBindImageMemory2(m_device->allocator, images.allocation, images.offsets[i], images.handles[i], nullptr);
+                res != vkres::ok)
+            {
+                return error_t { "Could not bind aliased image memory: {}", vkres::get_repr(res) };
+            }
+        }
+
+        return images;
+    }
+} // namespace orb::vk
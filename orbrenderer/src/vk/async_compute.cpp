@@ -0,0 +1,252 @@
+#include "orb/vk/async_compute.hpp"
+
+#include "vk/legacy_sync.hpp"
+
+namespace orb::vk
+{
+    namespace
+    {
+        /* @brief Only writes need to be made available */
+        auto written(const usage_info_t& info) -> VkAccessFlags2
+        {
+            return info.writes ? info.access : VK_ACCESS_2_NONE;
+        }
+    } // namespace
+
+    auto compute_job_t::acquire(VkBuffer buffer, resource_usage graphics_usage, resource_usage compute_usage)
+        -> compute_job_t&
+    {
+        m_inputs.push_back({ .buffer = buffer, .src_usage = graphics_usage, .dst_usage = compute_usage });
+        m_owner->record(cmd.handle,
+                        { &m_inputs.back(), 1 },
+                        m_owner->m_graphics_qf,
+                        m_owner->m_compute_qf,
+                        async_compute_t::side::acquire);
+        return *this;
+    }
+
+    auto compute_job_t::acquire(VkImage                        image,
+                                resource_usage                 graphics_usage,
+                                resource_usage                 compute_usage,
+                                const VkImageSubresourceRange& range) -> compute_job_t&
+    {
+        m_inputs.push_back({ .image = image, .range = range, .src_usage = graphics_usage, .dst_usage = compute_usage });
+        m_owner->record(cmd.handle,
+                        { &m_inputs.back(), 1 },
+                        m_owner->m_graphics_qf,
+                        m_owner->m_compute_qf,
+                        async_compute_t::side::acquire);
+        return *this;
+    }
+
+    auto compute_job_t::release(VkBuffer buffer, resource_usage compute_usage, resource_usage graphics_usage)
+        -> compute_job_t&
+    {
+        m_outputs.push_back({ .buffer = buffer, .src_usage = compute_usage, .dst_usage = graphics_usage });
+        return *this;
+    }
+
+    auto compute_job_t::release(VkImage                        image,
+                                resource_usage                 compute_usage,
+                                resource_usage                 graphics_usage,
+                                const VkImageSubresourceRange& range) -> compute_job_t&
+    {
+        m_outputs.push_back({ .image = image, .range = range, .src_usage = compute_usage, .dst_usage = graphics_usage });
+        return *this;
+    }
+
+    auto async_compute_t::begin(frame_context_t& frames) -> result<compute_job_t>
+    {
+        auto cmd = frames.cmd(m_compute_qf);
+        if (!cmd) return cmd.error();
+
+        if (auto r = cmd.value().begin(command_buffer_usage_flag::one_time_submit); !r) return r.error();
+
+        compute_job_t job;
+        job.cmd     = cmd.value();
+        job.m_owner = this;
+
+        return job;
+    }
+
+    void async_compute_t::release_inputs(const compute_job_t& job, VkCommandBuffer graphics_cmd) const
+    {
+        record(graphics_cmd, job.m_inputs, m_graphics_qf, m_compute_qf, side::release);
+    }
+
+    auto async_compute_t::submit(compute_job_t& job, frame_sync_t& sync, submit_batch_t& submits) -> result<sync_point_t>
+    {
+        record(job.cmd.handle, job.m_outputs, m_compute_qf, m_graphics_qf, side::release);
+
+        if (auto r = job.cmd.end(); !r) return r.error();
+
+        job.m_done = sync.timeline(m_compute).next();
+
+        submits.submit(m_compute);
+
+        for (const auto& [point, stages] : job.m_waits)
+        {
+            submits.wait(point.semaphore, stages, point.value);
+        }
+
+        submits.cmd_buffer(job.cmd.handle).signal_timeline(job.m_done);
+
+        return job.m_done;
+    }
+
+    void async_compute_t::acquire_outputs(const compute_job_t& job, VkCommandBuffer graphics_cmd) const
+    {
+        record(graphics_cmd, job.m_outputs, m_compute_qf, m_graphics_qf, side::acquire);
+    }
+
+    void async_compute_t::record(VkCommandBuffer                  cmd,
+                                 std::span<const queue_handoff_t> handoffs,
+                                 ui32                             src_qf,
+                                 ui32                             dst_qf,
+                                 side                             s) const
+    {
+        if (handoffs.empty()) return;
+
+        const bool transfer = src_qf != dst_qf;
+
+        // Within one family the release is a no-op and the acquire a regular barrier. On another
+        // queue of the family, accesses before the semaphore wait are only reachable by chaining
+        // on it: all_commands covers whatever stages the wait blocks
+        if (!transfer && s == side::release) return;
+
+        std::vector<VkImageMemoryBarrier2>  images;
+        std::vector<VkBufferMemoryBarrier2> buffers;
+
+        for (const auto& h : handoffs)
+        {
+            const auto src = usage_info(h.src_usage);
+            const auto dst = usage_info(h.dst_usage);
+
+            VkPipelineStageFlags2 src_stages = src.stages;
+            VkAccessFlags2        src_access = written(src);
+            VkPipelineStageFlags2 dst_stages = dst.stages;
+            VkAccessFlags2        dst_access = dst.access;
+
+            if (transfer && s == side::release)
+            {
+                dst_stages = VK_PIPELINE_STAGE_2_NONE;
+                dst_access = VK_ACCESS_2_NONE;
+            }
+            else if (transfer)
+            {
+                src_stages = VK_PIPELINE_STAGE_2_NONE;
+                src_access = VK_ACCESS_2_NONE;
+            }
+            else if (dedicated())
+            {
+                src_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                src_access = VK_ACCESS_2_NONE;
+            }
+
+            const ui32 src_index = transfer ? src_qf : VK_QUEUE_FAMILY_IGNORED;
+            const ui32 dst_index = transfer ? dst_qf : VK_QUEUE_FAMILY_IGNORED;
+
+            if (h.image)
+            {
+                images.push_back({
+                    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                    .pNext               = nullptr,
+                    .srcStageMask        = src_stages,
+                    .srcAccessMask       = src_access,
+                    .dstStageMask        = dst_stages,
+                    .dstAccessMask       = dst_access,
+                    .oldLayout           = src.layout,
+                    .newLayout           = dst.layout,
+                    .srcQueueFamilyIndex = src_index,
+                    .dstQueueFamilyIndex = dst_index,
+                    .image               = h.image,
+                    .subresourceRange    = h.range,
+                });
+            }
+            else
+            {
+                buffers.push_back({
+                    .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                    .pNext               = nullptr,
+                    .srcStageMask        = src_stages,
+                    .srcAccessMask       = src_access,
+                    .dstStageMask        = dst_stages,
+                    .dstAccessMask       = dst_access,
+                    .srcQueueFamilyIndex = src_index,
+                    .dstQueueFamilyIndex = dst_index,
+                    .buffer              = h.buffer,
+                    .offset              = 0,
+                    .size                = VK_WHOLE_SIZE,
+                });
+            }
+        }
+
+        if (m_use_sync2)
+        {
+            VkDependencyInfo info {
+                .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .bufferMemoryBarrierCount = static_cast<ui32>(buffers.size()),
+                .pBufferMemoryBarriers    = buffers.data(),
+                .imageMemoryBarrierCount  = static_cast<ui32>(images.size()),
+                .pImageMemoryBarriers     = images.data(),
+            };
+
+            vkCmdPipelineBarrier2(cmd, &info);
+            return;
+        }
+
+        VkPipelineStageFlags2 src_stages = VK_PIPELINE_STAGE_2_NONE;
+        VkPipelineStageFlags2 dst_stages = VK_PIPELINE_STAGE_2_NONE;
+
+        std::vector<VkImageMemoryBarrier>  legacy_images;
+        std::vector<VkBufferMemoryBarrier> legacy_buffers;
+
+        for (const auto& b : images)
+        {
+            src_stages |= b.srcStageMask;
+            dst_stages |= b.dstStageMask;
+
+            legacy_images.push_back({
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .pNext               = nullptr,
+                .srcAccessMask       = legacy_access(b.srcAccessMask),
+                .dstAccessMask       = legacy_access(b.dstAccessMask),
+                .oldLayout           = b.oldLayout,
+                .newLayout           = b.newLayout,
+                .srcQueueFamilyIndex = b.srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = b.dstQueueFamilyIndex,
+                .image               = b.image,
+                .subresourceRange    = b.subresourceRange,
+            });
+        }
+
+        for (const auto& b : buffers)
+        {
+            src_stages |= b.srcStageMask;
+            dst_stages |= b.dstStageMask;
+
+            legacy_buffers.push_back({
+                .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .pNext               = nullptr,
+                .srcAccessMask       = legacy_access(b.srcAccessMask),
+                .dstAccessMask       = legacy_access(b.dstAccessMask),
+                .srcQueueFamilyIndex = b.srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = b.dstQueueFamilyIndex,
+                .buffer              = b.buffer,
+                .offset              = b.offset,
+                .size                = b.size,
+            });
+        }
+
+        vkCmdPipelineBarrier(cmd,
+                             legacy_stages(src_stages, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                             legacy_stages(dst_stages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT),
+                             0,
+                             0,
+                             nullptr,
+                             static_cast<ui32>(legacy_buffers.size()),
+                             legacy_buffers.data(),
+                             static_cast<ui32>(legacy_images.size()),
+                             legacy_images.data());
+    }
+} // namespace orb::vk
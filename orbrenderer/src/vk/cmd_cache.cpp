@@ -0,0 +1,94 @@
+#include "orb/vk/cmd_cache.hpp"
+
+#include "orb/profiler.hpp"
+
+namespace orb::vk
+{
+    void cmd_cache_t::begin_frame(ui32 slot)
+    {
+        m_slot     = slot % m_slots.size();
+        m_recorded = 0;
+        m_reused   = 0;
+    }
+
+    auto cmd_cache_t::segment(ui32 id, const cmd_segment_key_t& key, const segment_fn_t& fn) -> result<VkCommandBuffer>
+    {
+        if (id >= m_versions.size()) m_versions.resize(id + 1, 0);
+
+        auto& slot = m_slots[m_slot];
+        if (id >= slot.entries.size()) slot.entries.resize(id + 1);
+
+        auto& entry = slot.entries[id];
+
+        if (entry.recorded && entry.key == key && entry.version == m_versions[id])
+        {
+            m_reused++;
+            return entry.handle;
+        }
+
+        ORB_PROFILE_ZONE("cmd_cache_t::segment record");
+
+        if (!entry.handle)
+        {
+            auto cmds = slot.pool->alloc_cmds(1, cmd_buffer_level::secondary);
+            if (!cmds) return cmds.error();
+
+            entry.handle = cmds.value().handles.front();
+        }
+
+        auto inheritance        = structs::cmd_buffer_inheritance();
+        inheritance.renderPass  = key.render_pass;
+        inheritance.subpass     = key.subpass;
+        inheritance.framebuffer = nullptr;
+
+        // The pool allows individual resets, so beginning discards the previous recording
+        entry.recorded = false;
+
+        cmd_buffer_t cmd { .handle = entry.handle };
+        if (auto r = cmd.begin_secondary(inheritance, command_buffer_usage_flag {}); !r) return r.error();
+
+        fn(cmd);
+
+        if (auto r = cmd.end(); !r) return r.error();
+
+        entry.key      = key;
+        entry.version  = m_versions[id];
+        entry.recorded = true;
+        m_recorded++;
+
+        return entry.handle;
+    }
+
+    void cmd_cache_t::invalidate(ui32 id)
+    {
+        if (id < m_versions.size()) m_versions[id]++;
+    }
+
+    void cmd_cache_t::invalidate_all()
+    {
+        for (auto& version : m_versions)
+        {
+            version++;
+        }
+    }
+
+    auto cmd_cache_builder_t::build() -> result<box<cmd_cache_t>>
+    {
+        auto cache = make_box<cmd_cache_t>();
+        cache->m_slots.resize(m_frames_in_flight);
+
+        for (auto& slot : cache->m_slots)
+        {
+            auto pool = cmd_pool_builder_t::prepare(m_device, m_qf_index)
+                            .unwrap()
+                            .flag(command_pool_create_flag::reset_command_buffer)
+                            .build();
+
+            if (!pool) return pool.error();
+
+            slot.pool = std::move(pool.value());
+        }
+
+        return cache;
+    }
+} // namespace orb::vk
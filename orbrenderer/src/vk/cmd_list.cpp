@@ -0,0 +1,619 @@
+#include "orb/vk/cmd_list.hpp"
+
+#include "orb/profiler.hpp"
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+namespace orb::vk
+{
+    namespace
+    {
+        // Every command starts 8 byte aligned, so handle arrays can be passed to Vulkan in place
+        constexpr size_t cmd_alignment = 8;
+
+        constexpr size_t no_draw = ~size_t { 0 };
+
+        constexpr ui32 bind_slots          = 3; // graphics, compute, ray tracing
+        constexpr ui32 max_tracked_sets    = 8;
+        constexpr ui32 max_tracked_buffers = 16;
+
+        struct cmd_header_t
+        {
+            cmd_type type;
+            ui32     size; // header, payload, trailing arrays and padding
+        };
+
+        static_assert(sizeof(cmd_header_t) == cmd_alignment);
+
+        struct pipeline_cmd_t
+        {
+            VkPipelineBindPoint bind_point;
+            VkPipeline          pipeline;
+        };
+
+        // Followed by `set_count` sets then `offset_count` dynamic offsets
+        struct desc_sets_cmd_t
+        {
+            VkPipelineBindPoint bind_point;
+            VkPipelineLayout    layout;
+            ui32                first_set;
+            ui32                set_count;
+            ui32                offset_count;
+        };
+
+        // Followed by `count` buffers then `count` offsets
+        struct vertex_buffers_cmd_t
+        {
+            ui32 first_binding;
+            ui32 count;
+        };
+
+        struct index_buffer_cmd_t
+        {
+            VkBuffer     buffer;
+            VkDeviceSize offset;
+            VkIndexType  type;
+        };
+
+        // Followed by `size` bytes
+        struct push_constants_cmd_t
+        {
+            VkPipelineLayout   layout;
+            VkShaderStageFlags stages;
+            ui32               offset;
+            ui32               size;
+        };
+
+        struct draw_cmd_t
+        {
+            ui32 vertex_count;
+            ui32 instance_count;
+            ui32 first_vertex;
+            ui32 first_instance;
+        };
+
+        struct draw_indexed_cmd_t
+        {
+            ui32 index_count;
+            ui32 instance_count;
+            ui32 first_index;
+            i32  vertex_offset;
+            ui32 first_instance;
+        };
+
+        struct dispatch_cmd_t
+        {
+            ui32 x;
+            ui32 y;
+            ui32 z;
+        };
+
+        template <typename T>
+        auto load(const std::byte* at) -> T
+        {
+            T value;
+            std::memcpy(&value, at, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void store(std::byte* at, const T& value)
+        {
+            std::memcpy(at, &value, sizeof(T));
+        }
+
+        /* @brief Appends a command to `out`, returns where its trailing arrays go */
+        template <typename T>
+        auto append(std::vector<std::byte>& out, cmd_type type, const T& payload, size_t tail_size = 0) -> std::byte*
+        {
+            const size_t unpadded = sizeof(cmd_header_t) + sizeof(T) + tail_size;
+            const size_t size     = (unpadded + cmd_alignment - 1) & ~(cmd_alignment - 1);
+            const size_t at       = out.size();
+
+            out.resize(at + size);
+
+            store(out.data() + at, cmd_header_t { .type = type, .size = static_cast<ui32>(size) });
+            store(out.data() + at + sizeof(cmd_header_t), payload);
+
+            return out.data() + at + sizeof(cmd_header_t) + sizeof(T);
+        }
+
+        template <typename T>
+        auto payload(const std::byte* cmd) -> T
+        {
+            return load<T>(cmd + sizeof(cmd_header_t));
+        }
+
+        template <typename T>
+        auto tail(const std::byte* cmd) -> const std::byte*
+        {
+            return cmd + sizeof(cmd_header_t) + sizeof(T);
+        }
+
+        template <typename TFn>
+        void for_each_cmd(const std::vector<std::byte>& data, TFn&& fn)
+        {
+            for (size_t at = 0; at < data.size();)
+            {
+                const auto header = load<cmd_header_t>(data.data() + at);
+                fn(header.type, data.data() + at, header.size);
+                at += header.size;
+            }
+        }
+
+        auto bind_slot(VkPipelineBindPoint bind_point) -> ui32
+        {
+            switch (bind_point)
+            {
+            case VK_PIPELINE_BIND_POINT_GRAPHICS:
+                return 0;
+            case VK_PIPELINE_BIND_POINT_COMPUTE:
+                return 1;
+            default:
+                return 2;
+            }
+        }
+
+        auto same(const VkViewport& a, const VkViewport& b) -> bool
+        {
+            return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height
+                && a.minDepth == b.minDepth && a.maxDepth == b.maxDepth;
+        }
+
+        auto same(const VkRect2D& a, const VkRect2D& b) -> bool
+        {
+            return a.offset.x == b.offset.x && a.offset.y == b.offset.y
+                && a.extent.width == b.extent.width && a.extent.height == b.extent.height;
+        }
+
+        using tracked_sets_t = std::array<VkDescriptorSet, max_tracked_sets>;
+
+        /* @brief What the command buffer has bound at a point of the list, null when unknown */
+        struct bound_state_t
+        {
+            std::array<VkPipeline, bind_slots>            pipelines {};
+            std::array<VkPipelineLayout, bind_slots>      layouts {};
+            std::array<tracked_sets_t, bind_slots>        sets {};
+            std::array<VkBuffer, max_tracked_buffers>     vertex_buffers {};
+            std::array<VkDeviceSize, max_tracked_buffers> vertex_offsets {};
+            VkBuffer                                      index_buffer = nullptr;
+            VkDeviceSize                                  index_offset = 0;
+            VkIndexType                                   index_type   = VK_INDEX_TYPE_MAX_ENUM;
+            std::optional<VkViewport>                     viewport;
+            std::optional<VkRect2D>                       scissor;
+        };
+
+        /* @brief Updates `state` with a descriptor set bind, returns false if it binds nothing new */
+        auto track_sets(bound_state_t& state, const std::byte* cmd) -> bool
+        {
+            const auto  c    = payload<desc_sets_cmd_t>(cmd);
+            const ui32  slot = bind_slot(c.bind_point);
+            auto&       sets = state.sets[slot];
+            const auto* data = tail<desc_sets_cmd_t>(cmd);
+
+            const bool tracked = c.first_set + c.set_count <= max_tracked_sets;
+
+            // Dynamic offsets can change between binds of the same set, they are never skipped
+            if (tracked && c.offset_count == 0 && c.layout == state.layouts[slot])
+            {
+                bool redundant = true;
+                for (ui32 i = 0; i < c.set_count && redundant; ++i)
+                {
+                    const auto set = load<VkDescriptorSet>(data + i * sizeof(VkDescriptorSet));
+                    redundant      = set && set == sets[c.first_set + i];
+                }
+
+                if (redundant) return false;
+            }
+
+            // Another layout may disturb the sets bound with the previous one
+            if (c.layout != state.layouts[slot])
+            {
+                sets.fill(nullptr);
+                state.layouts[slot] = c.layout;
+            }
+
+            for (ui32 i = 0; i < c.set_count && c.first_set + i < max_tracked_sets; ++i)
+            {
+                sets[c.first_set + i] = c.offset_count == 0
+                                          ? load<VkDescriptorSet>(data + i * sizeof(VkDescriptorSet))
+                                          : nullptr;
+            }
+
+            return true;
+        }
+
+        /* @brief Updates `state` with a vertex buffer bind, returns false if it binds nothing new */
+        auto track_vertex_buffers(bound_state_t& state, const std::byte* cmd) -> bool
+        {
+            const auto  c       = payload<vertex_buffers_cmd_t>(cmd);
+            const auto* buffers = tail<vertex_buffers_cmd_t>(cmd);
+            const auto* offsets = buffers + c.count * sizeof(VkBuffer);
+
+            bool redundant = c.first_binding + c.count <= max_tracked_buffers;
+            for (ui32 i = 0; i < c.count && redundant; ++i)
+            {
+                const auto buffer = load<VkBuffer>(buffers + i * sizeof(VkBuffer));
+                const auto offset = load<VkDeviceSize>(offsets + i * sizeof(VkDeviceSize));
+
+                redundant = buffer
+                         && buffer == state.vertex_buffers[c.first_binding + i]
+                         && offset == state.vertex_offsets[c.first_binding + i];
+            }
+
+            if (redundant) return false;
+
+            for (ui32 i = 0; i < c.count && c.first_binding + i < max_tracked_buffers; ++i)
+            {
+                state.vertex_buffers[c.first_binding + i] = load<VkBuffer>(buffers + i * sizeof(VkBuffer));
+                state.vertex_offsets[c.first_binding + i] = load<VkDeviceSize>(offsets + i * sizeof(VkDeviceSize));
+            }
+
+            return true;
+        }
+
+        /* @brief Folds `next` into the instances of `prev` when it continues them */
+        template <typename T>
+        auto merge(std::byte* prev_cmd, const std::byte* next_cmd) -> bool
+        {
+            auto       prev = payload<T>(prev_cmd);
+            const auto next = payload<T>(next_cmd);
+
+            if constexpr (std::is_same_v<T, draw_indexed_cmd_t>)
+            {
+                if (prev.index_count != next.index_count
+                    || prev.first_index != next.first_index
+                    || prev.vertex_offset != next.vertex_offset)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if (prev.vertex_count != next.vertex_count || prev.first_vertex != next.first_vertex) return false;
+            }
+
+            if (static_cast<ui64>(prev.first_instance) + prev.instance_count != next.first_instance) return false;
+            if (static_cast<ui64>(prev.instance_count) + next.instance_count > ~ui32 { 0 }) return false;
+
+            prev.instance_count += next.instance_count;
+            store(prev_cmd + sizeof(cmd_header_t), prev);
+
+            return true;
+        }
+    } // namespace
+
+    void cmd_list_t::reset()
+    {
+        m_data.clear();
+        m_count = 0;
+    }
+
+    void cmd_list_t::bind_pipeline(VkPipelineBindPoint bind_point, VkPipeline pipeline)
+    {
+        append(m_data, cmd_type::bind_pipeline, pipeline_cmd_t { .bind_point = bind_point, .pipeline = pipeline });
+        m_count++;
+    }
+
+    void cmd_list_t::bind_desc_sets(VkPipelineBindPoint              bind_point,
+                                    VkPipelineLayout                 layout,
+                                    ui32                             first_set,
+                                    std::span<const VkDescriptorSet> sets,
+                                    std::span<const ui32>            dynamic_offsets)
+    {
+        const desc_sets_cmd_t c {
+            .bind_point   = bind_point,
+            .layout       = layout,
+            .first_set    = first_set,
+            .set_count    = static_cast<ui32>(sets.size()),
+            .offset_count = static_cast<ui32>(dynamic_offsets.size()),
+        };
+
+        auto* data = append(m_data, cmd_type::bind_desc_sets, c, sets.size_bytes() + dynamic_offsets.size_bytes());
+        if (!sets.empty()) std::memcpy(data, sets.data(), sets.size_bytes());
+        if (!dynamic_offsets.empty()) std::memcpy(data + sets.size_bytes(), dynamic_offsets.data(), dynamic_offsets.size_bytes());
+
+        m_count++;
+    }
+
+    void cmd_list_t::bind_vertex_buffers(ui32                          first_binding,
+                                         std::span<const VkBuffer>     buffers,
+                                         std::span<const VkDeviceSize> offsets)
+    {
+        orbassert(buffers.size() == offsets.size(), "Each vertex buffer needs an offset");
+
+        const vertex_buffers_cmd_t c { .first_binding = first_binding, .count = static_cast<ui32>(buffers.size()) };
+
+        auto* data = append(m_data, cmd_type::bind_vertex_buffers, c, buffers.size_bytes() + offsets.size_bytes());
+        if (!buffers.empty())
+        {
+            std::memcpy(data, buffers.data(), buffers.size_bytes());
+            std::memcpy(data + buffers.size_bytes(), offsets.data(), offsets.size_bytes());
+        }
+
+        m_count++;
+    }
+
+    void cmd_list_t::bind_index_buffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type)
+    {
+        append(m_data, cmd_type::bind_index_buffer, index_buffer_cmd_t { .buffer = buffer, .offset = offset, .type = type });
+        m_count++;
+    }
+
+    void cmd_list_t::set_viewport(const VkViewport& viewport)
+    {
+        append(m_data, cmd_type::set_viewport, viewport);
+        m_count++;
+    }
+
+    void cmd_list_t::set_scissor(const VkRect2D& scissor)
+    {
+        append(m_data, cmd_type::set_scissor, scissor);
+        m_count++;
+    }
+
+    void cmd_list_t::push_constants(VkPipelineLayout           layout,
+                                    VkShaderStageFlags         stages,
+                                    ui32                       offset,
+                                    std::span<const std::byte> data)
+    {
+        const push_constants_cmd_t c {
+            .layout = layout,
+            .stages = stages,
+            .offset = offset,
+            .size   = static_cast<ui32>(data.size()),
+        };
+
+        auto* bytes = append(m_data, cmd_type::push_constants, c, data.size());
+        if (!data.empty()) std::memcpy(bytes, data.data(), data.size());
+
+        m_count++;
+    }
+
+    void cmd_list_t::draw(ui32 vertex_count, ui32 instance_count, ui32 first_vertex, ui32 first_instance)
+    {
+        const draw_cmd_t c {
+            .vertex_count   = vertex_count,
+            .instance_count = instance_count,
+            .first_vertex   = first_vertex,
+            .first_instance = first_instance,
+        };
+
+        append(m_data, cmd_type::draw, c);
+        m_count++;
+    }
+
+    void cmd_list_t::draw_indexed(ui32 index_count, ui32 instance_count, ui32 first_index, i32 vertex_offset, ui32 first_instance)
+    {
+        const draw_indexed_cmd_t c {
+            .index_count    = index_count,
+            .instance_count = instance_count,
+            .first_index    = first_index,
+            .vertex_offset  = vertex_offset,
+            .first_instance = first_instance,
+        };
+
+        append(m_data, cmd_type::draw_indexed, c);
+        m_count++;
+    }
+
+    void cmd_list_t::dispatch(ui32 x, ui32 y, ui32 z)
+    {
+        append(m_data, cmd_type::dispatch, dispatch_cmd_t { .x = x, .y = y, .z = z });
+        m_count++;
+    }
+
+    auto cmd_list_t::optimize() -> cmd_list_stats_t
+    {
+        ORB_PROFILE_ZONE("cmd_list_t::optimize");
+
+        cmd_list_stats_t stats;
+        stats.commands_in = m_count;
+
+        bound_state_t state;
+        size_t        last_draw = no_draw; // offset in m_scratch of the draw new draws can merge into
+        ui32          count     = 0;
+
+        m_scratch.clear();
+        m_scratch.reserve(m_data.size());
+
+        for_each_cmd(m_data, [&](cmd_type type, const std::byte* cmd, ui32 size) {
+            bool keep = true;
+
+            switch (type)
+            {
+            case cmd_type::bind_pipeline:
+            {
+                const auto c    = payload<pipeline_cmd_t>(cmd);
+                const ui32 slot = bind_slot(c.bind_point);
+
+                keep = c.pipeline != state.pipelines[slot];
+                if (keep)
+                {
+                    state.pipelines[slot] = c.pipeline;
+                    if (slot == 0)
+                    {
+                        state.viewport.reset();
+                        state.scissor.reset();
+                    }
+                }
+                else
+                {
+                    stats.dropped_binds++;
+                }
+                break;
+            }
+            case cmd_type::bind_desc_sets:
+                keep = track_sets(state, cmd);
+                if (!keep) stats.dropped_binds++;
+                break;
+            case cmd_type::bind_vertex_buffers:
+                keep = track_vertex_buffers(state, cmd);
+                if (!keep) stats.dropped_binds++;
+                break;
+            case cmd_type::bind_index_buffer:
+            {
+                const auto c = payload<index_buffer_cmd_t>(cmd);
+
+                keep = !c.buffer || c.buffer != state.index_buffer || c.offset != state.index_offset || c.type != state.index_type;
+                if (keep)
+                {
+                    state.index_buffer = c.buffer;
+                    state.index_offset = c.offset;
+                    state.index_type   = c.type;
+                }
+                else
+                {
+                    stats.dropped_binds++;
+                }
+                break;
+            }
+            case cmd_type::set_viewport:
+            {
+                const auto c = payload<VkViewport>(cmd);
+
+                keep = !state.viewport || !same(*state.viewport, c);
+                if (keep) state.viewport = c;
+                else stats.dropped_states++;
+                break;
+            }
+            case cmd_type::set_scissor:
+            {
+                const auto c = payload<VkRect2D>(cmd);
+
+                keep = !state.scissor || !same(*state.scissor, c);
+                if (keep) state.scissor = c;
+                else stats.dropped_states++;
+                break;
+            }
+            case cmd_type::draw:
+            case cmd_type::draw_indexed:
+            {
+                if (last_draw != no_draw && load<cmd_header_t>(m_scratch.data() + last_draw).type == type)
+                {
+                    const bool merged = type == cmd_type::draw
+                                          ? merge<draw_cmd_t>(m_scratch.data() + last_draw, cmd)
+                                          : merge<draw_indexed_cmd_t>(m_scratch.data() + last_draw, cmd);
+
+                    if (merged)
+                    {
+                        stats.merged_draws++;
+                        return;
+                    }
+                }
+
+                const size_t at = m_scratch.size();
+                m_scratch.insert(m_scratch.end(), cmd, cmd + size);
+                last_draw = at;
+                count++;
+                return;
+            }
+            case cmd_type::push_constants:
+            case cmd_type::dispatch:
+                break;
+            }
+
+            if (!keep) return;
+
+            // Anything recorded between two draws prevents merging them
+            m_scratch.insert(m_scratch.end(), cmd, cmd + size);
+            last_draw = no_draw;
+            count++;
+        });
+
+        m_data.swap(m_scratch);
+        m_count = count;
+
+        stats.commands_out = count;
+        return stats;
+    }
+
+    void cmd_list_t::replay(VkCommandBuffer cmd) const
+    {
+        ORB_PROFILE_ZONE("cmd_list_t::replay");
+
+        for_each_cmd(m_data, [cmd](cmd_type type, const std::byte* at, ui32) {
+            switch (type)
+            {
+            case cmd_type::bind_pipeline:
+            {
+                const auto c = payload<pipeline_cmd_t>(at);
+                vkCmdBindPipeline(cmd, c.bind_point, c.pipeline);
+                break;
+            }
+            case cmd_type::bind_desc_sets:
+            {
+                const auto  c    = payload<desc_sets_cmd_t>(at);
+                const auto* sets = tail<desc_sets_cmd_t>(at);
+
+                vkCmdBindDescriptorSets(cmd,
+                                        c.bind_point,
+                                        c.layout,
+                                        c.first_set,
+                                        c.set_count,
+                                        reinterpret_cast<const VkDescriptorSet*>(sets),
+                                        c.offset_count,
+                                        reinterpret_cast<const ui32*>(sets + c.set_count * sizeof(VkDescriptorSet)));
+                break;
+            }
+            case cmd_type::bind_vertex_buffers:
+            {
+                const auto  c       = payload<vertex_buffers_cmd_t>(at);
+                const auto* buffers = tail<vertex_buffers_cmd_t>(at);
+
+                vkCmdBindVertexBuffers(cmd,
+                                       c.first_binding,
+                                       c.count,
+                                       reinterpret_cast<const VkBuffer*>(buffers),
+                                       reinterpret_cast<const VkDeviceSize*>(buffers + c.count * sizeof(VkBuffer)));
+                break;
+            }
+            case cmd_type::bind_index_buffer:
+            {
+                const auto c = payload<index_buffer_cmd_t>(at);
+                vkCmdBindIndexBuffer(cmd, c.buffer, c.offset, c.type);
+                break;
+            }
+            case cmd_type::set_viewport:
+            {
+                const auto c = payload<VkViewport>(at);
+                vkCmdSetViewport(cmd, 0, 1, &c);
+                break;
+            }
+            case cmd_type::set_scissor:
+            {
+                const auto c = payload<VkRect2D>(at);
+                vkCmdSetScissor(cmd, 0, 1, &c);
+                break;
+            }
+            case cmd_type::push_constants:
+            {
+                const auto c = payload<push_constants_cmd_t>(at);
+                vkCmdPushConstants(cmd, c.layout, c.stages, c.offset, c.size, tail<push_constants_cmd_t>(at));
+                break;
+            }
+            case cmd_type::draw:
+            {
+                const auto c = payload<draw_cmd_t>(at);
+                vkCmdDraw(cmd, c.vertex_count, c.instance_count, c.first_vertex, c.first_instance);
+                break;
+            }
+            case cmd_type::draw_indexed:
+            {
+                const auto c = payload<draw_indexed_cmd_t>(at);
+                vkCmdDrawIndexed(cmd, c.index_count, c.instance_count, c.first_index, c.vertex_offset, c.first_instance);
+                break;
+            }
+            case cmd_type::dispatch:
+            {
+                const auto c = payload<dispatch_cmd_t>(at);
+                vkCmdDispatch(cmd, c.x, c.y, c.z);
+                break;
+            }
+            }
+        });
+    }
+} // namespace orb::vk
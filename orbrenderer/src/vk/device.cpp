@@ -1,11 +1,46 @@
 #include "orb/vk/device.hpp"
 
+#include "orb/profiler.hpp"
 #include "orb/vk/gpu.hpp"
 
 #include <orb/flux.hpp>
 
+#include <cstring>
+
 namespace orb::vk
 {
+    namespace
+    {
+        auto supports_present_wait(VkPhysicalDevice gpu) -> bool
+        {
+            ui32 count = 0;
+            vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, nullptr);
+            std::vector<VkExtensionProperties> available(count);
+            vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, available.data());
+
+            const auto has = [&](const char* name) {
+                for (const auto& ext : available)
+                {
+                    if (std::strcmp(ext.extensionName, name) == 0) return true;
+                }
+
+                return false;
+            };
+
+            if (!has(khr_extensions::present_id) || !has(khr_extensions::present_wait)) return false;
+
+            auto present_id   = structs::present_id_features();
+            auto present_wait = structs::present_wait_features();
+            auto features     = structs::physical_device_features();
+            features.pNext    = &present_id;
+            present_id.pNext  = &present_wait;
+
+            vkGetPhysicalDeviceFeatures2(gpu, &features);
+
+            return present_id.presentId == VK_TRUE && present_wait.presentWait == VK_TRUE;
+        }
+    } // namespace
+
     auto device_builder_t::prepare(VkInstance instance) -> result<device_builder_t>
     {
         device_builder_t d;
@@ -51,7 +86,21 @@ namespace orb::vk
 
     auto device_builder_t::build(gpu_t& gpu) -> result<box<device_t>>
     {
-        auto set_debug_name_fn = proc_addresses::set_debug_name(m_instance);
+        ORB_PROFILE_ZONE("device_builder_t::build");
+
+        auto set_debug_name_fn  = proc_addresses::set_debug_name(m_instance);
+        auto cmd_begin_label_fn = proc_addresses::cmd_begin_label(m_instance);
+        auto cmd_end_label_fn   = proc_addresses::cmd_end_label(m_instance);
+
+        const bool present_wait = m_present_wait && supports_present_wait(gpu.handle);
+
+        if (present_wait)
+        {
+            m_extensions.push_back(khr_extensions::present_id);
+            m_extensions.push_back(khr_extensions::present_wait);
+            m_present_id_features.presentId     = VK_TRUE;
+            m_present_wait_features.presentWait = VK_TRUE;
+        }
 
         auto create_info                    = structs::create::device();
         create_info.queueCreateInfoCount    = m_queue_infos_raw.size();
@@ -59,8 +108,29 @@ namespace orb::vk
         create_info.enabledExtensionCount   = m_extensions.size();
         create_info.ppEnabledExtensionNames = m_extensions.data();
 
+        // Feature chain: core, 1.2, 1.3, then extension structs
+        auto* tail = reinterpret_cast<VkBaseOutStructure*>(&m_features); // NOLINT
+
+        const auto chain = [&](void* features) {
+            tail->pNext = static_cast<VkBaseOutStructure*>(features);
+            tail        = tail->pNext;
+        };
+
+        if (m_use_features_12) chain(&m_features_12);
+        if (m_use_features_13) chain(&m_features_13);
+        for (auto* features : m_extension_features) chain(features);
+
+        if (present_wait)
+        {
+            chain(&m_present_id_features);
+            chain(&m_present_wait_features);
+        }
+
+        tail->pNext       = nullptr;
+        create_info.pNext = &m_features;
+
         auto device = make_box<device_t>();
-        auto res    = vkCreateDevice(gpu.handle, &create_info, nullptr, &device->handle);
+        auto res    = vkCreateDevice(gpu.handle, &create_info, host_callbacks(host_scope::device), &device->handle);
 
         if (res != vkres::ok)
         {
@@ -77,15 +147,37 @@ namespace orb::vk
             }
         }
 
-        auto allocator_info             = structs::create::allocator();
-        allocator_info.physicalDevice   = gpu.handle;
-        allocator_info.device           = device->handle;
-        allocator_info.instance         = m_instance;
-        allocator_info.pVulkanFunctions = nullptr;
+        auto allocator_info                 = structs::create::allocator();
+        allocator_info.physicalDevice       = gpu.handle;
+        allocator_info.device               = device->handle;
+        allocator_info.instance             = m_instance;
+        allocator_info.pVulkanFunctions     = nullptr;
+        allocator_info.pAllocationCallbacks = host_callbacks(host_scope::allocator);
 
         vmaCreateAllocator(&allocator_info, &device->allocator);
 
-        device->set_debug_name_fb = set_debug_name_fn;
+        device->physical_device    = gpu.handle;
+        device->set_debug_name_fb  = set_debug_name_fn;
+        device->cmd_begin_label_fb = cmd_begin_label_fn;
+        device->cmd_end_label_fb   = cmd_end_label_fn;
+        device->features           = m_features.features;
+
+        if (present_wait)
+        {
+            device->wait_for_present_fb = proc_addresses::wait_for_present(device->handle);
+        }
+
+        if (m_use_features_12)
+        {
+            device->features_12       = m_features_12;
+            device->features_12.pNext = nullptr;
+        }
+
+        if (m_use_features_13)
+        {
+            device->features_13       = m_features_13;
+            device->features_13.pNext = nullptr;
+        }
         return device;
     }
 } // namespace orb::vk
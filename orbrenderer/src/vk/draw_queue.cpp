@@ -0,0 +1,180 @@
+#include "orb/vk/draw_queue.hpp"
+
+#include "orb/profiler.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace orb::vk
+{
+    namespace
+    {
+        constexpr ui32 radix_bits    = 8;
+        constexpr ui32 radix_buckets = 1 << radix_bits;
+        constexpr ui32 radix_passes  = 64 / radix_bits;
+
+        // Below this, the histograms cost more than a comparison sort
+        constexpr size_t radix_threshold = 256;
+
+        constexpr ui32 depth_max = (1u << 24) - 1;
+
+        auto bits(ui32 value, ui32 width) -> ui64
+        {
+            return static_cast<ui64>(value) & ((1ull << width) - 1);
+        }
+    } // namespace
+
+    auto draw_key_t::pack() const -> ui64
+    {
+        const auto quantized_depth = static_cast<ui32>(std::clamp(depth, 0.0f, 1.0f) * static_cast<f32>(depth_max));
+
+        return bits(layer, 4) << 60
+             | bits(pipeline, 12) << 48
+             | bits(desc_set, 12) << 36
+             | bits(mesh, 12) << 24
+             | bits(quantized_depth, 24);
+    }
+
+    void draw_queue_t::clear()
+    {
+        m_entries.clear();
+        m_items.clear();
+    }
+
+    void draw_queue_t::reserve(ui32 count)
+    {
+        m_entries.reserve(count);
+        m_scratch.reserve(count);
+        m_items.reserve(count);
+    }
+
+    void draw_queue_t::push(ui64 key, const draw_item_t& item)
+    {
+        m_entries.push_back({ .key = key, .index = static_cast<ui32>(m_items.size()) });
+        m_items.push_back(item);
+    }
+
+    void draw_queue_t::sort()
+    {
+        ORB_PROFILE_ZONE("draw_queue_t::sort");
+
+        const size_t count = m_entries.size();
+
+        if (count < radix_threshold)
+        {
+            std::ranges::stable_sort(m_entries, {}, &entry_t::key);
+            return;
+        }
+
+        // Every histogram in a single read of the keys
+        std::array<std::array<ui32, radix_buckets>, radix_passes> histograms {};
+
+        for (const auto& e : m_entries)
+        {
+            for (ui32 pass = 0; pass < radix_passes; ++pass)
+            {
+                histograms[pass][(e.key >> (pass * radix_bits)) & (radix_buckets - 1)]++;
+            }
+        }
+
+        m_scratch.resize(count);
+
+        for (ui32 pass = 0; pass < radix_passes; ++pass)
+        {
+            auto&      histogram = histograms[pass];
+            const ui32 shift     = pass * radix_bits;
+
+            // All keys share this byte, the pass would not move anything
+            if (histogram[(m_entries.front().key >> shift) & (radix_buckets - 1)] == count) continue;
+
+            ui32 offset = 0;
+            for (auto& bucket : histogram)
+            {
+                const ui32 size = bucket;
+                bucket          = offset;
+                offset         += size;
+            }
+
+            for (const auto& e : m_entries)
+            {
+                m_scratch[histogram[(e.key >> shift) & (radix_buckets - 1)]++] = e;
+            }
+
+            m_entries.swap(m_scratch);
+        }
+    }
+
+    auto draw_queue_t::record(VkCommandBuffer cmd) const -> draw_stats_t
+    {
+        ORB_PROFILE_ZONE("draw_queue_t::record");
+        return walk(cmd);
+    }
+
+    auto draw_queue_t::stats() const -> draw_stats_t
+    {
+        return walk(nullptr);
+    }
+
+    auto draw_queue_t::walk(VkCommandBuffer cmd) const -> draw_stats_t
+    {
+        draw_stats_t stats;
+
+        VkPipeline       pipeline      = nullptr;
+        VkPipelineLayout layout        = nullptr;
+        VkDescriptorSet  desc_set      = nullptr;
+        VkBuffer         vertex_buffer = nullptr;
+        VkBuffer         index_buffer  = nullptr;
+        VkIndexType      index_type    = VK_INDEX_TYPE_MAX_ENUM;
+
+        for (const auto& e : m_entries)
+        {
+            const auto& item = m_items[e.index];
+
+            if (item.pipeline != pipeline)
+            {
+                if (cmd) vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, item.pipeline);
+                pipeline = item.pipeline;
+                stats.pipeline_binds++;
+            }
+
+            // Sets stay bound across pipelines with compatible layouts, a layout change rebinds
+            if (item.desc_set && (item.desc_set != desc_set || item.layout != layout))
+            {
+                if (cmd) vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, item.layout, 0, 1, &item.desc_set, 0, nullptr);
+                desc_set = item.desc_set;
+                layout   = item.layout;
+                stats.set_binds++;
+            }
+
+            if (item.vertex_buffer != vertex_buffer)
+            {
+                const VkDeviceSize offset = 0;
+                if (cmd) vkCmdBindVertexBuffers(cmd, 0, 1, &item.vertex_buffer, &offset);
+                vertex_buffer = item.vertex_buffer;
+                stats.vertex_binds++;
+            }
+
+            if (item.index_buffer != index_buffer || item.index_type != index_type)
+            {
+                if (cmd) vkCmdBindIndexBuffer(cmd, item.index_buffer, 0, item.index_type);
+                index_buffer = item.index_buffer;
+                index_type   = item.index_type;
+                stats.index_binds++;
+            }
+
+            if (cmd)
+            {
+                vkCmdDrawIndexed(cmd,
+                                 item.index_count,
+                                 item.instance_count,
+                                 item.first_index,
+                                 item.vertex_offset,
+                                 item.first_instance);
+            }
+
+            stats.draws++;
+        }
+
+        return stats;
+    }
+} // namespace orb::vk
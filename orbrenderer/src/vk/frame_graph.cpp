@@ -0,0 +1,842 @@
+#include "orb/vk/frame_graph.hpp"
+
+#include "orb/profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace orb::vk
+{
+    namespace
+    {
+        constexpr ui64 fnv_offset = 14695981039346656037ull;
+        constexpr ui64 fnv_prime  = 1099511628211ull;
+
+        void hash_combine(ui64& h, ui64 value)
+        {
+            for (ui32 i = 0; i < 8; ++i)
+            {
+                h ^= (value >> (i * 8)) & 0xff;
+                h *= fnv_prime;
+            }
+        }
+
+        /* @brief Usages that overwrite the whole content without reading it */
+        auto discards(resource_usage usage) -> bool
+        {
+            switch (usage)
+            {
+            case resource_usage::color_attachment_write:
+            case resource_usage::compute_storage_write:
+            case resource_usage::transfer_dst:
+            case resource_usage::host_write:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        auto reads(resource_usage usage) -> bool
+        {
+            return usage != resource_usage::undefined && !discards(usage);
+        }
+
+        auto image_usage(resource_usage usage) -> VkImageUsageFlags
+        {
+            switch (usage)
+            {
+            case resource_usage::vertex_shader_read:
+            case resource_usage::fragment_shader_read:
+            case resource_usage::compute_shader_read:
+                return VK_IMAGE_USAGE_SAMPLED_BIT;
+            case resource_usage::compute_storage_read:
+            case resource_usage::compute_storage_write:
+            case resource_usage::compute_storage_read_write:
+                return VK_IMAGE_USAGE_STORAGE_BIT;
+            case resource_usage::color_attachment_write:
+            case resource_usage::color_attachment_read_write:
+                return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+            case resource_usage::depth_attachment_write:
+            case resource_usage::depth_attachment_read:
+                return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            case resource_usage::transfer_src:
+                return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            case resource_usage::transfer_dst:
+                return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            case resource_usage::general:
+                return VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+                     | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            default:
+                return 0;
+            }
+        }
+
+        /* @brief Stages a semaphore wait blocks for a usage, present and discard block everything */
+        auto wait_stages(resource_usage usage) -> VkPipelineStageFlags2
+        {
+            const auto stages = usage_info(usage).stages;
+            return stages == VK_PIPELINE_STAGE_2_NONE ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : stages;
+        }
+    } // namespace
+
+    auto graph_context_t::image(graph_resource_t id) const -> VkImage
+    {
+        return m_graph->image_handle(id);
+    }
+
+    auto graph_context_t::view(graph_resource_t id) const -> VkImageView
+    {
+        const auto& r = m_graph->m_resources[id];
+        if (r.imported) return r.import.view;
+
+        return m_graph->m_transients[m_graph->m_slot].views[m_graph->m_compiled[id].transient];
+    }
+
+    auto graph_context_t::buffer(graph_resource_t id) const -> VkBuffer
+    {
+        return m_graph->m_resources[id].buffer;
+    }
+
+    auto graph_context_t::extent(graph_resource_t id) const -> VkExtent2D
+    {
+        return m_graph->image_extent(m_graph->m_resources[id]);
+    }
+
+    auto graph_pass_builder_t::use(graph_resource_t id, resource_usage usage) -> graph_pass_builder_t&
+    {
+        orbassert(id < m_graph->m_resources.size(), "Unknown graph resource");
+
+        m_graph->m_passes[m_pass].uses.push_back({ id, usage });
+        return *this;
+    }
+
+    auto graph_pass_builder_t::side_effect() -> graph_pass_builder_t&
+    {
+        m_graph->m_passes[m_pass].side_effect = true;
+        return *this;
+    }
+
+    auto graph_pass_builder_t::execute(graph_execute_fn_t fn) -> graph_pass_builder_t&
+    {
+        m_graph->m_passes[m_pass].fn = std::move(fn);
+        return *this;
+    }
+
+    void frame_graph_t::reset()
+    {
+        m_resources.clear();
+        m_passes.clear();
+    }
+
+    auto frame_graph_t::create_image(std::string name, const graph_image_desc_t& desc) -> graph_resource_t
+    {
+        m_resources.push_back({ .name = std::move(name), .desc = desc });
+        return m_resources.size() - 1;
+    }
+
+    auto frame_graph_t::import_image(std::string name, const graph_import_t& image) -> graph_resource_t
+    {
+        m_resources.push_back({ .name = std::move(name), .imported = true, .import = image });
+        return m_resources.size() - 1;
+    }
+
+    auto frame_graph_t::import_buffer(std::string name, VkBuffer buffer) -> graph_resource_t
+    {
+        m_resources.push_back({ .name = std::move(name), .imported = true, .is_buffer = true, .buffer = buffer });
+        return m_resources.size() - 1;
+    }
+
+    auto frame_graph_t::add_pass(std::string name, graph_queue queue) -> graph_pass_builder_t
+    {
+        m_passes.push_back({ .name = std::move(name), .queue = queue });
+        return { this, static_cast<ui32>(m_passes.size() - 1) };
+    }
+
+    void frame_graph_t::output(graph_resource_t id, resource_usage final_usage)
+    {
+        m_resources[id].output      = true;
+        m_resources[id].final_usage = final_usage;
+    }
+
+    void frame_graph_t::wait(graph_resource_t id, VkSemaphore semaphore, VkPipelineStageFlags2 stages)
+    {
+        m_resources[id].wait_semaphore = semaphore;
+        m_resources[id].wait_stages    = stages;
+    }
+
+    void frame_graph_t::signal(graph_resource_t id, VkSemaphore semaphore)
+    {
+        m_resources[id].signal_semaphore = semaphore;
+    }
+
+    auto frame_graph_t::hash() const -> ui64
+    {
+        // Everything the schedule depends on, handles and callbacks excluded since they change
+        // every frame without affecting it
+        ui64 h = fnv_offset;
+
+        hash_combine(h, m_extent.width);
+        hash_combine(h, m_extent.height);
+
+        for (const auto& r : m_resources)
+        {
+            hash_combine(h, r.imported | r.is_buffer << 1 | r.output << 2 | (r.wait_semaphore != nullptr) << 3
+                                | (r.signal_semaphore != nullptr) << 4);
+            hash_combine(h, std::to_underlying(r.final_usage));
+            hash_combine(h, r.wait_stages);
+
+            if (!r.imported)
+            {
+                hash_combine(h, std::to_underlying(r.desc.format));
+                hash_combine(h, static_cast<ui64>(r.desc.extent.width) << 32 | r.desc.extent.height);
+                hash_combine(h, std::bit_cast<ui32>(r.desc.scale));
+                hash_combine(h, static_cast<ui64>(std::to_underlying(r.desc.aspect)) << 32 | r.desc.levels);
+            }
+        }
+
+        for (const auto& p : m_passes)
+        {
+            hash_combine(h, std::to_underlying(p.queue) | p.side_effect << 8 | p.uses.size() << 16);
+
+            for (const auto& u : p.uses)
+            {
+                hash_combine(h, static_cast<ui64>(u.resource) << 32 | std::to_underlying(u.usage));
+            }
+        }
+
+        return h;
+    }
+
+    auto frame_graph_t::queue(graph_queue kind) const -> const queue_t&
+    {
+        const auto& q = m_queues[std::to_underlying(kind)];
+        return q.handle ? q : m_queues[std::to_underlying(graph_queue::graphics)];
+    }
+
+    auto frame_graph_t::image_extent(const resource_t& r) const -> VkExtent2D
+    {
+        if (r.imported) return r.import.extent;
+        if (r.desc.extent.width != 0) return r.desc.extent;
+
+        return {
+            std::max(1u, static_cast<ui32>(std::lround(static_cast<f32>(m_extent.width) * r.desc.scale))),
+            std::max(1u, static_cast<ui32>(std::lround(static_cast<f32>(m_extent.height) * r.desc.scale))),
+        };
+    }
+
+    auto frame_graph_t::image_handle(graph_resource_t id) const -> VkImage
+    {
+        const auto& r = m_resources[id];
+        if (r.imported) return r.import.image;
+
+        return m_transients[m_slot].images.handles[m_compiled[id].transient];
+    }
+
+    auto frame_graph_t::compile() -> result<void>
+    {
+        ORB_PROFILE_ZONE("frame_graph_t::compile");
+
+        const ui64 h = hash();
+        if (m_generation != 0 && h == m_hash) return {};
+
+        const size_t pass_count = m_passes.size();
+
+        // Hazards in declaration order. Reads depend on the last writer (the data it needs),
+        // writes are ordered after the previous writer and the reads since (the data they destroy)
+        std::vector<std::vector<ui32>> successors(pass_count);
+        std::vector<std::vector<ui32>> producers(pass_count);
+        std::vector<ui32>              last_writer(m_resources.size(), none);
+        std::vector<std::vector<ui32>> readers(m_resources.size());
+
+        for (ui32 p = 0; p < pass_count; ++p)
+        {
+            for (const auto& u : m_passes[p].uses)
+            {
+                const ui32 writer = last_writer[u.resource];
+
+                if (reads(u.usage) && writer != none && writer != p)
+                {
+                    successors[writer].push_back(p);
+                    producers[p].push_back(writer);
+                }
+
+                if (!usage_info(u.usage).writes) continue;
+
+                if (writer != none && writer != p) successors[writer].push_back(p);
+
+                for (ui32 reader : readers[u.resource])
+                {
+                    if (reader != p) successors[reader].push_back(p);
+                }
+
+                readers[u.resource].clear();
+                last_writer[u.resource] = p;
+            }
+
+            for (const auto& u : m_passes[p].uses)
+            {
+                if (reads(u.usage) && last_writer[u.resource] != p) readers[u.resource].push_back(p);
+            }
+        }
+
+        // Culling: keep the side effects and the final writers of the outputs, then everything
+        // they read from
+        std::vector<bool> alive(pass_count, false);
+        std::vector<ui32> stack;
+
+        for (ui32 p = 0; p < pass_count; ++p)
+        {
+            if (m_passes[p].side_effect) stack.push_back(p);
+        }
+
+        for (graph_resource_t r = 0; r < m_resources.size(); ++r)
+        {
+            if (m_resources[r].output && last_writer[r] != none) stack.push_back(last_writer[r]);
+        }
+
+        while (!stack.empty())
+        {
+            const ui32 p = stack.back();
+            stack.pop_back();
+
+            if (alive[p]) continue;
+            alive[p] = true;
+
+            for (ui32 producer : producers[p])
+            {
+                stack.push_back(producer);
+            }
+        }
+
+        schedule(successors, alive);
+        build_batches();
+
+        if (auto r = build_transients(); !r) return r.error();
+
+        m_hash = h;
+        m_generation++;
+
+        return {};
+    }
+
+    void frame_graph_t::schedule(const std::vector<std::vector<ui32>>& successors, const std::vector<bool>& alive)
+    {
+        const size_t pass_count = m_passes.size();
+
+        std::vector<ui32> in_degree(pass_count, 0);
+
+        for (ui32 p = 0; p < pass_count; ++p)
+        {
+            if (!alive[p]) continue;
+
+            for (ui32 s : successors[p])
+            {
+                if (alive[s]) in_degree[s]++;
+            }
+        }
+
+        std::vector<ui32> ready;
+
+        for (ui32 p = 0; p < pass_count; ++p)
+        {
+            if (alive[p] && in_degree[p] == 0) ready.push_back(p);
+        }
+
+        m_order.clear();
+
+        // Kahn's algorithm, preferring the queue of the previous pass so batches stay long, then
+        // the declaration order
+        while (!ready.empty())
+        {
+            auto pick = ready.begin();
+
+            if (!m_order.empty())
+            {
+                const VkQueue current = queue(m_passes[m_order.back()].queue).handle;
+
+                auto same = std::ranges::find_if(ready, [&](ui32 p) { return queue(m_passes[p].queue).handle == current; });
+                if (same != ready.end()) pick = same;
+            }
+
+            const ui32 p = *pick;
+            ready.erase(pick);
+            m_order.push_back(p);
+
+            for (ui32 s : successors[p])
+            {
+                if (alive[s] && --in_degree[s] == 0)
+                {
+                    ready.insert(std::ranges::upper_bound(ready, s), s);
+                }
+            }
+        }
+    }
+
+    void frame_graph_t::add_wait(ui32 batch, ui32 producer, VkPipelineStageFlags2 stages)
+    {
+        auto& waits = m_batches[batch].waits;
+
+        // Timeline values only grow: waiting for the latest batch of a queue covers the earlier ones
+        for (auto& [other, other_stages] : waits)
+        {
+            if (m_batches[other].queue.handle == m_batches[producer].queue.handle)
+            {
+                other = std::max(other, producer);
+                other_stages |= stages;
+                return;
+            }
+        }
+
+        waits.emplace_back(producer, stages);
+    }
+
+    void frame_graph_t::build_batches()
+    {
+        m_batches.clear();
+        m_compiled.assign(m_resources.size(), {});
+
+        for (ui32 p : m_order)
+        {
+            const auto& q = queue(m_passes[p].queue);
+
+            if (m_batches.empty() || m_batches.back().queue.handle != q.handle)
+            {
+                m_batches.push_back({ .queue = q });
+            }
+
+            m_batches.back().passes.push_back(p);
+        }
+
+        // Every pass culled: an empty batch still consumes the imported wait semaphores and
+        // signals the imported signal semaphores
+        if (m_batches.empty()) m_batches.push_back({ .queue = queue(graph_queue::graphics) });
+
+        // Cross queue hazards, replayed in schedule order: the batch using a resource on another
+        // queue than its previous users waits for them. A layout transition rewrites the image,
+        // so a read in another layout than the previous use orders like a write
+        std::vector<ui32>              last_write(m_resources.size(), none);
+        std::vector<std::vector<ui32>> reads_since(m_resources.size());
+        std::vector<VkImageLayout>     last_layout(m_resources.size(), VK_IMAGE_LAYOUT_UNDEFINED);
+
+        for (ui32 r = 0; r < m_resources.size(); ++r)
+        {
+            if (m_resources[r].imported && !m_resources[r].is_buffer) last_layout[r] = m_resources[r].import.layout;
+        }
+
+        for (ui32 b = 0; b < m_batches.size(); ++b)
+        {
+            const VkQueue current = m_batches[b].queue.handle;
+
+            for (ui32 p : m_batches[b].passes)
+            {
+                for (const auto& u : m_passes[p].uses)
+                {
+                    auto& c = m_compiled[u.resource];
+                    if (c.first_batch == none) c.first_batch = b;
+                    c.last_batch = b;
+
+                    const ui32 writer = last_write[u.resource];
+
+                    if (writer != none && m_batches[writer].queue.handle != current)
+                    {
+                        add_wait(b, writer, wait_stages(u.usage));
+                    }
+
+                    const auto info = usage_info(u.usage);
+
+                    bool rewrites = info.writes;
+                    if (!m_resources[u.resource].is_buffer)
+                    {
+                        rewrites |= info.layout != last_layout[u.resource];
+                        last_layout[u.resource] = info.layout;
+                    }
+
+                    if (rewrites)
+                    {
+                        for (ui32 reader : reads_since[u.resource])
+                        {
+                            if (m_batches[reader].queue.handle != current) add_wait(b, reader, wait_stages(u.usage));
+                        }
+
+                        reads_since[u.resource].clear();
+                        last_write[u.resource] = b;
+                    }
+                    else
+                    {
+                        reads_since[u.resource].push_back(b);
+                    }
+                }
+            }
+        }
+    }
+
+    auto frame_graph_t::build_transients() -> result<void>
+    {
+        // Lifetimes in schedule steps
+        std::vector<ui32> first_step(m_resources.size(), none);
+        std::vector<ui32> last_step(m_resources.size(), none);
+        std::vector<VkImageUsageFlags> usages(m_resources.size(), 0);
+
+        for (ui32 step = 0; step < m_order.size(); ++step)
+        {
+            for (const auto& u : m_passes[m_order[step]].uses)
+            {
+                if (first_step[u.resource] == none) first_step[u.resource] = step;
+                last_step[u.resource] = step;
+                usages[u.resource] |= image_usage(u.usage);
+            }
+        }
+
+        std::vector<ui32> families;
+
+        for (const auto& batch : m_batches)
+        {
+            if (std::ranges::find(families, batch.queue.qf_index) == families.end())
+            {
+                families.push_back(batch.queue.qf_index);
+            }
+        }
+
+        m_transient_resources.clear();
+
+        for (graph_resource_t r = 0; r < m_resources.size(); ++r)
+        {
+            if (m_resources[r].imported || first_step[r] == none) continue;
+
+            if (m_resources[r].output) usages[r] |= image_usage(m_resources[r].final_usage);
+
+            m_compiled[r].transient = m_transient_resources.size();
+            m_transient_resources.push_back(r);
+        }
+
+        // The previous transients may still be in use by frames in flight
+        if (!m_transients.empty())
+        {
+            for (auto& slot : m_transients)
+            {
+                for (auto img : slot.images.handles)
+                {
+                    m_tracker.forget(img);
+                }
+            }
+
+            if (m_deletions.raw())
+            {
+                for (auto& slot : m_transients)
+                {
+                    m_deletions->defer(std::move(slot));
+                }
+            }
+            else
+            {
+                vkDeviceWaitIdle(m_device->handle);
+            }
+
+            m_transients.clear();
+        }
+
+        m_transients.resize(m_frames_in_flight);
+
+        for (auto& slot : m_transients)
+        {
+            slot.device = m_device->handle;
+
+            auto builder = aliased_images_builder_t::prepare(m_device).unwrap();
+
+            for (graph_resource_t r : m_transient_resources)
+            {
+                const auto& desc   = m_resources[r].desc;
+                const auto  extent = image_extent(m_resources[r]);
+
+                auto info          = structs::create::image();
+                info.format        = vkenum(desc.format);
+                info.extent        = { extent.width, extent.height, 1 };
+                info.mipLevels     = desc.levels;
+                info.arrayLayers   = 1;
+                info.samples       = VK_SAMPLE_COUNT_1_BIT;
+                info.tiling        = VK_IMAGE_TILING_OPTIMAL;
+                info.usage         = usages[r];
+                info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+                if (families.size() > 1)
+                {
+                    info.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+                    info.queueFamilyIndexCount = families.size();
+                    info.pQueueFamilyIndices   = families.data();
+                }
+
+                builder.image(info, first_step[r], last_step[r]);
+            }
+
+            if (m_transient_resources.empty()) continue;
+
+            auto images = builder.build();
+            if (!images) return images.error();
+
+            slot.images = std::move(images.value());
+
+            for (size_t t = 0; t < m_transient_resources.size(); ++t)
+            {
+                const auto& desc = m_resources[m_transient_resources[t]].desc;
+
+                auto info                        = structs::create::image_view();
+                info.image                       = slot.images.handles[t];
+                info.format                      = vkenum(desc.format);
+                info.subresourceRange.aspectMask = vkflag(desc.aspect);
+                info.subresourceRange.levelCount = desc.levels;
+
+                VkImageView view = nullptr;
+
+                if (auto res = vkCreateImageView(m_device->handle, &info, host_callbacks(host_scope::resources), &view);
+                    res != vkres::ok)
+                {
+                    return error_t { "Could not create view of graph image {}: {}",
+                                     m_resources[m_transient_resources[t]].name,
+                                     vkres::get_repr(res) };
+                }
+
+                slot.views.push_back(view);
+            }
+        }
+
+        if (m_transient_resources.empty()) return {};
+
+        // Images placed over the memory of an earlier one start from its last accesses
+        for (size_t a = 0; a < m_transient_resources.size(); ++a)
+        {
+            for (size_t b = 0; b < m_transient_resources.size(); ++b)
+            {
+                const graph_resource_t ra = m_transient_resources[a];
+                const graph_resource_t rb = m_transient_resources[b];
+
+                if (a == b || last_step[rb] >= first_step[ra]) continue;
+
+                const bool overlap = std::ranges::any_of(m_transients, [&](const graph_transients_t& slot) {
+                    return slot.images.overlap(a, b);
+                });
+
+                if (!overlap) continue;
+
+                auto& c          = m_compiled[ra];
+                c.aliased        = true;
+                const ui32 after = m_compiled[rb].last_batch;
+
+                if (m_batches[after].queue.handle != m_batches[c.first_batch].queue.handle)
+                {
+                    add_wait(c.first_batch, after, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+                }
+            }
+        }
+
+        return {};
+    }
+
+    void frame_graph_t::track(graph_resource_t id, resource_usage usage)
+    {
+        const auto& r = m_resources[id];
+
+        if (r.is_buffer)
+        {
+            m_tracker.use(r.buffer, usage);
+        }
+        else
+        {
+            m_tracker.use(image_handle(id), usage);
+        }
+    }
+
+    void frame_graph_t::enter(graph_resource_t id, ui32 batch)
+    {
+        if (m_entered[id] == batch) return;
+
+        const ui32  previous = m_entered[id];
+        const auto& r        = m_resources[id];
+        const auto& c        = m_compiled[id];
+        m_entered[id]        = batch;
+
+        if (r.is_buffer)
+        {
+            if (!m_tracker.tracked(r.buffer)) m_tracker.track_buffer(r.buffer);
+        }
+        else if (r.imported)
+        {
+            if (!m_tracker.tracked(r.import.image))
+            {
+                m_tracker.track_image(r.import.image, r.import.aspect, r.import.levels, 1, r.import.layout);
+            }
+        }
+        else if (previous == none)
+        {
+            // Transient content never outlives the frame
+            m_tracker.track_image(image_handle(id), r.desc.aspect, r.desc.levels);
+        }
+
+        // Accesses since the last batch on this queue are behind a semaphore wait: chain the next
+        // barrier on the stages that wait
+        VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+
+        if (previous == none)
+        {
+            if (r.wait_semaphore) stages |= r.wait_stages;
+            if (c.aliased) stages |= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        }
+        else if (m_batches[previous].queue.handle != m_batches[batch].queue.handle)
+        {
+            for (const auto& [producer, wait] : m_batches[batch].waits)
+            {
+                stages |= wait;
+            }
+        }
+
+        if (stages == VK_PIPELINE_STAGE_2_NONE) return;
+
+        if (r.is_buffer)
+        {
+            m_tracker.wait_external(r.buffer, stages);
+        }
+        else
+        {
+            m_tracker.wait_external(image_handle(id), stages);
+        }
+    }
+
+    auto frame_graph_t::execute(frame_context_t& frames, frame_sync_t& sync, submit_batch_t& submits) -> result<void>
+    {
+        orbassert(m_generation != 0 && m_compiled.size() == m_resources.size(), "Frame graph not compiled");
+
+        m_slot = frames.slot() % m_frames_in_flight;
+        m_entered.assign(m_resources.size(), none);
+        m_batch_points.resize(m_batches.size());
+
+        graph_context_t ctx;
+        ctx.slot    = m_slot;
+        ctx.m_graph = this;
+
+        const ui32 last_batch = m_batches.size() - 1;
+
+        for (ui32 b = 0; b < m_batches.size(); ++b)
+        {
+            const auto& batch = m_batches[b];
+
+            auto cmd_res = frames.cmd(batch.queue.qf_index);
+            if (!cmd_res) return cmd_res.error();
+
+            auto cmd = cmd_res.value();
+
+            if (auto r = cmd.begin(command_buffer_usage_flag::one_time_submit); !r) return r.error();
+
+            submits.submit(batch.queue.handle);
+
+            for (const auto& [producer, stages] : batch.waits)
+            {
+                submits.wait(m_batch_points[producer].semaphore, stages, m_batch_points[producer].value);
+            }
+
+            // Semaphores of resources no scheduled pass uses still have to be consumed
+            for (graph_resource_t id = 0; id < m_resources.size(); ++id)
+            {
+                const auto& r = m_resources[id];
+                if (!r.wait_semaphore) continue;
+
+                const ui32 first = m_compiled[id].first_batch;
+                if (first == b || (first == none && b == 0)) submits.wait(r.wait_semaphore, r.wait_stages);
+            }
+
+            ctx.cmd = cmd;
+
+            for (ui32 p : batch.passes)
+            {
+                const auto& pass = m_passes[p];
+
+                for (const auto& u : pass.uses)
+                {
+                    enter(u.resource, b);
+                    track(u.resource, u.usage);
+                }
+
+                m_tracker.flush(cmd.handle);
+
+                if (!pass.fn) continue;
+
+                gpu_zone_t zone;
+                if (m_profiler.raw()) zone = m_profiler->zone(cmd.handle, pass.name, batch.queue.qf_index);
+
+                pass.fn(ctx);
+            }
+
+            for (graph_resource_t id = 0; id < m_resources.size(); ++id)
+            {
+                if (m_resources[id].output && m_compiled[id].last_batch == b) track(id, m_resources[id].final_usage);
+            }
+
+            m_tracker.flush(cmd.handle);
+
+            if (auto r = cmd.end(); !r) return r.error();
+
+            m_batch_points[b] = sync.timeline(batch.queue.handle).next();
+
+            submits.cmd_buffer(cmd.handle).signal_timeline(m_batch_points[b]);
+
+            for (graph_resource_t id = 0; id < m_resources.size(); ++id)
+            {
+                const auto& r = m_resources[id];
+                if (!r.signal_semaphore) continue;
+
+                const ui32 last = m_compiled[id].last_batch;
+                if (last == b || (last == none && b == last_batch)) submits.signal(r.signal_semaphore);
+            }
+        }
+
+        return {};
+    }
+
+    auto frame_graph_t::transient_size() const -> VkDeviceSize
+    {
+        return m_transients.empty() ? 0 : m_transients.front().images.size;
+    }
+
+    auto frame_graph_t::unaliased_transient_size() const -> VkDeviceSize
+    {
+        return m_transients.empty() ? 0 : m_transients.front().images.unaliased_size;
+    }
+
+    void frame_graph_t::describe() const
+    {
+        fmt::println("- Frame graph (generation {})", m_generation);
+        fmt::println("  * {} passes scheduled, {} culled, {} batches",
+                     scheduled_passes(),
+                     culled_passes(),
+                     batches());
+        fmt::println("  * {} transient images: {} KiB, {} KiB without aliasing",
+                     m_transient_resources.size(),
+                     transient_size() / 1024,
+                     unaliased_transient_size() / 1024);
+
+        for (ui32 b = 0; b < m_batches.size(); ++b)
+        {
+            const auto& batch = m_batches[b];
+
+            fmt::println("  * Batch {} on queue family {}", b, batch.queue.qf_index);
+
+            for (const auto& [producer, stages] : batch.waits)
+            {
+                fmt::println("    waits for batch {} (stages {:#x})", producer, stages);
+            }
+
+            for (ui32 p : batch.passes)
+            {
+                fmt::println("    {}", m_passes[p].name);
+
+                for (const auto& u : m_passes[p].uses)
+                {
+                    const auto& r = m_resources[u.resource];
+                    fmt::println("      {} {}{}",
+                                 usage_info(u.usage).writes ? "writes" : "reads ",
+                                 r.name,
+                                 m_compiled[u.resource].aliased ? " (aliased)" : "");
+                }
+            }
+        }
+    }
+} // namespace orb::vk
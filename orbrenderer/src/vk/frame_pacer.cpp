@@ -0,0 +1,244 @@
+#include "orb/vk/frame_pacer.hpp"
+
+#include "orb/profiler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace orb::vk
+{
+    namespace
+    {
+        // Presents may never complete, e.g. while the window is minimized
+        constexpr ui64 wait_timeout = 100'000'000; // ns
+
+        // A wait returning faster found its present already displayed
+        constexpr f32 starved_ms = 0.1f;
+
+        // Share of the tuning window that must be starved without any delay to add a frame in flight
+        constexpr ui32 starved_limit = frame_pacer_t::tuning_window / 8;
+
+        // Windows to wait after adding a frame in flight before removing one
+        constexpr ui32 cooldown_windows = 4;
+
+        // Longer when a removed frame in flight had to be added back, the workload may change
+        constexpr ui32 revert_cooldown_windows = 16;
+
+        // Fraction of the latency error corrected on each frame
+        constexpr f32 delay_gain = 0.25f;
+
+        auto to_ms(pacing_clock_t::duration d) -> f32
+        {
+            return std::chrono::duration<f32, std::milli>(d).count();
+        }
+
+        // sleep_for overshoots by up to a scheduler tick, the last millisecond is spent yielding
+        void sleep_until(pacing_clock_t::time_point deadline)
+        {
+            for (auto now = pacing_clock_t::now(); now < deadline; now = pacing_clock_t::now())
+            {
+                if (deadline - now > std::chrono::milliseconds(1))
+                {
+                    std::this_thread::sleep_for(deadline - now - std::chrono::milliseconds(1));
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    } // namespace
+
+    auto frame_pacer_t::begin_frame() -> result<void>
+    {
+        ORB_PROFILE_ZONE("frame_pacer_t::begin_frame");
+
+        // Present ids start over with each swapchain
+        if (m_swapchain->generation != m_generation) reset();
+
+        if (!enabled() || m_next_id <= m_frames_in_flight) return {};
+
+        // Already waited on when a frame was dropped or a frame in flight was added
+        const ui64 id = m_next_id - m_frames_in_flight;
+        if (id <= m_waited_id) return {};
+
+        const auto start = pacing_clock_t::now();
+        const auto res   = m_device->wait_for_present_fb(m_device->handle, m_swapchain->handle, id, wait_timeout);
+        const auto end   = pacing_clock_t::now();
+
+        m_waited_id = id;
+
+        if (res == vkres::timeout || res == vkres::err_out_of_date_khr || res == vkres::err_surface_lost_khr)
+        {
+            // Nothing to measure, the swapchain is rebuilt on the next acquire
+            return {};
+        }
+
+        if (res != vkres::ok && res != vkres::suboptimal_khr)
+        {
+            return error_t { "Failed to wait for present {}: {}", id, vkres::get_repr(res) };
+        }
+
+        const f32 blocked_ms = to_ms(end - start);
+
+        // Consecutive displays give the refresh interval, or the frame interval with mailbox.
+        // A wait that did not block returned after the display, its time is not the display's
+        bool missed = false;
+
+        if (blocked_ms < starved_ms)
+        {
+            m_last_display_id = 0;
+        }
+        else
+        {
+            if (m_last_display_id != 0)
+            {
+                const f32 interval = to_ms(end - m_last_display) / static_cast<f32>(id - m_last_display_id);
+
+                // A missed display is not the refresh interval, but a slower display must win eventually
+                missed       = interval > 1.5f * m_refresh_ms;
+                m_refresh_ms = missed ? m_refresh_ms * 1.02f : m_refresh_ms + 0.1f * (interval - m_refresh_ms);
+            }
+
+            m_last_display    = end;
+            m_last_display_id = id;
+        }
+
+        // Measured up to the return of the wait, only an upper bound when it did not block
+        sample(to_ms(end - m_present_times[id % m_present_times.size()]), blocked_ms, missed);
+        tune();
+
+        if (m_delay_ms > 0.0f)
+        {
+            ORB_PROFILE_ZONE("frame_pacer_t::delay");
+            sleep_until(end + std::chrono::duration_cast<pacing_clock_t::duration>(std::chrono::duration<f32, std::milli>(m_delay_ms)));
+        }
+
+        return {};
+    }
+
+    void frame_pacer_t::presented(const img_res_t& res)
+    {
+        if (!enabled()) return;
+
+        // Suboptimal still presented the image
+        if (res.is_error() && res.error() != vkres::suboptimal_khr) return;
+
+        m_present_times[m_next_id % m_present_times.size()] = pacing_clock_t::now();
+        m_next_id++;
+    }
+
+    void frame_pacer_t::reset()
+    {
+        m_generation      = m_swapchain->generation;
+        m_next_id         = 1;
+        m_waited_id       = 0;
+        m_last_display_id = 0;
+        m_last_latency_ms = 0.0f;
+        m_frames          = 0;
+        m_sum_ms          = 0.0f;
+        m_starved         = 0;
+    }
+
+    void frame_pacer_t::sample(f32 latency_ms, f32 blocked_ms, bool missed)
+    {
+        m_latency.add(latency_ms);
+
+        m_frames++;
+        m_sum_ms += latency_ms;
+
+        const bool starved = blocked_ms < starved_ms;
+
+        // A delay pushing frames past their vblank shows as a latency jump of about a refresh
+        // interval, each frame still being displayed on time after that. Any of that delay would
+        // keep them there
+        const bool jumped = m_delay_ms > 0.0f && latency_ms > m_last_latency_ms + 0.5f * m_refresh_ms;
+        m_last_latency_ms = latency_ms;
+
+        if (starved || missed || jumped)
+        {
+            // Frames late for their display may be the delay's doing, drop it before blaming the
+            // frames in flight. Past a missed display the latency drops, more delay would not help
+            if (m_delay_ms > 0.0f)
+            {
+                m_delay_ms = m_delay_ms < 1.0f || jumped ? 0.0f : 0.5f * m_delay_ms;
+            }
+            else if (starved)
+            {
+                m_starved++;
+            }
+
+            return;
+        }
+
+        // The time spent blocked is slack: the delay may take it, short of a margin for the
+        // scheduling jitter of the sleep and of the frame itself
+        const f32 margin    = 0.25f * m_refresh_ms;
+        const f32 max_delay = std::max(0.0f, m_delay_ms + blocked_ms - margin);
+        m_delay_ms          = std::clamp(m_delay_ms + delay_gain * (latency_ms - target_latency()), 0.0f, max_delay);
+    }
+
+    void frame_pacer_t::tune()
+    {
+        if (m_frames < tuning_window) return;
+
+        const f32 average = m_sum_ms / static_cast<f32>(m_frames);
+
+        if (m_shrunk_interval_ms > 0.0f)
+        {
+            // Fewer frames in flight must not cost displayed frames: the CPU and the GPU may need
+            // the extra frame to overlap, without ever starving the display
+            if (m_refresh_ms > 1.25f * m_shrunk_interval_ms && m_frames_in_flight < m_max_frames)
+            {
+                m_frames_in_flight++;
+                m_delay_ms = 0.0f;
+                m_cooldown = revert_cooldown_windows;
+            }
+
+            m_shrunk_interval_ms = 0.0f;
+        }
+        else if (m_starved > starved_limit && m_frames_in_flight < m_max_frames)
+        {
+            // The display waits on the frames, not the other way around: queue one more
+            m_frames_in_flight++;
+            m_delay_ms = 0.0f;
+            m_cooldown = cooldown_windows;
+        }
+        else if (m_cooldown > 0)
+        {
+            m_cooldown--;
+        }
+        else if (m_starved <= starved_limit / 4 && average > target_latency() + 0.5f * m_refresh_ms && m_frames_in_flight > m_min_frames)
+        {
+            // The delay alone cannot bring the latency down, the queue is deeper than needed
+            m_frames_in_flight--;
+            m_shrunk_interval_ms = m_refresh_ms;
+        }
+
+        m_frames  = 0;
+        m_sum_ms  = 0.0f;
+        m_starved = 0;
+    }
+
+    auto frame_pacer_builder_t::build() -> result<box<frame_pacer_t>>
+    {
+        if (m_max_frames == 0 || m_min_frames == 0 || m_min_frames > m_max_frames)
+        {
+            return error_t { "Invalid frames in flight range [{}, {}]", m_min_frames, m_max_frames };
+        }
+
+        auto pacer                = make_box<frame_pacer_t>();
+        pacer->m_device           = m_device;
+        pacer->m_swapchain        = m_swapchain;
+        pacer->m_generation       = m_swapchain->generation;
+        pacer->m_min_frames       = m_min_frames;
+        pacer->m_max_frames       = m_max_frames;
+        pacer->m_frames_in_flight = m_max_frames;
+        pacer->m_target_ms        = m_target_ms;
+        pacer->m_latency.name     = "present latency";
+
+        pacer->m_present_times.resize(m_max_frames + 1);
+
+        return pacer;
+    }
+} // namespace orb::vk
@@ -0,0 +1,392 @@
+#include "orb/vk/gpu_culling.hpp"
+
+#include "orb/profiler.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace orb::vk
+{
+    namespace
+    {
+        // One invocation per object, survivors append their draw through the counter
+        constexpr std::string_view cull_source = R"(#version 450
+            layout(local_size_x = 64) in;
+
+            struct object_t
+            {
+                vec4 sphere;
+                uint index_count;
+                uint first_index;
+                int  vertex_offset;
+                uint instance;
+            };
+
+            struct draw_t
+            {
+                uint index_count;
+                uint instance_count;
+                uint first_index;
+                int  vertex_offset;
+                uint first_instance;
+            };
+
+            layout(std430, set = 0, binding = 0) readonly buffer objects_b { object_t objects[]; };
+            layout(std430, set = 0, binding = 1) writeonly buffer draws_b { draw_t draws[]; };
+            layout(std430, set = 0, binding = 2) buffer count_b { uint draw_count; };
+
+            layout(push_constant) uniform constants_b
+            {
+                vec4 planes[6];
+                uint object_count;
+            } pc;
+
+            void main()
+            {
+                uint i = gl_GlobalInvocationID.x;
+                if (i >= pc.object_count) return;
+
+                object_t o = objects[i];
+
+                for (int p = 0; p < 6; ++p)
+                {
+                    if (dot(pc.planes[p].xyz, o.sphere.xyz) + pc.planes[p].w < -o.sphere.w) return;
+                }
+
+                uint slot   = atomicAdd(draw_count, 1);
+                draws[slot] = draw_t(o.index_count, 1, o.first_index, o.vertex_offset, o.instance);
+            }
+        )";
+
+        constexpr ui32 cull_group_size = 64;
+
+        struct cull_constants_t
+        {
+            std::array<glm::vec4, 6> planes;
+            ui32                     object_count;
+        };
+
+        void memory_barrier(VkCommandBuffer      cmd,
+                            VkPipelineStageFlags src_stage,
+                            VkAccessFlags        src_access,
+                            VkPipelineStageFlags dst_stage,
+                            VkAccessFlags        dst_access)
+        {
+            VkMemoryBarrier barrier {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .pNext         = nullptr,
+                .srcAccessMask = src_access,
+                .dstAccessMask = dst_access,
+            };
+
+            vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+    } // namespace
+
+    auto frustum_t::from_view_proj(const glm::mat4& view_proj) -> frustum_t
+    {
+        // glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const auto row = [&](int i) {
+            return glm::vec4(view_proj[0][i], view_proj[1][i], view_proj[2][i], view_proj[3][i]);
+        };
+
+        frustum_t f;
+        f.planes = {
+            row(3) + row(0), // left
+            row(3) - row(0), // right
+            row(3) + row(1), // bottom
+            row(3) - row(1), // top
+            row(3) + row(2), // near
+            row(3) - row(2), // far
+        };
+
+        // Normalized, so the plane distance can be compared with the sphere radius
+        for (auto& p : f.planes)
+        {
+            p /= glm::length(glm::vec3(p));
+        }
+
+        return f;
+    }
+
+    void gpu_culling_t::destroy()
+    {
+        for (auto& frame : m_frames)
+        {
+            destroy_buffer(frame.objects);
+            destroy_buffer(frame.draws);
+            destroy_buffer(frame.count);
+            destroy_buffer(frame.readback);
+        }
+
+        m_objects.clear();
+        m_frames.clear();
+        m_desc_pool.destroy();
+        m_current = nullptr;
+    }
+
+    auto gpu_culling_t::objects(std::span<const gpu_object_t> objects) -> result<void>
+    {
+        if (objects.size() > m_max_objects)
+        {
+            return error_t { "Could not write {} culled objects: capacity is {}", objects.size(), m_max_objects };
+        }
+
+        m_objects.assign(objects.begin(), objects.end());
+        m_object_count = static_cast<ui32>(objects.size());
+        m_objects_version++;
+
+        return {};
+    }
+
+    auto gpu_culling_t::begin_frame(ui32 slot) -> result<void>
+    {
+        auto& frame = m_frames[slot % m_frames.size()];
+        m_current   = &frame;
+
+        // The slot's previous cull completed, its copy of the objects can be overwritten
+        if (frame.objects_version != m_objects_version)
+        {
+            const std::span<const gpu_object_t> objects = m_objects;
+
+            if (!objects.empty()) std::memcpy(frame.objects.ptr, objects.data(), objects.size_bytes());
+
+            if (auto res = vmaFlushAllocation(m_device->allocator, frame.objects.allocation, 0, objects.size_bytes());
+                res != vkres::ok)
+            {
+                return error_t { "Could not flush culled objects: {}", vkres::get_repr(res) };
+            }
+
+            frame.object_count    = m_object_count;
+            frame.objects_version = m_objects_version;
+        }
+
+        if (!frame.recorded) return {};
+
+        if (auto res = vmaInvalidateAllocation(m_device->allocator, frame.readback.allocation, 0, sizeof(ui32));
+            res != vkres::ok)
+        {
+            return error_t { "Could not read the culled draw count: {}", vkres::get_repr(res) };
+        }
+
+        std::memcpy(&m_visible_count, frame.readback.ptr, sizeof(ui32));
+        frame.recorded = false;
+
+        return {};
+    }
+
+    void gpu_culling_t::record_cull(VkCommandBuffer cmd, const frustum_t& frustum)
+    {
+        ORB_PROFILE_ZONE("gpu_culling_t::record_cull");
+        orbassert(m_current != nullptr, "gpu_culling_t::begin_frame was not called");
+
+        auto& frame = *m_current;
+
+        vkCmdFillBuffer(cmd, frame.count.buffer, 0, sizeof(ui32), 0);
+
+        memory_barrier(cmd,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        const cull_constants_t constants {
+            .planes       = frustum.planes,
+            .object_count = frame.object_count,
+        };
+
+        m_pipeline->bind(cmd);
+        m_pipeline->bind_desc_set(cmd, frame.set);
+        m_pipeline->push_constants(cmd, constants);
+
+        vkCmdDispatch(cmd, (frame.object_count + cull_group_size - 1) / cull_group_size, 1, 1);
+
+        // The draws and the counter are consumed as indirect parameters, the counter is also copied back
+        memory_barrier(cmd,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+
+        const VkBufferCopy region { .srcOffset = 0, .dstOffset = 0, .size = sizeof(ui32) };
+        vkCmdCopyBuffer(cmd, frame.count.buffer, frame.readback.buffer, 1, &region);
+
+        memory_barrier(cmd,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_HOST_BIT,
+                       VK_ACCESS_HOST_READ_BIT);
+
+        frame.recorded = true;
+    }
+
+    void gpu_culling_t::record_draw(VkCommandBuffer cmd) const
+    {
+        orbassert(m_current != nullptr, "gpu_culling_t::begin_frame was not called");
+
+        vkCmdDrawIndexedIndirectCount(cmd,
+                                      m_current->draws.buffer,
+                                      0,
+                                      m_current->count.buffer,
+                                      0,
+                                      m_max_objects,
+                                      sizeof(VkDrawIndexedIndirectCommand));
+    }
+
+    auto gpu_culling_t::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocationCreateFlags flags)
+        -> result<buffer_t>
+    {
+        VkBufferCreateInfo info {
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size        = size,
+            .usage       = usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+
+        VmaAllocationCreateInfo alloc_info {
+            .flags = flags,
+            .usage = VMA_MEMORY_USAGE_AUTO,
+        };
+
+        buffer_t          buffer;
+        VmaAllocationInfo allocated {};
+
+        if (auto res = vmaCreateBuffer(m_device->allocator, &info, &alloc_info, &buffer.buffer, &buffer.allocation, &allocated);
+            res != vkres::ok)
+        {
+            return error_t { "Could not create culling buffer: {}", vkres::get_repr(res) };
+        }
+
+        buffer.ptr = allocated.pMappedData;
+
+        return buffer;
+    }
+
+    void gpu_culling_t::destroy_buffer(buffer_t& buffer)
+    {
+        if (!buffer.buffer) return;
+
+        vmaDestroyBuffer(m_device->allocator, buffer.buffer, buffer.allocation);
+        buffer = {};
+    }
+
+    auto gpu_culling_builder_t::build() -> result<box<gpu_culling_t>>
+    {
+        ORB_PROFILE_ZONE("gpu_culling_builder_t::build");
+
+        if (m_device->features_12.drawIndirectCount != VK_TRUE
+            || m_device->features.multiDrawIndirect != VK_TRUE
+            || m_device->features.drawIndirectFirstInstance != VK_TRUE)
+        {
+            return error_t { "Could not create GPU culling: draw_indirect_count is not enabled on the device" };
+        }
+
+        if (m_max_objects == 0)
+        {
+            return error_t { "Could not create GPU culling: max_objects is 0" };
+        }
+
+        auto culling           = make_box<gpu_culling_t>();
+        culling->m_device      = m_device;
+        culling->m_max_objects = m_max_objects;
+
+        auto module = shader_module_builder_t::prepare(m_device, m_compiler)
+                          .unwrap()
+                          .kind(shader_kind::glsl_compute)
+                          .content(std::string(cull_source))
+                          .build();
+
+        if (!module) return module.error();
+
+        auto pipeline = compute_pipeline_builder_t::prepare(m_device)
+                            .unwrap()
+                            .shader(module.value().handle)
+                            .binding(0, descriptor_type::storage_buffer)
+                            .binding(1, descriptor_type::storage_buffer)
+                            .binding(2, descriptor_type::storage_buffer)
+                            .push_constants_size(sizeof(cull_constants_t))
+                            .build();
+
+        if (!pipeline) return pipeline.error();
+        culling->m_pipeline = std::move(pipeline.value());
+
+        constexpr VmaAllocationCreateFlags host_write = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+                                                      | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        constexpr VmaAllocationCreateFlags host_read  = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
+                                                     | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        auto pool = desc_pool_builder_t::prepare(m_device)
+                        .unwrap()
+                        .pool(descriptor_type::storage_buffer, 3 * m_frames_in_flight)
+                        .max_desc_sets(m_frames_in_flight)
+                        .build();
+
+        if (!pool) return pool.error();
+        culling->m_desc_pool = std::move(pool.value());
+
+        culling->m_frames.resize(m_frames_in_flight);
+
+        for (auto& frame : culling->m_frames)
+        {
+            auto objects = culling->create_buffer(sizeof(gpu_object_t) * m_max_objects,
+                                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                  host_write);
+
+            if (!objects) return objects.error();
+            frame.objects = objects.value();
+
+            auto draws = culling->create_buffer(sizeof(VkDrawIndexedIndirectCommand) * m_max_objects,
+                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                                0);
+
+            if (!draws) return draws.error();
+            frame.draws = draws.value();
+
+            auto count = culling->create_buffer(sizeof(ui32),
+                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                                                    | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                                                    | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                                                    | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                0);
+
+            if (!count) return count.error();
+            frame.count = count.value();
+
+            auto readback = culling->create_buffer(sizeof(ui32), VK_BUFFER_USAGE_TRANSFER_DST_BIT, host_read);
+
+            if (!readback) return readback.error();
+            frame.readback = readback.value();
+
+            auto alloc_info               = structs::create::desc_sets(culling->m_desc_pool.handle);
+            alloc_info.descriptorSetCount = 1;
+            alloc_info.pSetLayouts        = &culling->m_pipeline->desc_set_layout;
+
+            if (auto res = vkAllocateDescriptorSets(m_device->handle, &alloc_info, &frame.set); res != vkres::ok)
+            {
+                return error_t { "Could not allocate culling descriptor set: {}", vkres::get_repr(res) };
+            }
+
+            std::array<VkDescriptorBufferInfo, 3> buffer_infos { {
+                { .buffer = frame.objects.buffer, .offset = 0, .range = VK_WHOLE_SIZE },
+                { .buffer = frame.draws.buffer, .offset = 0, .range = VK_WHOLE_SIZE },
+                { .buffer = frame.count.buffer, .offset = 0, .range = VK_WHOLE_SIZE },
+            } };
+
+            std::array<VkWriteDescriptorSet, 3> writes {};
+            for (ui32 binding = 0; binding < writes.size(); ++binding)
+            {
+                auto& write           = writes[binding];
+                write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet          = frame.set;
+                write.dstBinding      = binding;
+                write.descriptorCount = 1;
+                write.descriptorType  = vkenum(descriptor_type::storage_buffer);
+                write.pBufferInfo     = &buffer_infos[binding];
+            }
+
+            vkUpdateDescriptorSets(m_device->handle, writes.size(), writes.data(), 0, nullptr);
+        }
+
+        return culling;
+    }
+} // namespace orb::vk
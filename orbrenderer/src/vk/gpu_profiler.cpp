@@ -0,0 +1,217 @@
+#include "orb/vk/gpu_profiler.hpp"
+
+namespace orb::vk
+{
+    namespace
+    {
+        constexpr ui32 no_query = std::numeric_limits<ui32>::max();
+
+        auto timestamp_mask(ui32 valid_bits) -> ui64
+        {
+            if (valid_bits >= 64) return ~0ull;
+            return (1ull << valid_bits) - 1;
+        }
+    } // namespace
+
+    void gpu_zone_t::end()
+    {
+        if (!m_profiler) return;
+
+        m_profiler->close(*this);
+        m_profiler = nullptr;
+    }
+
+    void gpu_profiler_t::destroy()
+    {
+        for (auto& frame : m_frames)
+        {
+            if (frame.pool) vkDestroyQueryPool(m_device->handle, frame.pool, host_callbacks(host_scope::resources));
+        }
+
+        m_frames.clear();
+        m_current = nullptr;
+    }
+
+    auto gpu_profiler_t::begin_frame(ui32 slot) -> result<void>
+    {
+        auto& frame = m_frames[slot % m_frames.size()];
+        m_current   = &frame;
+
+        if (frame.used != 0)
+        {
+            // Pairs of [timestamp, availability], unfinished queries are skipped instead of waited on
+            const auto res = vkGetQueryPoolResults(m_device->handle,
+                                                   frame.pool,
+                                                   0,
+                                                   frame.used,
+                                                   m_results.size() * sizeof(ui64),
+                                                   m_results.data(),
+                                                   2 * sizeof(ui64),
+                                                   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+            if (res != vkres::ok && res != vkres::not_ready)
+            {
+                return error_t { "Could not read timestamp queries: {}", vkres::get_repr(res) };
+            }
+
+            for (const auto& r : frame.recorded)
+            {
+                const ui64* begin = &m_results[2 * r.query];
+                const ui64* end   = &m_results[2 * (r.query + 1)];
+
+                if (begin[1] == 0 || end[1] == 0) continue;
+
+                const ui64 ticks = (end[0] - begin[0]) & r.mask;
+                m_zones[r.zone].add(static_cast<f32>(ticks) * m_ms_per_tick);
+            }
+        }
+
+        frame.used = 0;
+        frame.recorded.clear();
+
+        if (m_host_reset)
+        {
+            vkResetQueryPool(m_device->handle, frame.pool, 0, m_max_queries);
+        }
+        else
+        {
+            frame.needs_reset = true;
+        }
+
+        return {};
+    }
+
+    auto gpu_profiler_t::zone(VkCommandBuffer cmd, std::string_view name, ui32 qf_index) -> gpu_zone_t
+    {
+        orbassert(m_current != nullptr, "gpu_profiler_t::begin_frame was not called");
+
+        auto it = m_zone_ids.find(name);
+
+        if (it == m_zone_ids.end())
+        {
+            it = m_zone_ids.emplace(std::string(name), static_cast<ui32>(m_zones.size())).first;
+            m_zones.emplace_back().name = std::string(name);
+        }
+
+        gpu_zone_t zone;
+        zone.m_profiler = this;
+        zone.m_cmd      = cmd;
+
+        if (m_device->cmd_begin_label_fb)
+        {
+            // The stored name is null terminated, the view might not be
+            VkDebugUtilsLabelEXT label {
+                .sType      = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                .pNext      = nullptr,
+                .pLabelName = m_zones[it->second].name.c_str(),
+                .color      = { 0.0f, 0.0f, 0.0f, 0.0f },
+            };
+
+            m_device->cmd_begin_label_fb(cmd, &label);
+        }
+
+        auto& frame = *m_current;
+
+        const ui64 mask = qf_index < m_masks.size() ? m_masks[qf_index] : 0;
+        if (mask == 0 || frame.used + 2 > m_max_queries) return zone;
+
+        if (frame.needs_reset)
+        {
+            vkCmdResetQueryPool(cmd, frame.pool, 0, m_max_queries);
+            frame.needs_reset = false;
+        }
+
+        zone.m_pool  = frame.pool;
+        zone.m_query = frame.used;
+        frame.used  += 2;
+        frame.recorded.push_back({ .zone = it->second, .query = zone.m_query, .mask = mask });
+
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.pool, zone.m_query);
+
+        return zone;
+    }
+
+    void gpu_profiler_t::close(const gpu_zone_t& zone)
+    {
+        if (zone.m_query != no_query)
+        {
+            vkCmdWriteTimestamp(zone.m_cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, zone.m_pool, zone.m_query + 1);
+        }
+
+        if (m_device->cmd_end_label_fb) m_device->cmd_end_label_fb(zone.m_cmd);
+    }
+
+    auto gpu_profiler_t::stats(std::string_view name) const -> const gpu_zone_stats_t*
+    {
+        const auto it = m_zone_ids.find(name);
+        return it == m_zone_ids.end() ? nullptr : &m_zones[it->second];
+    }
+
+    void gpu_profiler_t::describe() const
+    {
+        fmt::println("- GPU profiler ({} zones)", m_zones.size());
+
+        for (const auto& z : m_zones)
+        {
+            fmt::println("  * {}: {:.3f} ms avg, {:.3f} ms p50, {:.3f} ms p99",
+                         z.name,
+                         z.average(),
+                         z.percentile(0.5f),
+                         z.percentile(0.99f));
+        }
+    }
+
+    auto gpu_profiler_builder_t::build() -> result<box<gpu_profiler_t>>
+    {
+        if (m_gpu->limits.timestampPeriod == 0.0f)
+        {
+            return error_t { "Could not create GPU profiler: timestamps are not supported" };
+        }
+
+        auto profiler           = make_box<gpu_profiler_t>();
+        profiler->m_device      = m_device;
+        profiler->m_ms_per_tick = m_gpu->limits.timestampPeriod / 1e6f;
+        profiler->m_max_queries = 2 * m_max_zones;
+        profiler->m_default_qf  = m_default_qf;
+        profiler->m_host_reset  = m_device->features_12.hostQueryReset == VK_TRUE;
+        profiler->m_results.resize(2 * static_cast<size_t>(profiler->m_max_queries));
+
+        for (const auto& qf : m_gpu->queue_families)
+        {
+            if (profiler->m_masks.size() <= qf->index) profiler->m_masks.resize(qf->index + 1, 0);
+            profiler->m_masks[qf->index] = timestamp_mask(qf->properties.timestampValidBits);
+        }
+
+        VkQueryPoolCreateInfo info {
+            .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext              = nullptr,
+            .flags              = 0,
+            .queryType          = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount         = profiler->m_max_queries,
+            .pipelineStatistics = 0,
+        };
+
+        profiler->m_frames.resize(m_frames_in_flight);
+
+        for (auto& frame : profiler->m_frames)
+        {
+            const auto res = vkCreateQueryPool(m_device->handle,
+                                               &info,
+                                               host_callbacks(host_scope::resources),
+                                               &frame.pool);
+
+            if (res != vkres::ok)
+            {
+                return error_t { "Could not create timestamp query pool: {}", vkres::get_repr(res) };
+            }
+
+            if (profiler->m_host_reset)
+            {
+                vkResetQueryPool(m_device->handle, frame.pool, 0, profiler->m_max_queries);
+                frame.needs_reset = false;
+            }
+        }
+
+        return profiler;
+    }
+} // namespace orb::vk
@@ -0,0 +1,427 @@
+#include "orb/vk/host_allocator.hpp"
+
+#include <orb/result.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace orb::vk
+{
+    namespace
+    {
+        constexpr size_t scope_count = static_cast<size_t>(host_scope::count);
+
+        // Every allocation is preceded by this header, pooled or not
+        struct alloc_header_t
+        {
+            ui64 size;
+            ui32 base_offset; // distance to the pointer returned by malloc, for large allocations
+            ui8  size_class;
+            ui8  scope;
+            ui16 reserved;
+        };
+
+        static_assert(sizeof(alloc_header_t) == 16);
+
+        constexpr size_t header_size    = sizeof(alloc_header_t);
+        constexpr size_t pool_alignment = 16;
+        constexpr size_t chunk_size     = 64 * 1024;
+        constexpr ui8    no_size_class  = 0xff;
+
+        constexpr std::array<size_t, 6> size_classes = { 16, 32, 64, 128, 256, 512 };
+
+        struct free_slot_t
+        {
+            free_slot_t* next;
+        };
+
+        struct size_class_pool_t
+        {
+            std::mutex   mutex;
+            free_slot_t* free_list = nullptr;
+            std::byte*   cursor    = nullptr;
+            size_t       remaining = 0;
+        };
+
+        struct scope_counters_t
+        {
+            std::atomic<ui64> allocations    = 0;
+            std::atomic<ui64> reallocations  = 0;
+            std::atomic<ui64> frees          = 0;
+            std::atomic<ui64> pooled         = 0;
+            std::atomic<ui64> live_bytes     = 0;
+            std::atomic<ui64> peak_bytes     = 0;
+            std::atomic<ui64> total_bytes    = 0;
+            std::atomic<ui64> internal_bytes = 0;
+        };
+
+        struct state_t
+        {
+            std::once_flag    enable_once;
+            std::atomic<bool> enabled = false; // published once the callbacks are filled
+
+            std::array<scope_counters_t, scope_count>           counters;
+            std::array<VkAllocationCallbacks, scope_count>      callbacks {};
+            std::array<size_class_pool_t, size_classes.size()> pools;
+
+            std::atomic<ui64> chunks = 0;
+        };
+
+        // Never destroyed: drivers may free memory from their own static destructors
+        auto state() -> state_t&
+        {
+            static auto* s = new state_t; // NOLINT
+            return *s;
+        }
+
+        auto header_of(void* memory) -> alloc_header_t*
+        {
+            return reinterpret_cast<alloc_header_t*>(static_cast<std::byte*>(memory) - header_size); // NOLINT
+        }
+
+        auto size_class_of(size_t size, size_t alignment) -> ui8
+        {
+            if (alignment > pool_alignment) return no_size_class;
+
+            for (size_t i = 0; i < size_classes.size(); ++i)
+            {
+                if (size <= size_classes[i]) return static_cast<ui8>(i);
+            }
+
+            return no_size_class;
+        }
+
+        auto pool_pop(ui8 size_class) -> std::byte*
+        {
+            auto&      pool = state().pools[size_class];
+            const auto slot = header_size + size_classes[size_class];
+
+            std::scoped_lock lock(pool.mutex);
+
+            if (pool.free_list)
+            {
+                auto* slot_ptr = reinterpret_cast<std::byte*>(pool.free_list); // NOLINT
+                pool.free_list = pool.free_list->next;
+                return slot_ptr;
+            }
+
+            if (pool.remaining < slot)
+            {
+                // Over-allocated and aligned by hand like large allocations, std::aligned_alloc
+                // does not exist on MSVC. Chunks are never freed, the base is not kept
+                auto* base = static_cast<std::byte*>(std::malloc(chunk_size + pool_alignment));
+                if (!base) return nullptr;
+
+                const auto addr = reinterpret_cast<uintptr_t>(base); // NOLINT
+                pool.cursor     = base + ((addr + pool_alignment - 1) / pool_alignment * pool_alignment - addr);
+                pool.remaining  = chunk_size;
+                state().chunks++;
+            }
+
+            auto* slot_ptr = pool.cursor;
+            pool.cursor += slot;
+            pool.remaining -= slot;
+
+            return slot_ptr;
+        }
+
+        void pool_push(ui8 size_class, std::byte* slot_ptr)
+        {
+            auto& pool = state().pools[size_class];
+
+            std::scoped_lock lock(pool.mutex);
+
+            auto* slot     = reinterpret_cast<free_slot_t*>(slot_ptr); // NOLINT
+            slot->next     = pool.free_list;
+            pool.free_list = slot;
+        }
+
+        auto allocate(host_scope scope, size_t size, size_t alignment) -> void*
+        {
+            alignment = std::max(alignment, pool_alignment);
+
+            const auto size_class = size_class_of(size, alignment);
+
+            std::byte* user        = nullptr;
+            ui32       base_offset = 0;
+
+            if (size_class != no_size_class)
+            {
+                auto* slot = pool_pop(size_class);
+                if (!slot) return nullptr;
+
+                user = slot + header_size;
+            }
+            else
+            {
+                auto* base = static_cast<std::byte*>(std::malloc(size + alignment + header_size));
+                if (!base) return nullptr;
+
+                const auto addr = reinterpret_cast<uintptr_t>(base) + header_size; // NOLINT
+                user            = base + ((addr + alignment - 1) / alignment * alignment - addr) + header_size;
+                base_offset     = static_cast<ui32>(user - base);
+            }
+
+            *header_of(user) = {
+                .size        = size,
+                .base_offset = base_offset,
+                .size_class  = size_class,
+                .scope       = static_cast<ui8>(scope),
+                .reserved    = 0,
+            };
+
+            return user;
+        }
+
+        void release(void* memory)
+        {
+            auto* header = header_of(memory);
+
+            if (header->size_class != no_size_class)
+            {
+                pool_push(header->size_class, reinterpret_cast<std::byte*>(header)); // NOLINT
+            }
+            else
+            {
+                std::free(static_cast<std::byte*>(memory) - header->base_offset); // NOLINT
+            }
+        }
+
+        void add_live_bytes(scope_counters_t& counters, ui64 size)
+        {
+            const ui64 live = counters.live_bytes.fetch_add(size) + size;
+            ui64       peak = counters.peak_bytes.load();
+
+            while (live > peak && !counters.peak_bytes.compare_exchange_weak(peak, live)) {}
+        }
+
+        auto counters_of(void* user_data) -> scope_counters_t&
+        {
+            return state().counters[reinterpret_cast<uintptr_t>(user_data)]; // NOLINT
+        }
+
+        auto scope_of(void* user_data) -> host_scope
+        {
+            return static_cast<host_scope>(reinterpret_cast<uintptr_t>(user_data)); // NOLINT
+        }
+
+        VKAPI_ATTR auto VKAPI_CALL on_allocation(void*                   user_data,
+                                                 size_t                  size,
+                                                 size_t                  alignment,
+                                                 VkSystemAllocationScope /*scope*/) -> void*
+        {
+            if (size == 0) return nullptr;
+
+            void* memory = allocate(scope_of(user_data), size, alignment);
+            if (!memory) return nullptr;
+
+            auto& counters = counters_of(user_data);
+            counters.allocations++;
+            counters.total_bytes += size;
+            if (header_of(memory)->size_class != no_size_class) counters.pooled++;
+            add_live_bytes(counters, size);
+
+            return memory;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL on_free(void* user_data, void* memory)
+        {
+            if (!memory) return;
+
+            auto& counters = counters_of(user_data);
+            counters.frees++;
+            counters.live_bytes -= header_of(memory)->size;
+
+            release(memory);
+        }
+
+        VKAPI_ATTR auto VKAPI_CALL on_reallocation(void*                   user_data,
+                                                   void*                   original,
+                                                   size_t                  size,
+                                                   size_t                  alignment,
+                                                   VkSystemAllocationScope scope) -> void*
+        {
+            if (!original) return on_allocation(user_data, size, alignment, scope);
+
+            if (size == 0)
+            {
+                on_free(user_data, original);
+                return nullptr;
+            }
+
+            auto&      counters = counters_of(user_data);
+            auto*      header   = header_of(original);
+            const auto old_size = header->size;
+
+            counters.reallocations++;
+
+            // Shrinking or growing within the slot of a size class needs no copy
+            if (header->size_class != no_size_class && size <= size_classes[header->size_class]
+                && alignment <= pool_alignment)
+            {
+                header->size = size;
+            }
+            else
+            {
+                void* memory = allocate(scope_of(user_data), size, alignment);
+                if (!memory) return nullptr;
+
+                std::memcpy(memory, original, std::min<size_t>(old_size, size));
+                release(original);
+
+                original = memory;
+            }
+
+            counters.live_bytes -= old_size;
+            add_live_bytes(counters, size);
+
+            if (size > old_size) counters.total_bytes += size - old_size;
+
+            return original;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL on_internal_allocation(void* user_data,
+                                                          size_t size,
+                                                          VkInternalAllocationType /*type*/,
+                                                          VkSystemAllocationScope /*scope*/)
+        {
+            counters_of(user_data).internal_bytes += size;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL on_internal_free(void* user_data,
+                                                    size_t size,
+                                                    VkInternalAllocationType /*type*/,
+                                                    VkSystemAllocationScope /*scope*/)
+        {
+            counters_of(user_data).internal_bytes -= size;
+        }
+    } // namespace
+
+    auto host_scope_name(host_scope scope) -> const char*
+    {
+        switch (scope)
+        {
+        case host_scope::instance:
+            return "instance";
+        case host_scope::device:
+            return "device";
+        case host_scope::allocator:
+            return "allocator";
+        case host_scope::pipelines:
+            return "pipelines";
+        case host_scope::descriptors:
+            return "descriptors";
+        case host_scope::commands:
+            return "commands";
+        case host_scope::sync:
+            return "sync";
+        case host_scope::resources:
+            return "resources";
+        case host_scope::count:
+            break;
+        }
+
+        return "unknown";
+    }
+
+    void host_allocation_report_t::print() const
+    {
+        fmt::println("Vulkan host allocations:");
+        fmt::println("  {:<12} {:>10} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12}",
+                     "scope",
+                     "allocs",
+                     "reallocs",
+                     "frees",
+                     "pooled",
+                     "live",
+                     "peak",
+                     "internal");
+
+        for (size_t i = 0; i < scopes.size(); ++i)
+        {
+            const auto& s = scopes[i];
+
+            fmt::println("  {:<12} {:>10} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12}",
+                         host_scope_name(static_cast<host_scope>(i)),
+                         s.allocations,
+                         s.reallocations,
+                         s.frees,
+                         s.pooled,
+                         s.live_bytes,
+                         s.peak_bytes,
+                         s.internal_bytes);
+        }
+
+        fmt::println("  {} pool chunks ({} bytes)", pool_chunks, pool_chunk_bytes);
+    }
+
+    namespace host_allocator
+    {
+        void enable()
+        {
+            auto& s = state();
+
+            // Concurrent callers return once the callbacks are visible to host_callbacks
+            std::call_once(s.enable_once, [&s] {
+                for (size_t i = 0; i < scope_count; ++i)
+                {
+                    s.callbacks[i] = {
+                        .pUserData             = reinterpret_cast<void*>(i), // NOLINT
+                        .pfnAllocation         = on_allocation,
+                        .pfnReallocation       = on_reallocation,
+                        .pfnFree               = on_free,
+                        .pfnInternalAllocation = on_internal_allocation,
+                        .pfnInternalFree       = on_internal_free,
+                    };
+                }
+
+                s.enabled.store(true, std::memory_order_release);
+            });
+        }
+
+        auto enabled() -> bool
+        {
+            return state().enabled.load(std::memory_order_acquire);
+        }
+
+        auto report() -> host_allocation_report_t
+        {
+            auto& s = state();
+
+            host_allocation_report_t r;
+
+            for (size_t i = 0; i < scope_count; ++i)
+            {
+                const auto& c = s.counters[i];
+                auto&       o = r.scopes[i];
+
+                o.allocations    = c.allocations.load();
+                o.reallocations  = c.reallocations.load();
+                o.frees          = c.frees.load();
+                o.pooled         = c.pooled.load();
+                o.live_bytes     = c.live_bytes.load();
+                o.peak_bytes     = c.peak_bytes.load();
+                o.total_bytes    = c.total_bytes.load();
+                o.internal_bytes = c.internal_bytes.load();
+            }
+
+            r.pool_chunks      = s.chunks.load();
+            r.pool_chunk_bytes = r.pool_chunks * chunk_size;
+
+            return r;
+        }
+    } // namespace host_allocator
+
+    auto host_callbacks(host_scope scope) -> const VkAllocationCallbacks*
+    {
+        auto& s = state();
+
+        if (!s.enabled.load(std::memory_order_acquire)) return nullptr;
+
+        return &s.callbacks[static_cast<size_t>(scope)];
+    }
+} // namespace orb::vk
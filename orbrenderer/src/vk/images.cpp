@@ -4,6 +4,9 @@
 
 #include <orb/flux.hpp>
 
+#include <utility>
+#include <vector>
+
 namespace orb::vk
 {
     auto images_builder_t::prepare(VmaAllocator allocator) -> result<images_builder_t>
@@ -37,41 +40,160 @@ namespace orb::vk
         images.handles.resize(m_count);
         images.allocations.resize(m_count);
 
+        const auto info       = this->info();
+        auto       alloc_info = m_alloc_info;
+
+        if (m_transient)
+        {
+            alloc_info.usage = vkenum(memory_usage::gpu_lazily_allocated);
+            alloc_info.flags &= ~vkflag(memory_flag::dedicated_memory);
+            images.lazily_allocated = true;
+        }
+
         for (const auto& [img, alloc] : flux::zip_all_mut(images.handles, images.allocations))
         {
-            vmaCreateImage(m_allocator, &m_info, &m_alloc_info, &img, &alloc, nullptr);
+            auto res = vmaCreateImage(m_allocator, &info, &alloc_info, &img, &alloc, nullptr);
+
+            // No lazily allocated memory type on this device: use regular memory instead
+            if (res == VK_ERROR_FEATURE_NOT_PRESENT && images.lazily_allocated)
+            {
+                alloc_info              = m_alloc_info;
+                images.lazily_allocated = false;
+
+                res = vmaCreateImage(m_allocator, &info, &alloc_info, &img, &alloc, nullptr);
+            }
+
+            if (res != vkres::ok)
+            {
+                return error_t { "Could not create image: {}", vkres::get_repr(res) };
+            }
         }
 
         return images;
     }
-    void transition_layout(
-        VkCommandBuffer cmd, VkImage img, image_layout prev, image_layout next)
+    namespace
     {
-        VkImageMemoryBarrier barrier {
-            .sType         = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .pNext         = nullptr,
-            .srcAccessMask = vkflag(access_flag::memory_write),
-            .dstAccessMask = vkflag(access_flag::memory_read | access_flag::memory_write),
-            .oldLayout     = vkenum(prev),
-            .newLayout     = vkenum(next),
-            .image         = img,
+        struct layout_sync_t
+        {
+            pipeline_stage_flag stage;
+            access_flag         access;
         };
 
-        auto aspect = (next == image_layout::depth_attachment_optimal)
-                                      ? image_aspect_flag::depth
-                                      : image_aspect_flag::color;
+        auto layout_sync(image_layout layout) -> layout_sync_t
+        {
+            switch (layout)
+            {
+            case image_layout::undefined:
+                return { pipeline_stage_flag::top_of_pipe, access_flag::none };
+            case image_layout::transfer_src_optimal:
+                return { pipeline_stage_flag::transfer, access_flag::transfer_read };
+            case image_layout::transfer_dst_optimal:
+                return { pipeline_stage_flag::transfer, access_flag::transfer_write };
+            case image_layout::shader_read_only_optimal:
+                return { pipeline_stage_flag::fragment_shader | pipeline_stage_flag::compute_shader,
+                         access_flag::shader_read };
+            case image_layout::general:
+                return { pipeline_stage_flag::compute_shader,
+                         access_flag::shader_read | access_flag::shader_write };
+            case image_layout::color_attachment_optimal:
+                return { pipeline_stage_flag::color_attachment_output,
+                         access_flag::color_attachment_read | access_flag::color_attachment_write };
+            case image_layout::depth_attachment_optimal:
+            case image_layout::depth_stencil_attachment_optimal:
+                return { pipeline_stage_flag::early_fragment_tests | pipeline_stage_flag::late_fragment_tests,
+                         access_flag::depth_stencil_attachment_read | access_flag::depth_stencil_attachment_write };
+            case image_layout::present_src_khr:
+                return { pipeline_stage_flag::bottom_of_pipe, access_flag::none };
+            default:
+                return { pipeline_stage_flag::all_commands,
+                         access_flag::memory_read | access_flag::memory_write };
+            }
+        }
 
-        barrier.subresourceRange = {
-            .aspectMask     = vkflag(aspect),
-            .baseMipLevel   = 0,
-            .levelCount     = 1,
-            .baseArrayLayer = 0,
-            .layerCount     = 1,
+        // Every family supports transfers, graphics and compute families add their own stages
+        auto supported_stages(VkQueueFlags queue_flags) -> VkPipelineStageFlags
+        {
+            VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+                                        | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                                        | VK_PIPELINE_STAGE_HOST_BIT
+                                        | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+                                        | VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+            if (queue_flags & VK_QUEUE_GRAPHICS_BIT)
+            {
+                stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT
+                        | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+                        | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                        | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT
+                        | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT
+                        | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT
+                        | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                        | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+                        | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+                        | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                        | VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+            }
+
+            if (queue_flags & VK_QUEUE_COMPUTE_BIT)
+            {
+                stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            }
+
+            return stages;
+        }
+
+        /* @brief Keeps the stages of `sync` the family supports
+         *
+         * When none is left, the usage belongs to work on another queue, ordered by the semaphore
+         * or fence the caller submits with: `none` stands in, without any access.
+         */
+        auto restrict_sync(layout_sync_t sync, VkQueueFlags queue_flags, VkPipelineStageFlags none)
+            -> std::pair<VkPipelineStageFlags, VkAccessFlags>
+        {
+            const VkPipelineStageFlags stages = vkflag(sync.stage) & supported_stages(queue_flags);
+
+            if (stages == 0) return { none, 0 };
+
+            return { stages, vkflag(sync.access) };
+        }
+    } // namespace
+
+    auto queue_family_flags(VkPhysicalDevice gpu, ui32 qf_index) -> VkQueueFlags
+    {
+        ui32 count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, nullptr);
+        std::vector<VkQueueFamilyProperties> families(count);
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, families.data());
+
+        return qf_index < count ? families[qf_index].queueFlags : 0;
+    }
+
+    void transition_layout(VkCommandBuffer                cmd,
+                           VkImage                        img,
+                           image_layout                   prev,
+                           image_layout                   next,
+                           const VkImageSubresourceRange& range,
+                           VkQueueFlags                   queue_flags)
+    {
+        const auto [src_stages, src_access] = restrict_sync(layout_sync(prev), queue_flags, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        const auto [dst_stages, dst_access] = restrict_sync(layout_sync(next), queue_flags, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        VkImageMemoryBarrier barrier {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext               = nullptr,
+            .srcAccessMask       = src_access,
+            .dstAccessMask       = dst_access,
+            .oldLayout           = vkenum(prev),
+            .newLayout           = vkenum(next),
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = img,
+            .subresourceRange    = range,
         };
 
         vkCmdPipelineBarrier(cmd,
-                             vkenum(pipeline_stage_flag::top_of_pipe),
-                             vkenum(pipeline_stage_flag::top_of_pipe),
+                             src_stages,
+                             dst_stages,
                              0,
                              0,
                              nullptr,
@@ -81,6 +203,24 @@ namespace orb::vk
                              &barrier);
     }
 
+    void transition_layout(VkCommandBuffer cmd, VkImage img, image_layout prev, image_layout next)
+    {
+        const auto aspect = (next == image_layout::depth_attachment_optimal) ? image_aspect_flag::depth
+                                                                             : image_aspect_flag::color;
+
+        transition_layout(cmd,
+                          img,
+                          prev,
+                          next,
+                          {
+                              .aspectMask     = vkflag(aspect),
+                              .baseMipLevel   = 0,
+                              .levelCount     = 1,
+                              .baseArrayLayer = 0,
+                              .layerCount     = 1,
+                          });
+    }
+
     void copy_img(VkCommandBuffer cmd, VkImage src, VkImage dst, VkExtent2D src_extent)
     {
         VkImageCopy region {};
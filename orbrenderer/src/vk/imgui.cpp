@@ -1,6 +1,7 @@
 #include "orb/vk/imgui.hpp"
 
 #include "orb/glfw/window.hpp"
+#include "orb/profiler.hpp"
 #include "orb/vk/desc_pool.hpp"
 #include "orb/vk/device.hpp"
 #include "orb/vk/gpu.hpp"
@@ -93,7 +94,7 @@ namespace orb::vk
         builder.m_info.MinImageCount   = sc->info.minImageCount;
         builder.m_info.ImageCount      = sc->img_count;
         builder.m_info.MSAASamples     = vkenum(sample_count_flag::_1);
-        builder.m_info.Allocator       = nullptr;
+        builder.m_info.Allocator       = host_callbacks(host_scope::resources);
         builder.m_info.CheckVkResultFn = nullptr;
 
         return builder;
@@ -101,6 +102,8 @@ namespace orb::vk
 
     auto imgui_driver_builder_t::build() -> result<imgui_driver_t>
     {
+        ORB_PROFILE_ZONE("imgui_driver_builder_t::build");
+
         imgui_driver_t driver {};
 
         IMGUI_CHECKVERSION();
@@ -1,5 +1,7 @@
 #include "orb/vk/instance.hpp"
 
+#include "orb/profiler.hpp"
+
 #include <orb/eval.hpp>
 #include <orb/print_time.hpp>
 #include <orb/utility.hpp>
@@ -135,6 +137,8 @@ namespace orb::vk
 
     auto instance_builder_t::build() -> result<box<instance_t>>
     {
+        ORB_PROFILE_ZONE("instance_builder_t::build");
+
         auto instance = make_box<instance_t>();
 
         auto app_info = structs::create::application_info();
@@ -177,13 +181,13 @@ namespace orb::vk
         create_deb_info.pfnUserCallback = debug_report;
         create_info.pNext               = &create_deb_info;
 
-        auto res = vkCreateInstance(&create_info, nullptr, &instance->handle);
+        auto res = vkCreateInstance(&create_info, host_callbacks(host_scope::instance), &instance->handle);
         if (res != VK_SUCCESS) { return error_t { "Could not create Vulkan instance: {}", vkres::get_repr(res) }; }
 
         // begin_chrono();
 
         auto create_deb_utils_fn = proc_addresses::create_deb_utils(instance->handle);
-        if (auto r = create_deb_utils_fn(instance->handle, &create_deb_info, nullptr, &instance->debug_utils); r != vkres::ok)
+        if (auto r = create_deb_utils_fn(instance->handle, &create_deb_info, host_callbacks(host_scope::instance), &instance->debug_utils); r != vkres::ok)
         {
             return error_t { "Could not create debug utils messenger: {}", vkres::get_repr(res) };
         }
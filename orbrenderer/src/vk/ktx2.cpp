@@ -0,0 +1,383 @@
+#include "orb/vk/ktx2.hpp"
+
+#include "orb/profiler.hpp"
+#include "orb/vk/fences.hpp"
+#include "orb/vk/images.hpp"
+#include "orb/vk/staging_buffer.hpp"
+#include "orb/vk/transcode.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace orb::vk
+{
+    namespace
+    {
+        constexpr std::array<ui8, 12> ktx2_identifier = {
+            0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A,
+        };
+
+        constexpr size_t ktx2_header_size      = 80;
+        constexpr size_t ktx2_level_entry_size = 24;
+
+        // Basic descriptor block, from the start of the DFD: texelBlockDimension0 at 16, bytesPlane0 at 20
+        constexpr size_t ktx2_dfd_min_size = 24;
+
+        // Level offsets in the staging buffer must be multiples of the texel block size and of 4
+        constexpr ui64 staging_alignment = 16;
+
+        template <typename T>
+        auto read(std::span<const std::byte> bytes, size_t offset) -> T
+        {
+            T value {};
+            std::memcpy(&value, bytes.data() + offset, sizeof(T));
+            return value;
+        }
+
+        auto align_up(ui64 value, ui64 alignment) -> ui64
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    } // namespace
+
+    auto ktx2_file_t::open(const std::filesystem::path& file_path) -> result<ktx2_file_t>
+    {
+        auto mapping = mapped_file_t::open(file_path);
+        if (!mapping) return mapping.error();
+
+        auto ktx = parse(mapping.value().bytes());
+        if (!ktx) return ktx.error();
+
+        // The mapping address does not change when moved, so `bytes` stays valid
+        ktx.value().file = std::move(mapping.value());
+
+        return std::move(ktx.value());
+    }
+
+    auto ktx2_file_t::parse(std::span<const std::byte> bytes) -> result<ktx2_file_t>
+    {
+        ktx2_file_t ktx;
+        ktx.bytes = bytes;
+
+        if (bytes.size() < ktx2_header_size
+            || std::memcmp(bytes.data(), ktx2_identifier.data(), ktx2_identifier.size()) != 0)
+        {
+            return error_t { "Could not parse KTX2 container: bad identifier" };
+        }
+
+        ktx.format           = static_cast<VkFormat>(read<ui32>(bytes, 12));
+        ktx.width            = read<ui32>(bytes, 20);
+        ktx.height           = read<ui32>(bytes, 24);
+        ktx.depth            = read<ui32>(bytes, 28);
+        ktx.layers           = read<ui32>(bytes, 32);
+        ktx.faces            = read<ui32>(bytes, 36);
+        ktx.supercompression = read<ui32>(bytes, 44);
+
+        const ui32 level_count = std::max(read<ui32>(bytes, 40), 1u);
+
+        if (ktx.format == VK_FORMAT_UNDEFINED)
+        {
+            return error_t { "Could not parse KTX2 container: Basis Universal payloads are not supported" };
+        }
+
+        if (ktx.supercompression != 0)
+        {
+            return error_t { "Could not parse KTX2 container: supercompression scheme {} is not supported",
+                             ktx.supercompression };
+        }
+
+        if (ktx.depth > 1)
+        {
+            return error_t { "Could not parse KTX2 container: 3D textures are not supported" };
+        }
+
+        if (ktx.faces != 1 && ktx.faces != 6)
+        {
+            return error_t { "Could not parse KTX2 container: invalid face count {}", ktx.faces };
+        }
+
+        if (ktx.width == 0 || ktx.height == 0)
+        {
+            return error_t { "Could not parse KTX2 container: 1D textures are not supported" };
+        }
+
+        // Level sizes are shifts of the base size by the level index
+        if (level_count > mip_chain_length(ktx.width, ktx.height))
+        {
+            return error_t { "Could not parse KTX2 container: {} levels for a {}x{} image", level_count, ktx.width, ktx.height };
+        }
+
+        const ui32 dfd_offset = read<ui32>(bytes, 48);
+        const ui32 dfd_length = read<ui32>(bytes, 52);
+
+        if (dfd_length < ktx2_dfd_min_size || ui64 { dfd_offset } + ktx2_dfd_min_size > bytes.size())
+        {
+            return error_t { "Could not parse KTX2 container: missing data format descriptor" };
+        }
+
+        ktx.block_width  = ui32 { read<ui8>(bytes, dfd_offset + 16) } + 1;
+        ktx.block_height = ui32 { read<ui8>(bytes, dfd_offset + 17) } + 1;
+        ktx.block_bytes  = read<ui8>(bytes, dfd_offset + 20);
+
+        if (ktx.block_bytes == 0)
+        {
+            return error_t { "Could not parse KTX2 container: data format descriptor without a block size" };
+        }
+
+        if (bytes.size() < ktx2_header_size + level_count * ktx2_level_entry_size)
+        {
+            return error_t { "Could not parse KTX2 container: truncated level index" };
+        }
+
+        ktx.levels.resize(level_count);
+
+        for (ui32 i = 0; i < level_count; ++i)
+        {
+            const size_t entry = ktx2_header_size + i * ktx2_level_entry_size;
+
+            auto& level             = ktx.levels[i];
+            level.offset            = read<ui64>(bytes, entry);
+            level.length            = read<ui64>(bytes, entry + 8);
+            level.uncompressed_size = read<ui64>(bytes, entry + 16);
+
+            if (ktx.level_data(i).size() != level.length)
+            {
+                return error_t { "Could not parse KTX2 container: level {} is out of bounds", i };
+            }
+
+            // Copies and decoding read exactly this much per level
+            if (const ui64 expected = ktx.level_size(i); level.length != expected)
+            {
+                return error_t { "Could not parse KTX2 container: level {} holds {} bytes, {} expected", i, level.length, expected };
+            }
+        }
+
+        return ktx;
+    }
+
+    auto ktx2_texture_builder_t::prepare(weak<device_t> device, const ktx2_file_t& file)
+        -> result<ktx2_texture_builder_t>
+    {
+        ktx2_texture_builder_t b;
+        b.m_device = device;
+        b.m_file   = &file;
+        return b;
+    }
+
+    auto ktx2_texture_builder_t::format_supported() const -> bool
+    {
+        VkFormatProperties props {};
+        vkGetPhysicalDeviceFormatProperties(m_device->physical_device, m_file->format, &props);
+
+        return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+    }
+
+    auto ktx2_texture_builder_t::build() -> result<texture_t>
+    {
+        ORB_PROFILE_ZONE("ktx2_texture_builder_t::build");
+
+        if (!m_pool || !m_queue)
+        {
+            return error_t { "Could not create KTX2 texture: no staging queue given" };
+        }
+
+        auto cmds_res = m_pool->alloc_cmds(1);
+        if (!cmds_res) return cmds_res.error();
+        auto cmd = cmds_res.value().get(0).unwrap();
+
+        // Freed on every path, the upload is no longer pending once it returns
+        auto texture = upload(cmd);
+        m_pool->free_cmds({ &cmd.handle, 1 });
+
+        return texture;
+    }
+
+    auto ktx2_texture_builder_t::upload(cmd_buffer_t& cmd) -> result<texture_t>
+    {
+        const auto& ktx = *m_file;
+
+        const bool transcode = m_force_transcode || !format_supported();
+
+        if (transcode && !can_transcode_to_rgba8(ktx.format))
+        {
+            return error_t { "Could not create KTX2 texture: format {} is not supported by the GPU "
+                             "and has no CPU fallback",
+                             static_cast<ui32>(ktx.format) };
+        }
+
+        const VkFormat img_format = transcode ? transcoded_format(ktx.format) : ktx.format;
+        const ui32     levels     = ktx.levels.size();
+        const ui32     layers     = ktx.image_layers();
+
+        // Staging layout: one region per level, tightly packed
+        std::vector<ui64> staging_offsets(levels);
+        ui64              staging_size = 0;
+
+        for (ui32 level = 0; level < levels; ++level)
+        {
+            staging_offsets[level] = staging_size;
+
+            const ui64 level_size = transcode
+                                      ? ui64 { ktx.level_width(level) } * ktx.level_height(level) * 4 * layers
+                                      : ktx.levels[level].length;
+
+            staging_size = align_up(staging_size + level_size, staging_alignment);
+        }
+
+        auto info          = structs::create::image();
+        info.format        = img_format;
+        info.extent        = { ktx.width, ktx.height, 1 };
+        info.mipLevels     = levels;
+        info.arrayLayers   = layers;
+        info.samples       = vkenum(sample_count_flag::_1);
+        info.tiling        = vkenum(image_tiling::optimal);
+        info.usage         = vkflag(image_usage_flag::sampled | image_usage_flag::transfer_dst);
+        info.sharingMode   = vkenum(sharing_mode::exclusive);
+        info.initialLayout = vkenum(image_layout::undefined);
+
+        if (ktx.faces == 6) info.flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+
+        auto alloc_info  = structs::create::allocation();
+        alloc_info.usage = vkenum(memory_usage::usage_auto);
+
+        texture_t texture;
+        texture.device     = m_device->handle;
+        texture.allocator  = m_device->allocator;
+        texture.format     = img_format;
+        texture.extent     = { ktx.width, ktx.height };
+        texture.mip_levels = levels;
+
+        if (auto res = vmaCreateImage(m_device->allocator, &info, &alloc_info, &texture.image, &texture.allocation, nullptr);
+            res != vkres::ok)
+        {
+            return error_t { "Could not create KTX2 texture image: {}", vkres::get_repr(res) };
+        }
+
+        auto staging_res = staging_buffer_builder_t::prepare(m_device, staging_size).unwrap().build();
+        if (!staging_res) return staging_res.error();
+        auto& staging = staging_res.value();
+
+        void* staging_data {};
+        if (auto res = vmaMapMemory(m_device->allocator, staging.allocation, &staging_data); res != vkres::ok)
+        {
+            return error_t { "Could not map staging buffer: {}", vkres::get_repr(res) };
+        }
+
+        auto* staging_bytes = static_cast<std::byte*>(staging_data);
+
+        for (ui32 level = 0; level < levels; ++level)
+        {
+            const auto src = ktx.level_data(level);
+            auto*      dst = staging_bytes + staging_offsets[level];
+
+            if (!transcode)
+            {
+                std::memcpy(dst, src.data(), src.size());
+                continue;
+            }
+
+            const ui32   w          = ktx.level_width(level);
+            const ui32   h          = ktx.level_height(level);
+            const size_t src_stride = src.size() / layers;
+            const size_t dst_stride = size_t { w } * h * 4;
+
+            for (ui32 layer = 0; layer < layers; ++layer)
+            {
+                auto res = transcode_to_rgba8(ktx.format,
+                                              src.subspan(layer * src_stride, src_stride),
+                                              w,
+                                              h,
+                                              { dst + layer * dst_stride, dst_stride });
+
+                if (!res)
+                {
+                    vmaUnmapMemory(m_device->allocator, staging.allocation);
+                    return res.error();
+                }
+            }
+        }
+
+        vmaFlushAllocation(m_device->allocator, staging.allocation, 0, staging_size);
+        vmaUnmapMemory(m_device->allocator, staging.allocation);
+
+        if (auto r = cmd.begin(command_buffer_usage_flag::one_time_submit); !r) return r.error();
+
+        const VkImageSubresourceRange range {
+            .aspectMask     = vkflag(image_aspect_flag::color),
+            .baseMipLevel   = 0,
+            .levelCount     = levels,
+            .baseArrayLayer = 0,
+            .layerCount     = layers,
+        };
+
+        const VkQueueFlags qf_flags = queue_family_flags(m_device->physical_device, m_pool->qf_index);
+
+        transition_layout(cmd.handle, texture.image, image_layout::undefined, image_layout::transfer_dst_optimal, range, qf_flags);
+
+        std::vector<VkBufferImageCopy> regions(levels);
+
+        for (ui32 level = 0; level < levels; ++level)
+        {
+            regions[level] = {
+                .bufferOffset      = staging_offsets[level],
+                .bufferRowLength   = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource  = {
+                    .aspectMask     = vkflag(image_aspect_flag::color),
+                    .mipLevel       = level,
+                    .baseArrayLayer = 0,
+                    .layerCount     = layers,
+                },
+                .imageOffset = { 0, 0, 0 },
+                .imageExtent = { ktx.level_width(level), ktx.level_height(level), 1 },
+            };
+        }
+
+        vkCmdCopyBufferToImage(cmd.handle,
+                               staging.buffer,
+                               texture.image,
+                               vkenum(image_layout::transfer_dst_optimal),
+                               regions.size(),
+                               regions.data());
+
+        transition_layout(cmd.handle, texture.image, image_layout::transfer_dst_optimal, m_final_layout, range, qf_flags);
+
+        if (auto r = cmd.end(); !r) return r.error();
+
+        auto fences_res = fences_builder_t::create(m_device, 1);
+        if (!fences_res) return fences_res.error();
+        auto fence = fences_res.value()[0];
+
+        if (auto r = fence.reset(); !r) return r.error();
+
+        if (auto r = submit_helper_t::prepare().cmd_buffer(&cmd.handle).submit(m_queue, fence.handle); !r)
+        {
+            return r.error();
+        }
+
+        if (auto r = fence.wait(); !r) return r.error();
+
+        texture.layout = m_final_layout;
+
+        auto view_info             = structs::create::image_view();
+        view_info.image            = texture.image;
+        view_info.format           = img_format;
+        view_info.subresourceRange = range;
+
+        if (ktx.faces == 6)
+        {
+            view_info.viewType = vkenum(layers > 6 ? image_view_type::cube_array : image_view_type::cube);
+        }
+        else if (ktx.layers > 0)
+        {
+            view_info.viewType = vkenum(image_view_type::_2d_array);
+        }
+
+        if (auto res = vkCreateImageView(m_device->handle, &view_info, host_callbacks(host_scope::resources), &texture.view); res != vkres::ok)
+        {
+            return error_t { "Could not create KTX2 texture view: {}", vkres::get_repr(res) };
+        }
+
+        return texture;
+    }
+} // namespace orb::vk
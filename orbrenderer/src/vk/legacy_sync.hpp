@@ -0,0 +1,23 @@
+#pragma once
+
+#include "orb/vk/core.hpp"
+
+namespace orb::vk
+{
+    /* @brief Stages for vkCmdPipelineBarrier, `none` replacing an empty mask and anything in the
+     * upper bits widening to all commands
+     */
+    inline auto legacy_stages(VkPipelineStageFlags2 stages, VkPipelineStageFlags none) -> VkPipelineStageFlags
+    {
+        if (stages == VK_PIPELINE_STAGE_2_NONE) return none;
+        if ((stages >> 32) != 0) return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        return static_cast<VkPipelineStageFlags>(stages);
+    }
+
+    /* @brief Accesses for the legacy barriers, anything in the upper bits widens to all memory */
+    inline auto legacy_access(VkAccessFlags2 access) -> VkAccessFlags
+    {
+        if ((access >> 32) != 0) return VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        return static_cast<VkAccessFlags>(access);
+    }
+} // namespace orb::vk
@@ -0,0 +1,109 @@
+#include "orb/vk/parallel_recorder.hpp"
+
+#include <algorithm>
+
+namespace orb::vk
+{
+    auto parallel_recorder_t::begin_frame(ui32 slot) -> result<void>
+    {
+        m_slot = slot % m_pools.front().size();
+
+        for (auto& pools : m_pools)
+        {
+            if (auto r = pools[m_slot].reset(); !r) return r.error();
+        }
+
+        return {};
+    }
+
+    auto parallel_recorder_t::record(const secondary_target_t& target, ui32 count, const record_fn_t& fn)
+        -> result<std::span<const VkCommandBuffer>>
+    {
+        const ui32 batches = std::max<ui32>((count + m_min_batch - 1) / m_min_batch, 1);
+
+        m_fn                      = &fn;
+        m_count                   = count;
+        m_chunk_count             = std::min(batches, threads());
+        m_inheritance             = structs::cmd_buffer_inheritance();
+        m_inheritance.renderPass  = target.render_pass;
+        m_inheritance.subpass     = target.subpass;
+        m_inheritance.framebuffer = target.framebuffer;
+        m_cmds.assign(m_chunk_count, nullptr);
+        m_error.reset();
+
+        job_counter_t recorded;
+
+        for (ui32 i = 1; i < m_chunk_count; ++i)
+        {
+            m_jobs->run([this, i] { record_chunk(i); }, &recorded);
+        }
+
+        record_chunk(0);
+        m_jobs->wait(recorded);
+
+        if (m_error) return *m_error;
+
+        return std::span<const VkCommandBuffer> { m_cmds };
+    }
+
+    void parallel_recorder_t::record_chunk(ui32 index)
+    {
+        const auto fail = [&](error_t error) {
+            std::lock_guard lock(m_mutex);
+            if (!m_error) m_error = std::move(error);
+        };
+
+        // Chunks run on whichever thread picks them, a thread may record several. Threads
+        // outside the job system share the last pool set: the caller, but also any thread
+        // running jobs from job_system_t::wait. A pool stays in use until the buffer is
+        // recorded, so they take turns
+        const ui32 thread = m_jobs->thread_slot();
+
+        std::unique_lock<std::mutex> external_lock;
+        if (thread == m_jobs->threads()) external_lock = std::unique_lock(m_external_mutex);
+
+        auto cmd = m_pools[thread][m_slot].acquire(cmd_buffer_level::secondary);
+        if (!cmd) return fail(cmd.error());
+
+        if (auto r = cmd.value().begin_secondary(m_inheritance); !r) return fail(r.error());
+
+        // Even split, chunk sizes differ by at most one item
+        const ui32 begin = static_cast<ui64>(m_count) * index / m_chunk_count;
+        const ui32 end   = static_cast<ui64>(m_count) * (index + 1) / m_chunk_count;
+
+        (*m_fn)(cmd.value(), begin, end);
+
+        if (auto r = cmd.value().end(); !r) return fail(r.error());
+
+        m_cmds[index] = cmd.value().handle;
+    }
+
+    auto parallel_recorder_builder_t::build() -> result<box<parallel_recorder_t>>
+    {
+        auto recorder         = make_box<parallel_recorder_t>();
+        recorder->m_jobs      = m_jobs;
+        recorder->m_min_batch = std::max(m_min_batch, 1u);
+
+        // One pool set per worker, plus one for threads outside the job system
+        recorder->m_pools.resize(m_jobs->threads() + 1);
+
+        for (auto& pools : recorder->m_pools)
+        {
+            pools.resize(m_frames_in_flight);
+
+            for (auto& pool : pools)
+            {
+                auto p = cmd_pool_builder_t::prepare(m_device, m_qf_index)
+                             .unwrap()
+                             .flag(command_pool_create_flag::transient)
+                             .build();
+
+                if (!p) return p.error();
+
+                pool.pool = std::move(p.value());
+            }
+        }
+
+        return recorder;
+    }
+} // namespace orb::vk
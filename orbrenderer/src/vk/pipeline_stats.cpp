@@ -0,0 +1,235 @@
+#include "orb/vk/pipeline_stats.hpp"
+
+#include <algorithm>
+
+namespace orb::vk
+{
+    namespace
+    {
+        // Same order as pipeline_counter, Vulkan writes the enabled counters by increasing bit
+        constexpr VkQueryPipelineStatisticFlags statistic_flags =
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+        // Counters followed by the availability value
+        constexpr ui32 result_stride = pipeline_counter_count + 1;
+    } // namespace
+
+    auto pipeline_counter_name(pipeline_counter counter) -> const char*
+    {
+        switch (counter)
+        {
+        case pipeline_counter::vertex_invocations:
+            return "vertex invocations";
+        case pipeline_counter::clipping_invocations:
+            return "clipping invocations";
+        case pipeline_counter::clipping_primitives:
+            return "clipping primitives";
+        case pipeline_counter::fragment_invocations:
+            return "fragment invocations";
+        case pipeline_counter::compute_invocations:
+            return "compute invocations";
+        }
+
+        return "unknown";
+    }
+
+    void pipeline_stats_t::destroy()
+    {
+        for (auto& frame : m_frames)
+        {
+            if (frame.pool) vkDestroyQueryPool(m_device->handle, frame.pool, host_callbacks(host_scope::resources));
+        }
+
+        m_frames.clear();
+        m_current = nullptr;
+    }
+
+    auto pipeline_stats_t::begin_frame(ui32 slot) -> result<void>
+    {
+        auto& frame = m_frames[slot % m_frames.size()];
+        m_current   = &frame;
+
+        if (frame.used != 0)
+        {
+            const auto res = vkGetQueryPoolResults(m_device->handle,
+                                                   frame.pool,
+                                                   0,
+                                                   frame.used,
+                                                   m_results.size() * sizeof(ui64),
+                                                   m_results.data(),
+                                                   result_stride * sizeof(ui64),
+                                                   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+            if (res != vkres::ok && res != vkres::not_ready)
+            {
+                return error_t { "Could not read pipeline statistics: {}", vkres::get_repr(res) };
+            }
+
+            // Sum per entry first, so `last` covers the whole frame
+            std::vector<pipeline_counters_t> frame_sums(m_entries.size());
+            std::vector<bool>                seen(m_entries.size(), false);
+
+            for (const auto& r : frame.recorded)
+            {
+                const ui64* values = &m_results[static_cast<size_t>(r.query) * result_stride];
+                if (values[pipeline_counter_count] == 0) continue;
+
+                pipeline_counters_t counters;
+                std::copy_n(values, pipeline_counter_count, counters.values.begin());
+
+                frame_sums[r.entry] += counters;
+                seen[r.entry]        = true;
+            }
+
+            for (ui32 e = 0; e < m_entries.size(); ++e)
+            {
+                if (!seen[e]) continue;
+
+                auto& entry  = m_entries[e];
+                entry.last   = frame_sums[e];
+                entry.total += frame_sums[e];
+                entry.frames++;
+            }
+        }
+
+        frame.used = 0;
+        frame.recorded.clear();
+
+        if (m_host_reset)
+        {
+            vkResetQueryPool(m_device->handle, frame.pool, 0, m_max_queries);
+        }
+        else
+        {
+            frame.needs_reset = true;
+        }
+
+        return {};
+    }
+
+    auto pipeline_stats_t::query(VkCommandBuffer cmd, ui64 key, std::string_view name) -> pipeline_query_t
+    {
+        orbassert(m_current != nullptr, "pipeline_stats_t::begin_frame was not called");
+
+        auto& frame = *m_current;
+        if (frame.used == m_max_queries) return {};
+
+        auto it = m_entry_ids.find(key);
+
+        if (it == m_entry_ids.end())
+        {
+            it = m_entry_ids.emplace(key, static_cast<ui32>(m_entries.size())).first;
+            m_entries.push_back({ .key = key, .name = std::string(name) });
+        }
+
+        orbassert(!frame.needs_reset, "pipeline_stats_t::record_reset was not called this frame");
+
+        pipeline_query_t q;
+        q.m_cmd   = cmd;
+        q.m_pool  = frame.pool;
+        q.m_query = frame.used++;
+
+        frame.recorded.push_back({ .entry = it->second, .query = q.m_query });
+
+        vkCmdBeginQuery(cmd, frame.pool, q.m_query, 0);
+
+        return q;
+    }
+
+    void pipeline_stats_t::record_reset(VkCommandBuffer cmd)
+    {
+        orbassert(m_current != nullptr, "pipeline_stats_t::begin_frame was not called");
+
+        if (!m_current->needs_reset) return;
+
+        vkCmdResetQueryPool(cmd, m_current->pool, 0, m_max_queries);
+        m_current->needs_reset = false;
+    }
+
+    auto pipeline_stats_t::ranked(pipeline_counter counter) const -> std::vector<const pipeline_stats_entry_t*>
+    {
+        std::vector<const pipeline_stats_entry_t*> sorted;
+        sorted.reserve(m_entries.size());
+
+        for (const auto& e : m_entries)
+        {
+            sorted.push_back(&e);
+        }
+
+        std::ranges::stable_sort(sorted, [counter](const auto* a, const auto* b) {
+            return a->average(counter) > b->average(counter);
+        });
+
+        return sorted;
+    }
+
+    void pipeline_stats_t::describe(pipeline_counter counter, ui32 count) const
+    {
+        const auto sorted = ranked(counter);
+
+        fmt::println("- Pipeline statistics ({} entries, by {})", sorted.size(), pipeline_counter_name(counter));
+
+        for (ui32 i = 0; i < std::min<size_t>(count, sorted.size()); ++i)
+        {
+            const auto* e = sorted[i];
+
+            fmt::println("  * {} ({:#x}): {} VS, {} clipped prims, {} FS, {} CS per frame",
+                         e->name,
+                         e->key,
+                         e->average(pipeline_counter::vertex_invocations),
+                         e->average(pipeline_counter::clipping_primitives),
+                         e->average(pipeline_counter::fragment_invocations),
+                         e->average(pipeline_counter::compute_invocations));
+        }
+    }
+
+    auto pipeline_stats_builder_t::build() -> result<box<pipeline_stats_t>>
+    {
+        if (m_device->features.pipelineStatisticsQuery != VK_TRUE)
+        {
+            return error_t { "Could not create pipeline statistics: pipelineStatisticsQuery is not enabled" };
+        }
+
+        auto stats           = make_box<pipeline_stats_t>();
+        stats->m_device      = m_device;
+        stats->m_max_queries = m_max_queries;
+        stats->m_host_reset  = m_device->features_12.hostQueryReset == VK_TRUE;
+        stats->m_results.resize(static_cast<size_t>(m_max_queries) * result_stride);
+
+        VkQueryPoolCreateInfo info {
+            .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext              = nullptr,
+            .flags              = 0,
+            .queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            .queryCount         = m_max_queries,
+            .pipelineStatistics = statistic_flags,
+        };
+
+        stats->m_frames.resize(m_frames_in_flight);
+
+        for (auto& frame : stats->m_frames)
+        {
+            const auto res = vkCreateQueryPool(m_device->handle,
+                                               &info,
+                                               host_callbacks(host_scope::resources),
+                                               &frame.pool);
+
+            if (res != vkres::ok)
+            {
+                return error_t { "Could not create pipeline statistics query pool: {}", vkres::get_repr(res) };
+            }
+
+            if (stats->m_host_reset)
+            {
+                vkResetQueryPool(m_device->handle, frame.pool, 0, m_max_queries);
+                frame.needs_reset = false;
+            }
+        }
+
+        return stats;
+    }
+} // namespace orb::vk
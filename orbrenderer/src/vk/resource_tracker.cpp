@@ -0,0 +1,417 @@
+#include "orb/vk/resource_tracker.hpp"
+
+#include "vk/legacy_sync.hpp"
+
+namespace orb::vk
+{
+    namespace
+    {
+        // Only stage and access bits shared with the legacy flags are used, so the fallback path
+        // is a plain truncation
+        constexpr VkPipelineStageFlags2 shader_stages = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT
+                                                      | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+                                                      | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+        constexpr VkPipelineStageFlags2 depth_stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT
+                                                     | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+        constexpr VkAccessFlags2 write_accesses = VK_ACCESS_2_SHADER_WRITE_BIT
+                                                | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+                                                | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                                                | VK_ACCESS_2_TRANSFER_WRITE_BIT
+                                                | VK_ACCESS_2_HOST_WRITE_BIT
+                                                | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+        auto covers(VkFlags64 set, VkFlags64 subset) -> bool
+        {
+            return (set & subset) == subset;
+        }
+    } // namespace
+
+    auto usage_info(resource_usage usage) -> usage_info_t
+    {
+        switch (usage)
+        {
+        case resource_usage::undefined:
+            return {};
+        case resource_usage::indirect_buffer:
+            return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT };
+        case resource_usage::index_buffer:
+            return { VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT };
+        case resource_usage::vertex_buffer:
+            return { VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT };
+        case resource_usage::uniform_buffer:
+            return { shader_stages, VK_ACCESS_2_UNIFORM_READ_BIT };
+        case resource_usage::vertex_shader_read:
+            return { VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                     VK_ACCESS_2_SHADER_READ_BIT,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case resource_usage::fragment_shader_read:
+            return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                     VK_ACCESS_2_SHADER_READ_BIT,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case resource_usage::compute_shader_read:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_2_SHADER_READ_BIT,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case resource_usage::compute_storage_read:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL };
+        case resource_usage::compute_storage_write:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+        case resource_usage::compute_storage_read_write:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_GENERAL,
+                     true };
+        case resource_usage::color_attachment_write:
+            return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                     true };
+        case resource_usage::color_attachment_read_write:
+            return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                     true };
+        case resource_usage::depth_attachment_write:
+            return { depth_stages,
+                     VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                     true };
+        case resource_usage::depth_attachment_read:
+            return { depth_stages,
+                     VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+        case resource_usage::transfer_src:
+            return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+        case resource_usage::transfer_dst:
+            return { VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                     VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     true };
+        case resource_usage::host_read:
+            return { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, VK_IMAGE_LAYOUT_GENERAL };
+        case resource_usage::host_write:
+            return { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+        case resource_usage::present:
+            return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+        case resource_usage::general:
+        default:
+            return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                     VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_GENERAL,
+                     true };
+        }
+    }
+
+    void resource_tracker_t::track_image(VkImage image, image_aspect_flag aspect, ui32 levels, ui32 layers, VkImageLayout layout)
+    {
+        auto& img  = m_images[image];
+        img.aspect = aspect;
+        img.levels = levels;
+        img.layers = layers;
+        img.subresources.assign(static_cast<size_t>(levels) * layers, state_t { .layout = layout });
+    }
+
+    void resource_tracker_t::track_buffer(VkBuffer buffer)
+    {
+        m_buffers[buffer] = {};
+    }
+
+    void resource_tracker_t::use(VkImage image, resource_usage usage)
+    {
+        auto it = m_images.find(image);
+        orbassert(it != m_images.end(), "Image not tracked");
+
+        use(image,
+            usage,
+            {
+                .aspectMask     = vkflag(it->second.aspect),
+                .baseMipLevel   = 0,
+                .levelCount     = it->second.levels,
+                .baseArrayLayer = 0,
+                .layerCount     = it->second.layers,
+            });
+    }
+
+    void resource_tracker_t::use(VkImage image, resource_usage usage, const VkImageSubresourceRange& range)
+    {
+        auto it = m_images.find(image);
+        orbassert(it != m_images.end(), "Image not tracked");
+
+        auto&      img  = it->second;
+        const auto next = usage_info(usage);
+
+        const ui32 count  = range.levelCount == VK_REMAINING_MIP_LEVELS ? img.levels - range.baseMipLevel
+                                                                        : range.levelCount;
+        const ui32 layers = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? img.layers - range.baseArrayLayer
+                                                                          : range.layerCount;
+
+        for (ui32 layer = range.baseArrayLayer; layer < range.baseArrayLayer + layers; ++layer)
+        {
+            // Adjacent levels needing the same transition share one barrier
+            transition_t run;
+            ui32         run_start = range.baseMipLevel;
+
+            for (ui32 level = range.baseMipLevel; level < range.baseMipLevel + count; ++level)
+            {
+                auto& state = img.subresources[static_cast<size_t>(layer) * img.levels + level];
+                auto  t     = transition(state, next, true);
+
+                if (level != run_start && !(t == run))
+                {
+                    queue_image(image, img.aspect, run, run_start, level - run_start, layer);
+                    run_start = level;
+                }
+
+                run = t;
+            }
+
+            queue_image(image, img.aspect, run, run_start, range.baseMipLevel + count - run_start, layer);
+        }
+    }
+
+    void resource_tracker_t::use(VkBuffer buffer, resource_usage usage)
+    {
+        auto it = m_buffers.find(buffer);
+        orbassert(it != m_buffers.end(), "Buffer not tracked");
+
+        queue_global(transition(it->second, usage_info(usage), false));
+    }
+
+    void resource_tracker_t::wait_external(VkImage image, VkPipelineStageFlags2 stages)
+    {
+        auto it = m_images.find(image);
+        orbassert(it != m_images.end(), "Image not tracked");
+
+        for (auto& state : it->second.subresources)
+        {
+            state = state_t { .layout = state.layout, .write_stages = stages };
+        }
+    }
+
+    void resource_tracker_t::wait_external(VkBuffer buffer, VkPipelineStageFlags2 stages)
+    {
+        auto it = m_buffers.find(buffer);
+        orbassert(it != m_buffers.end(), "Buffer not tracked");
+
+        it->second = state_t { .write_stages = stages };
+    }
+
+    auto resource_tracker_t::layout(VkImage image, ui32 level, ui32 layer) const -> VkImageLayout
+    {
+        auto it = m_images.find(image);
+        orbassert(it != m_images.end(), "Image not tracked");
+
+        return it->second.subresources[static_cast<size_t>(layer) * it->second.levels + level].layout;
+    }
+
+    auto resource_tracker_t::transition(state_t& state, const usage_info_t& next, bool is_image) -> transition_t
+    {
+        // Discarding keeps the pending accesses, the next usage still has to wait for them
+        if (next.stages == VK_PIPELINE_STAGE_2_NONE && next.layout == VK_IMAGE_LAYOUT_UNDEFINED)
+        {
+            state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            return {};
+        }
+
+        const bool layout_change = is_image && next.layout != state.layout;
+
+        transition_t t {
+            .dst_stages = next.stages,
+            .dst_access = next.access,
+            .old_layout = state.layout,
+            .new_layout = is_image ? next.layout : state.layout,
+        };
+
+        if (!layout_change && !next.writes)
+        {
+            state.read_stages |= next.stages;
+
+            // Read after read, or the last write is already visible to this usage
+            if (state.write_stages == VK_PIPELINE_STAGE_2_NONE
+                || (covers(state.visible_stages, next.stages) && covers(state.visible_access, next.access)))
+            {
+                return {};
+            }
+
+            t.src_stages = state.write_stages;
+            t.src_access = state.write_access;
+            t.needed     = true;
+
+            state.visible_stages |= next.stages;
+            state.visible_access |= next.access;
+
+            return t;
+        }
+
+        // Writes and layout transitions wait for every access since the last write, but only
+        // writes need to be made available
+        t.src_stages = state.write_stages | state.read_stages;
+        t.src_access = state.write_access;
+        t.needed     = layout_change || t.src_stages != VK_PIPELINE_STAGE_2_NONE;
+
+        state.layout = t.new_layout;
+
+        if (next.writes)
+        {
+            state.write_stages   = next.stages;
+            state.write_access   = next.access & write_accesses;
+            state.read_stages    = VK_PIPELINE_STAGE_2_NONE;
+            state.visible_stages = VK_PIPELINE_STAGE_2_NONE;
+            state.visible_access = VK_ACCESS_2_NONE;
+        }
+        else
+        {
+            // The layout transition is the write, visible to this usage only
+            state.write_stages   = next.stages;
+            state.write_access   = VK_ACCESS_2_NONE;
+            state.read_stages    = next.stages;
+            state.visible_stages = next.stages;
+            state.visible_access = next.access;
+        }
+
+        return t;
+    }
+
+    void resource_tracker_t::queue_global(const transition_t& t)
+    {
+        if (!t.needed) return;
+
+        m_global.srcStageMask  |= t.src_stages;
+        m_global.srcAccessMask |= t.src_access;
+        m_global.dstStageMask  |= t.dst_stages;
+        m_global.dstAccessMask |= t.dst_access;
+        m_global_pending = true;
+    }
+
+    void resource_tracker_t::queue_image(
+        VkImage image, image_aspect_flag aspect, const transition_t& t, ui32 level, ui32 level_count, ui32 layer)
+    {
+        if (!t.needed) return;
+
+        // Without layout change, an image needs nothing a global barrier does not provide
+        if (t.old_layout == t.new_layout)
+        {
+            queue_global(t);
+            return;
+        }
+
+        // Same transition on the same levels of the previous layer: extend that barrier
+        for (auto it = m_image_barriers.rbegin(); it != m_image_barriers.rend() && it->image == image; ++it)
+        {
+            auto& range = it->subresourceRange;
+
+            if (range.baseMipLevel == level && range.levelCount == level_count
+                && range.baseArrayLayer + range.layerCount == layer && it->oldLayout == t.old_layout
+                && it->newLayout == t.new_layout && it->srcStageMask == t.src_stages
+                && it->srcAccessMask == t.src_access && it->dstStageMask == t.dst_stages
+                && it->dstAccessMask == t.dst_access)
+            {
+                range.layerCount++;
+                return;
+            }
+        }
+
+        m_image_barriers.push_back({
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext               = nullptr,
+            .srcStageMask        = t.src_stages,
+            .srcAccessMask       = t.src_access,
+            .dstStageMask        = t.dst_stages,
+            .dstAccessMask       = t.dst_access,
+            .oldLayout           = t.old_layout,
+            .newLayout           = t.new_layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = image,
+            .subresourceRange    = {
+                .aspectMask     = vkflag(aspect),
+                .baseMipLevel   = level,
+                .levelCount     = level_count,
+                .baseArrayLayer = layer,
+                .layerCount     = 1,
+            },
+        });
+    }
+
+    void resource_tracker_t::flush(VkCommandBuffer cmd)
+    {
+        if (!pending()) return;
+
+        if (m_use_sync2)
+        {
+            flush_sync2(cmd);
+        }
+        else
+        {
+            flush_legacy(cmd);
+        }
+
+        m_barrier_calls++;
+        m_image_barrier_count += m_image_barriers.size();
+
+        m_global         = empty_global();
+        m_global_pending = false;
+        m_image_barriers.clear();
+    }
+
+    void resource_tracker_t::flush_sync2(VkCommandBuffer cmd)
+    {
+        VkDependencyInfo info {
+            .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .memoryBarrierCount      = m_global_pending ? 1u : 0u,
+            .pMemoryBarriers         = &m_global,
+            .imageMemoryBarrierCount = static_cast<ui32>(m_image_barriers.size()),
+            .pImageMemoryBarriers    = m_image_barriers.data(),
+        };
+
+        vkCmdPipelineBarrier2(cmd, &info);
+    }
+
+    void resource_tracker_t::flush_legacy(VkCommandBuffer cmd)
+    {
+        // One stage mask pair for the whole call: the union of every barrier's stages
+        VkPipelineStageFlags2 src_stages = m_global.srcStageMask;
+        VkPipelineStageFlags2 dst_stages = m_global.dstStageMask;
+
+        m_legacy_barriers.clear();
+
+        for (const auto& b : m_image_barriers)
+        {
+            src_stages |= b.srcStageMask;
+            dst_stages |= b.dstStageMask;
+
+            m_legacy_barriers.push_back({
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .pNext               = nullptr,
+                .srcAccessMask       = legacy_access(b.srcAccessMask),
+                .dstAccessMask       = legacy_access(b.dstAccessMask),
+                .oldLayout           = b.oldLayout,
+                .newLayout           = b.newLayout,
+                .srcQueueFamilyIndex = b.srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = b.dstQueueFamilyIndex,
+                .image               = b.image,
+                .subresourceRange    = b.subresourceRange,
+            });
+        }
+
+        const VkMemoryBarrier global {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .pNext         = nullptr,
+            .srcAccessMask = legacy_access(m_global.srcAccessMask),
+            .dstAccessMask = legacy_access(m_global.dstAccessMask),
+        };
+
+        vkCmdPipelineBarrier(cmd,
+                             legacy_stages(src_stages, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                             legacy_stages(dst_stages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT),
+                             0,
+                             m_global_pending ? 1 : 0,
+                             &global,
+                             0,
+                             nullptr,
+                             static_cast<ui32>(m_legacy_barriers.size()),
+                             m_legacy_barriers.data());
+    }
+} // namespace orb::vk
@@ -0,0 +1,278 @@
+#include "orb/vk/submit_service.hpp"
+
+#include "orb/profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace orb::vk
+{
+    namespace
+    {
+        // Min heap on tickets
+        constexpr auto later_ticket = [](const auto& a, const auto& b) {
+            return a.ticket > b.ticket;
+        };
+
+        // Longest a waiter blocks before checking whether the service failed
+        constexpr ui64 wait_slice_ns = 10'000'000;
+    } // namespace
+
+    submit_service_t::~submit_service_t()
+    {
+        for (auto& worker : m_workers)
+        {
+            worker->stop.store(true, std::memory_order_release);
+            worker->pushed.fetch_add(1, std::memory_order_release);
+            worker->pushed.notify_one();
+        }
+
+        for (auto& worker : m_workers)
+        {
+            if (worker->thread.joinable()) worker->thread.join();
+
+            while (worker->tail)
+            {
+                node_t* next = worker->tail->next.load(std::memory_order_acquire);
+                delete worker->tail;
+                worker->tail = next;
+            }
+        }
+    }
+
+    auto submit_service_t::push(VkQueue queue, submit_packet_t&& packet) -> result<sync_point_t>
+    {
+        auto* worker = find(queue);
+        if (!worker) return error_t { "Queue was not given to submit_service_builder_t::queue" };
+
+        const ui64 ticket = worker->next_ticket.fetch_add(1, std::memory_order_relaxed);
+
+        auto* node   = new node_t;
+        node->ticket = ticket;
+        node->packet = std::move(packet);
+
+        // Between the exchange and the link the node is not reachable yet, the submit thread
+        // stops at the gap and is woken again by the bump below. Once linked, the node may be
+        // consumed and freed at any time
+        node_t* prev = worker->head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+
+        worker->pushed.fetch_add(1, std::memory_order_release);
+        worker->pushed.notify_one();
+
+        return worker->timeline.point(ticket);
+    }
+
+    auto submit_service_t::wait(sync_point_t token, ui64 timeout) const -> result<void>
+    {
+        if (!token.semaphore || token.value == 0) return status();
+
+        auto info           = structs::semaphore_wait();
+        info.semaphoreCount = 1;
+        info.pSemaphores    = &token.semaphore;
+        info.pValues        = &token.value;
+
+        // Packets dropped after a failure never reach their point: wait in slices and give up
+        // as soon as the service failed
+        using clock = std::chrono::steady_clock;
+
+        const auto start = clock::now();
+
+        for (;;)
+        {
+            if (auto r = status(); !r) return r.error();
+
+            const auto elapsed = static_cast<ui64>(std::chrono::nanoseconds(clock::now() - start).count());
+            const ui64 left    = timeout > elapsed ? timeout - elapsed : 0;
+            const auto res     = vkWaitSemaphores(m_device, &info, std::min(left, wait_slice_ns));
+
+            if (res == vkres::ok) return status();
+
+            if (res != vkres::timeout || left <= wait_slice_ns)
+            {
+                return error_t { "Failed to wait for timeline semaphores: {}", vkres::get_repr(res) };
+            }
+        }
+    }
+
+    auto submit_service_t::completed(sync_point_t token) const -> result<bool>
+    {
+        if (auto r = status(); !r) return r.error();
+
+        ui64 value = 0;
+
+        if (auto res = vkGetSemaphoreCounterValue(m_device, token.semaphore, &value); res != vkres::ok)
+        {
+            return error_t { "Failed to read timeline semaphore: {}", vkres::get_repr(res) };
+        }
+
+        return value >= token.value;
+    }
+
+    auto submit_service_t::status() const -> result<void>
+    {
+        if (!m_failed.load(std::memory_order_acquire)) return {};
+
+        std::lock_guard lock(m_error_mutex);
+        return *m_error;
+    }
+
+    auto submit_service_t::submit_calls() const -> ui64
+    {
+        ui64 count = 0;
+        for (const auto& worker : m_workers)
+        {
+            count += worker->submit_calls.load(std::memory_order_relaxed);
+        }
+
+        return count;
+    }
+
+    auto submit_service_t::packets() const -> ui64
+    {
+        ui64 count = 0;
+        for (const auto& worker : m_workers)
+        {
+            count += worker->packets.load(std::memory_order_relaxed);
+        }
+
+        return count;
+    }
+
+    auto submit_service_t::find(VkQueue queue) -> worker_t*
+    {
+        for (auto& worker : m_workers)
+        {
+            if (worker->queue == queue) return worker.getmut().raw();
+        }
+
+        return nullptr;
+    }
+
+    void submit_service_t::fail(error_t error)
+    {
+        std::lock_guard lock(m_error_mutex);
+
+        if (!m_error) m_error = std::move(error);
+        m_failed.store(true, std::memory_order_release);
+    }
+
+    void submit_service_t::drain(worker_t& worker)
+    {
+        // The tail is the last node consumed, its successors hold the packets
+        while (node_t* next = worker.tail->next.load(std::memory_order_acquire))
+        {
+            worker.pending.push_back({ .ticket = next->ticket, .packet = std::move(next->packet) });
+            std::ranges::push_heap(worker.pending, later_ticket);
+
+            delete worker.tail;
+            worker.tail = next;
+        }
+    }
+
+    void submit_service_t::worker_loop(worker_t& worker)
+    {
+        for (;;)
+        {
+            const ui64 pushed = worker.pushed.load(std::memory_order_acquire);
+
+            drain(worker);
+
+            // Tickets are taken before the push, a later ticket may arrive first: only submit
+            // the run of consecutive tickets, the missing one is about to be pushed
+            ui32 count = 0;
+            ui64 last  = 0;
+
+            while (!worker.pending.empty() && worker.pending.front().ticket == worker.next_submit && count < m_max_batch)
+            {
+                std::ranges::pop_heap(worker.pending, later_ticket);
+                const auto& [ticket, packet] = worker.pending.back();
+
+                worker.batch.submit(worker.queue);
+
+                for (const auto& w : packet.m_waits)
+                {
+                    worker.batch.wait(w.semaphore, w.stages, w.value);
+                }
+
+                worker.batch.cmd_buffers(packet.m_cmds);
+
+                for (const auto& s : packet.m_signals)
+                {
+                    worker.batch.signal(s.semaphore, s.stages, s.value);
+                }
+
+                const bool fenced = packet.m_fence != nullptr;
+                if (fenced) worker.batch.fence(packet.m_fence);
+
+                last = ticket;
+                worker.next_submit++;
+                count++;
+                worker.pending.pop_back();
+
+                // A batch signals a single fence
+                if (fenced) break;
+            }
+
+            if (count > 0)
+            {
+                ORB_PROFILE_ZONE("submit_service_t::submit");
+
+                worker.batch.signal_timeline(worker.timeline.point(last));
+
+                if (m_failed.load(std::memory_order_acquire))
+                {
+                    worker.batch.clear();
+                }
+                else if (auto r = worker.batch.flush(); !r)
+                {
+                    fail(r.error());
+                }
+                else
+                {
+                    worker.submit_calls.fetch_add(1, std::memory_order_relaxed);
+                    worker.packets.fetch_add(count, std::memory_order_relaxed);
+                }
+
+                continue;
+            }
+
+            if (worker.stop.load(std::memory_order_acquire) && worker.pending.empty()) return;
+
+            worker.pushed.wait(pushed, std::memory_order_acquire);
+        }
+    }
+
+    auto submit_service_builder_t::build() -> result<box<submit_service_t>>
+    {
+        auto service         = make_box<submit_service_t>();
+        service->m_device    = m_device->handle;
+        service->m_max_batch = std::max(m_max_batch, 1u);
+
+        for (auto queue : m_queues)
+        {
+            auto timeline = timeline_semaphore_builder_t::prepare(m_device).unwrap().build();
+            if (!timeline) return timeline.error();
+
+            auto worker      = make_box<submit_service_t::worker_t>();
+            worker->queue    = queue;
+            worker->timeline = std::move(timeline.value());
+            worker->batch    = submit_batch_t::prepare(m_device);
+
+            // The list always holds a consumed node, so producers never see it empty
+            auto* stub = new submit_service_t::node_t;
+            worker->head.store(stub, std::memory_order_relaxed);
+            worker->tail = stub;
+
+            service->m_workers.push_back(std::move(worker));
+        }
+
+        // Threads start once the worker list is final, push only reads it
+        for (auto& worker : service->m_workers)
+        {
+            worker->thread = std::thread(&submit_service_t::worker_loop, service.getmut().raw(), std::ref(*worker.getmut().raw()));
+        }
+
+        return service;
+    }
+} // namespace orb::vk
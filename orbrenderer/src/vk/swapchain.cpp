@@ -2,6 +2,8 @@
 
 #include "orb/glfw/driver.hpp"
 #include "orb/glfw/window.hpp"
+#include "orb/profiler.hpp"
+#include "orb/vk/deletion_queue.hpp"
 #include "orb/vk/device.hpp"
 #include "orb/vk/gpu.hpp"
 #include "orb/vk/instance.hpp"
@@ -13,6 +15,8 @@
 
 #include <imgui_impl_vulkan.h>
 
+#include <algorithm>
+
 namespace orb::vk
 {
     auto swapchain_builder_t::prepare(weak<instance_t>     instance,
@@ -55,8 +59,20 @@ namespace orb::vk
         return *this;
     }
 
+    auto swapchain_builder_t::queue_family(ui32 index) -> swapchain_builder_t&
+    {
+        if (std::ranges::find(sc->queue_families, index) == sc->queue_families.end())
+        {
+            sc->queue_families.push_back(index);
+        }
+
+        return *this;
+    }
+
     auto swapchain_builder_t::build() -> result<box<swapchain_t>>
     {
+        ORB_PROFILE_ZONE("swapchain_builder_t::build");
+
         sc->window   = window;
         sc->device   = device;
         sc->gpu      = gpu;
@@ -153,6 +169,22 @@ namespace orb::vk
         sc->info.imageColorSpace  = sc->format.colorSpace;
         sc->info.imageArrayLayers = 1;
         sc->info.imageSharingMode = vkenum(sharing_mode::exclusive);
+
+        if (!sc->queue_families.empty())
+        {
+            queue_family(present_qf_index);
+        }
+
+        if (sc->queue_families.size() > 1)
+        {
+            sc->info.imageSharingMode      = vkenum(sharing_mode::concurrent);
+            sc->info.queueFamilyIndexCount = sc->queue_families.size();
+        }
+        else
+        {
+            sc->queue_families.clear();
+        }
+
         sc->info.preTransform     = vkenum(surface_transform_flag::identity_khr);
         sc->info.compositeAlpha   = vkenum(composite_alpha_flag::opaque_khr);
         sc->info.presentMode      = sc->present_mode;
@@ -170,18 +202,51 @@ namespace orb::vk
     {
         if (handle)
         {
-            vkDestroySwapchainKHR(device->handle, handle, nullptr);
+            vkDestroySwapchainKHR(device->handle, handle, host_callbacks(host_scope::device));
             handle = nullptr;
         }
 
         if (info.surface)
         {
-            vkDestroySurfaceKHR(instance, info.surface, nullptr);
+            vkDestroySurfaceKHR(instance, info.surface, host_callbacks(host_scope::instance));
             info.surface = nullptr;
         }
     }
 
     auto swapchain_t::rebuild() -> result<void>
+    {
+        ORB_PROFILE_ZONE("swapchain_t::rebuild");
+
+        const VkSwapchainKHR old = handle;
+        auto                 r   = recreate();
+
+        // The new handle replaced the old one even if fetching its images failed
+        if (old && old != handle)
+        {
+            vkDestroySwapchainKHR(device->handle, old, host_callbacks(host_scope::device));
+        }
+
+        return r;
+    }
+
+    auto swapchain_t::rebuild(deletion_queue_t& retired) -> result<void>
+    {
+        ORB_PROFILE_ZONE("swapchain_t::rebuild");
+
+        const VkSwapchainKHR old = handle;
+        auto                 r   = recreate();
+
+        if (old && old != handle)
+        {
+            retired.defer_fn([device = device->handle, old] {
+                vkDestroySwapchainKHR(device, old, host_callbacks(host_scope::device));
+            });
+        }
+
+        return r;
+    }
+
+    auto swapchain_t::recreate() -> result<void>
     {
         info.oldSwapchain = handle;
         auto dims         = window->get_fb_dimensions();
@@ -217,18 +282,17 @@ namespace orb::vk
         extent.width  = width;
         extent.height = height;
 
+        // The family list moves with the swapchain
+        info.pQueueFamilyIndices = queue_families.data();
+
         VkSwapchainKHR new_handle = nullptr;
 
-        if (auto r = vkCreateSwapchainKHR(device->handle, &info, nullptr, &new_handle); r != vkres::ok)
+        if (auto r = vkCreateSwapchainKHR(device->handle, &info, host_callbacks(host_scope::device), &new_handle); r != vkres::ok)
         {
             return error_t { "Could not create the swapchain: {}", vkres::get_repr(r) };
         }
 
-        if (handle)
-        {
-            vkDestroySwapchainKHR(device->handle, handle, nullptr);
-        }
-
+        // The caller retires the old handle
         handle = new_handle;
 
         if (auto r = vkGetSwapchainImagesKHR(device->handle, handle, &img_count, nullptr);
@@ -250,11 +314,15 @@ namespace orb::vk
             device->set_name(img, "Swapchain image");
         }
 
+        generation++;
+
         return {};
     }
 
     auto acquire_img(swapchain_t& sc, VkSemaphore sem, VkFence fence, ui64 timeout) -> img_res_t
     {
+        ORB_PROFILE_ZONE("acquire_img");
+
         ui32      frame {};
         img_res_t res;
 
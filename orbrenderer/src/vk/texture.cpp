@@ -0,0 +1,536 @@
+#include "orb/vk/texture.hpp"
+
+#include "orb/profiler.hpp"
+#include "orb/vk/fences.hpp"
+#include "orb/vk/images.hpp"
+#include "orb/vk/staging_buffer.hpp"
+
+#include <array>
+#include <string>
+
+namespace orb::vk
+{
+    namespace
+    {
+        // Averages 2x2 texels of the previous level. Odd sizes clamp to the last row / column.
+        constexpr std::string_view downsample_source = R"(
+            layout(local_size_x = 8, local_size_y = 8) in;
+
+            layout(set = 0, binding = 0, STORAGE_FORMAT) uniform readonly image2D src_mip;
+            layout(set = 0, binding = 1, STORAGE_FORMAT) uniform writeonly image2D dst_mip;
+
+            void main()
+            {
+                ivec2 dst_size = imageSize(dst_mip);
+                ivec2 p        = ivec2(gl_GlobalInvocationID.xy);
+
+                if (p.x >= dst_size.x || p.y >= dst_size.y) return;
+
+                ivec2 src_max = imageSize(src_mip) - 1;
+                ivec2 s       = p * 2;
+
+                vec4 c = imageLoad(src_mip, min(s, src_max))
+                       + imageLoad(src_mip, min(s + ivec2(1, 0), src_max))
+                       + imageLoad(src_mip, min(s + ivec2(0, 1), src_max))
+                       + imageLoad(src_mip, min(s + ivec2(1, 1), src_max));
+
+                imageStore(dst_mip, p, c * 0.25);
+            }
+        )";
+
+        constexpr ui32 downsample_group_size = 8;
+
+        constexpr auto storage_format_qualifier(format fmt) -> const char*
+        {
+            switch (fmt)
+            {
+            case format::r8g8b8a8_unorm:
+                return "rgba8";
+            case format::r16g16b16a16_sfloat:
+                return "rgba16f";
+            case format::r32g32b32a32_sfloat:
+                return "rgba32f";
+            default:
+                return nullptr;
+            }
+        }
+
+        auto full_range(ui32 base_level, ui32 level_count) -> VkImageSubresourceRange
+        {
+            return {
+                .aspectMask     = vkflag(image_aspect_flag::color),
+                .baseMipLevel   = base_level,
+                .levelCount     = level_count,
+                .baseArrayLayer = 0,
+                .layerCount     = 1,
+            };
+        }
+
+        auto mip_extent(ui32 size, ui32 level) -> int32_t
+        {
+            return static_cast<int32_t>(std::max(size >> level, 1u));
+        }
+
+        /* @brief Bytes per texel of the uncompressed formats the pixels are copied from, 0 otherwise */
+        auto texel_size(VkFormat fmt) -> ui32
+        {
+            switch (fmt)
+            {
+            case VK_FORMAT_R8_UNORM:
+            case VK_FORMAT_R8_SRGB:
+                return 1;
+            case VK_FORMAT_R8G8_UNORM:
+            case VK_FORMAT_R8G8_SRGB:
+            case VK_FORMAT_R16_UNORM:
+            case VK_FORMAT_R16_SFLOAT:
+                return 2;
+            case VK_FORMAT_R8G8B8_UNORM:
+            case VK_FORMAT_R8G8B8_SRGB:
+            case VK_FORMAT_B8G8R8_UNORM:
+            case VK_FORMAT_B8G8R8_SRGB:
+                return 3;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+            case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+            case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+            case VK_FORMAT_R16G16_UNORM:
+            case VK_FORMAT_R16G16_SFLOAT:
+            case VK_FORMAT_R32_SFLOAT:
+                return 4;
+            case VK_FORMAT_R16G16B16A16_UNORM:
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            case VK_FORMAT_R32G32_SFLOAT:
+                return 8;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                return 16;
+            default:
+                return 0;
+            }
+        }
+    } // namespace
+
+    auto mip_generator_t::create(weak<device_t> device, weak<spirv_compiler_t> compiler)
+        -> result<box<mip_generator_t>>
+    {
+        auto generator        = make_box<mip_generator_t>();
+        generator->m_device   = device;
+        generator->m_compiler = compiler;
+        return generator;
+    }
+
+    auto mip_generator_t::supports(format fmt) const -> bool
+    {
+        if (!storage_format_qualifier(fmt)) return false;
+
+        VkFormatProperties props {};
+        vkGetPhysicalDeviceFormatProperties(m_device->physical_device, vkenum(fmt), &props);
+
+        return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+    }
+
+    auto mip_generator_t::pipeline(format fmt) -> result<weak<compute_pipeline_t>>
+    {
+        for (auto& [pipeline_fmt, pipeline] : m_pipelines)
+        {
+            if (pipeline_fmt == fmt) return pipeline.getmut();
+        }
+
+        std::string source = "#version 450\n#define STORAGE_FORMAT ";
+        source += storage_format_qualifier(fmt);
+        source += downsample_source;
+
+        auto module = shader_module_builder_t::prepare(m_device, m_compiler)
+                          .unwrap()
+                          .kind(shader_kind::glsl_compute)
+                          .content(std::move(source))
+                          .build();
+
+        if (!module) return module.error();
+
+        auto pipeline = compute_pipeline_builder_t::prepare(m_device)
+                            .unwrap()
+                            .shader(module.value().handle)
+                            .binding(0, descriptor_type::storage_image)
+                            .binding(1, descriptor_type::storage_image)
+                            .build();
+
+        if (!pipeline) return pipeline.error();
+
+        return m_pipelines.emplace_back(fmt, std::move(pipeline.value())).second.getmut();
+    }
+
+    auto mip_generator_t::record(VkCommandBuffer cmd,
+                                 VkImage         image,
+                                 format          fmt,
+                                 VkExtent2D      extent,
+                                 ui32            levels) -> result<mip_generation_t>
+    {
+        auto pipeline_res = pipeline(fmt);
+        if (!pipeline_res) return pipeline_res.error();
+        auto downsample = pipeline_res.value();
+
+        mip_generation_t generation;
+
+        const ui32 dispatches = levels - 1;
+
+        auto pool_res = desc_pool_builder_t::prepare(m_device)
+                            .unwrap()
+                            .pool(descriptor_type::storage_image, dispatches * 2)
+                            .max_desc_sets(dispatches)
+                            .build();
+
+        if (!pool_res) return pool_res.error();
+        generation.pool = std::move(pool_res.value());
+
+        // One view per mip level
+        generation.views.device = m_device->handle;
+        generation.views.handles.reserve(levels);
+
+        for (ui32 level = 0; level < levels; ++level)
+        {
+            auto info             = structs::create::image_view();
+            info.image            = image;
+            info.format           = vkenum(fmt);
+            info.subresourceRange = full_range(level, 1);
+
+            auto& pair = generation.views.handles.emplace_back(image, nullptr);
+
+            if (auto res = vkCreateImageView(m_device->handle, &info, host_callbacks(host_scope::resources), &pair.view); res != vkres::ok)
+            {
+                return error_t { "Could not create mip view: {}", vkres::get_repr(res) };
+            }
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(dispatches, downsample->desc_set_layout);
+        std::vector<VkDescriptorSet>       sets(dispatches);
+
+        auto alloc_info               = structs::create::desc_sets(generation.pool.handle);
+        alloc_info.descriptorSetCount = dispatches;
+        alloc_info.pSetLayouts        = layouts.data();
+
+        if (auto res = vkAllocateDescriptorSets(m_device->handle, &alloc_info, sets.data()); res != vkres::ok)
+        {
+            return error_t { "Could not allocate mip descriptor sets: {}", vkres::get_repr(res) };
+        }
+
+        downsample->bind(cmd);
+
+        for (ui32 level = 1; level < levels; ++level)
+        {
+            VkDescriptorSet set = sets[level - 1];
+
+            std::array<VkDescriptorImageInfo, 2> img_infos { {
+                { .imageView = generation.views.handles[level - 1].view, .imageLayout = vkenum(image_layout::general) },
+                { .imageView = generation.views.handles[level].view, .imageLayout = vkenum(image_layout::general) },
+            } };
+
+            std::array<VkWriteDescriptorSet, 2> writes {};
+            for (ui32 binding = 0; binding < writes.size(); ++binding)
+            {
+                auto& write           = writes[binding];
+                write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet          = set;
+                write.dstBinding      = binding;
+                write.descriptorCount = 1;
+                write.descriptorType  = vkenum(descriptor_type::storage_image);
+                write.pImageInfo      = &img_infos[binding];
+            }
+
+            vkUpdateDescriptorSets(m_device->handle, writes.size(), writes.data(), 0, nullptr);
+
+            downsample->bind_desc_set(cmd, set);
+
+            const auto w = static_cast<ui32>(mip_extent(extent.width, level));
+            const auto h = static_cast<ui32>(mip_extent(extent.height, level));
+
+            vkCmdDispatch(cmd,
+                          (w + downsample_group_size - 1) / downsample_group_size,
+                          (h + downsample_group_size - 1) / downsample_group_size,
+                          1);
+
+            // The next dispatch reads what this one wrote
+            transition_layout(cmd, image, image_layout::general, image_layout::general, full_range(level, 1));
+        }
+
+        return generation;
+    }
+
+    auto texture_builder_t::prepare(weak<device_t> device) -> result<texture_builder_t>
+    {
+        texture_builder_t b;
+
+        b.m_device = device;
+
+        b.m_info.extent.depth  = 1;
+        b.m_info.mipLevels     = 1;
+        b.m_info.arrayLayers   = 1;
+        b.m_info.format        = vkenum(format::r8g8b8a8_srgb);
+        b.m_info.tiling        = vkenum(image_tiling::optimal);
+        b.m_info.initialLayout = vkenum(image_layout::undefined);
+        b.m_info.usage         = vkflag(image_usage_flag::sampled | image_usage_flag::transfer_dst);
+        b.m_info.samples       = vkenum(sample_count_flag::_1);
+        b.m_info.sharingMode   = vkenum(sharing_mode::exclusive);
+
+        b.m_alloc_info.usage = vkenum(memory_usage::usage_auto);
+
+        return std::move(b);
+    }
+
+    auto texture_builder_t::supports_linear_blit() const -> bool
+    {
+        VkFormatProperties props {};
+        vkGetPhysicalDeviceFormatProperties(m_device->physical_device, m_info.format, &props);
+
+        constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT
+                                                | VK_FORMAT_FEATURE_BLIT_DST_BIT
+                                                | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+        return (props.optimalTilingFeatures & required) == required;
+    }
+
+    auto texture_builder_t::build() -> result<texture_t>
+    {
+        ORB_PROFILE_ZONE("texture_builder_t::build");
+
+        if (!m_pool || !m_queue)
+        {
+            return error_t { "Could not create texture: no staging queue given" };
+        }
+
+        auto cmds_res = m_pool->alloc_cmds(1);
+        if (!cmds_res) return cmds_res.error();
+        auto cmd = cmds_res.value().get(0).unwrap();
+
+        // Freed on every path, the upload is no longer pending once it returns
+        auto texture = submit_and_wait(cmd);
+        m_pool->free_cmds({ &cmd.handle, 1 });
+
+        return texture;
+    }
+
+    auto texture_builder_t::submit_and_wait(cmd_buffer_t& cmd) -> result<texture_t>
+    {
+        if (auto r = cmd.begin(command_buffer_usage_flag::one_time_submit); !r) return r.error();
+
+        auto upload_res = record(cmd.handle, m_pool->qf_index);
+        if (!upload_res) return upload_res.error();
+        auto& upload = upload_res.value();
+
+        if (auto r = cmd.end(); !r) return r.error();
+
+        auto fences_res = fences_builder_t::create(m_device, 1);
+        if (!fences_res) return fences_res.error();
+        auto fence = fences_res.value()[0];
+
+        if (auto r = fence.reset(); !r) return r.error();
+
+        if (auto r = submit_helper_t::prepare().cmd_buffer(&cmd.handle).submit(m_queue, fence.handle); !r)
+        {
+            return r.error();
+        }
+
+        if (auto r = fence.wait(); !r) return r.error();
+
+        return std::move(upload.texture);
+    }
+
+    auto texture_builder_t::record(VkCommandBuffer cmd, ui32 qf_index) -> result<texture_upload_t>
+    {
+        ORB_PROFILE_ZONE("texture_builder_t::record");
+
+        const auto width  = m_info.extent.width;
+        const auto height = m_info.extent.height;
+        const auto fmt    = static_cast<vk::format>(m_info.format);
+
+        if (!m_data || m_size == 0)
+        {
+            return error_t { "Could not create texture: no pixel data given" };
+        }
+
+        if (width == 0 || height == 0)
+        {
+            return error_t { "Could not create texture: size is {}x{}", width, height };
+        }
+
+        const ui32 texel = texel_size(m_info.format);
+
+        if (texel == 0)
+        {
+            return error_t { "Could not create texture: format {} is not an uncompressed color format", static_cast<ui32>(fmt) };
+        }
+
+        // Only the first level is copied, tightly packed
+        if (const ui64 needed = ui64 { width } * height * texel; m_size < needed)
+        {
+            return error_t { "Could not create texture: {} bytes of pixels given, {}x{} needs {}", m_size, width, height, needed };
+        }
+
+        const ui32 levels = m_generate_mips ? mip_chain_length(width, height) : 1;
+
+        // vkCmdBlitImage needs a graphics queue, the downsampler a compute one
+        const VkQueueFlags qf_flags    = queue_family_flags(m_device->physical_device, qf_index);
+        const bool         can_blit    = (qf_flags & VK_QUEUE_GRAPHICS_BIT) != 0 && supports_linear_blit();
+        const bool         can_compute = (qf_flags & VK_QUEUE_COMPUTE_BIT) != 0 && m_generator && m_generator->supports(fmt);
+
+        const bool use_blit    = levels > 1 && can_blit;
+        const bool use_compute = levels > 1 && !use_blit;
+
+        if (use_compute && !can_compute)
+        {
+            return error_t { "Could not generate mips: format {} on queue family {} allows neither linear blits nor storage writes",
+                             static_cast<ui32>(fmt),
+                             qf_index };
+        }
+
+        auto info      = m_info;
+        info.mipLevels = levels;
+
+        if (use_blit) info.usage |= vkflag(image_usage_flag::transfer_src);
+        if (use_compute) info.usage |= vkflag(image_usage_flag::storage);
+
+        texture_upload_t upload;
+
+        auto& texture      = upload.texture;
+        texture.device     = m_device->handle;
+        texture.allocator  = m_device->allocator;
+        texture.format     = m_info.format;
+        texture.extent     = { width, height };
+        texture.mip_levels = levels;
+
+        if (auto res = vmaCreateImage(m_device->allocator, &info, &m_alloc_info, &texture.image, &texture.allocation, nullptr);
+            res != vkres::ok)
+        {
+            return error_t { "Could not create texture image: {}", vkres::get_repr(res) };
+        }
+
+        auto staging_res = staging_buffer_builder_t::prepare(m_device, m_size).unwrap().build();
+        if (!staging_res) return staging_res.error();
+        upload.staging = std::move(staging_res.value());
+
+        if (auto r = upload.staging.transfer(m_data, m_size); !r) return r.error();
+
+        transition_layout(cmd,
+                          texture.image,
+                          image_layout::undefined,
+                          image_layout::transfer_dst_optimal,
+                          full_range(0, levels),
+                          qf_flags);
+
+        VkBufferImageCopy region {
+            .bufferOffset      = 0,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource  = {
+                .aspectMask     = vkflag(image_aspect_flag::color),
+                .mipLevel       = 0,
+                .baseArrayLayer = 0,
+                .layerCount     = 1,
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = { width, height, 1 },
+        };
+
+        vkCmdCopyBufferToImage(cmd,
+                               upload.staging.buffer,
+                               texture.image,
+                               vkenum(image_layout::transfer_dst_optimal),
+                               1,
+                               &region);
+
+        if (use_blit)
+        {
+            for (ui32 level = 1; level < levels; ++level)
+            {
+                // Level - 1 is complete: read from it, then hand it over to its final layout
+                transition_layout(cmd,
+                                  texture.image,
+                                  image_layout::transfer_dst_optimal,
+                                  image_layout::transfer_src_optimal,
+                                  full_range(level - 1, 1),
+                                  qf_flags);
+
+                VkImageBlit blit {
+                    .srcSubresource = { vkflag(image_aspect_flag::color), level - 1, 0, 1 },
+                    .srcOffsets     = {
+                        { 0, 0, 0 },
+                        { mip_extent(width, level - 1), mip_extent(height, level - 1), 1 },
+                    },
+                    .dstSubresource = { vkflag(image_aspect_flag::color), level, 0, 1 },
+                    .dstOffsets     = {
+                        { 0, 0, 0 },
+                        { mip_extent(width, level), mip_extent(height, level), 1 },
+                    },
+                };
+
+                vkCmdBlitImage(cmd,
+                               texture.image,
+                               vkenum(image_layout::transfer_src_optimal),
+                               texture.image,
+                               vkenum(image_layout::transfer_dst_optimal),
+                               1,
+                               &blit,
+                               vkenum(filter::linear));
+
+                transition_layout(cmd,
+                                  texture.image,
+                                  image_layout::transfer_src_optimal,
+                                  m_final_layout,
+                                  full_range(level - 1, 1),
+                                  qf_flags);
+            }
+
+            transition_layout(cmd,
+                              texture.image,
+                              image_layout::transfer_dst_optimal,
+                              m_final_layout,
+                              full_range(levels - 1, 1),
+                              qf_flags);
+        }
+        else if (use_compute)
+        {
+            transition_layout(cmd,
+                              texture.image,
+                              image_layout::transfer_dst_optimal,
+                              image_layout::general,
+                              full_range(0, levels),
+                              qf_flags);
+
+            auto generation_res = m_generator->record(cmd, texture.image, fmt, texture.extent, levels);
+            if (!generation_res) return generation_res.error();
+            upload.mips = std::move(generation_res.value());
+
+            transition_layout(cmd,
+                              texture.image,
+                              image_layout::general,
+                              m_final_layout,
+                              full_range(0, levels),
+                              qf_flags);
+        }
+        else
+        {
+            transition_layout(cmd,
+                              texture.image,
+                              image_layout::transfer_dst_optimal,
+                              m_final_layout,
+                              full_range(0, levels),
+                              qf_flags);
+        }
+
+        texture.layout = m_final_layout;
+
+        auto view_info             = structs::create::image_view();
+        view_info.image            = texture.image;
+        view_info.format           = m_info.format;
+        view_info.subresourceRange = full_range(0, levels);
+
+        if (auto res = vkCreateImageView(m_device->handle, &view_info, host_callbacks(host_scope::resources), &texture.view); res != vkres::ok)
+        {
+            return error_t { "Could not create texture view: {}", vkres::get_repr(res) };
+        }
+
+        return upload;
+    }
+} // namespace orb::vk
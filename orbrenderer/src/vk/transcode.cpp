@@ -0,0 +1,1657 @@
+#include "orb/vk/transcode.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ORB_TRANSCODE_SSE2 1
+#endif
+
+namespace orb::vk
+{
+    namespace
+    {
+        // Largest block footprint, ASTC 12x12
+        constexpr ui32 max_block_texels = 144;
+
+        using texel_block_t = std::array<std::array<ui8, 4>, max_block_texels>;
+
+        enum class block_kind
+        {
+            bc1_rgb,
+            bc1_rgba,
+            bc2,
+            bc3,
+            bc4,
+            bc5,
+            bc7,
+            astc,
+            unsupported,
+        };
+
+        struct block_info_t
+        {
+            block_kind kind   = block_kind::unsupported;
+            ui32       width  = 4;
+            ui32       height = 4;
+            bool       srgb   = false;
+        };
+
+        auto info_of(VkFormat format) -> block_info_t
+        {
+            switch (format)
+            {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                return { .kind = block_kind::bc1_rgb };
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                return { .kind = block_kind::bc1_rgba };
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+                return { .kind = block_kind::bc2 };
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+                return { .kind = block_kind::bc3 };
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+                return { .kind = block_kind::bc4 };
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                return { .kind = block_kind::bc5 };
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                return { .kind = block_kind::bc7 };
+            case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+                return { block_kind::astc, 4, 4, false };
+            case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+                return { block_kind::astc, 4, 4, true };
+            case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:
+                return { block_kind::astc, 5, 4, false };
+            case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+                return { block_kind::astc, 5, 4, true };
+            case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+                return { block_kind::astc, 5, 5, false };
+            case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+                return { block_kind::astc, 5, 5, true };
+            case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:
+                return { block_kind::astc, 6, 5, false };
+            case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+                return { block_kind::astc, 6, 5, true };
+            case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+                return { block_kind::astc, 6, 6, false };
+            case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+                return { block_kind::astc, 6, 6, true };
+            case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:
+                return { block_kind::astc, 8, 5, false };
+            case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+                return { block_kind::astc, 8, 5, true };
+            case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:
+                return { block_kind::astc, 8, 6, false };
+            case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+                return { block_kind::astc, 8, 6, true };
+            case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+                return { block_kind::astc, 8, 8, false };
+            case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+                return { block_kind::astc, 8, 8, true };
+            case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:
+                return { block_kind::astc, 10, 5, false };
+            case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+                return { block_kind::astc, 10, 5, true };
+            case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:
+                return { block_kind::astc, 10, 6, false };
+            case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+                return { block_kind::astc, 10, 6, true };
+            case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:
+                return { block_kind::astc, 10, 8, false };
+            case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+                return { block_kind::astc, 10, 8, true };
+            case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+                return { block_kind::astc, 10, 10, false };
+            case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+                return { block_kind::astc, 10, 10, true };
+            case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:
+                return { block_kind::astc, 12, 10, false };
+            case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+                return { block_kind::astc, 12, 10, true };
+            case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+                return { block_kind::astc, 12, 12, false };
+            case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+                return { block_kind::astc, 12, 12, true };
+            default:
+                return {};
+            }
+        }
+
+        auto block_bytes(block_kind kind) -> size_t
+        {
+            return (kind == block_kind::bc1_rgb || kind == block_kind::bc1_rgba || kind == block_kind::bc4) ? 8 : 16;
+        }
+
+        auto load_u16(const std::byte* p) -> ui32
+        {
+            return static_cast<ui32>(p[0]) | (static_cast<ui32>(p[1]) << 8);
+        }
+
+        auto load_u32(const std::byte* p) -> ui32
+        {
+            return load_u16(p) | (load_u16(p + 2) << 16);
+        }
+
+        auto load_u64(const std::byte* p) -> ui64
+        {
+            return static_cast<ui64>(load_u32(p)) | (static_cast<ui64>(load_u32(p + 4)) << 32);
+        }
+
+        auto reverse_bits(ui64 v) -> ui64
+        {
+            v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+            v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+            v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+            v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+            v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+            return (v >> 32) | (v << 32);
+        }
+
+        /* @brief The 128 bits of a BC7 or ASTC block, bit 0 being the lowest bit of the first byte */
+        class block_bits_t
+        {
+        public:
+            explicit block_bits_t(const std::byte* block)
+                : m_lo(load_u64(block))
+                , m_hi(load_u64(block + 8))
+            {
+            }
+
+            /* @brief Up to 32 bits starting at `pos`, bits past the end of the block read as 0 */
+            [[nodiscard]] auto read(ui32 pos, ui32 count) const -> ui32
+            {
+                if (count == 0 || pos >= 128) return 0;
+
+                const ui64 v = pos >= 64 ? m_hi >> (pos - 64)
+                             : pos == 0  ? m_lo
+                                         : (m_lo >> pos) | (m_hi << (64 - pos));
+
+                return static_cast<ui32>(v & ((ui64 { 1 } << count) - 1));
+            }
+
+            /* @brief The block with its bit order reversed, ASTC weights are stored from bit 127 down */
+            [[nodiscard]] auto reversed() const -> block_bits_t
+            {
+                block_bits_t r;
+                r.m_lo = reverse_bits(m_hi);
+                r.m_hi = reverse_bits(m_lo);
+                return r;
+            }
+
+        private:
+            block_bits_t() = default;
+
+            ui64 m_lo = 0;
+            ui64 m_hi = 0;
+        };
+
+        enum class lerp_mode
+        {
+            bc7,        // 8 bit endpoints
+            astc_unorm, // endpoints widened to 16 bits as (c << 8) | c
+            astc_srgb,  // endpoints widened to 16 bits as (c << 8) | 0x80
+        };
+
+        /* @brief Interpolates between endpoints with 6 bit weights, 0 giving e0 and 64 giving e1
+         *
+         * BC7 rounds the 8 bit result. ASTC interpolates 16 bit endpoints and keeps the top 8 bits,
+         * as decode_unorm8 specifies; with a weight sum of 64 this folds into a single shift.
+         */
+        template <lerp_mode mode>
+        auto lerp(ui32 e0, ui32 e1, ui32 w) -> ui8
+        {
+            const ui32 v = e0 * (64 - w) + e1 * w;
+
+            if constexpr (mode == lerp_mode::bc7)
+            {
+                return static_cast<ui8>((v + 32) >> 6);
+            }
+            else if constexpr (mode == lerp_mode::astc_unorm)
+            {
+                return static_cast<ui8>(((v << 8) + v + 32) >> 14);
+            }
+            else
+            {
+                return static_cast<ui8>(((v << 8) + 8224) >> 14);
+            }
+        }
+
+#if ORB_TRANSCODE_SSE2
+        template <lerp_mode mode>
+        auto lerp_x8(__m128i e0, __m128i e1, __m128i w) -> __m128i
+        {
+            const __m128i v = _mm_add_epi16(_mm_mullo_epi16(e0, _mm_sub_epi16(_mm_set1_epi16(64), w)),
+                                            _mm_mullo_epi16(e1, w));
+
+            if constexpr (mode == lerp_mode::bc7)
+            {
+                return _mm_srli_epi16(_mm_add_epi16(v, _mm_set1_epi16(32)), 6);
+            }
+            else
+            {
+                // v * 257 or v * 256 no longer fits in 16 bits
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i lo   = _mm_unpacklo_epi16(v, zero);
+                const __m128i hi   = _mm_unpackhi_epi16(v, zero);
+
+                const auto widen = [](__m128i x) {
+                    if constexpr (mode == lerp_mode::astc_unorm)
+                    {
+                        return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(x, 8), x), _mm_set1_epi32(32)), 14);
+                    }
+                    else
+                    {
+                        return _mm_srli_epi32(_mm_add_epi32(_mm_slli_epi32(x, 8), _mm_set1_epi32(8224)), 14);
+                    }
+                };
+
+                return _mm_packs_epi32(widen(lo), widen(hi));
+            }
+        }
+#endif
+
+        /* @brief out[i] = lerp(e0[i], e1[i], w[i]) over `count` channels, 16 at a time with SSE2 */
+        template <lerp_mode mode>
+        void lerp_channels(const ui8* e0, const ui8* e1, const ui8* w, ui8* out, size_t count)
+        {
+            size_t i = 0;
+
+#if ORB_TRANSCODE_SSE2
+            const __m128i zero = _mm_setzero_si128();
+
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e0 + i)); // NOLINT
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e1 + i)); // NOLINT
+                const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));  // NOLINT
+
+                const __m128i lo = lerp_x8<mode>(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+                const __m128i hi = lerp_x8<mode>(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi)); // NOLINT
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                out[i] = lerp<mode>(e0[i], e1[i], w[i]);
+            }
+        }
+
+        /* @brief Per channel endpoints and weights of a block, interpolated in one pass */
+        struct lerp_inputs_t
+        {
+            alignas(16) std::array<ui8, max_block_texels * 4> e0;
+            alignas(16) std::array<ui8, max_block_texels * 4> e1;
+            alignas(16) std::array<ui8, max_block_texels * 4> w;
+        };
+
+        auto expand_565(ui32 c) -> std::array<ui32, 3>
+        {
+            const ui32 r = (c >> 11) & 31;
+            const ui32 g = (c >> 5) & 63;
+            const ui32 b = c & 31;
+
+            return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+        }
+
+        /* @brief Decodes the RGB part of a BC1, BC2 or BC3 block
+         *
+         * BC2 and BC3 always use the four color mode, BC1 switches to three colors plus
+         * transparent black when color0 <= color1.
+         */
+        void decode_color(const std::byte* block, bool allow_punch_through, bool has_alpha, texel_block_t& out)
+        {
+            const ui32 c0      = load_u16(block);
+            const ui32 c1      = load_u16(block + 2);
+            const ui32 indices = load_u32(block + 4);
+
+            const auto e0 = expand_565(c0);
+            const auto e1 = expand_565(c1);
+
+            std::array<std::array<ui8, 4>, 4> palette {};
+
+            for (size_t ch = 0; ch < 3; ++ch)
+            {
+                palette[0][ch] = static_cast<ui8>(e0[ch]);
+                palette[1][ch] = static_cast<ui8>(e1[ch]);
+
+                if (c0 > c1 || !allow_punch_through)
+                {
+                    palette[2][ch] = static_cast<ui8>((2 * e0[ch] + e1[ch]) / 3);
+                    palette[3][ch] = static_cast<ui8>((e0[ch] + 2 * e1[ch]) / 3);
+                }
+                else
+                {
+                    palette[2][ch] = static_cast<ui8>((e0[ch] + e1[ch]) / 2);
+                    palette[3][ch] = 0;
+                }
+            }
+
+            palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+            if (allow_punch_through && has_alpha && c0 <= c1)
+            {
+                palette[3][3] = 0;
+            }
+
+            for (size_t i = 0; i < 16; ++i)
+            {
+                out[i] = palette[(indices >> (2 * i)) & 3];
+            }
+        }
+
+        /* @brief Decodes a BC3 alpha / BC4 channel block into one channel of `out` */
+        void decode_channel(const std::byte* block, size_t channel, texel_block_t& out)
+        {
+            const ui32 a0      = static_cast<ui32>(block[0]);
+            const ui32 a1      = static_cast<ui32>(block[1]);
+            const ui64 indices = load_u64(block) >> 16;
+
+            std::array<ui8, 8> palette {};
+            palette[0] = static_cast<ui8>(a0);
+            palette[1] = static_cast<ui8>(a1);
+
+            if (a0 > a1)
+            {
+                for (ui32 k = 1; k < 7; ++k)
+                {
+                    palette[k + 1] = static_cast<ui8>(((7 - k) * a0 + k * a1) / 7);
+                }
+            }
+            else
+            {
+                for (ui32 k = 1; k < 5; ++k)
+                {
+                    palette[k + 1] = static_cast<ui8>(((5 - k) * a0 + k * a1) / 5);
+                }
+
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            for (size_t i = 0; i < 16; ++i)
+            {
+                out[i][channel] = palette[(indices >> (3 * i)) & 7];
+            }
+        }
+
+        /* @brief Decodes the explicit 4 bit alpha of a BC2 block */
+        void decode_explicit_alpha(const std::byte* block, texel_block_t& out)
+        {
+            const ui64 alpha = load_u64(block);
+
+            for (size_t i = 0; i < 16; ++i)
+            {
+                out[i][3] = static_cast<ui8>(((alpha >> (4 * i)) & 15) * 17);
+            }
+        }
+
+        // BC7, see the BPTC section of the Khronos data format specification
+
+        struct bc7_mode_t
+        {
+            ui8 subsets;
+            ui8 partition_bits;
+            ui8 rotation_bits;
+            ui8 index_selection_bits;
+            ui8 color_bits;
+            ui8 alpha_bits;
+            ui8 endpoint_pbits;
+            ui8 shared_pbits;
+            ui8 index_bits;
+            ui8 index2_bits;
+        };
+
+        constexpr std::array<bc7_mode_t, 8> bc7_modes = { {
+            { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+            { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+            { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+            { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+            { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+            { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+            { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+            { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+        } };
+
+        // Subset of each texel for two subsets, one bit per texel
+        constexpr std::array<ui16, 64> bc7_partitions_2 = {
+            0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+            0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+            0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+            0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+            0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+            0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+            0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+            0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+        };
+
+        // Subset of each texel for three subsets, two bits per texel
+        constexpr std::array<ui32, 64> bc7_partitions_3 = {
+            0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+            0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+            0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+            0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+            0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+            0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+            0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+            0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+        };
+
+        // Texels whose index drops its top bit: texel 0 for the first subset, these for the others
+        constexpr std::array<ui8, 64> bc7_anchors_2 = {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+            15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+            15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+            6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+        };
+
+        constexpr std::array<ui8, 64> bc7_anchors_3_second = {
+            3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+            3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+            8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+            3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+        };
+
+        constexpr std::array<ui8, 64> bc7_anchors_3_third = {
+            15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+            15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+            15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+            15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+        };
+
+        constexpr std::array<ui8, 4>  bc7_weights_2 = { 0, 21, 43, 64 };
+        constexpr std::array<ui8, 8>  bc7_weights_3 = { 0, 9, 18, 27, 37, 46, 55, 64 };
+        constexpr std::array<ui8, 16> bc7_weights_4 = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        auto bc7_weight(ui32 bits, ui32 index) -> ui8
+        {
+            return bits == 2 ? bc7_weights_2[index] : bits == 3 ? bc7_weights_3[index] : bc7_weights_4[index];
+        }
+
+        /* @brief Widens an endpoint of `bits` bits to 8 by replicating its top bits */
+        auto bc7_expand(ui32 v, ui32 bits) -> ui8
+        {
+            v <<= 8 - bits;
+            return static_cast<ui8>(v | (v >> bits));
+        }
+
+        void decode_bc7(const std::byte* block, texel_block_t& out)
+        {
+            const block_bits_t bits(block);
+
+            const auto first = static_cast<ui32>(block[0]);
+
+            if (first == 0)
+            {
+                // Reserved mode
+                std::fill_n(out.begin(), 16, std::array<ui8, 4> { 0, 0, 0, 0 });
+                return;
+            }
+
+            const ui32  mode_index = std::countr_zero(first);
+            const auto& mode       = bc7_modes[mode_index];
+
+            ui32 pos = mode_index + 1;
+
+            const auto take = [&](ui32 count) {
+                const ui32 v = bits.read(pos, count);
+                pos += count;
+                return v;
+            };
+
+            const ui32 partition = take(mode.partition_bits);
+            const ui32 rotation  = take(mode.rotation_bits);
+            const ui32 selection = take(mode.index_selection_bits);
+
+            // [subset * 2 + endpoint][channel]
+            std::array<std::array<ui32, 4>, 6> endpoints {};
+            const ui32                         count = mode.subsets * 2u;
+
+            for (ui32 ch = 0; ch < 3; ++ch)
+            {
+                for (ui32 e = 0; e < count; ++e)
+                {
+                    endpoints[e][ch] = take(mode.color_bits);
+                }
+            }
+
+            for (ui32 e = 0; e < count && mode.alpha_bits; ++e)
+            {
+                endpoints[e][3] = take(mode.alpha_bits);
+            }
+
+            std::array<ui32, 6> pbits {};
+
+            if (mode.endpoint_pbits)
+            {
+                for (ui32 e = 0; e < count; ++e)
+                {
+                    pbits[e] = take(1);
+                }
+            }
+            else if (mode.shared_pbits)
+            {
+                for (ui32 s = 0; s < mode.subsets; ++s)
+                {
+                    pbits[s * 2] = pbits[s * 2 + 1] = take(1);
+                }
+            }
+
+            const ui32 has_pbit = mode.endpoint_pbits | mode.shared_pbits;
+
+            std::array<std::array<ui8, 4>, 6> colors {};
+
+            for (ui32 e = 0; e < count; ++e)
+            {
+                for (ui32 ch = 0; ch < 3; ++ch)
+                {
+                    colors[e][ch] = bc7_expand((endpoints[e][ch] << has_pbit) | pbits[e], mode.color_bits + has_pbit);
+                }
+
+                colors[e][3] = mode.alpha_bits ? bc7_expand((endpoints[e][3] << has_pbit) | pbits[e], mode.alpha_bits + has_pbit)
+                                               : ui8 { 255 };
+            }
+
+            std::array<ui32, 3> anchors = { 0, 0, 0 };
+            if (mode.subsets == 2) anchors[1] = bc7_anchors_2[partition];
+            if (mode.subsets == 3) anchors[1] = bc7_anchors_3_second[partition];
+            if (mode.subsets == 3) anchors[2] = bc7_anchors_3_third[partition];
+
+            const auto subset_of = [&](ui32 i) -> ui32 {
+                if (mode.subsets == 2) return (bc7_partitions_2[partition] >> i) & 1;
+                if (mode.subsets == 3) return (bc7_partitions_3[partition] >> (2 * i)) & 3;
+                return 0;
+            };
+
+            std::array<ui32, 16> indices {};
+            std::array<ui32, 16> indices2 {};
+
+            for (ui32 i = 0; i < 16; ++i)
+            {
+                const bool anchor = i == anchors[0] || (mode.subsets > 1 && i == anchors[1]) || (mode.subsets > 2 && i == anchors[2]);
+                indices[i]        = take(mode.index_bits - (anchor ? 1 : 0));
+            }
+
+            for (ui32 i = 0; i < 16 && mode.index2_bits; ++i)
+            {
+                indices2[i] = take(mode.index2_bits - (i == 0 ? 1 : 0));
+            }
+
+            // Mode 4 and 5 carry a second index set, for alpha unless the selection bit swaps them
+            const bool  swap        = selection != 0;
+            const ui32  color_bits  = mode.index2_bits && swap ? mode.index2_bits : mode.index_bits;
+            const ui32  alpha_bits  = mode.index2_bits && !swap ? mode.index2_bits : mode.index_bits;
+            const auto& color_index = mode.index2_bits && swap ? indices2 : indices;
+            const auto& alpha_index = mode.index2_bits && !swap ? indices2 : indices;
+
+            lerp_inputs_t in;
+
+            for (ui32 i = 0; i < 16; ++i)
+            {
+                const ui32 s  = subset_of(i);
+                const ui8  wc = bc7_weight(color_bits, color_index[i]);
+                const ui8  wa = bc7_weight(alpha_bits, alpha_index[i]);
+
+                for (ui32 ch = 0; ch < 4; ++ch)
+                {
+                    in.e0[i * 4 + ch] = colors[s * 2][ch];
+                    in.e1[i * 4 + ch] = colors[s * 2 + 1][ch];
+                    in.w[i * 4 + ch]  = ch == 3 ? wa : wc;
+                }
+            }
+
+            lerp_channels<lerp_mode::bc7>(in.e0.data(), in.e1.data(), in.w.data(), out[0].data(), 64);
+
+            if (rotation != 0)
+            {
+                for (ui32 i = 0; i < 16; ++i)
+                {
+                    std::swap(out[i][rotation - 1], out[i][3]);
+                }
+            }
+        }
+
+        // ASTC LDR, see the ASTC section of the Khronos data format specification
+
+        /* @brief Integer sequence encoding range: values are trits or quints times 2^bits plus bits */
+        struct quant_range_t
+        {
+            ui16 levels;
+            ui8  bits;
+            ui8  trits;
+            ui8  quints;
+        };
+
+        constexpr std::array<quant_range_t, 21> quant_ranges = { {
+            { 2, 1, 0, 0 },
+            { 3, 0, 1, 0 },
+            { 4, 2, 0, 0 },
+            { 5, 0, 0, 1 },
+            { 6, 1, 1, 0 },
+            { 8, 3, 0, 0 },
+            { 10, 1, 0, 1 },
+            { 12, 2, 1, 0 },
+            { 16, 4, 0, 0 },
+            { 20, 2, 0, 1 },
+            { 24, 3, 1, 0 },
+            { 32, 5, 0, 0 },
+            { 40, 3, 0, 1 },
+            { 48, 4, 1, 0 },
+            { 64, 6, 0, 0 },
+            { 80, 4, 0, 1 },
+            { 96, 5, 1, 0 },
+            { 128, 7, 0, 0 },
+            { 160, 5, 0, 1 },
+            { 192, 6, 1, 0 },
+            { 256, 8, 0, 0 },
+        } };
+
+        // Endpoints use the ranges from 6 levels up
+        constexpr ui32 first_color_range = 4;
+
+        constexpr auto ise_bit_count(ui32 count, const quant_range_t& range) -> ui32
+        {
+            return count * range.bits + (range.trits ? (8 * count + 4) / 5 : 0) + (range.quints ? (7 * count + 2) / 3 : 0);
+        }
+
+        constexpr auto bit(ui32 v, ui32 i) -> ui32
+        {
+            return (v >> i) & 1;
+        }
+
+        // Five trits packed in 8 bits
+        constexpr auto trit_table = [] {
+            std::array<std::array<ui8, 5>, 256> table {};
+
+            for (ui32 t = 0; t < 256; ++t)
+            {
+                ui32 c  = 0;
+                ui32 t3 = 0;
+                ui32 t4 = 0;
+
+                if (((t >> 2) & 7) == 7)
+                {
+                    c  = (((t >> 5) & 7) << 2) | (t & 3);
+                    t4 = 2;
+                    t3 = 2;
+                }
+                else
+                {
+                    c = t & 0x1F;
+
+                    if (((t >> 5) & 3) == 3)
+                    {
+                        t4 = 2;
+                        t3 = bit(t, 7);
+                    }
+                    else
+                    {
+                        t4 = bit(t, 7);
+                        t3 = (t >> 5) & 3;
+                    }
+                }
+
+                ui32 t0 = 0;
+                ui32 t1 = 0;
+                ui32 t2 = 0;
+
+                if ((c & 3) == 3)
+                {
+                    t2 = 2;
+                    t1 = bit(c, 4);
+                    t0 = (bit(c, 3) << 1) | (bit(c, 2) & ~bit(c, 3) & 1);
+                }
+                else if (((c >> 2) & 3) == 3)
+                {
+                    t2 = 2;
+                    t1 = 2;
+                    t0 = c & 3;
+                }
+                else
+                {
+                    t2 = bit(c, 4);
+                    t1 = (c >> 2) & 3;
+                    t0 = (bit(c, 1) << 1) | (bit(c, 0) & ~bit(c, 1) & 1);
+                }
+
+                table[t] = { static_cast<ui8>(t0), static_cast<ui8>(t1), static_cast<ui8>(t2), static_cast<ui8>(t3), static_cast<ui8>(t4) };
+            }
+
+            return table;
+        }();
+
+        // Three quints packed in 7 bits
+        constexpr auto quint_table = [] {
+            std::array<std::array<ui8, 3>, 128> table {};
+
+            for (ui32 q = 0; q < 128; ++q)
+            {
+                ui32 q0 = 0;
+                ui32 q1 = 0;
+                ui32 q2 = 0;
+
+                if (((q >> 1) & 3) == 3 && ((q >> 5) & 3) == 0)
+                {
+                    const ui32 n = ~q & 1;
+                    q2           = (bit(q, 0) << 2) | ((bit(q, 4) & n) << 1) | (bit(q, 3) & n);
+                    q1           = 4;
+                    q0           = 4;
+                }
+                else
+                {
+                    ui32 c = 0;
+
+                    if (((q >> 1) & 3) == 3)
+                    {
+                        q2 = 4;
+                        c  = (((q >> 3) & 3) << 3) | ((~q >> 5 & 3) << 1) | (q & 1);
+                    }
+                    else
+                    {
+                        q2 = (q >> 5) & 3;
+                        c  = q & 0x1F;
+                    }
+
+                    if ((c & 7) == 5)
+                    {
+                        q1 = 4;
+                        q0 = (c >> 3) & 3;
+                    }
+                    else
+                    {
+                        q1 = (c >> 3) & 3;
+                        q0 = c & 7;
+                    }
+                }
+
+                table[q] = { static_cast<ui8>(q0), static_cast<ui8>(q1), static_cast<ui8>(q2) };
+            }
+
+            return table;
+        }();
+
+        /* @brief Decodes `count` values of an integer sequence starting at `pos` */
+        void decode_ise(const block_bits_t& bits, ui32 pos, ui32 count, const quant_range_t& range, ui8* out)
+        {
+            // A truncated last group reads its missing bits as 0, not from the data that follows
+            const ui32 end  = pos + ise_bit_count(count, range);
+            const auto take = [&](ui32 n) {
+                const ui32 available = pos < end ? std::min(n, end - pos) : 0;
+                const ui32 v         = bits.read(pos, available);
+                pos += n;
+                return v;
+            };
+
+            const ui32 n = range.bits;
+
+            if (range.trits)
+            {
+                for (ui32 i = 0; i < count; i += 5)
+                {
+                    std::array<ui32, 5> m {};
+                    ui32                t = 0;
+
+                    m[0] = take(n);
+                    t |= take(2);
+                    m[1] = take(n);
+                    t |= take(2) << 2;
+                    m[2] = take(n);
+                    t |= take(1) << 4;
+                    m[3] = take(n);
+                    t |= take(2) << 5;
+                    m[4] = take(n);
+                    t |= take(1) << 7;
+
+                    for (ui32 j = 0; j < 5 && i + j < count; ++j)
+                    {
+                        out[i + j] = static_cast<ui8>((trit_table[t][j] << n) | m[j]);
+                    }
+                }
+            }
+            else if (range.quints)
+            {
+                for (ui32 i = 0; i < count; i += 3)
+                {
+                    std::array<ui32, 3> m {};
+                    ui32                q = 0;
+
+                    m[0] = take(n);
+                    q |= take(3);
+                    m[1] = take(n);
+                    q |= take(2) << 3;
+                    m[2] = take(n);
+                    q |= take(2) << 5;
+
+                    for (ui32 j = 0; j < 3 && i + j < count; ++j)
+                    {
+                        out[i + j] = static_cast<ui8>((quint_table[q][j] << n) | m[j]);
+                    }
+                }
+            }
+            else
+            {
+                for (ui32 i = 0; i < count; ++i)
+                {
+                    out[i] = static_cast<ui8>(take(n));
+                }
+            }
+        }
+
+        /* @brief Unquantizes an endpoint value to 0..255 */
+        auto unquantize_color(ui32 v, const quant_range_t& range) -> ui8
+        {
+            if (!range.trits && !range.quints)
+            {
+                // Bit replication
+                ui32 r = v << (8 - range.bits);
+                for (ui32 shift = range.bits; shift < 8; shift *= 2)
+                {
+                    r |= r >> shift;
+                }
+                return static_cast<ui8>(r);
+            }
+
+            const ui32 n = range.bits;
+            const ui32 a = (v & 1) ? 0x1FF : 0;
+            const ui32 d = v >> n;
+            const ui32 m = (v & ((1u << n) - 1)) >> 1; // bits above the lowest
+
+            ui32 b = 0;
+            ui32 c = 0;
+
+            if (range.trits)
+            {
+                switch (n)
+                {
+                case 1:
+                    c = 204;
+                    break;
+                case 2:
+                    b = (m << 8) | (m << 4) | (m << 2) | (m << 1);
+                    c = 93;
+                    break;
+                case 3:
+                    b = (m << 7) | (m << 2) | m;
+                    c = 44;
+                    break;
+                case 4:
+                    b = (m << 6) | m;
+                    c = 22;
+                    break;
+                case 5:
+                    b = (m << 5) | (m >> 2);
+                    c = 11;
+                    break;
+                default:
+                    b = (m << 4) | (m >> 4);
+                    c = 5;
+                    break;
+                }
+            }
+            else
+            {
+                switch (n)
+                {
+                case 1:
+                    c = 113;
+                    break;
+                case 2:
+                    b = (m << 8) | (m << 3) | (m << 2);
+                    c = 54;
+                    break;
+                case 3:
+                    b = (m << 7) | (m << 1) | (m >> 1);
+                    c = 26;
+                    break;
+                case 4:
+                    b = (m << 6) | (m >> 1);
+                    c = 13;
+                    break;
+                default:
+                    b = (m << 5) | (m >> 3);
+                    c = 6;
+                    break;
+                }
+            }
+
+            const ui32 t = (d * c + b) ^ a;
+            return static_cast<ui8>((a & 0x80) | (t >> 2));
+        }
+
+        /* @brief Unquantizes a weight to 0..64 */
+        auto unquantize_weight(ui32 v, const quant_range_t& range) -> ui8
+        {
+            ui32 r = 0;
+
+            if (!range.trits && !range.quints)
+            {
+                r = v << (6 - range.bits);
+                for (ui32 shift = range.bits; shift < 6; shift *= 2)
+                {
+                    r |= r >> shift;
+                }
+            }
+            else if (range.bits == 0)
+            {
+                r = range.trits ? std::array<ui32, 3> { 0, 32, 63 }[v] : std::array<ui32, 5> { 0, 16, 32, 47, 63 }[v];
+            }
+            else
+            {
+                const ui32 n = range.bits;
+                const ui32 a = (v & 1) ? 0x7F : 0;
+                const ui32 d = v >> n;
+                const ui32 m = (v & ((1u << n) - 1)) >> 1;
+
+                ui32 b = 0;
+                ui32 c = 0;
+
+                if (range.trits)
+                {
+                    c = n == 1 ? 50 : n == 2 ? 23 : 11;
+                    b = n == 2 ? (m << 6) | (m << 2) | m : n == 3 ? (m << 5) | m : 0;
+                }
+                else
+                {
+                    c = n == 1 ? 28 : 13;
+                    b = n == 2 ? (m << 6) | (m << 1) : 0;
+                }
+
+                const ui32 t = (d * c + b) ^ a;
+                r            = (a & 0x20) | (t >> 2);
+            }
+
+            return static_cast<ui8>(r > 32 ? r + 1 : r);
+        }
+
+        using rgba_t = std::array<i32, 4>;
+
+        void bit_transfer_signed(i32& a, i32& b)
+        {
+            b >>= 1;
+            b |= a & 0x80;
+            a >>= 1;
+            a &= 0x3F;
+            if (a & 0x20) a -= 0x40;
+        }
+
+        auto blue_contract(i32 r, i32 g, i32 b, i32 a) -> rgba_t
+        {
+            return { (r + b) >> 1, (g + b) >> 1, b, a };
+        }
+
+        auto clamp_rgba(rgba_t c) -> rgba_t
+        {
+            for (auto& v : c)
+            {
+                v = std::clamp(v, 0, 255);
+            }
+            return c;
+        }
+
+        /* @brief LDR endpoints of one partition, false for the HDR modes */
+        auto decode_endpoints(ui32 cem, const ui8* values, rgba_t& e0, rgba_t& e1) -> bool
+        {
+            std::array<i32, 8> v {};
+            for (ui32 i = 0; i < 2 * ((cem >> 2) + 1); ++i)
+            {
+                v[i] = values[i];
+            }
+
+            switch (cem)
+            {
+            case 0:
+                e0 = { v[0], v[0], v[0], 255 };
+                e1 = { v[1], v[1], v[1], 255 };
+                return true;
+            case 1:
+            {
+                const i32 l0 = (v[0] >> 2) | (v[1] & 0xC0);
+                const i32 l1 = std::min(l0 + (v[1] & 0x3F), 255);
+                e0           = { l0, l0, l0, 255 };
+                e1           = { l1, l1, l1, 255 };
+                return true;
+            }
+            case 4:
+                e0 = { v[0], v[0], v[0], v[2] };
+                e1 = { v[1], v[1], v[1], v[3] };
+                return true;
+            case 5:
+                bit_transfer_signed(v[1], v[0]);
+                bit_transfer_signed(v[3], v[2]);
+                e0 = { v[0], v[0], v[0], v[2] };
+                e1 = clamp_rgba({ v[0] + v[1], v[0] + v[1], v[0] + v[1], v[2] + v[3] });
+                return true;
+            case 6:
+                e0 = { (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, 255 };
+                e1 = { v[0], v[1], v[2], 255 };
+                return true;
+            case 8:
+                if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4])
+                {
+                    e0 = { v[0], v[2], v[4], 255 };
+                    e1 = { v[1], v[3], v[5], 255 };
+                }
+                else
+                {
+                    e0 = blue_contract(v[1], v[3], v[5], 255);
+                    e1 = blue_contract(v[0], v[2], v[4], 255);
+                }
+                return true;
+            case 9:
+                bit_transfer_signed(v[1], v[0]);
+                bit_transfer_signed(v[3], v[2]);
+                bit_transfer_signed(v[5], v[4]);
+
+                if (v[1] + v[3] + v[5] >= 0)
+                {
+                    e0 = { v[0], v[2], v[4], 255 };
+                    e1 = clamp_rgba({ v[0] + v[1], v[2] + v[3], v[4] + v[5], 255 });
+                }
+                else
+                {
+                    e0 = clamp_rgba(blue_contract(v[0] + v[1], v[2] + v[3], v[4] + v[5], 255));
+                    e1 = blue_contract(v[0], v[2], v[4], 255);
+                }
+                return true;
+            case 10:
+                e0 = { (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, v[4] };
+                e1 = { v[0], v[1], v[2], v[5] };
+                return true;
+            case 12:
+                if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4])
+                {
+                    e0 = { v[0], v[2], v[4], v[6] };
+                    e1 = { v[1], v[3], v[5], v[7] };
+                }
+                else
+                {
+                    e0 = blue_contract(v[1], v[3], v[5], v[7]);
+                    e1 = blue_contract(v[0], v[2], v[4], v[6]);
+                }
+                return true;
+            case 13:
+                bit_transfer_signed(v[1], v[0]);
+                bit_transfer_signed(v[3], v[2]);
+                bit_transfer_signed(v[5], v[4]);
+                bit_transfer_signed(v[7], v[6]);
+
+                if (v[1] + v[3] + v[5] >= 0)
+                {
+                    e0 = { v[0], v[2], v[4], v[6] };
+                    e1 = clamp_rgba({ v[0] + v[1], v[2] + v[3], v[4] + v[5], v[6] + v[7] });
+                }
+                else
+                {
+                    e0 = clamp_rgba(blue_contract(v[0] + v[1], v[2] + v[3], v[4] + v[5], v[6] + v[7]));
+                    e1 = blue_contract(v[0], v[2], v[4], v[6]);
+                }
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        auto hash52(ui32 p) -> ui32
+        {
+            p ^= p >> 15;
+            p -= p << 17;
+            p += p << 7;
+            p += p << 4;
+            p ^= p >> 5;
+            p += p << 16;
+            p ^= p >> 7;
+            p ^= p >> 3;
+            p ^= p << 6;
+            p ^= p >> 17;
+            return p;
+        }
+
+        /* @brief Partition of a texel, from the hash the format defines instead of a table */
+        auto select_partition(ui32 seed, ui32 x, ui32 y, ui32 partitions, bool small_block) -> ui32
+        {
+            if (small_block)
+            {
+                x <<= 1;
+                y <<= 1;
+            }
+
+            seed += (partitions - 1) * 1024;
+
+            const ui32 rnum = hash52(seed);
+
+            std::array<ui32, 12> s = {
+                rnum & 0xF,
+                (rnum >> 4) & 0xF,
+                (rnum >> 8) & 0xF,
+                (rnum >> 12) & 0xF,
+                (rnum >> 16) & 0xF,
+                (rnum >> 20) & 0xF,
+                (rnum >> 24) & 0xF,
+                (rnum >> 28) & 0xF,
+                (rnum >> 18) & 0xF,
+                (rnum >> 22) & 0xF,
+                (rnum >> 26) & 0xF,
+                ((rnum >> 30) | (rnum << 2)) & 0xF,
+            };
+
+            for (auto& v : s)
+            {
+                v *= v;
+            }
+
+            ui32 sh1 = 0;
+            ui32 sh2 = 0;
+
+            if (seed & 1)
+            {
+                sh1 = (seed & 2) ? 4 : 5;
+                sh2 = partitions == 3 ? 6 : 5;
+            }
+            else
+            {
+                sh1 = partitions == 3 ? 6 : 5;
+                sh2 = (seed & 2) ? 4 : 5;
+            }
+
+            const ui32 sh3 = (seed & 0x10) ? sh1 : sh2;
+
+            for (ui32 i = 0; i < 8; ++i)
+            {
+                s[i] >>= (i & 1) ? sh2 : sh1;
+            }
+
+            for (ui32 i = 8; i < 12; ++i)
+            {
+                s[i] >>= sh3;
+            }
+
+            // The z terms of 3D blocks are always 0 here
+            ui32 a = (s[0] * x + s[1] * y + (rnum >> 14)) & 0x3F;
+            ui32 b = (s[2] * x + s[3] * y + (rnum >> 10)) & 0x3F;
+            ui32 c = (s[4] * x + s[5] * y + (rnum >> 6)) & 0x3F;
+            ui32 d = (s[6] * x + s[7] * y + (rnum >> 2)) & 0x3F;
+
+            if (partitions < 4) d = 0;
+            if (partitions < 3) c = 0;
+
+            if (a >= b && a >= c && a >= d) return 0;
+            if (b >= c && b >= d) return 1;
+            if (c >= d) return 2;
+            return 3;
+        }
+
+        struct astc_block_mode_t
+        {
+            ui32 weights_x  = 0;
+            ui32 weights_y  = 0;
+            ui32 range      = 0; // index in `quant_ranges`
+            bool dual_plane = false;
+        };
+
+        auto decode_block_mode(ui32 mode, astc_block_mode_t& out) -> bool
+        {
+            const ui32 a = (mode >> 5) & 3;
+
+            ui32 r    = bit(mode, 4);
+            bool high = bit(mode, 9) != 0;
+            bool dual = bit(mode, 10) != 0;
+            ui32 x    = 0;
+            ui32 y    = 0;
+
+            if ((mode & 3) != 0)
+            {
+                r |= (mode & 3) << 1;
+                const ui32 b = (mode >> 7) & 3;
+
+                switch ((mode >> 2) & 3)
+                {
+                case 0:
+                    x = b + 4;
+                    y = a + 2;
+                    break;
+                case 1:
+                    x = b + 8;
+                    y = a + 2;
+                    break;
+                case 2:
+                    x = a + 2;
+                    y = b + 8;
+                    break;
+                default:
+                    if (bit(mode, 8))
+                    {
+                        x = (b & 1) + 2;
+                        y = a + 2;
+                    }
+                    else
+                    {
+                        x = a + 2;
+                        y = (b & 1) + 6;
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                r |= ((mode >> 2) & 3) << 1;
+                if (((mode >> 2) & 3) == 0) return false;
+
+                const ui32 b = (mode >> 9) & 3;
+
+                switch ((mode >> 7) & 3)
+                {
+                case 0:
+                    x = 12;
+                    y = a + 2;
+                    break;
+                case 1:
+                    x = a + 2;
+                    y = 12;
+                    break;
+                case 2:
+                    x    = a + 6;
+                    y    = b + 6;
+                    high = false;
+                    dual = false;
+                    break;
+                default:
+                    if (a == 0)
+                    {
+                        x = 6;
+                        y = 10;
+                    }
+                    else if (a == 1)
+                    {
+                        x = 10;
+                        y = 6;
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    break;
+                }
+            }
+
+            out = {
+                .weights_x  = x,
+                .weights_y  = y,
+                .range      = (r - 2) + (high ? 6 : 0),
+                .dual_plane = dual,
+            };
+
+            return true;
+        }
+
+        void fill_error_color(ui32 texels, texel_block_t& out)
+        {
+            std::fill_n(out.begin(), texels, std::array<ui8, 4> { 255, 0, 255, 255 });
+        }
+
+        void decode_astc(const std::byte* block, ui32 bw, ui32 bh, bool srgb, texel_block_t& out)
+        {
+            const block_bits_t bits(block);
+            const ui32         texels = bw * bh;
+
+            const ui32 mode = bits.read(0, 11);
+
+            if ((mode & 0x1FF) == 0x1FC)
+            {
+                // Void extent: one color for the whole block, HDR colors are errors
+                if (bit(mode, 9))
+                {
+                    fill_error_color(texels, out);
+                    return;
+                }
+
+                const ui32 s0 = bits.read(12, 13);
+                const ui32 s1 = bits.read(25, 13);
+                const ui32 t0 = bits.read(38, 13);
+                const ui32 t1 = bits.read(51, 13);
+
+                const bool all_ones = s0 == 0x1FFF && s1 == 0x1FFF && t0 == 0x1FFF && t1 == 0x1FFF;
+
+                if (!all_ones && (s0 >= s1 || t0 >= t1))
+                {
+                    fill_error_color(texels, out);
+                    return;
+                }
+
+                const std::array<ui8, 4> color = {
+                    static_cast<ui8>(bits.read(64, 16) >> 8),
+                    static_cast<ui8>(bits.read(80, 16) >> 8),
+                    static_cast<ui8>(bits.read(96, 16) >> 8),
+                    static_cast<ui8>(bits.read(112, 16) >> 8),
+                };
+
+                std::fill_n(out.begin(), texels, color);
+                return;
+            }
+
+            astc_block_mode_t block_mode;
+
+            if (!decode_block_mode(mode, block_mode) || block_mode.weights_x > bw || block_mode.weights_y > bh)
+            {
+                fill_error_color(texels, out);
+                return;
+            }
+
+            const auto& weight_range = quant_ranges[block_mode.range];
+            const ui32  planes       = block_mode.dual_plane ? 2 : 1;
+            const ui32  weight_count = block_mode.weights_x * block_mode.weights_y * planes;
+            const ui32  weight_bits  = ise_bit_count(weight_count, weight_range);
+            const ui32  partitions   = bits.read(11, 2) + 1;
+
+            if (weight_count > 64 || weight_bits < 24 || weight_bits > 96 || (block_mode.dual_plane && partitions == 4))
+            {
+                fill_error_color(texels, out);
+                return;
+            }
+
+            std::array<ui32, 4> cems {};
+            ui32                seed        = 0;
+            ui32                color_start = 17;
+            ui32                below       = 128 - weight_bits;
+
+            if (partitions == 1)
+            {
+                cems[0] = bits.read(13, 4);
+            }
+            else
+            {
+                seed        = bits.read(13, 10);
+                color_start = 29;
+
+                const ui32 low = bits.read(23, 6);
+
+                if ((low & 3) == 0)
+                {
+                    cems.fill(low >> 2);
+                }
+                else
+                {
+                    // Class bumps and modes of each partition, continued right below the weights
+                    const ui32 extra = 3 * partitions - 4;
+                    below -= extra;
+
+                    const ui32 encoded = (low >> 2) | (bits.read(below, extra) << 4);
+                    const ui32 base    = (low & 3) - 1;
+
+                    for (ui32 p = 0; p < partitions; ++p)
+                    {
+                        const ui32 cls = base + bit(encoded, p);
+                        const ui32 sub = (encoded >> (partitions + 2 * p)) & 3;
+                        cems[p]        = (cls << 2) | sub;
+                    }
+                }
+            }
+
+            ui32 plane2_channel = 4;
+
+            if (block_mode.dual_plane)
+            {
+                below -= 2;
+                plane2_channel = bits.read(below, 2);
+            }
+
+            ui32 value_count = 0;
+            for (ui32 p = 0; p < partitions; ++p)
+            {
+                value_count += 2 * ((cems[p] >> 2) + 1);
+            }
+
+            if (value_count > 18 || below < color_start)
+            {
+                fill_error_color(texels, out);
+                return;
+            }
+
+            // Endpoints take the largest range that fits in the bits left
+            const ui32 color_bits  = below - color_start;
+            ui32       color_range = quant_ranges.size();
+
+            for (ui32 r = quant_ranges.size(); r-- > first_color_range;)
+            {
+                if (ise_bit_count(value_count, quant_ranges[r]) <= color_bits)
+                {
+                    color_range = r;
+                    break;
+                }
+            }
+
+            if (color_range == quant_ranges.size())
+            {
+                fill_error_color(texels, out);
+                return;
+            }
+
+            std::array<ui8, 18> values {};
+            decode_ise(bits, color_start, value_count, quant_ranges[color_range], values.data());
+
+            for (ui32 i = 0; i < value_count; ++i)
+            {
+                values[i] = unquantize_color(values[i], quant_ranges[color_range]);
+            }
+
+            std::array<rgba_t, 4> e0 {};
+            std::array<rgba_t, 4> e1 {};
+            ui32                  offset = 0;
+
+            for (ui32 p = 0; p < partitions; ++p)
+            {
+                // HDR endpoints only turn their own partition into the error color
+                if (!decode_endpoints(cems[p], values.data() + offset, e0[p], e1[p]))
+                {
+                    e0[p] = e1[p] = { 255, 0, 255, 255 };
+                }
+
+                offset += 2 * ((cems[p] >> 2) + 1);
+            }
+
+            // Weights, plane after plane for each grid point. Padded for the infill reads past the grid
+            std::array<ui8, 64>      raw {};
+            std::array<ui8, 64 + 32> weights {};
+
+            decode_ise(bits.reversed(), 0, weight_count, weight_range, raw.data());
+
+            for (ui32 i = 0; i < weight_count; ++i)
+            {
+                weights[i] = unquantize_weight(raw[i], weight_range);
+            }
+
+            const ui32 gx = block_mode.weights_x;
+            const ui32 gy = block_mode.weights_y;
+
+            // Bilinear infill from the weight grid to the texels, in 1/16 steps
+            const ui32 ds = (1024 + bw / 2) / (bw - 1);
+            const ui32 dt = (1024 + bh / 2) / (bh - 1);
+
+            const bool small_block = texels < 31;
+
+            lerp_inputs_t in;
+
+            for (ui32 t = 0; t < bh; ++t)
+            {
+                for (ui32 s = 0; s < bw; ++s)
+                {
+                    const ui32 i = t * bw + s;
+
+                    std::array<ui8, 2> w {};
+
+                    if (gx == bw && gy == bh)
+                    {
+                        w[0] = weights[i * planes];
+                        w[1] = weights[i * planes + planes - 1];
+                    }
+                    else
+                    {
+                        const ui32 cs = ds * s;
+                        const ui32 ct = dt * t;
+                        const ui32 fx = (cs * (gx - 1) + 32) >> 6;
+                        const ui32 fy = (ct * (gy - 1) + 32) >> 6;
+                        const ui32 js = fx >> 4;
+                        const ui32 jt = fy >> 4;
+                        const ui32 fs = fx & 0xF;
+                        const ui32 ft = fy & 0xF;
+
+                        const ui32 w11 = (fs * ft + 8) >> 4;
+                        const ui32 w10 = ft - w11;
+                        const ui32 w01 = fs - w11;
+                        const ui32 w00 = 16 - fs - ft + w11;
+
+                        const ui32 v0 = js + jt * gx;
+
+                        for (ui32 p = 0; p < planes; ++p)
+                        {
+                            const ui32 sum = weights[v0 * planes + p] * w00
+                                           + weights[(v0 + 1) * planes + p] * w01
+                                           + weights[(v0 + gx) * planes + p] * w10
+                                           + weights[(v0 + gx + 1) * planes + p] * w11;
+
+                            w[p] = static_cast<ui8>((sum + 8) >> 4);
+                        }
+
+                        if (planes == 1) w[1] = w[0];
+                    }
+
+                    const ui32 p = partitions > 1 ? select_partition(seed, s, t, partitions, small_block) : 0;
+
+                    for (ui32 ch = 0; ch < 4; ++ch)
+                    {
+                        in.e0[i * 4 + ch] = static_cast<ui8>(e0[p][ch]);
+                        in.e1[i * 4 + ch] = static_cast<ui8>(e1[p][ch]);
+                        in.w[i * 4 + ch]  = ch == plane2_channel ? w[1] : w[0];
+                    }
+                }
+            }
+
+            if (srgb)
+            {
+                lerp_channels<lerp_mode::astc_srgb>(in.e0.data(), in.e1.data(), in.w.data(), out[0].data(), texels * 4);
+            }
+            else
+            {
+                lerp_channels<lerp_mode::astc_unorm>(in.e0.data(), in.e1.data(), in.w.data(), out[0].data(), texels * 4);
+            }
+        }
+
+        void decode_block(const block_info_t& info, const std::byte* block, texel_block_t& out)
+        {
+            switch (info.kind)
+            {
+            case block_kind::bc1_rgb:
+                decode_color(block, true, false, out);
+                break;
+            case block_kind::bc1_rgba:
+                decode_color(block, true, true, out);
+                break;
+            case block_kind::bc2:
+                decode_color(block + 8, false, false, out);
+                decode_explicit_alpha(block, out);
+                break;
+            case block_kind::bc3:
+                decode_color(block + 8, false, false, out);
+                decode_channel(block, 3, out);
+                break;
+            case block_kind::bc4:
+                std::fill_n(out.begin(), 16, std::array<ui8, 4> { 0, 0, 0, 255 });
+                decode_channel(block, 0, out);
+                break;
+            case block_kind::bc5:
+                std::fill_n(out.begin(), 16, std::array<ui8, 4> { 0, 0, 0, 255 });
+                decode_channel(block, 0, out);
+                decode_channel(block + 8, 1, out);
+                break;
+            case block_kind::bc7:
+                decode_bc7(block, out);
+                break;
+            case block_kind::astc:
+                decode_astc(block, info.width, info.height, info.srgb, out);
+                break;
+            case block_kind::unsupported:
+                break;
+            }
+        }
+    } // namespace
+
+    auto can_transcode_to_rgba8(VkFormat format) -> bool
+    {
+        return info_of(format).kind != block_kind::unsupported;
+    }
+
+    auto transcoded_format(VkFormat format) -> VkFormat
+    {
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        default:
+            return info_of(format).srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        }
+    }
+
+    auto transcode_to_rgba8(VkFormat                   format,
+                            std::span<const std::byte> src,
+                            ui32                       width,
+                            ui32                       height,
+                            std::span<std::byte>       dst) -> result<void>
+    {
+        const auto info = info_of(format);
+
+        if (info.kind == block_kind::unsupported)
+        {
+            return error_t { "Could not transcode: unsupported format {}", static_cast<ui32>(format) };
+        }
+
+        const ui32   blocks_x = (width + info.width - 1) / info.width;
+        const ui32   blocks_y = (height + info.height - 1) / info.height;
+        const size_t stride   = block_bytes(info.kind);
+
+        if (src.size() < size_t { blocks_x } * blocks_y * stride)
+        {
+            return error_t { "Could not transcode: {} bytes given for a {}x{} image", src.size(), width, height };
+        }
+
+        if (dst.size() < size_t { width } * height * 4)
+        {
+            return error_t { "Could not transcode: destination too small" };
+        }
+
+        texel_block_t texels {};
+        const auto*   block = src.data();
+
+        for (ui32 by = 0; by < blocks_y; ++by)
+        {
+            for (ui32 bx = 0; bx < blocks_x; ++bx, block += stride)
+            {
+                decode_block(info, block, texels);
+
+                const ui32 x0 = bx * info.width;
+                const ui32 y0 = by * info.height;
+                const ui32 w  = std::min(info.width, width - x0);
+                const ui32 h  = std::min(info.height, height - y0);
+
+                // Each row of the block is written with a single copy
+                for (ui32 y = 0; y < h; ++y)
+                {
+                    auto* row = dst.data() + (size_t { y0 + y } * width + x0) * 4;
+                    std::memcpy(row, texels[y * info.width].data(), size_t { w } * 4);
+                }
+            }
+        }
+
+        return {};
+    }
+} // namespace orb::vk
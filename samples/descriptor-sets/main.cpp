@@ -382,7 +382,10 @@ auto main() -> int
 
         device->wait().unwrap();
 
-        ui32 frame = 0;
+        ui32 frame            = 0;
+        ui64 frames_submitted = 0;
+
+        vk::deletion_queue_t deletions;
 
         ubo_t ubo_data {};
 
@@ -419,15 +422,17 @@ auto main() -> int
 
             // Wait fences
             fence.wait().unwrap();
+            deletions.begin_frame(frames_submitted, max_frames_in_flight);
 
             // Acquire the next swapchain image
             auto res = vk::acquire_img(*swapchain, img_avail.handles.back(), nullptr);
 
             if (res.require_sc_rebuild())
             {
-                device->wait().unwrap();
-                swapchain->rebuild().unwrap();
+                swapchain->rebuild(deletions).unwrap();
 
+                deletions.defer(std::move(views));
+                deletions.defer(std::move(fbs));
                 views = create_views();
                 fbs   = create_fbs();
                 continue;
@@ -521,6 +526,7 @@ auto main() -> int
             }
 
             frame = (frame + 1) % max_frames_in_flight;
+            frames_submitted++;
         }
 
         device->wait().unwrap();
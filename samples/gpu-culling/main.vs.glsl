@@ -0,0 +1,21 @@
+#version 450
+
+layout(binding = 0) uniform CameraBufferObject {
+    mat4 view_proj;
+} camera;
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+// Quads are laid out on a grid x grid layout centered on the origin, the culling pass passes
+// the object index as the first instance
+const int grid = 512;
+
+void main() {
+    vec2 cell = vec2(gl_InstanceIndex % grid, gl_InstanceIndex / grid);
+    vec2 center = cell - grid * 0.5;
+    gl_Position = camera.view_proj * vec4(inPosition * 0.8 + center, 0.0, 1.0);
+    fragColor = inColor;
+}
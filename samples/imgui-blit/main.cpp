@@ -130,6 +130,9 @@ auto main() -> int
                           .add_extension(vk::khr_extensions::swapchain)
                           .add_queue(graphics_qf, 1.0f)
                           .add_queue(transfer_qf, 1.0f)
+                          .timeline_semaphores()
+                          .present_wait()
+                          .synchronization2(gpu->api_version >= VK_API_VERSION_1_3)
                           .build(*gpu)
                           .unwrap();
 
@@ -216,8 +219,24 @@ auto main() -> int
                              .unwrap();
 
         // Synchronization
-        auto fences = vk::fences_builder_t::create(device.getmut(), max_frames_in_flight)
-                          .unwrap();
+        auto frame_sync = vk::frame_sync_builder_t::prepare(device.getmut())
+                              .unwrap()
+                              .frames_in_flight(max_frames_in_flight)
+                              .queue(graphics_qf->queues.front())
+                              .queue(transfer_qf->queues.front())
+                              .build()
+                              .unwrap();
+
+        auto pacer = vk::frame_pacer_builder_t::prepare(device.getmut(), swapchain.getmut())
+                         .unwrap()
+                         .max_frames_in_flight(max_frames_in_flight)
+                         .build()
+                         .unwrap();
+
+        vk::deletion_queue_t deletions;
+
+        auto& graphics_timeline = frame_sync->timeline(graphics_qf->queues.front());
+        auto& transfer_timeline = frame_sync->timeline(transfer_qf->queues.front());
 
         auto img_avail_sems = vk::semaphores_builder_t::prepare(device.getmut())
                                   .unwrap()
@@ -226,34 +245,34 @@ auto main() -> int
                                   .build()
                                   .unwrap();
 
+        // Indexed by frame slot, between the render and the copy of the same frame
         auto render_finished_sems = vk::semaphores_builder_t::prepare(device.getmut())
                                         .unwrap()
-                                        .count(swapchain->images.size())
+                                        .count(max_frames_in_flight)
                                         .stage(vk::pipeline_stage_flag::transfer)
                                         .build()
                                         .unwrap();
 
-        auto blit_finished_sems = vk::semaphores_builder_t::prepare(device.getmut())
-                                        .unwrap()
-                                        .count(swapchain->images.size())
-                                        .stage(vk::pipeline_stage_flag::color_attachment_output)
-                                        .build()
-                                        .unwrap();
-
-        auto graphics_cmd_pool = vk::cmd_pool_builder_t::prepare(device.getmut(), graphics_qf->index)
-                                     .unwrap()
-                                     .flag(vk::command_pool_create_flag::reset_command_buffer)
-                                     .build()
-                                     .unwrap();
+        // Indexed by swapchain image, whose count may change with a rebuild
+        const auto create_blit_finished_sems = [&] {
+            return vk::semaphores_builder_t::prepare(device.getmut())
+                .unwrap()
+                .count(swapchain->images.size())
+                .stage(vk::pipeline_stage_flag::color_attachment_output)
+                .build()
+                .unwrap();
+        };
 
-        auto transfer_cmd_pool = vk::cmd_pool_builder_t::prepare(device.getmut(), transfer_qf->index)
-                                     .unwrap()
-                                     .flag(vk::command_pool_create_flag::reset_command_buffer)
-                                     .build()
-                                     .unwrap();
+        auto blit_finished_sems = create_blit_finished_sems();
 
-        auto draw_cmds = graphics_cmd_pool->alloc_cmds(max_frames_in_flight).unwrap();
-        auto copy_cmds = transfer_cmd_pool->alloc_cmds(max_frames_in_flight).unwrap();
+        // Per frame command pools, reset as a whole once the frame's slot is free again
+        auto frame_ctx = vk::frame_context_builder_t::prepare(device.getmut())
+                             .unwrap()
+                             .frames_in_flight(max_frames_in_flight)
+                             .queue_family(graphics_qf->index)
+                             .queue_family(transfer_qf->index)
+                             .build()
+                             .unwrap();
 
         auto imgui_driver = vk::imgui_driver_builder_t::prepare(window,
                                                                 instance.getmut(),
@@ -269,7 +288,11 @@ auto main() -> int
                                 .build()
                                 .unwrap();
 
-        ui32 frame = 0;
+        // Both submits of a frame are flushed together, with vkQueueSubmit2 when available
+        auto submits = vk::submit_batch_t::prepare(device.getmut());
+
+        // Layout transitions of the copy
+        auto tracker = vk::resource_tracker_t::prepare(device.getmut()).unwrap();
 
         while (!window->should_close())
         {
@@ -282,9 +305,14 @@ auto main() -> int
                 continue;
             }
 
-            auto fence           = fences[frame];
-            auto img_avail       = img_avail_sems.view(frame, 1);
-            auto render_finished = render_finished_sems.view(frame, 1);
+            pacer->begin_frame().unwrap();
+
+            // Wait until the GPU is done with the frame that last used this slot
+            const ui32 frame           = frame_ctx->begin_frame(*frame_sync).unwrap();
+            auto       img_avail       = img_avail_sems.view(frame, 1);
+            auto       render_finished = render_finished_sems.view(frame, 1);
+
+            deletions.begin_frame(frame_sync->frame(), frame_sync->frames_in_flight());
 
             // Start a new ImGui frame
             imgui_driver.new_frame();
@@ -295,21 +323,23 @@ auto main() -> int
             // Render imgui
             imgui_driver.render();
 
-            // Wait fences
-            fence.wait().unwrap();
-
             // Acquire the next swapchain image
             auto res = vk::acquire_img(*swapchain, img_avail.handles.back(), nullptr);
 
             if (res.require_sc_rebuild())
             {
-                device->wait().unwrap();
-                swapchain->rebuild().unwrap();
+                swapchain->rebuild(deletions).unwrap();
 
+                deletions.defer(std::move(imgui_fbs));
+                deletions.defer(std::move(imgui_views));
+                deletions.defer(std::move(imgui_images));
                 imgui_images = create_images();
                 imgui_views  = create_views();
                 imgui_fbs    = create_fbs();
 
+                deletions.defer(std::move(blit_finished_sems));
+                blit_finished_sems = create_blit_finished_sems();
+
                 continue;
             }
             else if (res.is_error())
@@ -318,19 +348,16 @@ auto main() -> int
                 return 1;
             }
 
-            // Reset fences
-            fence.reset().unwrap();
-
-            uint32_t img_index = res.img_index();
-            auto blit_finished   = blit_finished_sems.view(img_index, 1);
+            uint32_t img_index     = res.img_index();
+            auto     blit_finished = blit_finished_sems.view(img_index, 1);
 
             // Render to the imgui pass framebuffer
             imgui_pass->begin_info.framebuffer       = imgui_fbs.handles[frame];
             imgui_pass->begin_info.renderArea.extent = swapchain->extent;
 
             // Begin command buffer recording
-            auto cmd = draw_cmds.get(frame).unwrap();
-            cmd.begin_one_time().unwrap();
+            auto cmd = frame_ctx->cmd(graphics_qf->index).unwrap();
+            cmd.begin(vk::command_buffer_usage_flag::one_time_submit).unwrap();
 
             // Begin the render pass
             imgui_pass->begin(cmd.handle);
@@ -344,52 +371,57 @@ auto main() -> int
             // End command buffer recording
             cmd.end();
 
-            // Submit render
-            vk::submit_helper_t::prepare()
+            // Queue the render
+            submits.submit(graphics_qf->queues.front())
                 .wait_semaphores(img_avail)
                 .signal_semaphores(render_finished.handles)
-                .cmd_buffer(&cmd.handle)
-                .submit(graphics_qf->queues.front(), nullptr)
-                .unwrap();
+                .signal_timeline(graphics_timeline.next())
+                .cmd_buffer(cmd.handle);
 
             // Copying rendered image to swapchain
             auto rendered_img  = imgui_images.handles.at(frame);
             auto swapchain_img = swapchain->images.at(img_index);
-            auto copy_cmd      = copy_cmds.get(frame).unwrap();
-            copy_cmd.begin_one_time().unwrap();
-
-            vk::transition_layout(copy_cmd.handle,
-                                  rendered_img,
-                                  vk::image_layout::undefined,
-                                  vk::image_layout::transfer_src_optimal);
-            vk::transition_layout(copy_cmd.handle,
-                                  swapchain_img,
-                                  vk::image_layout::undefined,
-                                  vk::image_layout::transfer_dst_optimal);
+            auto copy_cmd      = frame_ctx->cmd(transfer_qf->index).unwrap();
+            copy_cmd.begin(vk::command_buffer_usage_flag::one_time_submit).unwrap();
+
+            // The imgui pass leaves its image in present_src_khr, the swapchain image content is
+            // discarded. Both were last touched before the semaphore wait of the copy submit
+            tracker.track_image(rendered_img, vk::image_aspect_flag::color, 1, 1, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+            tracker.track_image(swapchain_img);
+            tracker.wait_external(rendered_img, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+            tracker.wait_external(swapchain_img, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+
+            tracker.use(rendered_img, vk::resource_usage::transfer_src);
+            tracker.use(swapchain_img, vk::resource_usage::transfer_dst);
+            tracker.flush(copy_cmd.handle);
 
             vk::copy_img(copy_cmd.handle, rendered_img, swapchain_img, swapchain->extent);
 
-            vk::transition_layout(copy_cmd.handle,
-                                  swapchain_img,
-                                  vk::image_layout::transfer_dst_optimal,
-                                  vk::image_layout::present_src_khr);
+            tracker.use(swapchain_img, vk::resource_usage::present);
+            tracker.flush(copy_cmd.handle);
             copy_cmd.end();
 
-            // Submit copy
-            vk::submit_helper_t::prepare()
+            // Queue the copy, then submit both
+            submits.submit(transfer_qf->queues.front())
                 .wait_semaphores(render_finished)
                 .signal_semaphores(blit_finished.handles)
-                .cmd_buffer(&copy_cmd.handle)
-                .submit(transfer_qf->queues.front(), fence.handle)
-                .unwrap();
+                .signal_timeline(transfer_timeline.next())
+                .cmd_buffer(copy_cmd.handle);
+
+            submits.flush().unwrap();
+
+            frame_sync->end_frame();
 
             // Present the rendered image
             auto present_res = vk::present_helper_t::prepare()
                                    .swapchain(*swapchain)
                                    .wait_semaphores(blit_finished.handles)
                                    .img_index(img_index)
+                                   .present_id(pacer->present_id())
                                    .present(graphics_qf->queues.front());
 
+            pacer->presented(present_res);
+
             if (present_res.require_sc_rebuild())
             {
                 continue;
@@ -399,8 +431,6 @@ auto main() -> int
                 fmt::println("Frame present error: {}", vk::vkres::get_repr(present_res.error()));
                 return 1;
             }
-
-            frame = (frame + 1) % max_frames_in_flight;
         }
 
         device->wait().unwrap();
@@ -0,0 +1,447 @@
+#include <array>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <orb/eval.hpp>
+#include <orb/flux.hpp>
+#include <orb/renderer.hpp>
+#include <orb/time.hpp>
+
+using namespace orb;
+
+static constexpr ui32 max_frames_in_flight = 2;
+
+// Pipeline statistics key of the ImGui draws, which share one pipeline
+static constexpr ui64 imgui_stats_key = 1;
+
+namespace
+{
+    /* @brief Creates the ImGui render pass
+     *
+     * @param device The vulkan device
+     * @param img_format The format of the image ImGui renders to
+     * @return The ImGui render pass
+     */
+    [[nodiscard]] auto create_imgui_pass(VkDevice device, VkFormat img_format) -> box<vk::render_pass_t>
+    {
+        vk::attachments_t attachments;
+        vk::subpasses_t   subpasses;
+
+        attachments.add({
+            .img_format        = img_format,
+            .samples           = vk::sample_count_flag::_1,
+            .load_ops          = vk::attachment_load_op::clear,
+            .store_ops         = vk::attachment_store_op::store,
+            .stencil_load_ops  = vk::attachment_load_op::dont_care,
+            .stencil_store_ops = vk::attachment_store_op::dont_care,
+            .initial_layout    = vk::image_layout::undefined,
+            .final_layout      = vk::image_layout::color_attachment_optimal,
+            .attachment_layout = vk::image_layout::color_attachment_optimal,
+        });
+
+        const auto [color_descs, color_refs] = attachments.spans(0, 1);
+
+        subpasses.add_subpass({
+            .bind_point = vk::pipeline_bind_point::graphics,
+            .color_refs = color_refs,
+        });
+
+        subpasses.add_dependency({
+            .src        = vk::subpass_external,
+            .dst        = 0,
+            .src_stage  = vk::pipeline_stage_flag::color_attachment_output,
+            .dst_stage  = vk::pipeline_stage_flag::color_attachment_output,
+            .src_access = 0,
+            .dst_access = vk::access_flag::color_attachment_write,
+        });
+
+        auto imgui_pass = vk::render_pass_builder_t::prepare(device)
+                              .unwrap()
+                              .clear_color({ 0.0f, 0.0f, 0.0f, 1.0f })
+                              .build(subpasses, attachments)
+                              .unwrap();
+        imgui_pass->bind_color();
+
+        return imgui_pass;
+    }
+} // namespace
+
+auto main() -> int
+{
+    try
+    {
+        box<glfw::driver_t> glfw_driver = glfw::driver_t::create().unwrap();
+
+        weak<glfw::window_t> window = glfw_driver->create_window_for_vk().unwrap();
+
+        box<vk::instance_t> instance = vk::instance_builder_t::prepare()
+                                           .unwrap()
+                                           .add_glfw_required_extensions()
+                                           .molten_vk(orb::on_macos ? true : false)
+                                           .add_extension(vk::khr_extensions::device_properties_2)
+                                           .add_extension(vk::extensions::debug_utils)
+                                           .debug_layer(vk::validation_layers::validation)
+                                           .build()
+                                           .unwrap();
+
+        vk::surface_t surface = vk::surface_builder_t::prepare(instance->handle, window)
+                                    .build()
+                                    .unwrap();
+
+        box<vk::gpu_t> gpu = vk::gpu_selector_t::prepare(instance->handle)
+                                 .unwrap()
+                                 .prefer_type(vk::gpu_type::discrete)
+                                 .prefer_type(vk::gpu_type::integrated)
+                                 .select()
+                                 .unwrap();
+
+        gpu->describe();
+
+        auto [graphics_qf, transfer_qf] = orb::eval | [&] {
+            std::span graphics_qfs = gpu->queue_family_map->graphics().unwrap();
+            std::span transfer_qfs = gpu->queue_family_map->transfer().unwrap();
+
+            auto graphics_qf = graphics_qfs.front();
+
+            auto transfer_qf = orb::eval | [&] {
+                for (auto qf : transfer_qfs)
+                {
+                    if (qf->index != graphics_qf->index)
+                    {
+                        return qf;
+                    }
+                }
+
+                return transfer_qfs.front();
+            };
+
+            return std::make_tuple(graphics_qf, transfer_qf);
+        };
+
+        fmt::println("- Selected graphics queue family {} with {} queues",
+                     graphics_qf->index,
+                     graphics_qf->properties.queueCount);
+
+        fmt::println("- Selected transfer queue family {} with {} queues",
+                     transfer_qf->index,
+                     transfer_qf->properties.queueCount);
+
+        auto device = vk::device_builder_t::prepare(instance->handle)
+                          .unwrap()
+                          .add_extension(vk::khr_extensions::swapchain)
+                          .add_queue(graphics_qf, 1.0f)
+                          .add_queue(transfer_qf, 1.0f)
+                          .timeline_semaphores()
+                          .present_wait()
+                          .host_query_reset()
+                          .pipeline_statistics()
+                          .synchronization2(gpu->api_version >= VK_API_VERSION_1_3)
+                          .build(*gpu)
+                          .unwrap();
+
+        for (auto queue : graphics_qf->queues)
+        {
+            device->set_name(queue, "Graphics queue");
+        }
+
+        for (auto queue : transfer_qf->queues)
+        {
+            device->set_name(queue, "Transfer queue");
+        }
+
+        box<vk::swapchain_t> swapchain = vk::swapchain_builder_t::prepare(instance.getmut(),
+                                                                          gpu.getmut(),
+                                                                          device.getmut(),
+                                                                          window,
+                                                                          &surface)
+                                             .unwrap()
+                                             .fb_dimensions_from_window()
+                                             .present_queue_family_index(graphics_qf->index)
+                                             .queue_family(transfer_qf->index)
+
+                                             .usage(vk::image_usage_flag::transfer_dst)
+                                             .usage(vk::image_usage_flag::color_attachment)
+                                             .color_space(vk::color_space::srgb_nonlinear_khr)
+                                             .format(vk::format::b8g8r8a8_unorm)
+                                             .format(vk::format::r8g8b8a8_unorm)
+                                             .format(vk::format::b8g8r8_unorm)
+                                             .format(vk::format::r8g8b8_unorm)
+
+                                             .present_mode(vk::present_mode::mailbox_khr)
+                                             .present_mode(vk::present_mode::immediate_khr)
+                                             .present_mode(vk::present_mode::fifo_khr)
+
+                                             .build()
+                                             .unwrap();
+
+        box<vk::render_pass_t> imgui_pass = create_imgui_pass(device->handle, VK_FORMAT_B8G8R8A8_UNORM);
+
+        auto desc_pool = vk::desc_pool_builder_t::prepare(device.getmut())
+                             .unwrap()
+                             .pool(vk::descriptor_type::combined_image_sampler, 100)
+                             .flag(vk::descriptor_pool_create_flag::free_descriptor_set)
+                             .build()
+                             .unwrap();
+
+        // Synchronization
+        auto frame_sync = vk::frame_sync_builder_t::prepare(device.getmut())
+                              .unwrap()
+                              .frames_in_flight(max_frames_in_flight)
+                              .queue(graphics_qf->queues.front())
+                              .queue(transfer_qf->queues.front())
+                              .build()
+                              .unwrap();
+
+        auto pacer = vk::frame_pacer_builder_t::prepare(device.getmut(), swapchain.getmut())
+                         .unwrap()
+                         .max_frames_in_flight(max_frames_in_flight)
+                         .build()
+                         .unwrap();
+
+        auto img_avail_sems = vk::semaphores_builder_t::prepare(device.getmut())
+                                  .unwrap()
+                                  .count(max_frames_in_flight)
+                                  .stage(vk::pipeline_stage_flag::transfer)
+                                  .build()
+                                  .unwrap();
+
+        // Indexed by swapchain image, whose count may change with a rebuild
+        const auto create_blit_finished_sems = [&] {
+            return vk::semaphores_builder_t::prepare(device.getmut())
+                .unwrap()
+                .count(swapchain->images.size())
+                .stage(vk::pipeline_stage_flag::color_attachment_output)
+                .build()
+                .unwrap();
+        };
+
+        auto blit_finished_sems = create_blit_finished_sems();
+
+        auto frame_ctx = vk::frame_context_builder_t::prepare(device.getmut())
+                             .unwrap()
+                             .frames_in_flight(max_frames_in_flight)
+                             .queue_family(graphics_qf->index)
+                             .queue_family(transfer_qf->index)
+                             .build()
+                             .unwrap();
+
+        auto imgui_driver = vk::imgui_driver_builder_t::prepare(window,
+                                                                instance.getmut(),
+                                                                gpu.getmut(),
+                                                                device.getmut(),
+                                                                swapchain.getmut(),
+                                                                &desc_pool,
+                                                                imgui_pass.getmut(),
+                                                                graphics_qf->index,
+                                                                graphics_qf->queues.front())
+                                .dark_theme(true)
+                                .config_flag(ImGuiConfigFlags_NavEnableKeyboard)
+                                .build()
+                                .unwrap();
+
+        auto submits = vk::submit_batch_t::prepare(device.getmut());
+
+        auto profiler = vk::gpu_profiler_builder_t::prepare(device.getmut(), gpu.getmut())
+                            .unwrap()
+                            .frames_in_flight(max_frames_in_flight)
+                            .queue_family(graphics_qf->index)
+                            .build()
+                            .unwrap();
+
+        auto pipeline_stats = vk::pipeline_stats_builder_t::prepare(device.getmut())
+                                  .unwrap()
+                                  .frames_in_flight(max_frames_in_flight)
+                                  .build()
+                                  .unwrap();
+
+        auto deletions = make_box<vk::deletion_queue_t>();
+
+        // The graph owns the imgui image and the layout transitions. The swapchain images are
+        // shared with the transfer family, the blit needs no ownership transfer before present
+        auto graph = vk::frame_graph_builder_t::prepare(device.getmut())
+                         .unwrap()
+                         .queue(vk::graph_queue::graphics, graphics_qf->queues.front(), graphics_qf->index)
+                         .queue(vk::graph_queue::transfer, transfer_qf->queues.front(), transfer_qf->index)
+                         .frames_in_flight(max_frames_in_flight)
+                         .deletion_queue(deletions.getmut())
+                         .profiler(profiler.getmut())
+                         .build()
+                         .unwrap();
+
+        // Framebuffers on graph images, rebuilt lazily once the graph recompiled
+        std::array<vk::framebuffers_t, max_frames_in_flight> imgui_fbs;
+        std::array<ui64, max_frames_in_flight>               imgui_fbs_generation {};
+
+        ORB_PROFILE_THREAD("Main thread");
+
+        while (!window->should_close())
+        {
+            ORB_PROFILE_ZONE("Frame");
+
+            glfw_driver->poll_events();
+
+            if (window->minimized())
+            {
+                using namespace std::literals;
+                std::this_thread::sleep_for(orb::milliseconds_t(100));
+                continue;
+            }
+
+            pacer->begin_frame().unwrap();
+
+            // Wait until the GPU is done with the frame that last used this slot
+            const ui32 frame     = frame_ctx->begin_frame(*frame_sync).unwrap();
+            auto       img_avail = img_avail_sems.view(frame, 1);
+
+            deletions->begin_frame(frame_sync->frame(), frame_sync->frames_in_flight());
+            profiler->begin_frame(frame).unwrap();
+            pipeline_stats->begin_frame(frame).unwrap();
+
+            imgui_driver.new_frame();
+            ImGui::ShowDemoWindow();
+
+            ImGui::Begin("GPU timings");
+            for (const auto& zone : profiler->zones())
+            {
+                ImGui::Text("%-8s %.3f ms avg, %.3f ms p99",
+                            zone.name.c_str(),
+                            zone.average(),
+                            zone.percentile(0.99f));
+            }
+
+            if (pacer->enabled())
+            {
+                ImGui::Text("%-8s %.3f ms avg, %.3f ms p99, %u in flight",
+                            "present",
+                            pacer->latency().average(),
+                            pacer->latency().percentile(0.99f),
+                            pacer->frames_in_flight());
+            }
+
+            for (const auto& entry : pipeline_stats->entries())
+            {
+                ImGui::Text("%-8s %llu fragments",
+                            entry.name.c_str(),
+                            static_cast<unsigned long long>(entry.last[vk::pipeline_counter::fragment_invocations]));
+            }
+            ImGui::End();
+
+            imgui_driver.render();
+
+            auto res = vk::acquire_img(*swapchain, img_avail.handles.back(), nullptr);
+
+            if (res.require_sc_rebuild())
+            {
+                for (auto img : swapchain->images)
+                {
+                    graph->forget(img);
+                }
+
+                swapchain->rebuild(*deletions).unwrap();
+
+                deletions->defer(std::move(blit_finished_sems));
+                blit_finished_sems = create_blit_finished_sems();
+
+                continue;
+            }
+            else if (res.is_error())
+            {
+                fmt::println("Acquire img error");
+                return 1;
+            }
+
+            uint32_t img_index     = res.img_index();
+            auto     blit_finished = blit_finished_sems.view(img_index, 1);
+
+            // Declare the frame, recompiled only when the swapchain extent changes
+            graph->reset();
+            graph->set_extent(swapchain->extent);
+
+            auto ui = graph->create_image("imgui", { .format = vk::format::b8g8r8a8_unorm });
+            auto sc = graph->import_image("swapchain",
+                                          { .image = swapchain->images.at(img_index), .extent = swapchain->extent });
+
+            graph->wait(sc, img_avail.handles.back(), VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+            graph->signal(sc, blit_finished.handles.back());
+            graph->output(sc, vk::resource_usage::present);
+
+            graph->add_pass("imgui")
+                .use(ui, vk::resource_usage::color_attachment_write)
+                .execute([&](vk::graph_context_t& ctx) {
+                    if (imgui_fbs_generation[ctx.slot] != graph->generation())
+                    {
+                        imgui_fbs[ctx.slot] = vk::framebuffers_builder_t::prepare(device.getmut(), imgui_pass->handle)
+                                                  .unwrap()
+                                                  .size(swapchain->width, swapchain->height)
+                                                  .attachment(ctx.view(ui))
+                                                  .build()
+                                                  .unwrap();
+
+                        imgui_fbs_generation[ctx.slot] = graph->generation();
+                    }
+
+                    imgui_pass->begin_info.framebuffer       = imgui_fbs[ctx.slot].handles.front();
+                    imgui_pass->begin_info.renderArea.extent = ctx.extent(ui);
+
+                    imgui_pass->begin(ctx.cmd.handle);
+                    {
+                        auto query = pipeline_stats->query(ctx.cmd.handle, imgui_stats_key, "imgui");
+                        imgui_driver.submit_render(ctx.cmd.handle);
+                    }
+                    imgui_pass->end(ctx.cmd.handle);
+                });
+
+            graph->add_pass("blit", vk::graph_queue::transfer)
+                .use(ui, vk::resource_usage::transfer_src)
+                .use(sc, vk::resource_usage::transfer_dst)
+                .execute([&](vk::graph_context_t& ctx) {
+                    vk::copy_img(ctx.cmd.handle, ctx.image(ui), ctx.image(sc), swapchain->extent);
+                });
+
+            const ui64 generation = graph->generation();
+
+            graph->compile().unwrap();
+
+            if (graph->generation() != generation) graph->describe();
+
+            graph->execute(*frame_ctx, *frame_sync, submits).unwrap();
+            submits.flush().unwrap();
+
+            frame_sync->end_frame();
+
+            auto present_res = vk::present_helper_t::prepare()
+                                   .swapchain(*swapchain)
+                                   .wait_semaphores(blit_finished.handles)
+                                   .img_index(img_index)
+                                   .present_id(pacer->present_id())
+                                   .present(graphics_qf->queues.front());
+
+            pacer->presented(present_res);
+
+            if (present_res.require_sc_rebuild())
+            {
+                continue;
+            }
+            else if (present_res.is_error())
+            {
+                fmt::println("Frame present error: {}", vk::vkres::get_repr(present_res.error()));
+                return 1;
+            }
+        }
+
+        device->wait().unwrap();
+
+#ifdef ORBRENDERER_PROFILING
+        orb::profiler::write_trace("imgui-graph-trace.json").unwrap();
+#endif
+    }
+    catch (const orb::exception& e)
+    {
+        fmt::println("Fatal error: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -187,7 +187,10 @@ auto main() -> int
                                 .build()
                                 .unwrap();
 
-        ui32 frame = 0;
+        ui32 frame            = 0;
+        ui64 frames_submitted = 0;
+
+        vk::deletion_queue_t deletions;
 
         while (!window->should_close())
         {
@@ -214,15 +217,17 @@ auto main() -> int
 
             // Wait fences
             fence.wait().unwrap();
+            deletions.begin_frame(frames_submitted, max_frames_in_flight);
 
             // Acquire the next swapchain image
             auto res = vk::acquire_img(*swapchain, img_avail.handles.back(), nullptr);
 
             if (res.require_sc_rebuild())
             {
-                device->wait().unwrap();
-                swapchain->rebuild().throw_if_error();
+                swapchain->rebuild(deletions).throw_if_error();
 
+                deletions.defer(std::move(views));
+                deletions.defer(std::move(imgui_fbs));
                 views     = create_views();
                 imgui_fbs = create_fbs();
 
@@ -287,6 +292,7 @@ auto main() -> int
             }
 
             frame = (frame + 1) % max_frames_in_flight;
+            frames_submitted++;
         }
 
         device->wait().unwrap();
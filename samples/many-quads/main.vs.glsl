@@ -0,0 +1,16 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+// Quads are laid out on a grid x grid layout, row by row
+const int grid = 256;
+
+void main() {
+    vec2 cell = vec2(gl_InstanceIndex % grid, gl_InstanceIndex / grid);
+    vec2 center = (cell + 0.5) / grid * 2.0 - 1.0;
+    gl_Position = vec4(inPosition / grid + center, 0.0, 1.0);
+    fragColor = inColor;
+}
@@ -25,6 +25,7 @@ auto main() -> int
                                            .add_extension(vk::khr_extensions::device_properties_2)
                                            .add_extension(vk::extensions::debug_utils)
                                            .debug_layer(vk::validation_layers::validation)
+                                           .track_host_allocations(true)
                                            .build()
                                            .unwrap();
 
@@ -73,6 +74,8 @@ auto main() -> int
                           .add_extension(vk::khr_extensions::swapchain)
                           .add_queue(graphics_qf, 1.0f)
                           .add_queue(transfer_qf, 1.0f)
+                          .timeline_semaphores()
+                          .present_wait()
                           .build(*gpu)
                           .unwrap();
 
@@ -230,8 +233,22 @@ auto main() -> int
         fmt::println("- Creating synchronization objects");
 
         // Synchronization
-        auto fences = vk::fences_builder_t::create(device.getmut(), max_frames_in_flight)
-                          .unwrap();
+        auto frame_sync = vk::frame_sync_builder_t::prepare(device.getmut())
+                              .unwrap()
+                              .frames_in_flight(max_frames_in_flight)
+                              .queue(graphics_qf->queues.front())
+                              .build()
+                              .unwrap();
+
+        auto pacer = vk::frame_pacer_builder_t::prepare(device.getmut(), swapchain.getmut())
+                         .unwrap()
+                         .max_frames_in_flight(max_frames_in_flight)
+                         .build()
+                         .unwrap();
+
+        vk::deletion_queue_t deletions;
+
+        auto& graphics_timeline = frame_sync->timeline(graphics_qf->queues.front());
 
         auto img_avail_sems = vk::semaphores_builder_t::prepare(device.getmut())
                                   .unwrap()
@@ -263,6 +280,15 @@ auto main() -> int
         fmt::println("- Creating command buffers");
         auto draw_cmds = graphics_cmd_pool->alloc_cmds(max_frames_in_flight).unwrap();
 
+        fmt::println("- Creating command cache");
+        auto cmd_cache = vk::cmd_cache_builder_t::prepare(device.getmut(), graphics_qf->index)
+                             .unwrap()
+                             .frames_in_flight(max_frames_in_flight)
+                             .build()
+                             .unwrap();
+
+        static constexpr ui32 quad_segment = 0;
+
         std::vector<vertex_t> vertices = {
             { { -0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f } },
             {  { 0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f } },
@@ -278,6 +304,7 @@ auto main() -> int
                                  .vertices<vertex_t>(vertices)
                                  .buffer_usage_flag(vk::buffer_usage_flag::transfer_destination)
                                  .memory_flags(vk::memory_flag::dedicated_memory)
+                                 .prefer_direct_upload()
                                  .build()
                                  .unwrap();
 
@@ -287,52 +314,21 @@ auto main() -> int
                                 .indices(std::span<const ui16> { indices })
                                 .buffer_usage_flag(vk::buffer_usage_flag::transfer_destination)
                                 .memory_flags(vk::memory_flag::dedicated_memory)
+                                .prefer_direct_upload()
                                 .build()
                                 .unwrap();
 
-        fmt::println("- Creating staging buffer");
-        auto staging_buffer = vk::staging_buffer_builder_t::prepare(device.getmut(), vertex_buffer.size)
-                                  .unwrap()
-                                  .build()
-                                  .unwrap();
-
-        fmt::println("- Copying vertices to staging buffer");
-        staging_buffer.transfer(vertices.data(), sizeof(vertex_t) * vertices.size()).unwrap();
-
-        fmt::println("- Copying staging buffer to vertex buffer");
-        auto cpy_cmd = transfer_cmd_pool->alloc_cmds(1).unwrap().get(0).unwrap();
-
-        cpy_cmd.begin_one_time().unwrap();
-        cpy_cmd.copy_buffer(staging_buffer.buffer, vertex_buffer.buffer, vertex_buffer.size);
-        cpy_cmd.end().unwrap();
-
-        fmt::println("- Submitting copy command buffer");
-        vk::submit_helper_t::prepare()
-            .cmd_buffer(&cpy_cmd.handle)
-            .submit(transfer_qf->queues.front())
-            .unwrap();
-
-        device->wait().unwrap();
-
-        fmt::println("- Copying indices to staging buffer");
-        staging_buffer.transfer(indices.data(), sizeof(ui16) * indices.size()).unwrap();
-
-        fmt::println("- Copying staging buffer to index buffer");
-        cpy_cmd = transfer_cmd_pool->alloc_cmds(1).unwrap().get(0).unwrap();
-
-        cpy_cmd.begin_one_time().unwrap();
-        cpy_cmd.copy_buffer(staging_buffer.buffer, index_buffer.buffer, index_buffer.size);
-        cpy_cmd.end().unwrap();
-
-        fmt::println("- Submitting copy command buffer");
-        vk::submit_helper_t::prepare()
-            .cmd_buffer(&cpy_cmd.handle)
-            .submit(transfer_qf->queues.front())
-            .unwrap();
-
-        device->wait().unwrap();
+        fmt::println("- Uploading vertices and indices");
+        auto upload_stats = vk::buffer_upload_helper_t::prepare(device.getmut())
+                                .copy(vertices, vertex_buffer)
+                                .copy(indices, index_buffer)
+                                .staging(transfer_cmd_pool.getmut(), transfer_qf->queues.front())
+                                .upload()
+                                .unwrap();
 
-        ui32 frame = 0;
+        fmt::println("  - {} bytes written directly, {} bytes through staging",
+                     upload_stats.direct_bytes,
+                     upload_stats.staged_bytes);
 
         fmt::println("- Main loop");
         while (!window->should_close())
@@ -346,20 +342,23 @@ auto main() -> int
                 continue;
             }
 
-            auto fence     = fences[frame];
-            auto img_avail = img_avail_sems.view(frame, 1);
+            pacer->begin_frame().unwrap();
+
+            // Wait until the GPU is done with the frame that last used this slot
+            const ui32 frame     = frame_sync->begin_frame().unwrap();
+            auto       img_avail = img_avail_sems.view(frame, 1);
 
-            // Wait fences
-            fence.wait().unwrap();
+            deletions.begin_frame(frame_sync->frame(), frame_sync->frames_in_flight());
 
             // Acquire the next swapchain image
             auto res = vk::acquire_img(*swapchain, img_avail.handles.back(), nullptr);
 
             if (res.require_sc_rebuild())
             {
-                device->wait().unwrap();
-                swapchain->rebuild().unwrap();
+                swapchain->rebuild(deletions).unwrap();
 
+                deletions.defer(std::move(views));
+                deletions.defer(std::move(fbs));
                 views = create_views();
                 fbs   = create_fbs();
                 continue;
@@ -370,9 +369,6 @@ auto main() -> int
                 return 1;
             }
 
-            // Reset fences
-            fence.reset().unwrap();
-
             uint32_t img_index = res.img_index();
 
             auto render_finished = render_finished_sems.view(img_index, 1);
@@ -381,31 +377,44 @@ auto main() -> int
             render_pass->begin_info.framebuffer       = fbs.handles[img_index];
             render_pass->begin_info.renderArea.extent = swapchain->extent;
 
-            // Begin command buffer recording
-            auto cmd = draw_cmds.get(frame).unwrap();
-            cmd.begin_one_time().unwrap();
+            // The quad never changes: its draw is recorded once per frame in flight, and again
+            // only when the swapchain is rebuilt since the viewport depends on its size
+            const vk::cmd_segment_key_t quad_key {
+                .generation  = swapchain->generation,
+                .render_pass = render_pass->handle,
+            };
 
-            // Begin the render pass
-            render_pass->begin(cmd.handle);
+            const vk::segment_fn_t draw_quad = [&](vk::cmd_buffer_t& secondary) {
+                // Bind the graphics pipeline
+                vkCmdBindPipeline(secondary.handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->handle);
+                std::array<VkDeviceSize, 1> offsets = { 0 };
+                vkCmdBindVertexBuffers(secondary.handle, 0, 1, &vertex_buffer.buffer, offsets.data());
+                vkCmdBindIndexBuffer(secondary.handle, index_buffer.buffer, 0, index_buffer.index_type);
+
+                // Set viewport and scissor
+                auto& viewport        = pipeline->viewports.back();
+                auto& scissor         = pipeline->scissors.back();
+                viewport.width        = static_cast<f32>(swapchain->width);
+                viewport.height       = static_cast<f32>(swapchain->height);
+                scissor.extent.width  = swapchain->width;
+                scissor.extent.height = swapchain->height;
+                vkCmdSetViewport(secondary.handle, 0, 1, &viewport);
+                vkCmdSetScissor(secondary.handle, 0, 1, &scissor);
+
+                // Draw quad
+                vkCmdDrawIndexed(secondary.handle, static_cast<ui32>(indices.size()), 1, 0, 0, 0);
+            };
 
-            // Bind the graphics pipeline
-            vkCmdBindPipeline(cmd.handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->handle);
-            std::array<VkDeviceSize, 1> offsets = { 0 };
-            vkCmdBindVertexBuffers(cmd.handle, 0, 1, &vertex_buffer.buffer, offsets.data());
-            vkCmdBindIndexBuffer(cmd.handle, index_buffer.buffer, 0, index_buffer.index_type);
+            cmd_cache->begin_frame(frame);
+            VkCommandBuffer quad_cmd = cmd_cache->segment(quad_segment, quad_key, draw_quad).unwrap();
 
-            // Set viewport and scissor
-            auto& viewport        = pipeline->viewports.back();
-            auto& scissor         = pipeline->scissors.back();
-            viewport.width        = static_cast<f32>(swapchain->width);
-            viewport.height       = static_cast<f32>(swapchain->height);
-            scissor.extent.width  = swapchain->width;
-            scissor.extent.height = swapchain->height;
-            vkCmdSetViewport(cmd.handle, 0, 1, &viewport);
-            vkCmdSetScissor(cmd.handle, 0, 1, &scissor);
+            // Begin command buffer recording
+            auto cmd = draw_cmds.get(frame).unwrap();
+            cmd.begin_one_time().unwrap();
 
-            // Draw quad
-            vkCmdDrawIndexed(cmd.handle, static_cast<ui32>(indices.size()), 1, 0, 0, 0);
+            // Begin the render pass and execute the cached draw in it
+            render_pass->begin(cmd.handle, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            cmd.execute({ &quad_cmd, 1 });
 
             // End the render pass
             render_pass->end(cmd.handle);
@@ -417,17 +426,23 @@ auto main() -> int
             vk::submit_helper_t::prepare()
                 .wait_semaphores(img_avail)
                 .signal_semaphores(render_finished.handles)
+                .signal_timeline(graphics_timeline.next())
                 .cmd_buffer(&cmd.handle)
-                .submit(graphics_qf->queues.front(), fence.handle)
+                .submit(graphics_qf->queues.front())
                 .unwrap();
 
+            frame_sync->end_frame();
+
             // Present the rendered image
             auto present_res = vk::present_helper_t::prepare()
                                    .swapchain(*swapchain)
                                    .wait_semaphores(render_finished.handles)
                                    .img_index(img_index)
+                                   .present_id(pacer->present_id())
                                    .present(graphics_qf->queues.front());
 
+            pacer->presented(present_res);
+
             if (present_res.require_sc_rebuild())
             {
                 continue;
@@ -437,11 +452,11 @@ auto main() -> int
                 fmt::println("Frame present error: {}", vk::vkres::get_repr(present_res.error()));
                 return 1;
             }
-
-            frame = (frame + 1) % max_frames_in_flight;
         }
 
         device->wait().unwrap();
+
+        vk::host_allocator::report().print();
     }
     catch (const orb::exception& e)
     {
@@ -0,0 +1,155 @@
+#include <array>
+#include <bit>
+#include <charconv>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <orb/renderer.hpp>
+
+using namespace orb;
+
+static constexpr std::array<std::pair<std::string_view, pak_blob_kind>, 6> blob_kinds = { {
+    { "raw", pak_blob_kind::raw },
+    { "vertices", pak_blob_kind::vertices },
+    { "indices16", pak_blob_kind::indices_u16 },
+    { "indices32", pak_blob_kind::indices_u32 },
+    { "spirv", pak_blob_kind::spirv },
+    { "ktx2", pak_blob_kind::ktx2 },
+} };
+
+static auto kind_from_name(std::string_view name) -> std::optional<pak_blob_kind>
+{
+    for (const auto& [n, kind] : blob_kinds)
+    {
+        if (n == name) return kind;
+    }
+
+    return std::nullopt;
+}
+
+static auto kind_name(pak_blob_kind kind) -> std::string_view
+{
+    for (const auto& [n, k] : blob_kinds)
+    {
+        if (k == kind) return n;
+    }
+
+    return "unknown";
+}
+
+static void print_usage()
+{
+    fmt::println("Usage:");
+    fmt::println("  orbpak pack <output.orbpak> [--align <bytes>] <kind>:<name>=<path>...");
+    fmt::println("  orbpak list <archive.orbpak>");
+    fmt::println("  orbpak verify <archive.orbpak>");
+    fmt::println("Kinds: raw, vertices, indices16, indices32, spirv, ktx2");
+}
+
+static auto pack(std::string_view output, std::span<char*> args) -> int
+{
+    auto writer = pak_writer_t::prepare();
+
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        const std::string_view arg = args[i];
+
+        if (arg == "--align" && i + 1 < args.size())
+        {
+            const std::string_view value = args[++i];
+            const char*            last  = value.data() + value.size();
+
+            ui32 alignment       = 0;
+            const auto [end, ec] = std::from_chars(value.data(), last, alignment);
+
+            if (ec != std::errc {} || end != last || !std::has_single_bit(alignment))
+            {
+                fmt::println("Invalid alignment {}, expected a power of two", value);
+                return 1;
+            }
+
+            writer.alignment(alignment);
+            continue;
+        }
+
+        const auto colon = arg.find(':');
+        const auto equal = arg.find('=', colon == std::string_view::npos ? 0 : colon);
+
+        if (colon == std::string_view::npos || equal == std::string_view::npos)
+        {
+            fmt::println("Invalid blob argument {}", arg);
+            return 1;
+        }
+
+        const auto kind = kind_from_name(arg.substr(0, colon));
+
+        if (!kind)
+        {
+            fmt::println("Unknown blob kind in {}", arg);
+            return 1;
+        }
+
+        const auto name = arg.substr(colon + 1, equal - colon - 1);
+        const auto path = arg.substr(equal + 1);
+
+        writer.add_file(std::string { name }, *kind, path).unwrap();
+    }
+
+    writer.write(output).unwrap();
+
+    return 0;
+}
+
+static auto list(std::string_view archive) -> int
+{
+    const auto reader = pak_reader_t::open(archive).unwrap();
+
+    for (size_t i = 0; i < reader.size(); ++i)
+    {
+        const auto blob = reader.blob(i);
+        fmt::println("{:<10} {:>12} {:016x} {}", kind_name(blob.kind), blob.data.size(), blob.checksum, blob.name);
+    }
+
+    return 0;
+}
+
+static auto verify(std::string_view archive) -> int
+{
+    const auto reader = pak_reader_t::open(archive).unwrap();
+
+    reader.verify_all().unwrap();
+    fmt::println("{}: {} blobs ok", archive, reader.size());
+
+    return 0;
+}
+
+auto main(int argc, char** argv) -> int
+{
+    const std::span<char*> args { argv, static_cast<size_t>(argc) };
+
+    if (args.size() < 3)
+    {
+        print_usage();
+        return 1;
+    }
+
+    try
+    {
+        const std::string_view command = args[1];
+
+        if (command == "pack") return pack(args[2], args.subspan(3));
+        if (command == "list") return list(args[2]);
+        if (command == "verify") return verify(args[2]);
+
+        print_usage();
+        return 1;
+    }
+    catch (const orb::exception& e)
+    {
+        fmt::println("Fatal error: {}", e.what());
+        return 1;
+    }
+}